@@ -36,6 +36,7 @@
  */
 
 #include "MSComm.h"
+#include "mscript_descriptors.h"
 
 
 /// Offset value for MethodSCRIPT parameters (see the MethodSCRIPT documentation paragraph 'Measurement data package variables')
@@ -341,67 +342,11 @@ int GetRangeFromPackage(char * metaDataRange)
 //
 char const * range_to_string(int range, VarType vt)
 {
-	if(s_dt == DT_ESPICO)
-	{
-		switch (range)
-		{
-		case   0: return "100 nA";
-		case   1: return   "2 uA";
-		case   2: return   "4 uA";
-		case   3: return   "8 uA";
-		case   4: return  "16 uA";
-		case   5: return  "32 uA";
-		case   6: return  "63 uA";
-		case   7: return "125 uA";
-		case   8: return "250 uA";
-		case   9: return "500 uA";
-		case  10: return   "1 mA";
-		case  11: return   "5 mA";
-		case 128: return "100 nA (High speed)";
-		case 129: return   "1 uA (High speed)";
-		case 130: return   "6 uA (High speed)";
-		case 131: return  "13 uA (High speed)";
-		case 132: return  "25 uA (High speed)";
-		case 133: return  "50 uA (High speed)";
-		case 134: return "100 uA (High speed)";
-		case 135: return "200 uA (High speed)";
-		case 136: return   "1 mA (High speed)";
-		case 137: return   "5 mA (High speed)";
-		default:  return "Invalid value";
-		}
-	}
-	else if(s_dt == DT_ES4)
-	{
-		if(vt == MSCR_VT_POTENTIAL)
-		{
-			switch (range)
-			{
-			case   2: return   "50 mV";
-			case   3: return  "100 mV";
-			case   4: return  "200 mV";
-			case   5: return  "500 mV";
-			case   6: return     "1 V";
-			default:  return "Invalid value";
-			}
-		}
-		else
-		{
-			switch (range)
-			{
-			case   0: return "100 pA";
-			case   3: return   "1 nA";
-			case   6: return  "10 nA";
-			case   9: return "100 nA";
-			case   12:return   "1 uA";
-			case   15:return  "10 uA";
-			case   18:return "100 uA";
-			case   21:return   "1 mA";
-			case   24:return  "10 mA";
-			case   27:return "100 mA";
-			default:  return "Invalid value";
-			}
-		}
-	}
+	// The range labels are shared with the C library (see mscript_descriptors.h).
+	MscriptRangeTable_t table = (s_dt == DT_ES4) ? MSCRIPT_RANGE_TABLE_EMSTAT4
+		: MSCRIPT_RANGE_TABLE_EMSTAT_PICO;
+	char const * label = mscript_get_range_label(table, vt, range);
+	return (label != NULL) ? label : "Invalid value";
 }
 
 //
@@ -409,88 +354,5 @@ char const * range_to_string(int range, VarType vt)
 //
 const char * VartypeToString(int variable_type)
 {
-	switch (variable_type) {
-	case MSCR_VT_UNKNOWN:
-		return "MSCR_VT_UNKNOWN";
-	case MSCR_VT_POTENTIAL:
-		return "Potential";
-	case MSCR_VT_POTENTIAL_CE:
-		return "Potential_CE";
-	case MSCR_VT_POTENTIAL_SE:
-		return "Potential_SE";
-	case MSCR_VT_POTENTIAL_RE:
-		return "Potential_RE";
-	case MSCR_VT_POTENTIAL_WE_VS_CE:
-		return "Potential_WE_vs_CE";
-	case MSCR_VT_POTENTIAL_AIN0:
-		return "Potential_AIN0";
-	case MSCR_VT_POTENTIAL_AIN1:
-		return "Potential_AIN1";
-	case MSCR_VT_POTENTIAL_AIN2:
-		return "Potential_AIN2";
-	case MSCR_VT_POTENTIAL_AIN3:
-		return "Potential_AIN3";
-	case MSCR_VT_POTENTIAL_AIN4:
-		return "Potential_AIN4";
-	case MSCR_VT_POTENTIAL_AIN5:
-		return "Potential_AIN5";
-	case MSCR_VT_POTENTIAL_AIN6:
-		return "Potential_AIN6";
-	case MSCR_VT_POTENTIAL_AIN7:
-		return "Potential_AIN7";
-	case MSCR_VT_CURRENT:
-		return "Current";
-	case MSCR_VT_PHASE:
-		return "Phase";
-	case MSCR_VT_IMP:
-		return "Imp";
-	case MSCR_VT_ZREAL:
-		return "Zreal";
-	case MSCR_VT_ZIMAG:
-		return "Zimag";
-	case MSCR_VT_CELL_SET_POTENTIAL:
-		return "Cell_set_potential";
-	case MSCR_VT_CELL_SET_CURRENT:
-		return "Cell_set_current";
-	case MSCR_VT_CELL_SET_FREQUENCY:
-		return "Cell_set_frequency";
-	case MSCR_VT_CELL_SET_AMPLITUDE:
-		return "Cell_set_amplitude";
-	case MSCR_VT_CHANNEL:
-		return "Channel";
-	case MSCR_VT_TIME:
-		return "Time";
-	case MSCR_VT_PIN_MSK:
-		return "Pin_msk";
-	case MSCR_VT_DEV_ADC_OFFSET:
-		return "Dev_adc_offset";
-	case MSCR_VT_DEV_HS_EX:
-		return "Dev_hs_ex";
-	case MSCR_VT_CURRENT_GENERIC1:
-		return "Current_generic1";
-	case MSCR_VT_CURRENT_GENERIC2:
-		return "Current_generic2";
-	case MSCR_VT_CURRENT_GENERIC3:
-		return "Current_generic3";
-	case MSCR_VT_CURRENT_GENERIC4:
-		return "Current_generic4";
-	case MSCR_VT_POTENTIAL_GENERIC1:
-		return "Potential_generic1";
-	case MSCR_VT_POTENTIAL_GENERIC2:
-		return "Potential_generic2";
-	case MSCR_VT_POTENTIAL_GENERIC3:
-		return "Potential_generic3";
-	case MSCR_VT_POTENTIAL_GENERIC4:
-		return "Potential_generic4";
-	case MSCR_VT_MISC_GENERIC1:
-		return "Misc_generic1";
-	case MSCR_VT_MISC_GENERIC2:
-		return "Misc_generic2";
-	case MSCR_VT_MISC_GENERIC3:
-		return "Misc_generic3";
-	case MSCR_VT_MISC_GENERIC4:
-		return "Misc_generic4";
-	default:
-		return "Undefined variable type";
-	}
+	return mscript_get_vartype_descriptor(variable_type)->name;
 }
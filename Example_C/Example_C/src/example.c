@@ -10,6 +10,17 @@
  *   - Reading the device firmware version.
  *   - Sending a MethodSCRIPT from file to the device.
  *   - Receiving and parsing the results from the MethodSCRIPT.
+ *   - Running scripts on multiple devices at the same time.
+ *   - Processing the channels of a multi-channel instrument in parallel.
+ *   - Splitting the data of multiplexer (MUX) scripts per channel.
+ *   - Reconnecting automatically when the connection is lost.
+ *   - Detecting peaks in voltammetric scans while the data arrives.
+ *   - Fitting an equivalent circuit to impedance spectra in parallel.
+ *   - Calculating impedance and harmonic distortion from EIS time domain data.
+ *   - Keeping running statistics of each variable in a measurement loop.
+ *   - Aborting the script when the data meets a condition (host-side triggers).
+ *   - Publishing the live data to other processes through shared memory.
+ *   - Streaming the live data to subscribers over a socket.
  * 
  * The measurement data is displayed on the standard output (the console) and
  * stored in CSV files (*1). The MethodSCRIPT can be supplied by the user. It is
@@ -25,7 +36,10 @@
  * 
  * The following example scripts are shipped with this demo:
  *   - example_CA
+ *   - example_CV_nscans
  *   - example_EIS
+ *   - example_EIS_TDD
+ *   - example_Mott_Schottky
  *   - example_LSV_10k
  *   - example_SWV_10k
  * There are more examples available in the Example_MethodSCRIPTs folder
@@ -41,6 +55,74 @@
  *         Higher-level (platform independent) communication functions and
  *         generic functions to communicate with MethodSCRIPT devices and to
  *         parse responses.
+ *   - mscript_acquisition:
+ *         Receives the output of a running script and passes it as events
+ *         to a sink. Can be used for several devices at the same time.
+ *   - mscript_columns:
+ *         Stores the data of a run in columns, split per channel, with an
+ *         index of the rows and statistics of each measurement loop.
+ *   - mscript_cv_scans:
+ *         Splits cyclic voltammetry data into scans and calculates the charge
+ *         and peaks of each scan, using the worker threads.
+ *   - mscript_downsample:
+ *         Min/max summary of long series of data, to show any range with a
+ *         limited number of points, and LTTB downsampling (not used by the
+ *         example itself).
+ *   - mscript_data_server:
+ *         Streams the data packages to clients that connect over TCP or a
+ *         UNIX domain socket, with a bounded send queue per client (Linux
+ *         only).
+ *   - mscript_demux:
+ *         Routes the data packages of a multi-channel instrument (such as the
+ *         MultiEmStat4) to a separate sink per channel, each processed by
+ *         its own thread.
+ *   - mscript_eis_fit:
+ *         Fits a Randles circuit to impedance spectra, using the worker
+ *         threads to fit many spectra in parallel.
+ *   - mscript_eis_tdd:
+ *         Calculates the impedance and harmonic distortion of each frequency
+ *         from EIS time domain data, using the worker threads.
+ *   - mscript_fft:
+ *         Fast Fourier transform of real data, of any length.
+ *   - mscript_peaks:
+ *         Streaming peak detection of voltammetric data (SWV, DPV and CV).
+ *   - mscript_savgol:
+ *         Savitzky-Golay smoothing and differentiation, applied to an array
+ *         or as a streaming stage (not used by the example itself).
+ *   - mscript_scan_average:
+ *         Running mean and standard error of repeated scans, aligned by their
+ *         applied potential.
+ *   - mscript_session:
+ *         Runs an acquisition and reconnects to the device when the
+ *         connection is lost.
+ *   - mscript_fw_upload:
+ *         Uploads firmware to the bootloader of a device, with pipelined
+ *         blocks (not used by the example itself, see tools/fw_upload.c).
+ *   - mscript_loop_tree:
+ *         Tree of the nested loops, measurement loops and scans of a run,
+ *         allocated from one arena (not used by the example itself).
+ *   - mscript_mott_schottky:
+ *         Capacitance and 1/C^2 of single frequency impedance measurements at
+ *         stepped DC potentials, with an incremental fit of the linear region
+ *         for the flat-band potential and doping density.
+ *   - mscript_output:
+ *         Shared output writer that writes the files of all devices from
+ *         one background thread.
+ *   - mscript_shm_ring:
+ *         Ring buffer in POSIX shared memory that publishes the data packages
+ *         to other local processes (Linux only, see tools/shm_reader.c).
+ *   - mscript_stats:
+ *         Online statistics (mean, standard deviation, min/max, slope and
+ *         status flag counts) of each variable in a measurement loop.
+ *   - mscript_trigger:
+ *         Host-side triggers that abort the script (or start a follow-up
+ *         script) when a value, mean or slope crosses a threshold.
+ *   - mscript_thread:
+ *         Threads and synchronization. Like the serial port, this module is
+ *         platform-dependent but has a common interface.
+ *   - mscript_workers:
+ *         Pool of worker threads, shared by the processing stages of all
+ *         devices.
  *   - example:
  *         A custom application to demonstrate the use of the above-mentioned
  *         modules.
@@ -78,12 +160,41 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "palmsens/mscript.h"
+#include "palmsens/mscript_acquisition.h"
+#include "palmsens/mscript_analyzer.h"
+#include "palmsens/mscript_columns.h"
+#include "palmsens/mscript_cv_scans.h"
+#include "palmsens/mscript_data_server.h"
+#include "palmsens/mscript_demux.h"
+#include "palmsens/mscript_discovery.h"
+#include "palmsens/mscript_eis_fit.h"
+#include "palmsens/mscript_eis_tdd.h"
+#include "palmsens/mscript_flash_cache.h"
+#include "palmsens/mscript_mott_schottky.h"
+#include "palmsens/mscript_output.h"
+#include "palmsens/mscript_peaks.h"
+#include "palmsens/mscript_scan_average.h"
 #include "palmsens/mscript_serial_port.h"
+#include "palmsens/mscript_session.h"
+#include "palmsens/mscript_shm_ring.h"
+#include "palmsens/mscript_stats.h"
+#include "palmsens/mscript_thread.h"
+#include "palmsens/mscript_trigger.h"
+#include "palmsens/mscript_workers.h"
+
+// When built using the Makefile, the scripts in the "scripts" directory are
+// compiled into the application (see tools/mscr2h.c).
+#ifdef MSCRIPT_HAVE_GENERATED_SCRIPTS
+#include "mscript_scripts.h"
+#endif
 
 /*
 Please uncomment one of the #define lines below to select the correct baudrate for your MethodSCRIPT device
@@ -98,9 +209,30 @@ For the EmStat4: 921600 (230400 for FW <= 1.1)
 #endif
 
 /// Timeout (in ms) for reading responses.
-// NOTE: If you're doing long measurements, you might need to increase this value.
+// NOTE: Inside measurement loops, this timeout is increased automatically
+// based on the predicted time between two data packages (see
+// `mscript_analyzer.h`). If your script has other long running commands
+// (e.g. a long `wait`), you might need to increase this value, or use the
+// `--reconnect` option, which keeps waiting while the device is connected.
 #define READ_TIMEOUT 5000
 
+/// Maximum time (in ms) for the device to become ready after aborting a script.
+#define ABORT_DEADLINE 2000
+
+/// Maximum number of devices that can be used at the same time.
+#define MAX_NR_OF_DEVICES 64
+
+/**
+ * Size of the blocks of the shared output writer, which writes the CSV files
+ * and the console output of the devices. See `mscript_output.h`. Since each
+ * file is written in blocks of this size, the CSV files do not need a write
+ * buffer based on the predicted output of the measurement loop.
+ */
+#define OUTPUT_BLOCK_SIZE (64 * 1024)
+
+/// Maximum length of one console message of a device.
+#define MAX_MESSAGE_LENGTH 256
+
 // Set the following macro to 1 to add a Microsoft Excel specific header line to
 // the CSV file. This might improve importing the CSV file using Excel,
 // depending on your regional settings.
@@ -112,39 +244,278 @@ For the EmStat4: 921600 (230400 for FW <= 1.1)
 
 #define FIRMWARE_STRING_LENGTH 80
 
+#define SERIAL_NUMBER_LENGTH 64
+
 /**
  * Maximum buffer size necessary to hold path to script file.
  * (The path will be "scripts/NAME.mscr")
  */
 #define MAX_SCRIPT_FILE_PATH_SIZE (8 + MAX_SCRIPT_NAME_LENGTH + 5 + 1)
 
+/// Maximum length of the suffix of a CSV file name (e.g. "-ch00-fit").
+#define MAX_CSV_FILE_SUFFIX_LENGTH 15
+
 /**
- * Maximum buffer size necessary to hold path to script file.
- * (The path will be "results/NAME-0000-M0000.csv")
+ * Maximum buffer size necessary to hold path to CSV file.
+ * (The path will be "results/NAME-dev00-0000-M0000SUFFIX.csv", where the
+ * index can have up to 10 digits)
+ */
+#define MAX_CSV_FILE_PATH_SIZE (8 + MAX_SCRIPT_NAME_LENGTH + 27 + MAX_CSV_FILE_SUFFIX_LENGTH + 1)
+
+/**
+ * Path to the file that records which script is stored in the flash memory of
+ * which device (see the `--flash` option).
  */
-#define MAX_CSV_FILE_PATH_SIZE (8 + MAX_SCRIPT_NAME_LENGTH + 15 + 1)
+#define FLASH_CACHE_PATH "results/flash_cache.txt"
 
 static char const help_text[] = 
-	"USAGE: %s PORT SCRIPT_NAME\n" // %s -> argv[0]
+	"USAGE: %s [--flash] [--reconnect] [--trigger CONDITION]... [--publish NAME]\n" // %s -> argv[0]
+	"       [--serve ADDRESS [--slow-clients POLICY]] PORT [SCRIPT_NAME] [PORT SCRIPT_NAME]...\n"
+	"       %s --discover\n" // %s -> argv[0]
 	"\n"
 	"with:\n"
 	"    PORT       : the serial port (e.g. COM1 on Windows or /dev/ttyUSB0 on Linux\n"
 	"    SCRIPT_NAME: name of the MethodSCRIPT file to send to the device.\n"
 	"                 The script should be located in the 'scripts' directory and\n"
 	"                 have a '.mscr' extension.\n"
+	"    --flash    : store the script in the flash memory of the device and run\n"
+	"                 it from there. The script is only uploaded again if it has\n"
+	"                 changed since the previous run on the same device.\n"
+	"    --reconnect: if the connection is lost during a measurement, reconnect\n"
+	"                 to the device and restart the script. The data is appended\n"
+	"                 to the same CSV file, after a line that marks the gap.\n"
+	"    --trigger  : abort the script as soon as a data package meets the\n"
+	"                 CONDITION, e.g. 'ba>1u' (current above 1 uA),\n"
+	"                 'mean(ba,5)<-2n' (mean of the last 5 currents below -2 nA)\n"
+	"                 or 'slope(ba@3,10)>1e-6' (slope of the current of channel 3).\n"
+	"    --publish  : publish all data packages in a ring buffer in shared memory\n"
+	"                 with the given NAME (e.g. '/mscript'), which other local\n"
+	"                 processes can read (e.g. tools/shm_reader.c). Linux only.\n"
+	"    --serve    : stream all data packages to clients that connect to ADDRESS,\n"
+	"                 a TCP port on the local host (e.g. 8765), HOST:PORT or the\n"
+	"                 path of a UNIX domain socket. Clients send a line like\n"
+	"                 'subscribe device=1 channel=3 format=ndjson'. Linux only.\n"
+	"    --slow-clients: what to do when a client does not keep up: drop-oldest\n"
+	"                 (default), drop-newest or disconnect.\n"
+	"    --discover : list the connected devices, with their port and baud rate.\n"
+	"\n"
+	"If more than one PORT SCRIPT_NAME pair is given, all devices are used at the\n"
+	"same time. The output of each device is prefixed with its number ([1], [2],\n"
+	"...) and the number is also part of the names of its CSV files.\n"
+	"\n"
+	"The data of each channel of a multi-channel instrument (MultiEmStat4) is\n"
+	"processed in parallel and stored in a separate CSV file per channel.\n"
+	"If the data packages of a script contain the channel number (variable type\n"
+	"'ea'), e.g. when using a multiplexer, a CSV file per channel is written\n"
+	"after each measurement loop as well.\n"
+	"\n"
+	"A Randles circuit is fitted to the spectrum of each EIS measurement loop\n"
+	"(and each channel); the results are stored in a '-fit' CSV file. If the\n"
+	"loop returns time domain data (eis_tdd), the impedance and harmonic\n"
+	"distortion of each frequency are stored in a '-tdd' CSV file.\n"
+	"\n"
+	"The data of a cyclic voltammetry measurement loop is split per scan, and\n"
+	"the charge, peak currents and peak separation of each scan are stored in\n"
+	"a '-scans' CSV file.\n"
+	"\n"
+	"When a voltammetric measurement (SWV, DPV, CV or LSV) is repeated, e.g. in\n"
+	"a loop or with 'nscans', the scans are averaged by potential. The mean and\n"
+	"standard error of each point are stored in an '-avg' CSV file.\n"
+	"\n"
+	"If the packages of an EIS measurement contain the DC potential (e.g.\n"
+	"example_Mott_Schottky), the capacitance and 1/C^2 of each point are stored\n"
+	"in an '-ms' CSV file and the flat-band potential and doping density are\n"
+	"estimated from the linear region of 1/C^2 (Mott-Schottky analysis).\n"
 	"\n"
 	;
 
+struct Device;
+
+/** Output of one channel of a multi-channel instrument. */
+typedef struct {
+	struct Device * device;
+	unsigned int number;
+	/** The CSV file of the current measurement loop, or NULL. */
+	MscriptOutputFile_t * csv;
+	/** Console output of the channel thread, or NULL if not used yet. */
+	MscriptOutputFile_t * console;
+	/** `true` if peaks are detected in the current measurement loop. */
+	bool detect_peaks;
+	MscriptPeakDetector_t peak_detector;
+	/** The response that started the current measurement loop (e.g. "M0008"). */
+	char meas_loop_id[6];
+} Channel_t;
+
+/** The Mott-Schottky analysis of one electrode. */
+typedef struct {
+	/** The analysis, or NULL if no points have been received. */
+	MscriptMottSchottky_t * analysis;
+	/** The measurement loop of the first point, used to name the CSV file. */
+	unsigned int meas_loop_index;
+	char meas_loop_id[6];
+} MottSchottky_t;
+
+/** The average of the scans of one measurement loop of the script. */
+typedef struct {
+	/** The average, or NULL if the loop has not been run yet. */
+	MscriptScanAverage_t * average;
+	/** The first run of the loop, used to name the CSV file. */
+	unsigned int meas_loop_index;
+	char meas_loop_id[6];
+} ScanAverage_t;
+
+/** Kind of potential scan of a measurement loop (see `get_scan_type()`). */
+typedef enum {
+	SCAN_TYPE_NONE,   //!< Not a potential scan, or the technique is not known
+	SCAN_TYPE_LINEAR, //!< LSV
+	SCAN_TYPE_PULSED, //!< SWV or DPV
+	SCAN_TYPE_CYCLIC, //!< CV
+} ScanType_t;
+
+/** State of one device. */
+typedef struct Device {
+	/** Number of the device (1 for the first PORT argument). */
+	unsigned int number;
+	char const * port;
+	/** Name of the script, or NULL to only identify the device. */
+	char const * script_name;
+	bool use_flash;
+	/** Reconnect and restart the script when the connection is lost. */
+	bool use_reconnect;
+	/** `true` if more than one device is used at the same time. */
+	bool is_concurrent;
+	DeviceType_t device_type;
+	/** Serial number (only read if `use_reconnect` is set). */
+	char serial_number[SERIAL_NUMBER_LENGTH];
+	/** Path to the script file. */
+	char script_file_path[MAX_SCRIPT_FILE_PATH_SIZE];
+	/** The built-in version of the script, or NULL. */
+	MscriptBuiltinScript_t const * builtin;
+	/** Prediction of the output of the script (only valid while it runs). */
+	MscriptPrediction_t const * prediction;
+	/** Console output, or NULL to print directly to stdout. */
+	MscriptOutputFile_t * console;
+	/** The CSV file of the current measurement loop, or NULL. */
+	MscriptOutputFile_t * csv;
+	/** Demultiplexer for the channels of a multi-channel instrument, or NULL. */
+	MscriptDemux_t * demux;
+	/** Output of each channel, if `demux` is used. */
+	Channel_t channels[MSCRIPT_DEMUX_MAX_CHANNELS];
+	/** The data split per channel, if the packages contain a channel number. */
+	MscriptColumnStore_t * columns;
+	/** The response that started the current measurement loop (e.g. "M0007"). */
+	char meas_loop_id[6];
+	/** Added to the package index, when continuing a CSV file after a reconnect. */
+	unsigned int package_index_offset;
+	/** Index of the last package written to the CSV file. */
+	unsigned int last_package_index;
+	/** `true` if the CSV file should be continued by the next measurement loop. */
+	bool is_resuming;
+	/** `true` if peaks are detected in the current measurement loop. */
+	bool detect_peaks;
+	MscriptPeakDetector_t peak_detector;
+	/** `true` if the current measurement loop is an EIS measurement. */
+	bool is_eis_loop;
+	/** The impedance spectra of the run, per channel, to be fitted. */
+	MscriptColumnStore_t * spectra;
+	/** The EIS time domain data of the current measurement loop, or NULL. */
+	MscriptEisTdd_t * tdd;
+	/** `true` if the current measurement loop is a cyclic voltammetry measurement. */
+	bool is_cv_loop;
+	/** The scans of the current cyclic voltammetry measurement loop, or NULL. */
+	MscriptCvScans_t * cv_scans;
+	/** The average of the scans of each measurement loop of the script. */
+	ScanAverage_t scan_averages[MSCRIPT_ANALYZER_MAX_LOOPS];
+	/** The average of the current measurement loop, or NULL if it is not averaged. */
+	ScanAverage_t * scan_average;
+	/**
+	 * The Mott-Schottky analysis of the packages without a channel number
+	 * (index 0) and of each channel (index channel + 1). The entry of a
+	 * channel of a multi-channel instrument is only used by its own thread.
+	 */
+	MottSchottky_t mott_schottky[MSCRIPT_COLUMN_STORE_MAX_CHANNELS + 1];
+	/** Statistics of the packages without a channel number in the current measurement loop. */
+	MscriptLoopStats_t loop_stats;
+	/** The triggers that abort the script (see the `--trigger` option). */
+	MscriptTriggerConfig_t const * triggers;
+	size_t nr_of_triggers;
+	MscriptTriggerStats_t trigger_stats;
+	MscriptAcquisitionStats_t stats;
+	bool success;
+} Device_t;
+
+/** A spectrum submitted to be fitted, passed to `handle_eis_fit()`. */
+typedef struct {
+	Device_t * device;
+	unsigned int meas_loop_index;
+	/** `true` if the packages contain a channel number (e.g. of a multiplexer). */
+	bool has_channel;
+	/** The channel (less than `MSCRIPT_COLUMN_STORE_MAX_CHANNELS`), if `has_channel`. */
+	unsigned int channel;
+	/** The response that started the measurement loop (e.g. "M0007"). */
+	char meas_loop_id[6];
+} EisFitRequest_t;
+
 // Forward declarations.
-static bool identify_device(SerialPortHandle_t handle);
-static bool execute_script(SerialPortHandle_t handle, char const * script_name);
-static bool process_response(SerialPortHandle_t handle, char const * script_name);
-static FILE * create_csv_file(char const * script_name, unsigned index, char const * response);
-static void print_data_package(MscriptDataPackage_t * package);
-static void write_csv_header_row(FILE * fp, MscriptDataPackage_t * package);
-static void write_csv_data_row(FILE * fp, unsigned int index, MscriptDataPackage_t * package);
+static bool discover_devices(void);
+static void run_device(void * arg);
+static void device_printf(Device_t * device, char const * format, ...);
+static bool identify_device(Device_t * device, SerialPortHandle_t handle);
+static bool execute_script(Device_t * device, SerialPortHandle_t * p_handle);
+static bool start_script(void * context, SerialPortHandle_t handle);
+static MscriptBuiltinScript_t const * find_builtin_script(Device_t * device,
+	char const * script_file_path);
+static void check_prediction(Device_t * device, MscriptPrediction_t const * prediction);
+static bool handle_event(void * context, MscriptEvent_t const * event);
+static void handle_trigger(void * context, MscriptTriggerEvent_t const * event);
+static bool create_channel_sink(void * context, unsigned int channel, MscriptSink_t * p_sink);
+static bool handle_channel_event(void * context, MscriptEvent_t const * event);
+static bool finish_channels(Device_t * device);
+static void publish_package(Device_t const * device, int channel, MscriptEvent_t const * event);
+static bool write_channel_csv_files(Device_t * device, unsigned int meas_loop_index);
+static char const * get_technique(MscriptEvent_t const * event);
+static ScanType_t get_scan_type(MscriptEvent_t const * event);
+static bool start_peak_detection(MscriptEvent_t const * event, MscriptPeakDetector_t * detector);
+static void print_peak(Device_t * device, Channel_t * ch, MscriptPeak_t const * peak);
+static void print_loop_stats(Device_t * device, int channel,
+	MscriptLoopStats_t const * loop_stats);
+static bool submit_eis_fits(Device_t * device, unsigned int meas_loop_index);
+static void handle_eis_fit(void * context, MscriptEisFitResult_t const * result);
+static bool write_eis_tdd_results(Device_t * device, unsigned int meas_loop_index);
+static bool start_cv_scans(Device_t * device, MscriptEvent_t const * event);
+static bool write_cv_scan_results(Device_t * device, unsigned int meas_loop_index);
+static ScanAverage_t * start_scan_average(Device_t * device, MscriptEvent_t const * event);
+static void end_scan_average(Device_t * device);
+static bool write_scan_averages(Device_t * device);
+static bool add_mott_schottky_point(MottSchottky_t * ms, MscriptEvent_t const * event,
+	char const * meas_loop_id);
+static bool write_mott_schottky_results(Device_t * device);
+static void print_statistics(Device_t const * devices, size_t nr_of_devices);
+static bool get_csv_file_path(Device_t const * device, unsigned int index, char const * response,
+	char const * suffix, char * path);
+static MscriptOutputFile_t * create_csv_file(Device_t * device, unsigned index,
+	char const * response);
+static void print_data_package(MscriptOutputFile_t * console,
+	MscriptDataPackage_t const * package, DeviceType_t device_type);
+static void write_csv_header_row(MscriptOutputFile_t * csv, MscriptDataPackage_t const * package);
+static void print_metadata_status(MscriptOutputFile_t * csv, int status);
+static void write_csv_data_row(MscriptOutputFile_t * csv, unsigned int index,
+	MscriptDataPackage_t const * package, DeviceType_t device_type);
+
+/// The shared output writer for all devices.
+static MscriptOutput_t * output = NULL;
+
+/// Worker threads that process the EIS data of all devices, or NULL if not available.
+static MscriptWorkers_t * workers = NULL;
+
+/// Protects the flash cache file, which is shared by all devices.
+static MscriptMutex_t flash_cache_mutex;
+
+/// Ring in shared memory to which the packages of all devices are published, or NULL.
+static MscriptShmRing_t * shm_ring = NULL;
 
-static DeviceType_t device_type = UNKNOWN_DEVICE;
+/// Server that streams the packages of all devices to its clients, or NULL.
+static MscriptDataServer_t * data_server = NULL;
 
 /**
  * Example application.
@@ -153,46 +524,276 @@ static DeviceType_t device_type = UNKNOWN_DEVICE;
  */
 int main(int argc, char * argv[])
 {
-	// Check the number of command-line arguments.
-	// Display help text if number of arguments is not 2 or 3.
-	if ((argc < 2) || (argc > 3)) {
-		printf(help_text, argv[0]);
-		return EXIT_FAILURE;
+	if ((argc == 2) && !strcmp(argv[1], "--discover")) {
+		return discover_devices() ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
 
-	// Set port and script name to supplied arguments.
-	char const * port = argv[1];
-	char const * script_name = (argc >= 3) ? argv[2] : NULL;
+	// Check for options, which precede the positional arguments.
+	int arg_index = 1;
+	bool use_flash = false;
+	bool use_reconnect = false;
+	static MscriptTriggerConfig_t triggers[MSCRIPT_TRIGGER_MAX_TRIGGERS];
+	size_t nr_of_triggers = 0;
+	char const * shm_ring_name = NULL;
+	MscriptDataServerConfig_t server_config;
+	mscript_data_server_default_config(&server_config);
+	bool use_data_server = false;
+	for (; arg_index < argc; ++arg_index) {
+		if (!strcmp(argv[arg_index], "--flash")) {
+			use_flash = true;
+		} else if (!strcmp(argv[arg_index], "--reconnect")) {
+			use_reconnect = true;
+		} else if (!strcmp(argv[arg_index], "--trigger") && (arg_index + 1 < argc)) {
+			++arg_index;
+			if ((nr_of_triggers == MSCRIPT_TRIGGER_MAX_TRIGGERS)
+				|| !mscript_trigger_parse(argv[arg_index], &triggers[nr_of_triggers])) {
+				printf("ERROR: Invalid or too many triggers: %s\n", argv[arg_index]);
+				return EXIT_FAILURE;
+			}
+			triggers[nr_of_triggers++].action = MSCRIPT_TRIGGER_ACTION_ABORT;
+		} else if (!strcmp(argv[arg_index], "--publish") && (arg_index + 1 < argc)) {
+			shm_ring_name = argv[++arg_index];
+		} else if (!strcmp(argv[arg_index], "--serve") && (arg_index + 1 < argc)) {
+			server_config.address = argv[++arg_index];
+			use_data_server = true;
+		} else if (!strcmp(argv[arg_index], "--slow-clients") && (arg_index + 1 < argc)) {
+			++arg_index;
+			if (!mscript_data_server_parse_policy(argv[arg_index], &server_config.policy)) {
+				printf("ERROR: Invalid slow client policy: %s\n", argv[arg_index]);
+				return EXIT_FAILURE;
+			}
+		} else {
+			break;
+		}
+	}
 
-	// Open the serial port on the requested port.
-	SerialPortHandle_t h_device = mscript_serial_port_open(port, MSCRIPT_DEV_BAUDRATE);
-	if (h_device == BAD_HANDLE) {
-		printf("ERROR: Could not open port.\n");
+	// Check the number of remaining command-line arguments.
+	// Display help text if there is not exactly one port, or a list of
+	// port and script name pairs.
+	int nr_of_args = argc - arg_index;
+	if ((nr_of_args < 1) || ((nr_of_args > 1) && ((nr_of_args % 2) != 0))
+		|| (nr_of_args > 2 * MAX_NR_OF_DEVICES)) {
+		printf(help_text, argv[0], argv[0]);
 		return EXIT_FAILURE;
 	}
 
-	// Flush communication. This is required for some Bluetooth devices.
-	mscript_flush_communication(h_device);
+	// Set port and script name of each device to supplied arguments.
+	static Device_t devices[MAX_NR_OF_DEVICES];
+	size_t nr_of_devices = (nr_of_args == 1) ? 1 : (size_t)nr_of_args / 2;
+	for (size_t i = 0; i < nr_of_devices; ++i) {
+		Device_t * device = &devices[i];
+		device->number = (unsigned int)i + 1;
+		device->port = argv[arg_index + 2 * i];
+		device->script_name = (nr_of_args >= 2) ? argv[arg_index + 2 * i + 1] : NULL;
+		device->use_flash = use_flash;
+		device->use_reconnect = use_reconnect;
+		device->triggers = triggers;
+		device->nr_of_triggers = nr_of_triggers;
+		device->is_concurrent = nr_of_devices > 1;
+		device->device_type = UNKNOWN_DEVICE;
+	}
 
-	// Identify the device: print the firmware version. The type of device
-	// can also be derived from the version information. Note that this also
-	// tests if communication is working correctly and the device is not busy.
-	bool success = identify_device(h_device);
+	// Each device has at most two output files open at the same time (its
+	// console and a CSV file), or a CSV file per channel for multi-channel
+	// instruments, which each use one block while being filled. Each worker
+	// thread also writes two files (a CSV file and the console).
+	output = mscript_output_create(OUTPUT_BLOCK_SIZE,
+		(3 * MSCRIPT_DEMUX_MAX_CHANNELS + 4) * nr_of_devices
+		+ 2 * mscript_get_nr_of_processors() + 4);
+	if (output == NULL) {
+		printf("ERROR: Could not start output writer.\n");
+		return EXIT_FAILURE;
+	}
+	if (shm_ring_name != NULL) {
+		shm_ring = mscript_shm_ring_create(shm_ring_name, 0);
+		if (shm_ring == NULL) {
+			printf("ERROR: Could not create shared memory ring %s.\n", shm_ring_name);
+			mscript_output_destroy(output, NULL);
+			return EXIT_FAILURE;
+		}
+		printf("Publishing data packages in shared memory ring %s.\n", shm_ring_name);
+	}
+	if (use_data_server) {
+		data_server = mscript_data_server_create(&server_config);
+		if (data_server == NULL) {
+			printf("ERROR: Could not start data server on %s.\n", server_config.address);
+			if (shm_ring != NULL) {
+				mscript_shm_ring_destroy(shm_ring);
+			}
+			mscript_output_destroy(output, NULL);
+			return EXIT_FAILURE;
+		}
+		printf("Serving data packages on %s.\n", server_config.address);
+	}
+	mscript_mutex_init(&flash_cache_mutex);
+	// One worker thread per processor. The EIS data is not processed if this fails.
+	workers = mscript_workers_create(0);
 
-	if (success) {
-		if (script_name == NULL) {
-			printf("No script name supplied. Quitting.\n");
+	if (nr_of_devices == 1) {
+		// The data packages are printed through the output writer as well,
+		// so they are not mixed with the output of the worker threads.
+		devices[0].console = mscript_output_open_stream(output, stdout);
+		if (devices[0].console == NULL) {
+			printf("ERROR: Could not open the console output.\n");
 		} else {
-			// Execute the script
-			success = execute_script(h_device, script_name);
+			run_device(&devices[0]);
+		}
+	} else {
+		// Run each device in its own thread.
+		static MscriptThread_t threads[MAX_NR_OF_DEVICES];
+		bool is_started[MAX_NR_OF_DEVICES];
+		for (size_t i = 0; i < nr_of_devices; ++i) {
+			devices[i].console = mscript_output_open_stream(output, stdout);
+			is_started[i] = (devices[i].console != NULL)
+				&& mscript_thread_create(&threads[i], run_device, &devices[i]);
+			if (!is_started[i]) {
+				printf("ERROR: Could not start thread for device %u.\n", devices[i].number);
+				if (devices[i].console != NULL) {
+					mscript_output_close(devices[i].console);
+				}
+			}
 		}
+		for (size_t i = 0; i < nr_of_devices; ++i) {
+			if (is_started[i]) {
+				mscript_thread_join(threads[i]);
+			}
+		}
+	}
+
+	// Wait until all spectra have been fitted and all output has been written.
+	if (workers != NULL) {
+		mscript_workers_destroy(workers);
+	}
+	bool success = mscript_output_destroy(output, NULL);
+	if (!success) {
+		printf("ERROR: Failed to write all output files.\n");
+	}
+	mscript_mutex_destroy(&flash_cache_mutex);
+	if (shm_ring != NULL) {
+		mscript_shm_ring_destroy(shm_ring);
+	}
+	if (data_server != NULL) {
+		MscriptDataServerStats_t server_stats;
+		mscript_data_server_get_stats(data_server, &server_stats);
+		mscript_data_server_destroy(data_server);
+		printf("Data server: %u client(s), %" PRIu64 " packages queued, %" PRIu64 " dropped,"
+			" %u slow client(s) disconnected.\n", server_stats.nr_of_clients,
+			server_stats.nr_of_queued, server_stats.nr_of_dropped,
+			server_stats.nr_of_slow_disconnects);
 	}
 
-	// Close the serial port and exit program.
-	mscript_serial_port_close(h_device);
+	if (devices[0].script_name != NULL) {
+		print_statistics(devices, nr_of_devices);
+	}
+	for (size_t i = 0; i < nr_of_devices; ++i) {
+		if (!devices[i].success) {
+			success = false;
+		}
+	}
 	return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+/**
+ * Find and print all connected MethodSCRIPT devices.
+ *
+ * All serial ports are probed at the same time, at all common baud rates (see
+ * `mscript_discovery.h`). The configured baud rate is tried first.
+ *
+ * \return `true` if at least one device was found, `false` otherwise
+ */
+static bool discover_devices(void)
+{
+	static MscriptDiscoveredDevice_t devices[MSCRIPT_DISCOVERY_MAX_PORTS];
+	uint32_t start_ms = mscript_get_time_ms();
+	size_t nr_of_devices = mscript_discover_devices(devices, MSCRIPT_DISCOVERY_MAX_PORTS,
+		MSCRIPT_DEV_BAUDRATE, MSCRIPT_DISCOVERY_DEFAULT_TIMEOUT);
+	uint32_t duration_ms = mscript_get_time_ms() - start_ms;
+
+	for (size_t i = 0; i < nr_of_devices; ++i) {
+		MscriptDiscoveredDevice_t const * device = &devices[i];
+		printf("%s: %s at %d baud, serial number %s, firmware version: %s\n", device->port,
+			mscript_get_device_type_name(device->device_type), device->baudrate,
+			(device->serial_number[0] != '\0') ? device->serial_number : "unknown",
+			device->firmware_version);
+	}
+	printf("Found %lu device(s) in %lu ms.\n", (unsigned long)nr_of_devices,
+		(unsigned long)duration_ms);
+	return nr_of_devices > 0;
+}
+
+/**
+ * Connect to a device and execute its script.
+ *
+ * This is the main function of the thread of each device when multiple
+ * devices are used. The result is stored in `device->success`.
+ */
+static void run_device(void * arg)
+{
+	Device_t * device = arg;
+
+	// Open the serial port on the requested port.
+	SerialPortHandle_t h_device = mscript_serial_port_open(device->port, MSCRIPT_DEV_BAUDRATE);
+	if (h_device == BAD_HANDLE) {
+		device_printf(device, "ERROR: Could not open port %s.\n", device->port);
+		device->success = false;
+	} else {
+		// Flush communication. This is required for some Bluetooth devices.
+		mscript_flush_communication(h_device);
+
+		// Identify the device: print the firmware version. The type of device
+		// can also be derived from the version information. Note that this also
+		// tests if communication is working correctly and the device is not busy.
+		device->success = identify_device(device, h_device);
+
+		if (device->success) {
+			if (device->script_name == NULL) {
+				device_printf(device, "No script name supplied. Quitting.\n");
+			} else {
+				// Execute the script
+				// Note that the handle changes if the device is reconnected.
+				device->success = execute_script(device, &h_device);
+			}
+		}
+
+		// Close the serial port.
+		if (h_device != BAD_HANDLE) {
+			mscript_serial_port_close(h_device);
+		}
+	}
+
+	if (device->console != NULL) {
+		mscript_output_close(device->console);
+		device->console = NULL;
+	}
+}
+
+/**
+ * Print a message of a device to the console.
+ *
+ * The message is written through the shared output writer, so it is not
+ * mixed with the output of other threads. If multiple devices are used, the
+ * message is prefixed with the number of the device. Each message should be
+ * one complete line.
+ */
+static void device_printf(Device_t * device, char const * format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	if (device->console == NULL) {
+		vprintf(format, args);
+	} else {
+		char message[MAX_MESSAGE_LENGTH];
+		vsnprintf(message, sizeof(message), format, args);
+		if (device->is_concurrent) {
+			mscript_output_printf(device->console, "[%u] %s", device->number, message);
+		} else {
+			mscript_output_printf(device->console, "%s", message);
+		}
+		mscript_output_flush(device->console);
+	}
+	va_end(args);
+}
+
 /**
  * Request and print the firmware version from the device.
  * 
@@ -201,27 +802,37 @@ int main(int argc, char * argv[])
  * with the device. If the serial number can be read successfully, this
  * means the communication is working and the device is ready to respond.
  *
+ * \param device The device.
  * \param handle Handle to the serial port.
  * 
  * \return `true` on success, `false` on failure
  */
-static bool identify_device(SerialPortHandle_t handle)
+static bool identify_device(Device_t * device, SerialPortHandle_t handle)
 {
 	// Request the firmware version.
 	char firmware_version[FIRMWARE_STRING_LENGTH];
 	bool success = mscript_get_firmware_version(handle, firmware_version,
 		FIRMWARE_STRING_LENGTH);
 	if (!success) {
+		device_printf(device, "ERROR: Could not read firmware version.\n");
 		return false;
 	}
 
 	// Derive device type from version string.
-	device_type = mscript_get_device_type(firmware_version);
-	char const * device_type_name = mscript_get_device_type_name(device_type);
+	device->device_type = mscript_get_device_type(firmware_version);
+	char const * device_type_name = mscript_get_device_type_name(device->device_type);
 
 	// Print results.
-	printf("Connected to %s with firmware version: %s\n", device_type_name,
+	device_printf(device, "Connected to %s with firmware version: %s\n", device_type_name,
 		firmware_version);
+
+	// The serial number is used to check that the same device is found after
+	// reconnecting.
+	if (device->use_reconnect && !mscript_get_serial_number(handle, device->serial_number,
+		sizeof(device->serial_number))) {
+		device_printf(device, "ERROR: Could not read serial number.\n");
+		return false;
+	}
 	return true;
 }
 
@@ -232,250 +843,1452 @@ static bool identify_device(SerialPortHandle_t handle)
  * the script must end with an empty line (meaning the file ends with "\n\n"
  * or "\r\n\r\n").
  * 
- * After the script has been sent to the device, `process_response()` is called,
- * which receives and processes the response of the device.
+ * After the script has been sent to the device, the response of the device is
+ * received and processed by the acquisition engine (see
+ * `mscript_acquisition.h`), which passes each response to `handle_event()`.
+ *
+ * If `use_flash` is set, the script is run from the flash memory of the device
+ * instead. It is only uploaded (and stored in flash) if the device does not
+ * have the same script stored already.
+ *
+ * If the script was compiled into the application, the built-in (minified)
+ * version is sent instead of the file, and its known package layout is used
+ * to parse the data packages.
+ *
+ * For multi-channel instruments, the data packages are routed to a separate
+ * sink per channel (see `mscript_demux.h`), so the channels are parsed and
+ * written in parallel.
+ *
+ * If `use_reconnect` is set, the results are received using a session (see
+ * `mscript_session.h`), which reconnects to the device and restarts the
+ * script if the connection is lost. In that case, `*p_handle` is replaced by
+ * the handle of the new connection (or `BAD_HANDLE` if it failed).
+ *
+ * If triggers are given, they are evaluated on each data package before it is
+ * processed, and the script is aborted when one fires (see
+ * `mscript_trigger.h`).
  * 
  * \return `true` on success, `false` on failure
  */
-static bool execute_script(SerialPortHandle_t handle, char const * script_name)
+static bool execute_script(Device_t * device, SerialPortHandle_t * p_handle)
 {
-	if (strlen(script_name) > MAX_SCRIPT_NAME_LENGTH) {
-		printf("ERROR: script name should be at most %d characters long.\n", 
+	if (strlen(device->script_name) > MAX_SCRIPT_NAME_LENGTH) {
+		device_printf(device, "ERROR: script name should be at most %d characters long.\n", 
 			MAX_SCRIPT_NAME_LENGTH);
 		return false;
 	}
 
-	char script_file_path[MAX_SCRIPT_FILE_PATH_SIZE];
+	char * script_file_path = device->script_file_path;
 	strcpy(script_file_path, "scripts/");
-	strcat(script_file_path, script_name);
+	strcat(script_file_path, device->script_name);
 	strcat(script_file_path, ".mscr");
 
-	bool success = mscript_send_file(handle, script_file_path);
-	if (!success) {
+	// Predict the output of the script, to check in advance if the link and
+	// buffers can handle it and to choose suitable read timeouts.
+	MscriptPrediction_t prediction;
+	if (mscript_analyze_file(script_file_path, &prediction)) {
+		check_prediction(device, &prediction);
+	} else {
+		prediction.nr_of_loops = 0;
+	}
+
+	device->builtin = find_builtin_script(device, script_file_path);
+	MscriptBuiltinScript_t const * builtin = device->builtin;
+
+	if (!start_script(device, *p_handle)) {
 		return false;
 	}
 
-	success = process_response(handle, script_name);
+	if ((device->device_type == MULTI_EMSTAT4_LR) || (device->device_type == MULTI_EMSTAT4_HR)) {
+		device->demux = mscript_demux_create(create_channel_sink, device);
+		if (device->demux == NULL) {
+			device_printf(device, "ERROR: Could not create channel demultiplexer.\n");
+			return false;
+		}
+	}
+
+	// Receive and process the results. The session is only used to reconnect;
+	// without `use_reconnect`, its acquisition is used directly.
+	MscriptSession_t session;
+	MscriptSink_t sink = { handle_event, device };
+	mscript_session_init(&session, device->port, MSCRIPT_DEV_BAUDRATE, *p_handle, sink,
+		start_script, device);
+	session.serial_number = device->serial_number;
+	MscriptAcquisition_t * acquisition = &session.acquisition;
+	acquisition->read_timeout_ms = READ_TIMEOUT;
+	// Without reconnecting, a timeout ends the acquisition as before.
+	acquisition->wait_while_connected = device->use_reconnect;
+	acquisition->prediction = &prediction;
+	device->prediction = &prediction;
+	if (builtin != NULL) {
+		acquisition->nr_of_schemas = builtin->nr_of_loops;
+		acquisition->schemas = builtin->loops;
+	}
+	// With the demultiplexer, the packages are parsed by the channel threads.
+	acquisition->parse_packages = device->demux == NULL;
+	MscriptTriggerEngine_t * trigger_engine = NULL;
+	if (device->nr_of_triggers > 0) {
+		trigger_engine = mscript_trigger_engine_create(acquisition, handle_trigger, device);
+		if (trigger_engine == NULL) {
+			device_printf(device, "ERROR: Could not create trigger engine.\n");
+			return false;
+		}
+		for (size_t i = 0; i < device->nr_of_triggers; ++i) {
+			mscript_trigger_engine_add(trigger_engine, &device->triggers[i]);
+		}
+	}
+	device_printf(device, "Receiving results...\n");
+	bool success;
+	if (device->use_reconnect) {
+		success = mscript_session_run(&session);
+		*p_handle = acquisition->handle;
+		if (session.stats.nr_of_reconnects > 0) {
+			device_printf(device, "Reconnected %u time(s), total downtime %lu ms "
+				"(longest %lu ms).\n", session.stats.nr_of_reconnects,
+				(unsigned long)session.stats.total_downtime_ms,
+				(unsigned long)session.stats.longest_downtime_ms);
+		}
+	} else {
+		success = mscript_acquisition_run(acquisition);
+	}
+	if (trigger_engine != NULL) {
+		mscript_trigger_engine_get_stats(trigger_engine, &device->trigger_stats);
+		mscript_trigger_engine_destroy(trigger_engine);
+	}
+	if ((device->demux != NULL) && !finish_channels(device)) {
+		success = false;
+	}
+	if (!write_mott_schottky_results(device)) {
+		device_printf(device, "ERROR: Could not write the Mott-Schottky analysis.\n");
+		success = false;
+	}
+	if (device->columns != NULL) {
+		mscript_column_store_destroy(device->columns);
+		device->columns = NULL;
+	}
+	if (!write_scan_averages(device)) {
+		device_printf(device, "ERROR: Could not write the averaged scans.\n");
+		success = false;
+	}
+	// The worker threads have their own copy of the spectra.
+	if (device->spectra != NULL) {
+		mscript_column_store_destroy(device->spectra);
+		device->spectra = NULL;
+	}
+	if (device->tdd != NULL) {
+		mscript_eis_tdd_destroy(device->tdd);
+		device->tdd = NULL;
+	}
+	if (device->cv_scans != NULL) {
+		mscript_cv_scans_destroy(device->cv_scans);
+		device->cv_scans = NULL;
+	}
+	device->is_eis_loop = false;
+	device->is_cv_loop = false;
+	device->prediction = NULL;
+	device->stats = acquisition->stats;
+	if (acquisition->stats.nr_of_communication_errors > 0) {
+		device_printf(device, "Communication error or timeout.\n");
+	}
+	if (!success && (acquisition->stats.nr_of_script_errors == 0) && (*p_handle != BAD_HANDLE)) {
+		// The script may still be running (e.g. after a timeout or when the
+		// results could not be stored). Abort it, so the device is in a known
+		// state and ready for the next command.
+		MscriptAbortResult_t abort_result;
+		if (mscript_abort_and_sync(*p_handle, ABORT_DEADLINE, &abort_result)) {
+			device_printf(device, "%s, device ready after %lu ms.\n",
+				abort_result.was_running ? "Aborted script" : "No script running",
+				(unsigned long)abort_result.recovery_time_ms);
+		} else {
+			device_printf(device, "ERROR: Device not ready within %d ms after abort.\n",
+				ABORT_DEADLINE);
+		}
+	}
+
+	// Make sure the CSV file is closed.
+	if (device->csv != NULL) {
+		mscript_output_close(device->csv);
+		device->csv = NULL;
+	}
+	return success;
+}
+
+/**
+ * Start the script of a device.
+ *
+ * The script is sent to the device (the built-in version if available), or
+ * run from flash memory if `use_flash` is set. This is also used to restart
+ * the script after reconnecting (see `mscript_session.h`).
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool start_script(void * context, SerialPortHandle_t handle)
+{
+	Device_t * device = context;
+	bool success;
+	if (device->use_flash) {
+		bool uploaded = false;
+		// The cache file is shared by all devices.
+		mscript_mutex_lock(&flash_cache_mutex);
+		success = mscript_flash_cache_run_file(handle, FLASH_CACHE_PATH,
+			device->script_file_path, &uploaded);
+		mscript_mutex_unlock(&flash_cache_mutex);
+		if (success) {
+			device_printf(device, uploaded ? "Stored script in flash memory.\n"
+				: "Script in flash memory is up to date, skipped upload.\n");
+		}
+	} else if (device->builtin != NULL) {
+		device_printf(device, "Sending built-in version of script.\n");
+		success = mscript_send_script(handle, device->builtin->script);
+	} else {
+		success = mscript_send_file(handle, device->script_file_path);
+	}
+	if (!success) {
+		device_printf(device, "ERROR: Could not send script.\n");
+	}
 	return success;
 }
 
 /**
- * Read and process the output of the device until end of script.
+ * Find the built-in version of a script.
+ *
+ * The built-in version is only used if the script file has not been changed
+ * since the application was built, so changes to the file are never ignored.
+ * If the file does not exist, the built-in version is used.
+ *
+ * \return The built-in script, or NULL if not available or out of date.
+ */
+static MscriptBuiltinScript_t const * find_builtin_script(Device_t * device,
+	char const * script_file_path)
+{
+#ifdef MSCRIPT_HAVE_GENERATED_SCRIPTS
+	for (MscriptBuiltinScript_t const * const * p = MSCRIPT_BUILTIN_SCRIPTS; *p != NULL; ++p) {
+		if (!strcmp((*p)->name, device->script_name)) {
+			uint64_t hash;
+			if (mscript_hash_file(script_file_path, &hash) && (hash != (*p)->file_hash)) {
+				device_printf(device, "Script file has changed since the application was "
+					"built, using the file.\n");
+				return NULL;
+			}
+			return *p;
+		}
+	}
+#else
+	(void)device;
+	(void)script_file_path;
+#endif
+	return NULL;
+}
+
+/**
+ * Print the predicted output of the script and warn about potential problems.
+ *
+ * A warning is printed if a measurement loop is expected to send data faster
+ * than the serial link can carry, or if its data packages do not fit in the
+ * read buffer or package structure.
+ */
+static void check_prediction(Device_t * device, MscriptPrediction_t const * prediction)
+{
+	double capacity = mscript_link_capacity(MSCRIPT_DEV_BAUDRATE);
+	for (size_t i = 0; i < prediction->nr_of_loops; ++i) {
+		MscriptLoopPrediction_t const * loop = &prediction->loops[i];
+		device_printf(device, "Predicted %s (line %u): %lu x %lu points, %lu bytes/package, "
+			"%.1f s, peak %.0f bytes/s%s\n", loop->technique, loop->line_number,
+			(unsigned long)loop->nr_of_executions, (unsigned long)loop->nr_of_points,
+			(unsigned long)loop->bytes_per_package, loop->duration_s, loop->peak_line_rate,
+			loop->is_exact ? "" : " (estimate)");
+		if (loop->peak_line_rate > capacity) {
+			device_printf(device, "WARNING: predicted data rate exceeds link capacity "
+				"(%.0f bytes/s) at %d baud.\n", capacity, MSCRIPT_DEV_BAUDRATE);
+		}
+		if (loop->bytes_per_package >= MSCRIPT_READ_BUFFER_SIZE) {
+			device_printf(device, "WARNING: predicted package length exceeds the read "
+				"buffer size (%d).\n", MSCRIPT_READ_BUFFER_SIZE);
+		}
+		if (loop->nr_of_variables > MSCRIPT_MAX_SUB_PACKAGES_PER_LINE) {
+			device_printf(device, "WARNING: packages contain more than %d variables, "
+				"remaining variables will be ignored.\n", MSCRIPT_MAX_SUB_PACKAGES_PER_LINE);
+		}
+	}
+}
+
+/**
+ * Process one event of the acquisition of a device.
  * 
- * This function reads responses from the device, line by line, until the end
- * of script. Data packages sent from within a measurement loop are stored in
- * a CSV file. For each measurement, a new CSV file is created. The type of
- * measurement (and, optionally, the number of the scan) is stored as part of
- * the file name.
+ * Data packages sent from within a measurement loop are stored in a CSV file.
+ * For each measurement, a new CSV file is created. The type of measurement
+ * (and, optionally, the number of the scan) is stored as part of the file
+ * name. When only one device is used, the data packages are also printed to
+ * the console.
  * 
- * \return `true` on success, `false` on failure
+ * \return `true` to continue, `false` to stop the acquisition
  */
-static bool process_response(SerialPortHandle_t handle, char const * script_name)
-{
-	MscriptDataPackage_t package;
-	FILE *fp = NULL;
-	unsigned int meas_index = 0;
-	unsigned int data_index = 0;
-
-	printf("Receiving results...\n");
-	for (;;) {
-		char response[MSCRIPT_READ_BUFFER_SIZE];
-		// Read one complete line from the device.
-		bool success = mscript_serial_port_read_line(handle, response, MSCRIPT_READ_BUFFER_SIZE,
-			READ_TIMEOUT);
-		if (!success) {
-			printf("Communication error or timeout.\n");
+static bool handle_event(void * context, MscriptEvent_t const * event)
+{
+	Device_t * device = context;
+	MscriptPeak_t peak;
+
+	// For multi-channel instruments, the channels store the data themselves
+	// (see `handle_channel_event()`).
+	if ((device->demux != NULL) && !mscript_demux_handle_event(device->demux, event)) {
+		device_printf(device, "ERROR: Failed to process the data of a channel.\n");
+		return false;
+	}
+
+	switch (event->type) {
+
+	case MSCRIPT_EVENT_MEAS_LOOP_START:
+		// This denotes the start of a measurement loop.
+		device_printf(device, "Started measurement loop.\n");
+		if (device->demux == NULL) {
+			device->detect_peaks = start_peak_detection(event, &device->peak_detector);
+			char const * technique = get_technique(event);
+			device->is_eis_loop = (workers != NULL) && (technique != NULL)
+				&& !strcmp(technique, "meas_loop_eis");
+			if (device->tdd != NULL) {
+				mscript_eis_tdd_reset(device->tdd);
+			}
+			device->is_cv_loop = start_cv_scans(device, event);
+			device->scan_average = start_scan_average(device, event);
+		}
+		if (device->is_resuming) {
+			// After a reconnect, the same measurement loop of the restarted
+			// script is appended to the CSV file of the interrupted loop.
+			device->is_resuming = false;
+			if ((device->csv != NULL) && !strncmp(device->meas_loop_id, event->response, 5)) {
+				device->package_index_offset = device->last_package_index;
+				break;
+			}
+			if (device->csv != NULL) {
+				mscript_output_close(device->csv);
+				device->csv = NULL;
+			}
+		}
+		strncpy(device->meas_loop_id, event->response, 5);
+		device->meas_loop_id[5] = '\0';
+		device->package_index_offset = 0;
+		mscript_loop_stats_reset(&device->loop_stats);
+		if (device->demux != NULL) {
+			char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+			if (get_csv_file_path(device, event->meas_loop_index, event->response, "-chNN",
+				csv_file_path)) {
+				device_printf(device, "CSV files: %s\n", csv_file_path);
+			}
+			break;
+		}
+		device->csv = create_csv_file(device, event->meas_loop_index, event->response);
+		if (device->csv == NULL) {
+			device_printf(device, "ERROR: Could not create output file: %s\n",
+				strerror(errno));
 			return false;
 		}
-		// Uncomment the following line to see all MethodSCRIPT response lines
-		// printf("RX: %s", response);
+		break;
 
-		// Check the first character to determine the type of response.
-		switch (response[0]) {
+	case MSCRIPT_EVENT_MEAS_LOOP_END:
+		// This denotes the end of a measurement loop.
+		device_printf(device, "Finished measurement loop.\n");
+		if (device->detect_peaks && mscript_peak_detector_finish(&device->peak_detector, &peak)) {
+			print_peak(device, NULL, &peak);
+		}
+		device->detect_peaks = false;
+		if (device->loop_stats.nr_of_packages > 0) {
+			print_loop_stats(device, -1, &device->loop_stats);
+		}
+		if (device->is_eis_loop && !submit_eis_fits(device, event->meas_loop_index)) {
+			device_printf(device, "ERROR: Could not fit the impedance spectrum.\n");
+		}
+		if (device->is_eis_loop && (device->tdd != NULL)
+			&& !write_eis_tdd_results(device, event->meas_loop_index)) {
+			device_printf(device, "ERROR: Could not process the time domain data.\n");
+		}
+		device->is_eis_loop = false;
+		if (device->is_cv_loop && !write_cv_scan_results(device, event->meas_loop_index)) {
+			device_printf(device, "ERROR: Could not analyze the scans.\n");
+		}
+		device->is_cv_loop = false;
+		if (device->scan_average != NULL) {
+			end_scan_average(device);
+			device->scan_average = NULL;
+		}
+		if (device->csv != NULL) {
+			mscript_output_close(device->csv);
+			device->csv = NULL;
+		}
+		if ((device->columns != NULL)
+			&& !write_channel_csv_files(device, event->meas_loop_index)) {
+			device_printf(device, "ERROR: Could not create output file: %s\n",
+				strerror(errno));
+			return false;
+		}
+		break;
 
-		case MSCRIPT_REPLY_ID_MEAS_LOOP_START:
-			// This denotes the start of a measurement loop.
-			if (strlen(response) != 6) { // "Mxxxx\n"
-				printf("ERROR: invalid response: %s", response);
-				return false;
+	case MSCRIPT_EVENT_PACKAGE:
+		// This denotes a data package, which has already been parsed.
+		// With many devices, printing every package would flood the console.
+		if (!device->is_concurrent && (event->package != NULL)) {
+			print_data_package(device->console, event->package, device->device_type);
+		}
+		// Published packages are tagged with the channel of a multiplexer.
+		if (event->package != NULL) {
+			unsigned int mux_channel;
+			publish_package(device, mscript_get_package_channel(event->package, &mux_channel)
+				? (int)mux_channel : -1, event);
+		}
+		if (device->csv != NULL) {
+			unsigned int index = device->package_index_offset + event->package_index;
+			if (index == 1) {
+				write_csv_header_row(device->csv, event->package);
+			}
+			write_csv_data_row(device->csv, index, event->package, device->device_type);
+			device->last_package_index = index;
+		}
+		// Peaks are reported as soon as they are complete.
+		if (device->detect_peaks && (event->package != NULL)
+			&& mscript_peak_detector_add_package(&device->peak_detector, event->package, &peak)) {
+			print_peak(device, NULL, &peak);
+		}
+		// The spectrum is fitted at the end of the measurement loop. The time
+		// domain data of each frequency is processed as soon as it is complete.
+		if (device->is_eis_loop && (event->package != NULL)) {
+			if (device->spectra == NULL) {
+				device->spectra = mscript_column_store_create();
 			}
-			printf("Started measurement loop.\n");
-			fp = create_csv_file(script_name, ++meas_index, response);
-			if (fp == NULL) {
-				printf("ERROR: Could not create output file: %s\n", strerror(errno));
+			if ((device->spectra == NULL) || !mscript_column_store_add_package(
+				device->spectra, event->meas_loop_index, event->package)) {
+				device_printf(device, "ERROR: Could not store the impedance spectrum.\n");
 				return false;
 			}
-			data_index = 0;
-			break;
-
-		case MSCRIPT_REPLY_ID_MEAS_LOOP_END:
-			// This denotes the end of a measurement loop.
-			printf("Finished measurement loop.\n");
-			if (fp != NULL) {
-				if (fclose(fp)) {
-					printf("ERROR: Failed to close CSV file: %s\n", strerror(errno));
-				}
-				fp = NULL;
+			if (device->tdd == NULL) {
+				device->tdd = mscript_eis_tdd_create(workers, NULL, NULL);
 			}
-			break;
-
-		case MSCRIPT_REPLY_ID_DATA_PACKAGE:
-			// This denotes a data package.
-			// Parse the data package, i.e. extract the variables from the package.
-			success = parse_data_package(response, &package);
-			if (!success) {
-				printf("ERROR: failed to parse data package.\n");
+			if ((device->tdd == NULL)
+				|| !mscript_eis_tdd_add_package(device->tdd, event->package)) {
+				device_printf(device, "ERROR: Could not store the time domain data.\n");
 				return false;
 			}
-			print_data_package(&package);
-			if (fp != NULL) {
-				if (data_index == 0) {
-					write_csv_header_row(fp, &package);
-				}
-				write_csv_data_row(fp, ++data_index, &package);
+		}
+		// Each scan of a cyclic voltammetry measurement is analyzed as soon
+		// as it is complete.
+		if (device->is_cv_loop && (event->package != NULL)
+			&& !mscript_cv_scans_add_package(device->cv_scans, event->package)) {
+			device_printf(device, "ERROR: Could not store the scan.\n");
+			return false;
+		}
+		if ((device->scan_average != NULL) && (event->package != NULL)) {
+			mscript_scan_average_add_package(device->scan_average->average, event->package);
+		}
+		// The capacitance of each point of a Mott-Schottky measurement is
+		// calculated as soon as it is received, per channel.
+		if ((device->demux == NULL) && (event->package != NULL)) {
+			unsigned int ms_channel;
+			size_t ms_index = mscript_get_package_channel(event->package, &ms_channel)
+				? (size_t)ms_channel + 1 : 0;
+			if ((ms_index <= MSCRIPT_COLUMN_STORE_MAX_CHANNELS) && !add_mott_schottky_point(
+				&device->mott_schottky[ms_index], event, device->meas_loop_id)) {
+				device_printf(device, "ERROR: Could not store the Mott-Schottky data.\n");
+				return false;
 			}
+		}
+		// If the package contains a channel number (e.g. of a multiplexer),
+		// also store it per channel. These are written at the end of the loop,
+		// and the index of the column store holds the statistics of each
+		// channel. For other packages, only the statistics are kept.
+		unsigned int channel;
+		if (event->package == NULL) {
 			break;
+		}
+		if (mscript_get_package_channel(event->package, &channel)) {
+			if (device->columns == NULL) {
+				device->columns = mscript_column_store_create();
+			}
+			if ((device->columns == NULL) || !mscript_column_store_add_package(
+				device->columns, event->meas_loop_index, event->package)) {
+				device_printf(device, "ERROR: Could not store data of channel %u.\n", channel);
+				return false;
+			}
+		} else if (device->demux == NULL) {
+			mscript_loop_stats_add_package(&device->loop_stats, event->package);
+		}
+		break;
 
-		case MSCRIPT_REPLY_ID_END_OF_SCRIPT:
-			printf("Script finished successfully.\n");
-			// This denotes the end of the script.
-			return true;
+	case MSCRIPT_EVENT_END_OF_SCRIPT:
+		// This denotes the end of the script.
+		device_printf(device, "Script finished successfully.\n");
+		break;
 
-		case MSCRIPT_REPLY_ID_EXECUTE_SCRIPT:
-			// This denotes the start of the script.
-			break;
+	case MSCRIPT_EVENT_SCRIPT_START:
+		// This denotes the start of the script.
+		break;
 
-		case MSCRIPT_REPLY_ID_TEXT:
-			// This denotes the response of a "send_string" command.
-			printf("Text message: %s", response + 1);
-			break;
+	case MSCRIPT_EVENT_TEXT:
+		// This denotes the response of a "send_string" command.
+		device_printf(device, "Text message: %s", event->response + 1);
+		break;
 
-		case MSCRIPT_REPLY_ID_ERROR:
+	case MSCRIPT_EVENT_ERROR:
+		if (event->response[0] == MSCRIPT_REPLY_ID_ERROR) {
 			// An error occurred during execution of the MethodSCRIPT.
 			// The error message contains the error code and line number.
-			printf("ERROR during MethodSCRIPT execution: %s", response);
+			device_printf(device, "ERROR during MethodSCRIPT execution: %s", event->response);
+		} else {
+			device_printf(device, "ERROR: invalid response: %s", event->response);
+		}
+		break;
+
+	case MSCRIPT_EVENT_SCAN_START:
+		if (device->is_cv_loop && !mscript_cv_scans_start_scan(device->cv_scans)) {
+			device_printf(device, "ERROR: Could not store the scan.\n");
 			return false;
+		}
+		break;
+	case MSCRIPT_EVENT_SCAN_END:
+		// These replies are only applicable when the optional argument
+		// "nscans" is used (for Cyclic Voltammetry measurements, i.e. the
+		// "meas_loop_cv" command, only).
+		// They can be used to process each scan separately, or just be
+		// ignored to get one long measurement including all scans.
+		// In this example, we print an empty line after each scan so the
+		// separate scans can be easily distinguished in the output file.
+		if (device->csv != NULL) {
+			mscript_output_printf(device->csv, "\n");
+		}
+		// Each scan is searched for peaks separately.
+		if (device->detect_peaks && mscript_peak_detector_finish(&device->peak_detector, &peak)) {
+			print_peak(device, NULL, &peak);
+		}
+		// The complete scan is analyzed by the worker threads.
+		if (device->is_cv_loop && !mscript_cv_scans_end_scan(device->cv_scans)) {
+			device_printf(device, "ERROR: Could not analyze the scan.\n");
+		}
+		if (device->scan_average != NULL) {
+			end_scan_average(device);
+		}
+		break;
 
-		case MSCRIPT_REPLY_ID_NSCANS_START:
-			break;
-		case MSCRIPT_REPLY_ID_NSCANS_END:
-			// These replies are only applicable when the optional argument
-			// "nscans" is used (for Cyclic Voltammetry measurements, i.e. the
-			// "meas_loop_cv" command, only).
-			// They can be used to process each scan separately, or just be
-			// ignored to get one long measurement including all scans.
-			// In this example, we print an empty line after each scan so the
-			// separate scans can be easily distinguished in the output file.
-			if (fp != NULL) {
-				fprintf(fp, "\n");
-			}
-			break;
+	case MSCRIPT_EVENT_LOOP_START:
+	case MSCRIPT_EVENT_LOOP_END:
+		// These replies denote the start and end of a "loop" command.
+		break;
 
-		case MSCRIPT_REPLY_ID_LOOP_START:
-		case MSCRIPT_REPLY_ID_LOOP_END:
-			// These replies denote the start and end of a "loop" command.
-			break;
+	case MSCRIPT_EVENT_UNKNOWN:
+		// Ignore other responses
+		device_printf(device, "Ignored unexpected response line: %s", event->response);
+		break;
 
-		default:
-			// Ignore other responses
-			printf("Ignored unexpected response line: %s", response);
-			break;
-		}
-	}
+	case MSCRIPT_EVENT_ABORTED:
+		// The device confirms the abort command (sent by a trigger). The
+		// current measurement loop ends and the script finishes as usual.
+		device_printf(device, "Script aborted.\n");
+		break;
 
-	// Make sure file is closed.
-	if (fp != NULL) {
-		if (fclose(fp)) {
-			printf("ERROR: Failed to close CSV file: %s\n", strerror(errno));
+	case MSCRIPT_EVENT_GAP:
+		// The connection was lost and has been restored, and the script has
+		// been restarted. Mark the gap in the CSV file of the interrupted
+		// measurement loop, which is continued by the restarted script.
+		device_printf(device, "Reconnected after %lu ms, restarted script.\n",
+			(unsigned long)event->gap_ms);
+		if (device->csv != NULL) {
+			mscript_output_printf(device->csv, "Connection lost for %lu ms\r\n",
+				(unsigned long)event->gap_ms);
+			device->is_resuming = true;
 		}
-		fp = NULL;
+		break;
 	}
-	return false;
+	return true;
 }
 
 /**
- * Create and open a CSV file with file name based on supplied parameters.
- * 
- * \return A `FILE` pointer to the open file on success, or NULL on failure.
+ * Report a trigger that fired.
+ *
+ * This function is called by the trigger engine (see `mscript_trigger.h`),
+ * after the abort command has been sent.
  */
-static FILE * create_csv_file(char const * script_name, unsigned index,
-	char const * response)
+static void handle_trigger(void * context, MscriptTriggerEvent_t const * event)
 {
-	char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
-	char M[6] = {0};
-	strncpy(M, response, 5);
-	snprintf(csv_file_path, MAX_CSV_FILE_PATH_SIZE, "results/%s-%04u-%s.csv",
-		script_name, index, M);
-	printf("CSV file: %s\n", csv_file_path);
-	return fopen(csv_file_path, "wb");
-}
-
-static void print_sub_package(MscriptSubPackage_t const * sub_package)
-{
-	// Print the variable type (shortened/abbreviated) and value.
-	switch (sub_package->variable_type) {
-	case MSCRIPT_VARTYPE_POTENTIAL:
-	case MSCRIPT_VARTYPE_POTENTIAL_CE:
-	case MSCRIPT_VARTYPE_POTENTIAL_SE:
-	case MSCRIPT_VARTYPE_POTENTIAL_RE:
-	case MSCRIPT_VARTYPE_POTENTIAL_WE:
-	case MSCRIPT_VARTYPE_POTENTIAL_WE_VS_CE:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN0:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN1:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN2:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN3:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN4:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN5:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN6:
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN7:
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC1:
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC2:
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC3:
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC4:
-		printf("   E[V]: %6.3f", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_CURRENT:
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC1:
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC2:
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC3:
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC4:
-		printf("   I[A]: %11.3E", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_PHASE:
-		printf("   phase[degrees]: %f", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_IMP:
-		printf("   Z[ohm]: %16.3f", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_ZREAL:
-		printf("   Z_real[ohm]: %16.3f", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_ZIMAG:
-		printf("   Z_imag[ohm]: %16.3f", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_CELL_SET_POTENTIAL:
-		printf("   E_set[V]: %6.3f", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_CELL_SET_CURRENT:
-		printf("   I_set[A]: %11.3E", sub_package->value);
-		break;
-	case MSCRIPT_VARTYPE_CELL_SET_FREQUENCY:
-		printf("   F_set[Hz]: %6.3E", sub_package->value);
+	Device_t * device = context;
+	device_printf(device, "Trigger %u fired at package %u of loop %u (value %g), "
+		"abort %s after %" PRIu64 " us.\n", (unsigned int)event->trigger_index + 1,
+		event->package_index, event->meas_loop_index, event->value,
+		event->is_action_done ? "sent" : "already sent", event->latency_us);
+}
+
+/**
+ * Create the sink of a channel of a multi-channel instrument.
+ *
+ * This is called by the demultiplexer when the first package of the channel
+ * is received.
+ */
+static bool create_channel_sink(void * context, unsigned int channel, MscriptSink_t * p_sink)
+{
+	Device_t * device = context;
+	Channel_t * ch = &device->channels[channel];
+	ch->device = device;
+	ch->number = channel;
+	ch->csv = NULL;
+	p_sink->handle_event = handle_channel_event;
+	p_sink->context = ch;
+	return true;
+}
+
+/**
+ * Process one event of a channel of a multi-channel instrument.
+ *
+ * This is called from the thread of the channel. Like `handle_event()`, a CSV
+ * file is created for each measurement loop, but only with the packages of
+ * this channel. To keep the console readable, nothing is printed here.
+ *
+ * \return `true` to continue, `false` to stop the acquisition
+ */
+static bool handle_channel_event(void * context, MscriptEvent_t const * event)
+{
+	Channel_t * ch = context;
+	Device_t * device = ch->device;
+	MscriptPeak_t peak;
+
+	switch (event->type) {
+	case MSCRIPT_EVENT_MEAS_LOOP_START: {
+		char suffix[MAX_CSV_FILE_SUFFIX_LENGTH + 1];
+		char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+		snprintf(suffix, sizeof(suffix), "-ch%02u", ch->number);
+		if (!get_csv_file_path(device, event->meas_loop_index, event->response, suffix,
+			csv_file_path)) {
+			return false;
+		}
+		ch->csv = mscript_output_open(output, csv_file_path);
+		if (ch->csv == NULL) {
+			return false;
+		}
+		ch->detect_peaks = start_peak_detection(event, &ch->peak_detector);
+		strncpy(ch->meas_loop_id, event->response, 5);
+		ch->meas_loop_id[5] = '\0';
 		break;
-	case MSCRIPT_VARTYPE_CELL_SET_AMPLITUDE:
-		printf("   A_set[V]: %6.3f", sub_package->value);
+	}
+
+	case MSCRIPT_EVENT_MEAS_LOOP_END:
+		if (ch->csv != NULL) {
+			mscript_output_close(ch->csv);
+			ch->csv = NULL;
+		}
+		if (ch->detect_peaks && mscript_peak_detector_finish(&ch->peak_detector, &peak)) {
+			print_peak(device, ch, &peak);
+		}
+		ch->detect_peaks = false;
 		break;
-	case MSCRIPT_VARTYPE_TIME:
-		printf("  time[s]: %6.3f", sub_package->value);
+
+	case MSCRIPT_EVENT_PACKAGE:
+		publish_package(device, (int)ch->number, event);
+		if (ch->csv != NULL) {
+			if (event->package_index == 1) {
+				write_csv_header_row(ch->csv, event->package);
+			}
+			write_csv_data_row(ch->csv, event->package_index, event->package,
+				device->device_type);
+		}
+		if (ch->detect_peaks
+			&& mscript_peak_detector_add_package(&ch->peak_detector, event->package, &peak)) {
+			print_peak(device, ch, &peak);
+		}
+		if (!add_mott_schottky_point(&device->mott_schottky[ch->number + 1], event,
+			ch->meas_loop_id)) {
+			return false;
+		}
 		break;
-	case MSCRIPT_VARTYPE_MISC_GENERIC1:
-	case MSCRIPT_VARTYPE_MISC_GENERIC2:
-	case MSCRIPT_VARTYPE_MISC_GENERIC3:
-	case MSCRIPT_VARTYPE_MISC_GENERIC4:
-		printf("   misc: %6.3f", sub_package->value);
+
+	case MSCRIPT_EVENT_SCAN_END:
+		if (ch->csv != NULL) {
+			mscript_output_printf(ch->csv, "\n");
+		}
+		if (ch->detect_peaks && mscript_peak_detector_finish(&ch->peak_detector, &peak)) {
+			print_peak(device, ch, &peak);
+		}
 		break;
+
 	default:
-		printf("   ?%d?[?] %16.3f ", sub_package->variable_type, sub_package->value);
+		break;
+	}
+	return true;
+}
+
+/**
+ * Publish a data package in the shared memory ring and to the clients of the
+ * data server, if these are used.
+ *
+ * \param device The device.
+ * \param channel The channel of a multi-channel instrument or multiplexer, or -1.
+ * \param event The package event.
+ */
+static void publish_package(Device_t const * device, int channel, MscriptEvent_t const * event)
+{
+	if (shm_ring != NULL) {
+		mscript_shm_ring_publish(shm_ring, device->number, channel, event);
+	}
+	if (data_server != NULL) {
+		mscript_data_server_publish(data_server, device->number, channel, event);
+	}
+}
+
+/**
+ * Wait until all channels have processed their data, close their files and
+ * print the number of packages of each channel.
+ *
+ * \return `true` if all channels were processed successfully, `false` otherwise
+ */
+static bool finish_channels(Device_t * device)
+{
+	bool success = mscript_demux_finish(device->demux);
+	for (unsigned int i = 0; i < MSCRIPT_DEMUX_MAX_CHANNELS; ++i) {
+		MscriptChannelStats_t stats;
+		if (!mscript_demux_get_channel_stats(device->demux, i, &stats)) {
+			continue;
+		}
+		Channel_t * ch = &device->channels[i];
+		// The file is still open if the acquisition was aborted.
+		if (ch->csv != NULL) {
+			mscript_output_close(ch->csv);
+			ch->csv = NULL;
+		}
+		if (ch->console != NULL) {
+			mscript_output_close(ch->console);
+			ch->console = NULL;
+		}
+		device_printf(device, "Channel %u: %" PRIu64 " packages%s\n", i,
+			stats.nr_of_packages, stats.failed ? " (FAILED)" : "");
+	}
+	mscript_demux_destroy(device->demux);
+	device->demux = NULL;
+	return success;
+}
+
+/**
+ * Get the technique of the measurement loop of an event (e.g. "meas_loop_cv"),
+ * from the prediction of the script output.
+ *
+ * \return The technique, or NULL if it is not known.
+ */
+static char const * get_technique(MscriptEvent_t const * event)
+{
+	return (event->loop != NULL) ? event->loop->technique : NULL;
+}
+
+/**
+ * Get the kind of potential scan of the measurement loop of an event, which
+ * determines whether its peaks are detected and its scans are analyzed or
+ * averaged.
+ */
+static ScanType_t get_scan_type(MscriptEvent_t const * event)
+{
+	char const * technique = get_technique(event);
+	if (technique == NULL) {
+		return SCAN_TYPE_NONE;
+	}
+	if (!strcmp(technique, "meas_loop_lsv")) {
+		return SCAN_TYPE_LINEAR;
+	}
+	if (!strcmp(technique, "meas_loop_swv") || !strcmp(technique, "meas_loop_dpv")) {
+		return SCAN_TYPE_PULSED;
+	}
+	if (!strcmp(technique, "meas_loop_cv")) {
+		return SCAN_TYPE_CYCLIC;
+	}
+	return SCAN_TYPE_NONE;
+}
+
+/**
+ * Start the peak detection for a measurement loop, if it is a voltammetric
+ * technique with peaks (SWV, DPV or CV).
+ *
+ * \return `true` if the peaks of this measurement loop are detected.
+ */
+static bool start_peak_detection(MscriptEvent_t const * event, MscriptPeakDetector_t * detector)
+{
+	ScanType_t scan_type = get_scan_type(event);
+	if ((scan_type != SCAN_TYPE_PULSED) && (scan_type != SCAN_TYPE_CYCLIC)) {
+		return false;
+	}
+	mscript_peak_detector_init(detector);
+	return true;
+}
+
+/**
+ * Print a detected peak.
+ *
+ * \param device The device.
+ * \param ch The channel (if called by a channel thread), or NULL.
+ * \param peak The peak.
+ */
+static void print_peak(Device_t * device, Channel_t * ch, MscriptPeak_t const * peak)
+{
+	if (ch == NULL) {
+		device_printf(device, "Peak at %.3f V: height %.3E A, area %.3E VA\n",
+			peak->potential, peak->height, peak->area);
+		return;
+	}
+	// The channel threads can not use the console of the device, so each
+	// channel has its own output for the console.
+	if (ch->console == NULL) {
+		ch->console = mscript_output_open_stream(output, stdout);
+		if (ch->console == NULL) {
+			return;
+		}
+	}
+	mscript_output_printf(ch->console, "[%u] Channel %u: Peak at %.3f V: height %.3E A, "
+		"area %.3E VA\n", device->number, ch->number, peak->potential, peak->height, peak->area);
+	mscript_output_flush(ch->console);
+}
+
+/**
+ * Print the statistics of each column of a measurement loop.
+ *
+ * \param device The device.
+ * \param channel The channel, or -1 if the packages do not contain a channel number.
+ * \param loop_stats The statistics.
+ */
+static void print_loop_stats(Device_t * device, int channel,
+	MscriptLoopStats_t const * loop_stats)
+{
+	char prefix[24] = "";
+	if (channel >= 0) {
+		snprintf(prefix, sizeof(prefix), "Channel %d: ", channel);
+	}
+	for (size_t i = 0; i < loop_stats->nr_of_columns; ++i) {
+		MscriptColumnStats_t const * column = &loop_stats->columns[i];
+		MscriptStats_t const * stats = &column->stats;
+		// The time is the x value of the slopes, so it is not printed.
+		if ((stats->nr_of_values == 0)
+			|| (loop_stats->has_time && (column->variable_type == MSCRIPT_VARTYPE_TIME))) {
+			continue;
+		}
+		// Only the status flags that occurred are printed.
+		char flags[128] = "";
+		size_t length = 0;
+		for (unsigned int flag = 0; flag < MSCRIPT_STATS_NR_OF_STATUS_FLAGS; ++flag) {
+			if ((stats->status_counts[flag] > 0) && (length < sizeof(flags))) {
+				length += snprintf(flags + length, sizeof(flags) - length, ", %lu x %s",
+					(unsigned long)stats->status_counts[flag],
+					mscript_metadata_status_to_string(1 << flag));
+			}
+		}
+		device_printf(device, "%s%s: %lu values, mean %.4E, std. dev. %.3E, min %.4E, "
+			"max %.4E, slope %.3E/%s%s\n", prefix,
+			mscript_vartype_to_string(column->variable_type),
+			(unsigned long)stats->nr_of_values, stats->mean, mscript_stats_std_dev(stats),
+			stats->min, stats->max, mscript_stats_slope(stats),
+			loop_stats->has_time ? "s" : "point", flags);
+	}
+}
+
+/**
+ * Submit the impedance spectrum of a measurement loop to the worker threads.
+ *
+ * If the packages contain a channel number (e.g. of a multiplexer), the
+ * spectrum of each channel is fitted separately. The results are handled by
+ * `handle_eis_fit()` in one of the worker threads.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool submit_eis_fits(Device_t * device, unsigned int meas_loop_index)
+{
+	if (device->spectra == NULL) {
+		return true;
+	}
+	for (unsigned int ch = 0; ch < MSCRIPT_COLUMN_STORE_MAX_CHANNELS; ++ch) {
+		MscriptChannelColumns_t const * channel = mscript_column_store_get_channel(
+			device->spectra, ch);
+		MscriptLoopIndexEntry_t const * loop = (channel != NULL)
+			? mscript_channel_find_loop(channel, meas_loop_index) : NULL;
+		if (loop == NULL) {
+			continue;
+		}
+		EisFitRequest_t * request = malloc(sizeof(EisFitRequest_t));
+		if (request == NULL) {
+			return false;
+		}
+		request->device = device;
+		request->meas_loop_index = meas_loop_index;
+		request->has_channel = device->columns != NULL;
+		request->channel = ch;
+		strcpy(request->meas_loop_id, device->meas_loop_id);
+		if (!mscript_eis_fit_submit_loop(workers, MSCRIPT_EIS_MODEL_RANDLES, channel,
+			loop, handle_eis_fit, request)) {
+			free(request);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Store the result of an EIS fit in a CSV file and print it.
+ *
+ * This is called from a worker thread, so the console of the device can not
+ * be used.
+ */
+static void handle_eis_fit(void * context, MscriptEisFitResult_t const * result)
+{
+	EisFitRequest_t * request = context;
+	Device_t * device = request->device;
+	char prefix[32] = "";
+	char suffix[MAX_CSV_FILE_SUFFIX_LENGTH + 1] = "-fit";
+	if (device->is_concurrent) {
+		snprintf(prefix, sizeof(prefix), "[%u] ", device->number);
+	}
+	if (request->has_channel && (request->channel < MSCRIPT_COLUMN_STORE_MAX_CHANNELS)) {
+		snprintf(suffix, sizeof(suffix), "-ch%02u-fit", request->channel);
+	}
+
+	MscriptOutputFile_t * console = mscript_output_open_stream(output, stdout);
+	if (result == NULL) {
+		if (console != NULL) {
+			mscript_output_printf(console, "%sEIS fit of %s%s: too few points\n", prefix,
+				request->meas_loop_id, suffix);
+			mscript_output_close(console);
+		}
+		free(request);
+		return;
+	}
+
+	char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+	MscriptOutputFile_t * csv = get_csv_file_path(device, request->meas_loop_index,
+		request->meas_loop_id, suffix, csv_file_path)
+		? mscript_output_open(output, csv_file_path) : NULL;
+	if (csv != NULL) {
+		if (SET_SEPARATOR_FOR_MS_EXCEL) {
+			mscript_output_printf(csv, "sep=;\n");
+		}
+		mscript_output_printf(csv, "Parameter;Value;Standard error;Unit\r\n");
+		for (size_t i = 0; i < result->nr_of_parameters; ++i) {
+			mscript_output_printf(csv, "%s;%.6E;%.6E;%s\r\n", mscript_eis_parameter_name(i),
+				result->parameters[i], result->standard_errors[i],
+				mscript_eis_parameter_unit(i));
+		}
+		mscript_output_printf(csv, "Points;%lu;;\r\n", (unsigned long)result->nr_of_points);
+		mscript_output_printf(csv, "Chi square;%.6E;;\r\n", result->chi_square);
+		mscript_output_printf(csv, "RMS error;%.6E;;\r\n", result->rms_error);
+		mscript_output_printf(csv, "Converged;%s;;\r\n", result->converged ? "yes" : "no");
+		mscript_output_close(csv);
+	}
+	if (console != NULL) {
+		mscript_output_printf(console, "%sEIS fit of %s%s: Rs = %.3E Ohm, Rct = %.3E Ohm, "
+			"Cdl = %.3E F, RMS error %.2f%%%s\n", prefix, request->meas_loop_id,
+			request->has_channel ? suffix : "", result->parameters[MSCRIPT_EIS_PARAMETER_RS],
+			result->parameters[MSCRIPT_EIS_PARAMETER_RCT],
+			result->parameters[MSCRIPT_EIS_PARAMETER_CDL], 100.0 * result->rms_error,
+			result->converged ? "" : " (not converged)");
+		mscript_output_close(console);
+	}
+	free(request);
+}
+
+/**
+ * Write the impedance and harmonic distortion calculated from the time domain
+ * data of a measurement loop to a CSV file.
+ *
+ * The frequencies have been processed by the worker threads while the loop
+ * was running; this waits for the last frequencies. Nothing is written if the
+ * loop did not contain time domain data.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool write_eis_tdd_results(Device_t * device, unsigned int meas_loop_index)
+{
+	if (!mscript_eis_tdd_finish(device->tdd)) {
+		return false;
+	}
+	mscript_eis_tdd_wait(device->tdd);
+	size_t count;
+	MscriptEisTddResult_t const * results = mscript_eis_tdd_get_results(device->tdd, &count);
+	if (count == 0) {
+		return true;
+	}
+
+	char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+	if (!get_csv_file_path(device, meas_loop_index, device->meas_loop_id, "-tdd",
+		csv_file_path)) {
+		return false;
+	}
+	MscriptOutputFile_t * csv = mscript_output_open(output, csv_file_path);
+	if (csv == NULL) {
+		return false;
+	}
+	if (SET_SEPARATOR_FOR_MS_EXCEL) {
+		mscript_output_printf(csv, "sep=;\n");
+	}
+	mscript_output_printf(csv, "Frequency;Sample frequency;Samples;Periods;Z_real;Z_imag;"
+		"E amplitude;I amplitude;THD E;THD I;Z_real (device);Z_imag (device)\r\n");
+	size_t nr_of_valid = 0;
+	for (size_t i = 0; i < count; ++i) {
+		MscriptEisTddResult_t const * r = &results[i];
+		nr_of_valid += r->is_valid ? 1 : 0;
+		mscript_output_printf(csv, "%.6E;%.6E;%lu;%.3f;%.6E;%.6E;%.6E;%.6E;%.6E;%.6E;%.6E;%.6E\r\n",
+			r->frequency, r->sample_frequency, (unsigned long)r->nr_of_samples,
+			r->nr_of_periods, r->z_real, r->z_imag, r->potential_amplitude,
+			r->current_amplitude, r->potential_thd, r->current_thd, r->device_z_real,
+			r->device_z_imag);
+	}
+	mscript_output_close(csv);
+	device_printf(device, "Time domain data: %lu of %lu frequencies processed, CSV file: %s\n",
+		(unsigned long)nr_of_valid, (unsigned long)count, csv_file_path);
+	return true;
+}
+
+/**
+ * Start collecting the scans of a measurement loop, if it is a cyclic
+ * voltammetry measurement and the worker threads are available.
+ *
+ * If the script could be analyzed, the time between two points is used to
+ * integrate the charge (the packages of the example scripts do not contain
+ * the time).
+ *
+ * \return `true` if the scans are collected, `false` otherwise
+ */
+static bool start_cv_scans(Device_t * device, MscriptEvent_t const * event)
+{
+	if ((workers == NULL) || (get_scan_type(event) != SCAN_TYPE_CYCLIC)) {
+		return false;
+	}
+	if (device->cv_scans == NULL) {
+		device->cv_scans = mscript_cv_scans_create(workers, NULL, NULL);
+		if (device->cv_scans == NULL) {
+			return false;
+		}
+	}
+	mscript_cv_scans_reset(device->cv_scans);
+	MscriptLoopPrediction_t const * loop = event->loop;
+	mscript_cv_scans_set_point_interval(device->cv_scans,
+		loop->is_exact ? loop->min_point_interval_s : 0.0);
+	return true;
+}
+
+/**
+ * Write the analysis of each scan of a cyclic voltammetry measurement loop to
+ * a CSV file, and print a summary of each scan.
+ *
+ * The scans have been analyzed by the worker threads while the loop was
+ * running; this waits for the last scan.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool write_cv_scan_results(Device_t * device, unsigned int meas_loop_index)
+{
+	if (!mscript_cv_scans_end_scan(device->cv_scans)) {
+		return false;
+	}
+	mscript_cv_scans_wait(device->cv_scans);
+	size_t count;
+	MscriptCvScanResult_t const * results = mscript_cv_scans_get_results(device->cv_scans,
+		&count);
+	if (count == 0) {
+		return true;
+	}
+
+	char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+	if (!get_csv_file_path(device, meas_loop_index, device->meas_loop_id, "-scans",
+		csv_file_path)) {
+		return false;
+	}
+	MscriptOutputFile_t * csv = mscript_output_open(output, csv_file_path);
+	if (csv == NULL) {
+		return false;
+	}
+	if (SET_SEPARATOR_FOR_MS_EXCEL) {
+		mscript_output_printf(csv, "sep=;\n");
+	}
+	mscript_output_printf(csv, "Scan;Points;E_min;E_max;Q anodic;Q cathodic;"
+		"E_pa;i_pa;E_pc;i_pc;Delta E_p\r\n");
+	for (size_t i = 0; i < count; ++i) {
+		MscriptCvScanResult_t const * r = &results[i];
+		double e_pa = r->has_anodic_peak ? r->anodic_peak.potential : NAN;
+		double i_pa = r->has_anodic_peak ? r->anodic_peak.height : NAN;
+		double e_pc = r->has_cathodic_peak ? r->cathodic_peak.potential : NAN;
+		double i_pc = r->has_cathodic_peak ? r->cathodic_peak.height : NAN;
+		mscript_output_printf(csv, "%u;%lu;%.6E;%.6E;%.6E;%.6E;%.6E;%.6E;%.6E;%.6E;%.6E\r\n",
+			r->index + 1, (unsigned long)r->nr_of_points, r->min_potential, r->max_potential,
+			r->anodic_charge, r->cathodic_charge, e_pa, i_pa, e_pc, i_pc, r->peak_separation);
+		device_printf(device, "Scan %u: %lu points, Q = %.4E / %.4E C, i_pa = %.4E A, "
+			"i_pc = %.4E A, Delta E_p = %.4f V\n", r->index + 1, (unsigned long)r->nr_of_points,
+			r->anodic_charge, r->cathodic_charge, i_pa, i_pc, r->peak_separation);
+	}
+	mscript_output_close(csv);
+	device_printf(device, "Scans: CSV file: %s\n", csv_file_path);
+	return true;
+}
+
+/**
+ * Start averaging the scans of a measurement loop, if it is a voltammetric
+ * technique (SWV, DPV, CV or LSV).
+ *
+ * The scans of all runs of the same measurement loop of the script (e.g. in a
+ * "loop" command) are averaged together, as well as the scans of a CV
+ * measurement loop with the "nscans" argument.
+ *
+ * \return The average of the measurement loop, or NULL if it is not averaged.
+ */
+static ScanAverage_t * start_scan_average(Device_t * device, MscriptEvent_t const * event)
+{
+	if (get_scan_type(event) == SCAN_TYPE_NONE) {
+		return NULL;
+	}
+	ScanAverage_t * scan_average = &device->scan_averages[event->loop - device->prediction->loops];
+	if (scan_average->average == NULL) {
+		scan_average->average = mscript_scan_average_create(MSCRIPT_VARTYPE_CURRENT, 0.0);
+		if (scan_average->average == NULL) {
+			return NULL;
+		}
+		scan_average->meas_loop_index = event->meas_loop_index;
+		strncpy(scan_average->meas_loop_id, event->response, 5);
+		scan_average->meas_loop_id[5] = '\0';
+	}
+	return scan_average;
+}
+
+/**
+ * End the current scan of the averaged measurement loop, and print the
+ * progress of the average once more than one scan has been added.
+ */
+static void end_scan_average(Device_t * device)
+{
+	MscriptScanAverage_t * average = device->scan_average->average;
+	if (!mscript_scan_average_end_scan(average)
+		|| (mscript_scan_average_get_nr_of_scans(average) < 2)) {
+		return;
+	}
+	// The curve is only a few hundred points, so it is copied to find the
+	// largest standard error.
+	size_t count = mscript_scan_average_get_nr_of_points(average);
+	MscriptAveragePoint_t * points = malloc(count * sizeof(MscriptAveragePoint_t));
+	if (points == NULL) {
+		return;
+	}
+	count = mscript_scan_average_get_curve(average, points, count);
+	double max_std_error = 0.0;
+	for (size_t i = 0; i < count; ++i) {
+		if (points[i].std_error > max_std_error) {
+			max_std_error = points[i].std_error;
+		}
+	}
+	free(points);
+	device_printf(device, "Average of %u scans: %lu points, max. standard error %.4E A\n",
+		mscript_scan_average_get_nr_of_scans(average), (unsigned long)count, max_std_error);
+}
+
+/**
+ * Write the averaged scans of each measurement loop that has been repeated to
+ * a CSV file, and free the averages.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool write_scan_averages(Device_t * device)
+{
+	bool success = true;
+	device->scan_average = NULL;
+	for (size_t i = 0; i < MSCRIPT_ANALYZER_MAX_LOOPS; ++i) {
+		ScanAverage_t * scan_average = &device->scan_averages[i];
+		MscriptScanAverage_t * average = scan_average->average;
+		if (average == NULL) {
+			continue;
+		}
+		size_t count = mscript_scan_average_get_nr_of_points(average);
+		MscriptAveragePoint_t * points = NULL;
+		if ((mscript_scan_average_get_nr_of_scans(average) > 1) && (count > 0)) {
+			points = malloc(count * sizeof(MscriptAveragePoint_t));
+			success = success && (points != NULL);
+		}
+		if (points != NULL) {
+			count = mscript_scan_average_get_curve(average, points, count);
+			char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+			MscriptOutputFile_t * csv = get_csv_file_path(device, scan_average->meas_loop_index,
+				scan_average->meas_loop_id, "-avg", csv_file_path)
+				? mscript_output_open(output, csv_file_path) : NULL;
+			if (csv != NULL) {
+				if (SET_SEPARATOR_FOR_MS_EXCEL) {
+					mscript_output_printf(csv, "sep=;\n");
+				}
+				mscript_output_printf(csv, "Potential;Direction;Scans;Mean current;"
+					"Standard error\r\n");
+				for (size_t j = 0; j < count; ++j) {
+					MscriptAveragePoint_t const * p = &points[j];
+					mscript_output_printf(csv, "%.6E;%d;%u;%.6E;%.6E\r\n", p->potential,
+						p->direction, p->nr_of_scans, p->mean, p->std_error);
+				}
+				mscript_output_close(csv);
+				device_printf(device, "Average of %u scans: CSV file: %s\n",
+					mscript_scan_average_get_nr_of_scans(average), csv_file_path);
+			} else {
+				success = false;
+			}
+			free(points);
+		}
+		mscript_scan_average_destroy(average);
+		scan_average->average = NULL;
+	}
+	return success;
+}
+
+/**
+ * Add the point of a data package to a Mott-Schottky analysis, if the package
+ * contains a DC potential and impedance. The analysis is created when the
+ * first point is received.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool add_mott_schottky_point(MottSchottky_t * ms, MscriptEvent_t const * event,
+	char const * meas_loop_id)
+{
+	if (!mscript_mott_schottky_is_package(event->package)) {
+		return true;
+	}
+	if (ms->analysis == NULL) {
+		ms->analysis = mscript_mott_schottky_create(NULL);
+		if (ms->analysis == NULL) {
+			return false;
+		}
+		ms->meas_loop_index = event->meas_loop_index;
+		strcpy(ms->meas_loop_id, meas_loop_id);
+	}
+	return mscript_mott_schottky_add_package(ms->analysis, event->package);
+}
+
+/**
+ * Write the capacitance and 1/C^2 of each electrode with Mott-Schottky data
+ * to a CSV file, print the flat-band potential and doping density, and free
+ * the analyses.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool write_mott_schottky_results(Device_t * device)
+{
+	bool success = true;
+	for (size_t i = 0; i <= MSCRIPT_COLUMN_STORE_MAX_CHANNELS; ++i) {
+		MottSchottky_t * ms = &device->mott_schottky[i];
+		if (ms->analysis == NULL) {
+			continue;
+		}
+		MscriptMottSchottkyPoint_t const * points;
+		size_t count = mscript_mott_schottky_get_points(ms->analysis, &points);
+		char prefix[32] = "Mott-Schottky";
+		char suffix[MAX_CSV_FILE_SUFFIX_LENGTH + 1] = "-ms";
+		if (i > 0) {
+			snprintf(prefix, sizeof(prefix), "Channel %u: Mott-Schottky", (unsigned int)i - 1);
+			snprintf(suffix, sizeof(suffix), "-ch%02u-ms", (unsigned int)i - 1);
+		}
+		char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+		MscriptOutputFile_t * csv = get_csv_file_path(device, ms->meas_loop_index,
+			ms->meas_loop_id, suffix, csv_file_path)
+			? mscript_output_open(output, csv_file_path) : NULL;
+		if (csv != NULL) {
+			if (SET_SEPARATOR_FOR_MS_EXCEL) {
+				mscript_output_printf(csv, "sep=;\n");
+			}
+			mscript_output_printf(csv, "Potential;Frequency;Capacitance;1/C^2\r\n");
+			for (size_t j = 0; j < count; ++j) {
+				mscript_output_printf(csv, "%.6E;%.6E;%.6E;%.6E\r\n", points[j].potential,
+					points[j].frequency, points[j].capacitance, points[j].inverse_c2);
+			}
+			mscript_output_close(csv);
+			device_printf(device, "%s: CSV file: %s\n", prefix, csv_file_path);
+		} else {
+			success = false;
+		}
+
+		MscriptMottSchottkyResult_t result;
+		mscript_mott_schottky_get_result(ms->analysis, &result);
+		if (result.is_valid) {
+			// The doping density is usually given per cm^3.
+			device_printf(device, "%s: E_fb = %.4f V, N = %.4E cm^-3 (%s-type), "
+				"r^2 = %.5f over %.3f to %.3f V\n", prefix, result.flat_band_potential,
+				result.doping_density * 1e-6, result.is_n_type ? "n" : "p", result.r_squared,
+				result.min_potential, result.max_potential);
+		} else {
+			device_printf(device, "%s: not enough points for a fit.\n", prefix);
+		}
+		mscript_mott_schottky_destroy(ms->analysis);
+		ms->analysis = NULL;
+	}
+	return success;
+}
+
+/**
+ * Write the data of each channel in a measurement loop to a separate CSV file.
+ *
+ * The data is taken from the column store of the device, using its index to
+ * find the rows of this measurement loop. The columns have the same layout as
+ * the CSV file of the complete measurement loop, without the channel column.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool write_channel_csv_files(Device_t * device, unsigned int meas_loop_index)
+{
+	for (unsigned int ch = 0; ch < MSCRIPT_COLUMN_STORE_MAX_CHANNELS; ++ch) {
+		MscriptChannelColumns_t const * channel = mscript_column_store_get_channel(
+			device->columns, ch);
+		MscriptLoopIndexEntry_t const * loop = (channel != NULL)
+			? mscript_channel_find_loop(channel, meas_loop_index) : NULL;
+		if (loop == NULL) {
+			continue;
+		}
+
+		char suffix[MAX_CSV_FILE_SUFFIX_LENGTH + 1];
+		char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+		snprintf(suffix, sizeof(suffix), "-ch%02u", ch);
+		if (!get_csv_file_path(device, meas_loop_index, device->meas_loop_id, suffix,
+			csv_file_path)) {
+			return false;
+		}
+		MscriptOutputFile_t * csv = mscript_output_open(output, csv_file_path);
+		if (csv == NULL) {
+			return false;
+		}
+		device_printf(device, "CSV file: %s (%lu rows)\n", csv_file_path,
+			(unsigned long)loop->nr_of_rows);
+		// Multiplexer scripts often measure only one point per channel in
+		// each measurement loop, so the statistics are not useful then.
+		if (loop->nr_of_rows > 1) {
+			print_loop_stats(device, (int)ch, &loop->stats);
+		}
+
+		// The metadata columns are determined by the first row, like the
+		// header row of the CSV file of the complete loop.
+		size_t first = loop->first_row;
+		if (SET_SEPARATOR_FOR_MS_EXCEL) {
+			mscript_output_printf(csv, "sep=;\n");
+		}
+		mscript_output_printf(csv, "Index");
+		for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+			MscriptColumn_t const * column = &channel->columns[i];
+			mscript_output_printf(csv, ";%s", mscript_vartype_to_string(column->variable_type));
+			if (column->status[first] != MSCRIPT_COLUMN_NO_METADATA) {
+				mscript_output_printf(csv, ";Status");
+			}
+			if (column->range[first] != MSCRIPT_COLUMN_NO_METADATA) {
+				mscript_output_printf(csv, ";Current Range");
+			}
+		}
+		mscript_output_printf(csv, "\r\n");
+
+		for (size_t row = first; row < first + loop->nr_of_rows; ++row) {
+			mscript_output_printf(csv, "%lu", (unsigned long)(row - first + 1));
+			for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+				MscriptColumn_t const * column = &channel->columns[i];
+				mscript_output_printf(csv, ";%.15lf", column->values[row]);
+				if (column->status[first] != MSCRIPT_COLUMN_NO_METADATA) {
+					if (column->status[row] != MSCRIPT_COLUMN_NO_METADATA) {
+						print_metadata_status(csv, column->status[row]);
+					} else {
+						mscript_output_printf(csv, ";");
+					}
+				}
+				if (column->range[first] != MSCRIPT_COLUMN_NO_METADATA) {
+					char const * range_str = "";
+					if (column->range[row] != MSCRIPT_COLUMN_NO_METADATA) {
+						range_str = mscript_metadata_range_to_string(device->device_type,
+							column->variable_type, column->range[row]);
+					}
+					mscript_output_printf(csv, ";%s", range_str);
+				}
+			}
+			mscript_output_printf(csv, "\r\n");
+		}
+		mscript_output_close(csv);
+	}
+	return true;
+}
+
+/**
+ * Print the throughput and error statistics of each device.
+ */
+static void print_statistics(Device_t const * devices, size_t nr_of_devices)
+{
+	printf("\nStatistics:\n");
+	for (size_t i = 0; i < nr_of_devices; ++i) {
+		Device_t const * device = &devices[i];
+		MscriptAcquisitionStats_t const * stats = &device->stats;
+		double duration_s = stats->duration_ms / 1000.0;
+		double packages_per_s = (duration_s > 0) ? stats->nr_of_packages / duration_s : 0;
+		double bytes_per_s = (duration_s > 0) ? stats->nr_of_bytes / duration_s : 0;
+		printf("[%u] %s %s: %s\n", device->number, device->port, device->script_name,
+			device->success ? "OK" : "FAILED");
+		printf("    %" PRIu64 " packages, %" PRIu64 " bytes in %.2f s "
+			"(%.0f packages/s, %.0f bytes/s)\n", stats->nr_of_packages, stats->nr_of_bytes,
+			duration_s, packages_per_s, bytes_per_s);
+		printf("    errors: %u script, %u communication, %u unexpected lines\n",
+			stats->nr_of_script_errors, stats->nr_of_communication_errors,
+			stats->nr_of_unexpected_lines);
+		MscriptTriggerStats_t const * trigger_stats = &device->trigger_stats;
+		if (trigger_stats->nr_of_packages > 0) {
+			printf("    triggers: %u fired, %u abort(s), decision latency %.1f us mean, "
+				"%" PRIu64 " us max\n", trigger_stats->nr_of_fires, trigger_stats->nr_of_aborts,
+				(double)trigger_stats->total_latency_us / trigger_stats->nr_of_packages,
+				trigger_stats->max_latency_us);
+		}
+	}
+}
+
+/**
+ * Get the path of the CSV file of a measurement loop.
+ *
+ * When multiple devices are used, the number of the device is part of the
+ * file name, so devices that run the same script do not overwrite each
+ * other's files. The `suffix` (e.g. "-ch00-fit") is added to the end of the
+ * file name; it should be at most `MAX_CSV_FILE_SUFFIX_LENGTH` characters long.
+ *
+ * \param path[out] Buffer of `MAX_CSV_FILE_PATH_SIZE` characters for the path.
+ *
+ * \return `true` on success, `false` if the path does not fit in the buffer
+ *         (`errno` is set to `ENAMETOOLONG`)
+ */
+static bool get_csv_file_path(Device_t const * device, unsigned int index, char const * response,
+	char const * suffix, char * path)
+{
+	char M[6] = {0};
+	strncpy(M, response, 5);
+	int length;
+	if (device->is_concurrent) {
+		length = snprintf(path, MAX_CSV_FILE_PATH_SIZE, "results/%s-dev%02u-%04u-%s%s.csv",
+			device->script_name, device->number, index, M, suffix);
+	} else {
+		length = snprintf(path, MAX_CSV_FILE_PATH_SIZE, "results/%s-%04u-%s%s.csv",
+			device->script_name, index, M, suffix);
+	}
+	if ((length < 0) || (length >= MAX_CSV_FILE_PATH_SIZE)) {
+		errno = ENAMETOOLONG;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Create and open a CSV file with file name based on supplied parameters.
+ * 
+ * \return The output file on success, or NULL on failure.
+ */
+static MscriptOutputFile_t * create_csv_file(Device_t * device, unsigned index,
+	char const * response)
+{
+	char csv_file_path[MAX_CSV_FILE_PATH_SIZE];
+	if (!get_csv_file_path(device, index, response, "", csv_file_path)) {
+		return NULL;
+	}
+	device_printf(device, "CSV file: %s\n", csv_file_path);
+	return mscript_output_open(output, csv_file_path);
+}
+
+static void print_sub_package(MscriptOutputFile_t * console,
+	MscriptSubPackage_t const * sub_package, DeviceType_t device_type)
+{
+	// Print the variable type (shortened/abbreviated) and value, using the
+	// label, unit and format of the variable type.
+	MscriptVartypeDescriptor_t const * descriptor =
+		mscript_get_vartype_descriptor(sub_package->variable_type);
+	if (descriptor->label == NULL) {
+		mscript_output_printf(console, "   ?%d?[?] %16.3f ", sub_package->variable_type,
+			sub_package->value);
+	} else {
+		if (descriptor->unit[0] != '\0') {
+			mscript_output_printf(console, "   %s[%s]: ", descriptor->label, descriptor->unit);
+		} else {
+			mscript_output_printf(console, "   %s: ", descriptor->label);
+		}
+		mscript_output_printf(console, descriptor->format, sub_package->value);
 	}
 
 	// Print the metadata. Note that a value < 0 indicates that the variable
@@ -500,56 +2313,62 @@ static void print_sub_package(MscriptSubPackage_t const * sub_package)
 				}
 			}
 		}
-		printf("  status: %-16s", status_str);
+		mscript_output_printf(console, "  status: %-16s", status_str);
 	}
 
 	// Print the range metadata.
 	if (sub_package->metadata.range >= 0) {
-		printf("  range: %-19s", mscript_metadata_range_to_string(device_type,
-			sub_package->variable_type, sub_package->metadata.range));
+		mscript_output_printf(console, "  range: %-19s",
+			mscript_metadata_range_to_string(device_type, sub_package->variable_type,
+				sub_package->metadata.range));
 	}
 }
 
 /**
  * Print the contents of a data package to the console.
+ *
+ * The package is written as one line through the output writer.
  */
-static void print_data_package(MscriptDataPackage_t * package)
+static void print_data_package(MscriptOutputFile_t * console,
+	MscriptDataPackage_t const * package, DeviceType_t device_type)
 {
 	if (package->nr_of_sub_packages == 0) {
-		printf("Empty data package.");
+		mscript_output_printf(console, "Empty data package.");
 	}
 	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
-		print_sub_package(&package->sub_packages[i]);
+		print_sub_package(console, &package->sub_packages[i], device_type);
 	}
-	printf("\n");
+	mscript_output_printf(console, "\n");
+	mscript_output_flush(console);
 }
 
 /**
  * Write the CSV header row to file.
  */
-static void write_csv_header_row(FILE * fp, MscriptDataPackage_t * package)
+static void write_csv_header_row(MscriptOutputFile_t * csv, MscriptDataPackage_t const * package)
 {
 	if (SET_SEPARATOR_FOR_MS_EXCEL) {
-		fprintf(fp, "sep=;\n");
+		mscript_output_printf(csv, "sep=;\n");
 	}
 
 	// The first column is always the package index.
-	fprintf(fp, "Index");
+	mscript_output_printf(csv, "Index");
 
 	// Add one column for each variable in the package, plus a column for each
 	// metadata variable if present.
 	// NOTE: It is assumed that all data packages in a measurement loop contain the
 	// same variables!
 	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
-		fprintf(fp, ";%s", mscript_vartype_to_string(package->sub_packages[i].variable_type));
+		mscript_output_printf(csv, ";%s",
+			mscript_vartype_to_string(package->sub_packages[i].variable_type));
 		if (package->sub_packages[i].metadata.status >= 0) {
-			fprintf(fp, ";Status");
+			mscript_output_printf(csv, ";Status");
 		}
 		if (package->sub_packages[i].metadata.range >= 0) {
-			fprintf(fp, ";Current Range");
+			mscript_output_printf(csv, ";Current Range");
 		}
 	}
-	fprintf(fp, "\r\n");
+	mscript_output_printf(csv, "\r\n");
 }
 
 /**
@@ -559,43 +2378,44 @@ static void write_csv_header_row(FILE * fp, MscriptDataPackage_t * package)
  * the CSV file. All status flags are written. If multiple status flags are
  * set, they are concatenated with " + ".
  */
-static void print_metadata_status(FILE * fp, int status) {
+static void print_metadata_status(MscriptOutputFile_t * csv, int status) {
 	// The metadata status consists of 4 flags that could be set.
 	unsigned int num_flags = 0;
 	for (unsigned int i = 0; i < 4; ++i) {
 		int mask = 1 << i;
 		if (status & mask) {
 			if (num_flags++ == 0) {
-				fprintf(fp, ";%s", mscript_metadata_status_to_string(mask));
+				mscript_output_printf(csv, ";%s", mscript_metadata_status_to_string(mask));
 			} else {
-				fprintf(fp, " + %s", mscript_metadata_status_to_string(mask));
+				mscript_output_printf(csv, " + %s", mscript_metadata_status_to_string(mask));
 			}
 		}
 	}
 	if (num_flags == 0) {
-		fprintf(fp, ";%s", mscript_metadata_status_to_string(0));
+		mscript_output_printf(csv, ";%s", mscript_metadata_status_to_string(0));
 	}
 }
 
 /**
  * Write a CSV data row to file.
  */
-static void write_csv_data_row(FILE * fp, unsigned int index, MscriptDataPackage_t * package)
+static void write_csv_data_row(MscriptOutputFile_t * csv, unsigned int index,
+	MscriptDataPackage_t const * package, DeviceType_t device_type)
 {
 	// The first column is always the package index.
-	fprintf(fp, "%u", index);
+	mscript_output_printf(csv, "%u", index);
 
 	// Add all sub packages, i.e. the value and metadata of each variable.
 	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
-		fprintf(fp, ";%.15lf", package->sub_packages[i].value);
+		mscript_output_printf(csv, ";%.15lf", package->sub_packages[i].value);
 		if (package->sub_packages[i].metadata.status >= 0) {
-			print_metadata_status(fp, package->sub_packages[i].metadata.status);
+			print_metadata_status(csv, package->sub_packages[i].metadata.status);
 		}
 		if (package->sub_packages[i].metadata.range >= 0) {
-			fprintf(fp, ";%s", mscript_metadata_range_to_string(device_type,
+			mscript_output_printf(csv, ";%s", mscript_metadata_range_to_string(device_type,
 				package->sub_packages[i].variable_type,
 				package->sub_packages[i].metadata.range));
 		}
 	}
-	fprintf(fp, "\r\n");
+	mscript_output_printf(csv, "\r\n");
 }
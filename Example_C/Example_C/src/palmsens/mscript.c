@@ -68,16 +68,19 @@
 /// Buffer size for write line buffer (maximum length + 1 for terminating zero character)
 #define MSCRIPT_WRITE_LINE_BUF_SIZE (MSCRIPT_WRITE_LINE_MAX_CHARS + 1)
 
-/**
- * Offset value for MethodSCRIPT parameters (see the MethodSCRIPT documentation
- * paragraph 'Measurement data package variables').
- */
-#define MSCRIPT_PARAMETER_OFFSET 0x8000000
-
 #if defined(_WIN32)	// Windows (32-bit or 64-bit)
 
 	#include <windows.h> // for GetTickCount() and Sleep()
 	static inline uint32_t get_time_ms(void) { return (uint32_t)GetTickCount(); }
+	static uint64_t get_time_us(void)
+	{
+		LARGE_INTEGER frequency, counter;
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&counter);
+		// Split the calculation to avoid overflow of counter * 1000000.
+		return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000
+			+ (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+	}
 
 #elif defined (__linux__) // Linux
 
@@ -90,15 +93,64 @@
 		ts.tv_nsec = dt.rem * 1000000L;
 		nanosleep(&ts, NULL);
 	}
+	static void get_monotonic_time(struct timespec * ts)
+	{
+		// The monotonic clock is always available on Linux, but fall back to
+		// the real-time clock rather than returning an undefined time.
+		if (clock_gettime(CLOCK_MONOTONIC, ts) != 0) {
+			DEBUG_PRINTF("ERROR: clock_gettime(CLOCK_MONOTONIC) failed.\n");
+			if (clock_gettime(CLOCK_REALTIME, ts) != 0) {
+				ts->tv_sec = 0;
+				ts->tv_nsec = 0;
+			}
+		}
+	}
 	static uint32_t get_time_ms(void)
 	{
 		struct timespec ts;
-		assert(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+		get_monotonic_time(&ts);
 		return (uint32_t)((ts.tv_sec * 1000UL) + (ts.tv_nsec / 1000000UL));
 	}
+	static uint64_t get_time_us(void)
+	{
+		struct timespec ts;
+		get_monotonic_time(&ts);
+		return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+	}
 
 #endif
 
+/**
+ * Get the time of a monotonic clock in milliseconds.
+ *
+ * The value wraps around after 2^32 ms, so only the difference between two
+ * values (calculated using unsigned arithmetic) is meaningful.
+ */
+uint32_t mscript_get_time_ms(void)
+{
+	return get_time_ms();
+}
+
+/**
+ * Get the time of a high-resolution monotonic clock in microseconds.
+ *
+ * Used to measure short intervals, such as the time between receiving a
+ * response and acting on it. Only the difference between two values is
+ * meaningful.
+ */
+uint64_t mscript_get_time_us(void)
+{
+	return get_time_us();
+}
+
+/**
+ * Suspend the calling thread for the given time.
+ */
+void mscript_sleep_ms(uint32_t ms)
+{
+	Sleep(ms);
+}
+
 /**
  * Flush the communication.
  * 
@@ -140,6 +192,7 @@ void mscript_flush_communication(SerialPortHandle_t handle)
  *            buffer;
  * \return    `false` if a read error occurred, no new line character was
  *            received, or the buffer was too small to store the received line.
+ *            On a timeout, `errno` is set to `ETIMEDOUT`.
  */
 bool mscript_serial_port_read_line(SerialPortHandle_t handle, char * buf, size_t buf_size,
 	uint32_t timeout_ms)
@@ -171,6 +224,7 @@ bool mscript_serial_port_read_line(SerialPortHandle_t handle, char * buf, size_t
 			uint32_t dt = get_time_ms() - t0;
 			if (dt >= timeout_ms) {
 				DEBUG_PRINTF("ERROR: timeout while reading line.\n");
+				errno = ETIMEDOUT;
 				return false;
 			}
 		} else { // -1, error
@@ -277,7 +331,7 @@ DeviceType_t mscript_get_device_type(char const * firmware_version)
 		return EMSTAT4_LR;
 	} else if (!strncmp(firmware_version, "es4_hr", 6)) {
 		return EMSTAT4_HR;
-	} else if (!strncmp(firmware_version, "mes4hr", 6)) {
+	} else if (!strncmp(firmware_version, "mes4lr", 6)) {
 		return MULTI_EMSTAT4_LR;
 	} else if (!strncmp(firmware_version, "mes4hr", 6)) {
 		return MULTI_EMSTAT4_HR;
@@ -314,19 +368,51 @@ char const * mscript_get_device_type_name(DeviceType_t device_type)
 }
 
 /**
- * Send a MethodSCRIPT from file to the device.
+ * Read one reply line from the device and check if the command succeeded.
  *
- * \param h_device Handle to the serial port.
+ * The reply of most commands starts with the command character itself. If the
+ * command failed, the reply contains an error code preceded by a '!'.
+ *
+ * \param handle Handle to the serial port.
+ * \param command The (first character of the) command that was sent.
+ * \param timeout_ms Read timeout in milliseconds.
+ *
+ * \return `true` if the expected reply was received, `false` otherwise
+ */
+static bool check_command_reply(SerialPortHandle_t handle, char command, uint32_t timeout_ms)
+{
+	char response[MSCRIPT_READ_BUFFER_SIZE];
+	if (!mscript_serial_port_read_line(handle, response, MSCRIPT_READ_BUFFER_SIZE, timeout_ms)) {
+		return false;
+	}
+	if ((response[0] != command) || (strchr(response, '!') != NULL)) {
+		DEBUG_PRINTF("ERROR: Unexpected reply to '%c' command: %s", command, response);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Send a MethodSCRIPT file to the device, optionally replacing the first line.
+ *
+ * The first line of a MethodSCRIPT file is the command that tells the device
+ * what to do with the script (e.g. "e" to execute it). If `first_line` is not
+ * NULL, that line is replaced by `first_line`, so the same file can also be
+ * used to only load the script (e.g. to store it in flash memory).
+ *
+ * \param handle Handle to the serial port.
  * \param path Path to the MethodSCRIPT file to be read and sent.
- * 
+ * \param first_line Replacement for the first line of the file, or NULL.
+ *
  * \return `true` on success, `false` on failure
  */
-bool mscript_send_file(SerialPortHandle_t handle, char const * path)
+static bool send_file(SerialPortHandle_t handle, char const * path, char const * first_line)
 {
 	assert(handle != BAD_HANDLE);
 	assert(path != NULL);
 
 	bool success = true;
+	bool is_first_line = true;
 	// Allocate buffer for one line
 	char line[MSCRIPT_WRITE_LINE_BUF_SIZE];
 
@@ -350,7 +436,12 @@ bool mscript_send_file(SerialPortHandle_t handle, char const * path)
 			break;
 		}
 		// Send line to the device.
-		success = mscript_serial_port_write(handle, line);
+		if (is_first_line && (first_line != NULL)) {
+			success = mscript_serial_port_write(handle, first_line);
+		} else {
+			success = mscript_serial_port_write(handle, line);
+		}
+		is_first_line = false;
 	}
 
 	if (success) {
@@ -368,6 +459,210 @@ bool mscript_send_file(SerialPortHandle_t handle, char const * path)
 	return success;
 }
 
+/**
+ * Send a MethodSCRIPT from file to the device.
+ *
+ * \param h_device Handle to the serial port.
+ * \param path Path to the MethodSCRIPT file to be read and sent.
+ * 
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_send_file(SerialPortHandle_t handle, char const * path)
+{
+	return send_file(handle, path, NULL);
+}
+
+/**
+ * Send a MethodSCRIPT that is held in memory to the device.
+ *
+ * The script must have the same format as a script file, i.e. start with the
+ * "e" command and end with an empty line. This is typically used for scripts
+ * that were compiled into the application (see `MscriptBuiltinScript_t`).
+ *
+ * \param handle Handle to the serial port.
+ * \param script The complete script as a zero-terminated string.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_send_script(SerialPortHandle_t handle, char const * script)
+{
+	assert(handle != BAD_HANDLE);
+	assert(script != NULL);
+
+	bool success = mscript_serial_port_write(handle, script);
+	if (success) {
+		DEBUG_PRINTF("Successfully sent script to device.\n");
+	}
+	return success;
+}
+
+/**
+ * Get the serial number from the device.
+ *
+ * \param handle Handle to the serial port.
+ * \param buf buffer to store the serial number in
+ * \param buf_size size of the buffer
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_get_serial_number(SerialPortHandle_t handle, char * buf, size_t buf_size)
+{
+	assert(buf != NULL);
+
+	if (!mscript_serial_port_write(handle, "i\n")) {
+		return false;
+	}
+
+	// The response is "i<serial number>\n".
+	char response[MSCRIPT_READ_BUFFER_SIZE];
+	if (!mscript_serial_port_read_line(handle, response, MSCRIPT_READ_BUFFER_SIZE, 100)) {
+		return false;
+	}
+	if (response[0] != MSCRIPT_REPLY_ID_SERIAL_NUMBER) {
+		DEBUG_PRINTF("ERROR: Unexpected response to serial number request.\n");
+		return false;
+	}
+
+	size_t len = strcspn(response + 1, "\r\n");
+	if (buf_size <= len) {
+		DEBUG_PRINTF("ERROR: Buffer is too small to hold serial number.\n");
+		return false;
+	}
+	memcpy(buf, response + 1, len);
+	buf[len] = '\0';
+	return true;
+}
+
+/**
+ * Store a MethodSCRIPT from file in the flash memory of the device.
+ *
+ * The script is first loaded into RAM (using the "l" command instead of the
+ * "e" command on the first line of the file) and then written to flash using
+ * the "Smscr" command. The script is not executed. Use
+ * `mscript_run_from_flash()` to execute it.
+ *
+ * \param handle Handle to the serial port.
+ * \param path Path to the MethodSCRIPT file to be stored.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_store_file_in_flash(SerialPortHandle_t handle, char const * path)
+{
+	if (!send_file(handle, path, "l\n")) {
+		return false;
+	}
+	if (!check_command_reply(handle, MSCRIPT_REPLY_ID_LOAD_SCRIPT, 1000)) {
+		return false;
+	}
+	if (!mscript_serial_port_write(handle, "Smscr\n")) {
+		return false;
+	}
+	// Writing the flash memory can take a while.
+	return check_command_reply(handle, 'S', 5000);
+}
+
+/**
+ * Load the MethodSCRIPT stored in flash memory and start executing it.
+ *
+ * After this function returns successfully, the response of the script should
+ * be processed in the same way as after sending a script using
+ * `mscript_send_file()`.
+ *
+ * \param handle Handle to the serial port.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_run_from_flash(SerialPortHandle_t handle)
+{
+	if (!mscript_serial_port_write(handle, "Lmscr\n")) {
+		return false;
+	}
+	if (!check_command_reply(handle, 'L', 1000)) {
+		return false;
+	}
+	return mscript_serial_port_write(handle, "r\n");
+}
+
+/**
+ * Abort a possibly running script and wait until the device is ready.
+ *
+ * This function gets the device in a known state, e.g. after a read timeout
+ * or when the application was interrupted during a measurement. A newline is
+ * sent first, to terminate a possibly incomplete command, followed by the
+ * abort command ("Z"). Then, all lines are read and discarded until the reply
+ * to the abort command is received. If a script was running, the remaining
+ * output of the script is also discarded, up to the empty line that denotes
+ * the end of the script.
+ *
+ * Unlike waiting for the script to finish, this takes at most `deadline_ms`.
+ * If the device is not ready by then (e.g. because it is disconnected or
+ * hangs), this function fails.
+ *
+ * \param handle Handle to the serial port.
+ * \param deadline_ms Maximum time in milliseconds to wait for the device.
+ * \param p_result[out] Details of the recovery. May be NULL.
+ *
+ * \return `true` if the device is ready for new commands, `false` otherwise
+ */
+bool mscript_abort_and_sync(SerialPortHandle_t handle, uint32_t deadline_ms,
+	MscriptAbortResult_t * p_result)
+{
+	MscriptAbortResult_t result = { false, 0, 0 };
+	uint32_t t0 = get_time_ms();
+	bool success = mscript_serial_port_write(handle, "\n")
+		&& mscript_serial_port_write(handle, "Z\n");
+
+	// Wait for the reply to the abort command.
+	bool is_acknowledged = false;
+	char response[MSCRIPT_READ_BUFFER_SIZE];
+	while (success && !is_acknowledged) {
+		uint32_t elapsed = get_time_ms() - t0;
+		success = (elapsed < deadline_ms) && mscript_serial_port_read_line(handle, response,
+			MSCRIPT_READ_BUFFER_SIZE, deadline_ms - elapsed);
+		if (success) {
+			if (response[0] == 'Z') {
+				is_acknowledged = true;
+			} else {
+				++result.nr_of_discarded_lines;
+			}
+		}
+	}
+
+	if (is_acknowledged) {
+		if (!strcmp(response, "Z!0006\n")) {
+			// No script was running. The device needs > 50 ms after a
+			// failed command ('!' in response) before it accepts new ones.
+			Sleep(100);
+		} else {
+			// The script was running; discard the rest of its output.
+			result.was_running = true;
+			bool is_finished = false;
+			while (success && !is_finished) {
+				uint32_t elapsed = get_time_ms() - t0;
+				success = (elapsed < deadline_ms) && mscript_serial_port_read_line(handle,
+					response, MSCRIPT_READ_BUFFER_SIZE, deadline_ms - elapsed);
+				if (success) {
+					if (response[0] == MSCRIPT_REPLY_ID_END_OF_SCRIPT) {
+						is_finished = true;
+					} else {
+						++result.nr_of_discarded_lines;
+					}
+				}
+			}
+		}
+	}
+
+	result.recovery_time_ms = get_time_ms() - t0;
+	if (!success) {
+		DEBUG_PRINTF("ERROR: Device not ready %lu ms after abort command.\n",
+			(unsigned long)result.recovery_time_ms);
+	}
+	if (p_result != NULL) {
+		*p_result = result;
+	}
+	return success;
+}
+
 static void mscript_clear_sub_package(MscriptSubPackage_t * subpackage)
 {
 	subpackage->value = 0;
@@ -501,6 +796,123 @@ bool parse_data_package(char const * response, MscriptDataPackage_t * package)
 	return true;
 }
 
+/**
+ * Get the value of a hexadecimal digit.
+ *
+ * \return The value (0-15), or -1 if `c` is not a hexadecimal digit.
+ */
+static int get_hex_digit_value(char c)
+{
+	if ((c >= '0') && (c <= '9')) {
+		return c - '0';
+	}
+	if ((c >= 'A') && (c <= 'F')) {
+		return c - 'A' + 10;
+	}
+	if ((c >= 'a') && (c <= 'f')) {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+/**
+ * Parse a data package of which the layout is known in advance.
+ *
+ * Instead of searching for the separators and reading the variable types from
+ * the package, each sub package is expected at a fixed position with the
+ * variable type given by `schema`, and the value is decoded directly from the
+ * response. Only metadata, which can differ per package, is parsed as usual.
+ *
+ * If the package does not match the schema (e.g. because it contains a NaN
+ * value or different variables), or if no schema is given, the package is
+ * parsed using `parse_data_package()` instead. So the result is always the
+ * same as that of `parse_data_package()`, only faster in the common case.
+ *
+ * \param response The reponse line containing a MethodSCRIPT data package.
+ * \param schema The expected layout of the package, or NULL.
+ * \param package Package structure to store the parsed data in.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool parse_data_package_with_schema(char const * response,
+	MscriptPackageSchema_t const * schema, MscriptDataPackage_t * package)
+{
+	if ((schema == NULL) || (schema->nr_of_sub_packages == 0)
+		|| (schema->nr_of_sub_packages > MSCRIPT_MAX_SUB_PACKAGES_PER_LINE)) {
+		return parse_data_package(response, package);
+	}
+
+	// Skip the first character ('P').
+	char const * p = response + 1;
+	for (size_t i = 0; i < schema->nr_of_sub_packages; ++i) {
+		MscriptSubPackage_t * sub_package = &package->sub_packages[i];
+		unsigned int variable_type = schema->variable_types[i];
+		if ((p[0] < 'a') || (p[0] > 'z') || (p[1] < 'a') || (p[1] > 'z')
+			|| ((unsigned int)MSCRIPT_VARTYPE_STR_TO_INT(p) != variable_type)) {
+			return parse_data_package(response, package);
+		}
+
+		// Decode the 7 hexadecimal digits of the value.
+		long value = 0;
+		for (int j = 2; j < 9; ++j) {
+			int digit = get_hex_digit_value(p[j]);
+			if (digit < 0) {
+				return parse_data_package(response, package);
+			}
+			value = (value << 4) | digit;
+		}
+		double factor = get_si_prefix_value(p[9]);
+		if (factor == 0) {
+			return parse_data_package(response, package);
+		}
+		sub_package->value = (value - MSCRIPT_PARAMETER_OFFSET) * factor;
+		sub_package->variable_type = variable_type;
+		sub_package->metadata.status = -1;
+		sub_package->metadata.range = -1;
+		p += 10;
+
+		if (*p == ',') {
+			parse_metadata(p, sub_package);
+			p = strpbrk(p, ";\n");
+			if (p == NULL) {
+				return parse_data_package(response, package);
+			}
+		}
+		// Sub packages are separated by ';' and the package ends with '\n'.
+		char separator = (i + 1 < schema->nr_of_sub_packages) ? ';' : '\n';
+		if (*p++ != separator) {
+			return parse_data_package(response, package);
+		}
+	}
+	package->nr_of_sub_packages = schema->nr_of_sub_packages;
+	// Clear the unused sub packages, as `parse_data_package()` does.
+	for (size_t i = schema->nr_of_sub_packages; i < MSCRIPT_MAX_SUB_PACKAGES_PER_LINE; ++i) {
+		mscript_clear_sub_package(&package->sub_packages[i]);
+	}
+	return true;
+}
+
+/**
+ * Find the value of a variable type in a parsed data package.
+ *
+ * \param package The data package.
+ * \param variable_type The variable type to look for.
+ * \param p_value[out] The value of the first sub package with that variable type.
+ *
+ * \return `true` if the package contains the variable type, `false` otherwise
+ */
+bool mscript_find_value(MscriptDataPackage_t const * package, unsigned int variable_type,
+	double * p_value)
+{
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		if (package->sub_packages[i].variable_type == variable_type) {
+			*p_value = package->sub_packages[i].value;
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * Get a printable string representation of the variable type.
  *
@@ -510,56 +922,7 @@ bool parse_data_package(char const * response, MscriptDataPackage_t * package)
  */
 char const * mscript_vartype_to_string(unsigned int vartype)
 {
-	switch(vartype)
-	{
-	case MSCRIPT_VARTYPE_UNKNOWN:            return "UNKNOWN VAR TYPE";
-	case MSCRIPT_VARTYPE_POTENTIAL:          return "Potential";
-	case MSCRIPT_VARTYPE_POTENTIAL_CE:       return "Potential_CE_vs_GND";
-	case MSCRIPT_VARTYPE_POTENTIAL_SE:       return "Potential_SE_vs_GND";
-	case MSCRIPT_VARTYPE_POTENTIAL_RE:       return "Potential_RE_vs_GND";
-	case MSCRIPT_VARTYPE_POTENTIAL_WE_VS_CE: return "Potential_WE_vs_CE";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN0:     return "Potential_AIN0";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN1:     return "Potential_AIN1";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN2:     return "Potential_AIN2";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN3:     return "Potential_AIN3";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN4:     return "Potential_AIN4";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN5:     return "Potential_AIN5";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN6:     return "Potential_AIN6";
-	case MSCRIPT_VARTYPE_POTENTIAL_AIN7:     return "Potential_AIN7";
-	case MSCRIPT_VARTYPE_CURRENT:            return "Current";
-	case MSCRIPT_VARTYPE_PHASE:              return "Phase";
-	case MSCRIPT_VARTYPE_IMP:                return "Imp";
-	case MSCRIPT_VARTYPE_ZREAL:              return "Zreal";
-	case MSCRIPT_VARTYPE_ZIMAG:              return "Zimag";
-	case MSCRIPT_VARTYPE_EIS_TDD_E:          return "EIS_TDD_E";
-	case MSCRIPT_VARTYPE_EIS_TDD_I:          return "EIS_TDD_I";
-	case MSCRIPT_VARTYPE_EIS_FS:             return "EIS_FS";
-	case MSCRIPT_VARTYPE_EIS_E_AC:           return "EIS_E_AC";
-	case MSCRIPT_VARTYPE_EIS_E_DC:           return "EIS_E_DC";
-	case MSCRIPT_VARTYPE_EIS_I_AC:           return "EIS_I_AC";
-	case MSCRIPT_VARTYPE_EIS_I_DC:           return "EIS_I_DC";
-	case MSCRIPT_VARTYPE_CELL_SET_POTENTIAL: return "Cell_set_potential";
-	case MSCRIPT_VARTYPE_CELL_SET_CURRENT:   return "Cell_set_current";
-	case MSCRIPT_VARTYPE_CELL_SET_FREQUENCY: return "Cell_set_frequency";
-	case MSCRIPT_VARTYPE_CELL_SET_AMPLITUDE: return "Cell_set_amplitude";
-	case MSCRIPT_VARTYPE_CHANNEL:            return "Channel";
-	case MSCRIPT_VARTYPE_TIME:               return "Time";
-	case MSCRIPT_VARTYPE_PIN_MSK:            return "Pin_msk";
-	case MSCRIPT_VARTYPE_TEMPERATURE:        return "Temperature";
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC1:   return "Current_generic1";
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC2:   return "Current_generic2";
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC3:   return "Current_generic3";
-	case MSCRIPT_VARTYPE_CURRENT_GENERIC4:   return "Current_generic4";
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC1: return "Potential_generic1";
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC2: return "Potential_generic2";
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC3: return "Potential_generic3";
-	case MSCRIPT_VARTYPE_POTENTIAL_GENERIC4: return "Potential_generic4";
-	case MSCRIPT_VARTYPE_MISC_GENERIC1:      return "Misc_generic1";
-	case MSCRIPT_VARTYPE_MISC_GENERIC2:      return "Misc_generic2";
-	case MSCRIPT_VARTYPE_MISC_GENERIC3:      return "Misc_generic3";
-	case MSCRIPT_VARTYPE_MISC_GENERIC4:      return "Misc_generic4";
-	}
-	return "Undefined variable type";
+	return mscript_get_vartype_descriptor(vartype)->name;
 }
 
 /**
@@ -603,129 +966,20 @@ char const * mscript_metadata_status_to_string(unsigned int status_flag)
 char const * mscript_metadata_range_to_string(DeviceType_t device_type, 
 	unsigned int variable_type, int range)
 {
-	switch (device_type)
-	{
-	case EMSTAT_PICO:
-		// Translate current ranges used in EmStat Pico.
-		switch (range)
-		{
-		case   0: return "100 nA";
-		case   1: return   "2 uA";
-		case   2: return   "4 uA";
-		case   3: return   "8 uA";
-		case   4: return  "16 uA";
-		case   5: return  "32 uA";
-		case   6: return  "63 uA";
-		case   7: return "125 uA";
-		case   8: return "250 uA";
-		case   9: return "500 uA";
-		case  10: return   "1 mA";
-		case  11: return   "5 mA";
-		case 128: return "100 nA (High speed)";
-		case 129: return   "1 uA (High speed)";
-		case 130: return   "6 uA (High speed)";
-		case 131: return  "13 uA (High speed)";
-		case 132: return  "25 uA (High speed)";
-		case 133: return  "50 uA (High speed)";
-		case 134: return "100 uA (High speed)";
-		case 135: return "200 uA (High speed)";
-		case 136: return   "1 mA (High speed)";
-		case 137: return   "5 mA (High speed)";
-		}
-		break;
-
-	case EMSTAT4_LR:
-	case EMSTAT4_HR:
-	case MULTI_EMSTAT4_LR:
-	case MULTI_EMSTAT4_HR:
-		// For EmStat4 series instruments, the range can be a current range or
-		// potential range, depending on the variable type.
-		switch (variable_type)
-		{
-		case MSCRIPT_VARTYPE_POTENTIAL:
-		case MSCRIPT_VARTYPE_ZIMAG:
-			// These variable types define a potential range.
-			// Translate potential ranges used in EmStat4 instruments.
-			switch (range)
-			{
-			case 2: return  "50 mV";
-			case 3: return "100 mV";
-			case 4: return "200 mV";
-			case 5: return "500 mV";
-			case 6: return   "1 V";
-			}
-			break;
-		default:
-			// Translate current ranges used in EmStat4 instruments.
-			switch (range)
-			{
-			// (Multi)EmStat4 LR only:
-			case   3: return   "1 nA";
-			case   6: return  "10 nA";
-			// (Multi)EmStat4 LR/HR:
-			case   9: return "100 nA";
-			case  12: return   "1 uA";
-			case  15: return  "10 uA";
-			case  18: return "100 uA";
-			case  21: return   "1 mA";
-			case  24: return  "10 mA";
-			// (Multi)EmStat4 HR only:
-			case  27: return "100 mA";
-			}
-		}
-		break;
-	case NEXUS:
-		switch (variable_type)
-		{
-		case MSCRIPT_VARTYPE_POTENTIAL:
-		case MSCRIPT_VARTYPE_ZIMAG:
-			// These variable types define a potential range.
-			// Translate potential ranges used in Nexus instruments.
-			switch (range)
-			{
-			case 0: return "1 V";
-			case 1: return "100 mV";
-			case 2: return "10 mV";
-			case 3: return "1 mV";
-			}
-			break;
-		default:
-			// Translate current ranges used in Nexus instruments.
-			switch (range)
-			{
-			// Potentiostat ranges
-			case 16: return "100 pA";
-			case 0: return "1 nA";
-			case 1: return "10 nA";
-			case 2: return "100 nA";
-			case 3: return "1 uA";
-			case 4: return "10 uA";
-			case 5: return "100 uA";
-			case 6: return "1 mA (tia)";
-			case 7: return "10 mA (tia)";
-			case 8: return "1 mA";
-			case 9: return "10 mA";
-			case 10: return "100 mA";
-			case 11: return "1 A";
-			// Galvanostat ranges
-			case 32: return "1 nA";
-			case 33: return "10 nA";
-			case 34: return "100 nA";
-			case 35: return "1 uA";
-			case 36: return "10 uA";
-			case 37: return "100 uA";
-			case 38: return "1 mA (tia)";
-			case 39: return "10 mA (tia)";
-			case 40: return "1 mA";
-			case 41: return "10 mA";
-			case 42: return "100 mA";
-			case 43: return "1 A";
-			}
-		}
-
-	case UNKNOWN_DEVICE:
-		break;
+	// The range table used by each type of instrument.
+	static MscriptRangeTable_t const range_tables[] = {
+		[UNKNOWN_DEVICE]   = MSCRIPT_RANGE_TABLE_NONE,
+		[EMSTAT_PICO]      = MSCRIPT_RANGE_TABLE_EMSTAT_PICO,
+		[EMSTAT4_LR]       = MSCRIPT_RANGE_TABLE_EMSTAT4,
+		[EMSTAT4_HR]       = MSCRIPT_RANGE_TABLE_EMSTAT4,
+		[MULTI_EMSTAT4_LR] = MSCRIPT_RANGE_TABLE_EMSTAT4,
+		[MULTI_EMSTAT4_HR] = MSCRIPT_RANGE_TABLE_EMSTAT4,
+		[NEXUS]            = MSCRIPT_RANGE_TABLE_NEXUS,
+	};
+
+	char const * label = NULL;
+	if ((unsigned int)device_type < sizeof(range_tables) / sizeof(range_tables[0])) {
+		label = mscript_get_range_label(range_tables[device_type], variable_type, range);
 	}
-
-	return "Unknown/invalid range value";
+	return (label != NULL) ? label : "Unknown/invalid range value";
 }
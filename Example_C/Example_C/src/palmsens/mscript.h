@@ -53,6 +53,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "mscript_descriptors.h"
 #include "mscript_serial_port.h"
 
 /**
@@ -61,6 +62,12 @@
  */
 #define MSCRIPT_READ_BUFFER_SIZE 1000
 
+/**
+ * Offset value for MethodSCRIPT parameters (see the MethodSCRIPT documentation
+ * paragraph 'Measurement data package variables').
+ */
+#define MSCRIPT_PARAMETER_OFFSET 0x8000000
+
 /* The first character of the response of the device identifies the
  * type of message. The following defines define the most commonly used
  * message types.
@@ -74,9 +81,13 @@
 #define MSCRIPT_REPLY_ID_NSCANS_START     'C'  //!< Start of a scan (when nscans > 1)
 #define MSCRIPT_REPLY_ID_NSCANS_END       '-'  //!< End of a scan (when nscans > 1)
 #define MSCRIPT_REPLY_ID_EXECUTE_SCRIPT   'e'  //!< Start execution of script
+#define MSCRIPT_REPLY_ID_RUN_SCRIPT       'r'  //!< Start execution of loaded script
+#define MSCRIPT_REPLY_ID_LOAD_SCRIPT      'l'  //!< Script loaded (not executed)
+#define MSCRIPT_REPLY_ID_SERIAL_NUMBER    'i'  //!< Reply of serial number command
 #define MSCRIPT_REPLY_ID_END_OF_SCRIPT    '\n' //!< Empty line = end of script execution
 #define MSCRIPT_REPLY_ID_TEXT             'T'  //!< Response of "send_string" command
 #define MSCRIPT_REPLY_ID_ERROR            '!'  //!< An error occurred during script execution
+#define MSCRIPT_REPLY_ID_ABORT            'Z'  //!< Reply of the abort command
 
 /// Convert a MethodSCRIPT variable type to an integer.
 /// For example: "aa" -> 0, "ab" -> 1, "ba" -> 26 and "zz" -> 675.
@@ -190,11 +201,56 @@ typedef struct {
 	MscriptSubPackage_t sub_packages[MSCRIPT_MAX_SUB_PACKAGES_PER_LINE];
 } MscriptDataPackage_t;
 
+/**
+ * Expected layout of the data packages of one measurement loop.
+ *
+ * If the layout is known in advance, `parse_data_package_with_schema()` can
+ * decode the packages without searching for separators and variable types.
+ */
+typedef struct {
+	/** The number of sub packages in each package, or 0 if not known. */
+	size_t nr_of_sub_packages;
+	/** The variable type of each sub package, in the order they are sent. */
+	unsigned int variable_types[MSCRIPT_MAX_SUB_PACKAGES_PER_LINE];
+} MscriptPackageSchema_t;
+
+/**
+ * A MethodSCRIPT that was compiled into the application at build time.
+ *
+ * These structures are generated from the MethodSCRIPT files in the `scripts`
+ * directory by the `mscr2h` tool (see the Makefile).
+ */
+typedef struct {
+	/** Name of the script (the file name without extension). */
+	char const * name;
+	/** The script with comments and indentation removed, ready to be sent. */
+	char const * script;
+	/** Hash of the script file it was generated from (see `mscript_hash_file()`). */
+	uint64_t file_hash;
+	/** Number of measurement loops in the script. */
+	size_t nr_of_loops;
+	/** Package layout of each measurement loop, in the order of the script. */
+	MscriptPackageSchema_t const * loops;
+} MscriptBuiltinScript_t;
+
+/** Result of `mscript_abort_and_sync()`. */
+typedef struct {
+	/** `true` if a script was running and has been aborted. */
+	bool was_running;
+	/** Time from sending the abort command until the device was ready, in ms. */
+	uint32_t recovery_time_ms;
+	/** Number of lines of the aborted script that were discarded. */
+	unsigned int nr_of_discarded_lines;
+} MscriptAbortResult_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // Function prototypes
+uint32_t mscript_get_time_ms(void);
+uint64_t mscript_get_time_us(void);
+void mscript_sleep_ms(uint32_t ms);
 void mscript_flush_communication(SerialPortHandle_t handle);
 bool mscript_serial_port_read_line(SerialPortHandle_t handle, char * buf, size_t buf_size,
 	uint32_t timeout_ms);
@@ -202,7 +258,17 @@ bool mscript_get_firmware_version(SerialPortHandle_t handle, char * buf, size_t
 DeviceType_t mscript_get_device_type(char const * firmware_version);
 char const * mscript_get_device_type_name(DeviceType_t device_type);
 bool mscript_send_file(SerialPortHandle_t handle, char const * path);
+bool mscript_send_script(SerialPortHandle_t handle, char const * script);
+bool mscript_get_serial_number(SerialPortHandle_t handle, char * buf, size_t buf_size);
+bool mscript_store_file_in_flash(SerialPortHandle_t handle, char const * path);
+bool mscript_run_from_flash(SerialPortHandle_t handle);
+bool mscript_abort_and_sync(SerialPortHandle_t handle, uint32_t deadline_ms,
+	MscriptAbortResult_t * p_result);
 bool parse_data_package(char const * response, MscriptDataPackage_t * package);
+bool parse_data_package_with_schema(char const * response,
+	MscriptPackageSchema_t const * schema, MscriptDataPackage_t * package);
+bool mscript_find_value(MscriptDataPackage_t const * package, unsigned int variable_type,
+	double * p_value);
 char const * mscript_vartype_to_string(unsigned int vartype);
 char const * mscript_metadata_status_to_string(unsigned int status_flag);
 char const * mscript_metadata_range_to_string(DeviceType_t device_type,
@@ -0,0 +1,253 @@
+/**
+ * \file
+ * MethodSCRIPT acquisition engine.
+ *
+ * See `mscript_acquisition.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_acquisition.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+/**
+ * Initialize an acquisition.
+ *
+ * The prediction and package layouts are not set; set the `prediction`,
+ * `nr_of_schemas` and `schemas` fields after calling this function to use
+ * them.
+ *
+ * \param acquisition The acquisition to initialize.
+ * \param handle Handle to the serial port of the device.
+ * \param sink The sink that receives the events.
+ */
+void mscript_acquisition_init(MscriptAcquisition_t * acquisition, SerialPortHandle_t handle,
+	MscriptSink_t sink)
+{
+	assert(acquisition != NULL);
+	assert(sink.handle_event != NULL);
+
+	memset(acquisition, 0, sizeof(MscriptAcquisition_t));
+	acquisition->handle = handle;
+	acquisition->read_timeout_ms = MSCRIPT_ACQUISITION_DEFAULT_TIMEOUT;
+	acquisition->parse_packages = true;
+	acquisition->sink = sink;
+}
+
+/**
+ * Read and process the output of the device until the end of the script.
+ *
+ * This function should be called after the script has been sent to the
+ * device. Each response line is passed to the sink as an event. The function
+ * returns when the script has finished, when the device reports an error, when
+ * a communication error or timeout occurs, or when the sink returns `false`.
+ *
+ * The measurement loops are matched with the prediction in the order in which
+ * they run, counted from the start of the script; a script that is restarted
+ * (e.g. by `mscript_session_run()`) is counted from the start again.
+ *
+ * \return `true` if the script finished successfully, `false` otherwise
+ */
+bool mscript_acquisition_run(MscriptAcquisition_t * acquisition)
+{
+	MscriptAcquisitionStats_t * stats = &acquisition->stats;
+	MscriptPrediction_t const * prediction = acquisition->prediction;
+	MscriptPackageSchema_t const * schema = NULL;
+	MscriptLoopPrediction_t const * loop = NULL;
+	// Number of measurement loops since the start of the script.
+	unsigned int nr_of_runs = 0;
+	MscriptDataPackage_t package;
+	MscriptEvent_t event;
+	memset(&event, 0, sizeof(event));
+	uint32_t timeout = acquisition->read_timeout_ms;
+	bool success = false;
+	bool done = false;
+
+	stats->start_time_ms = mscript_get_time_ms();
+	while (!done) {
+		char response[MSCRIPT_READ_BUFFER_SIZE];
+		// Read one complete line from the device.
+		errno = 0;
+		if (!mscript_serial_port_read_line(acquisition->handle, response,
+			MSCRIPT_READ_BUFFER_SIZE, timeout)) {
+			if (errno == ETIMEDOUT) {
+				++stats->nr_of_timeouts;
+				if (acquisition->wait_while_connected
+					&& mscript_serial_port_is_connected(acquisition->handle)) {
+					// The device is only silent, e.g. during a long `wait`.
+					continue;
+				}
+			}
+			++stats->nr_of_communication_errors;
+			break;
+		}
+		event.receive_time_us = mscript_get_time_us();
+		++stats->nr_of_lines;
+		stats->nr_of_bytes += strlen(response);
+
+		event.response = response;
+		event.package = NULL;
+		event.loop = loop;
+
+		// Check the first character to determine the type of response.
+		switch (response[0]) {
+		case MSCRIPT_REPLY_ID_MEAS_LOOP_START:
+			if (strlen(response) != 6) { // "Mxxxx\n"
+				++stats->nr_of_unexpected_lines;
+				event.type = MSCRIPT_EVENT_ERROR;
+				done = true;
+				break;
+			}
+			event.type = MSCRIPT_EVENT_MEAS_LOOP_START;
+			event.meas_loop_index = ++stats->nr_of_meas_loops;
+			event.package_index = 0;
+			++nr_of_runs;
+			loop = (prediction != NULL) ? mscript_prediction_get_run(prediction, nr_of_runs) : NULL;
+			event.loop = loop;
+			schema = NULL;
+			if (loop != NULL) {
+				// The schemas are in the order of the loops of the prediction.
+				size_t index = (size_t)(loop - prediction->loops);
+				if (index < acquisition->nr_of_schemas) {
+					schema = &acquisition->schemas[index];
+				}
+			}
+			// Without a prediction of this loop, the default timeout is used.
+			timeout = (loop != NULL)
+				? mscript_prediction_read_timeout(loop, acquisition->read_timeout_ms)
+				: acquisition->read_timeout_ms;
+			break;
+
+		case MSCRIPT_REPLY_ID_MEAS_LOOP_END:
+			event.type = MSCRIPT_EVENT_MEAS_LOOP_END;
+			loop = NULL;
+			schema = NULL;
+			timeout = acquisition->read_timeout_ms;
+			break;
+
+		case MSCRIPT_REPLY_ID_DATA_PACKAGE:
+			// Parse the data package, i.e. extract the variables from the package.
+			if (acquisition->parse_packages) {
+				if (!parse_data_package_with_schema(response, schema, &package)) {
+					++stats->nr_of_unexpected_lines;
+					event.type = MSCRIPT_EVENT_ERROR;
+					done = true;
+					break;
+				}
+				event.package = &package;
+			}
+			++stats->nr_of_packages;
+			++event.package_index;
+			event.type = MSCRIPT_EVENT_PACKAGE;
+			break;
+
+		case MSCRIPT_REPLY_ID_END_OF_SCRIPT:
+			event.type = MSCRIPT_EVENT_END_OF_SCRIPT;
+			success = true;
+			done = true;
+			break;
+
+		case MSCRIPT_REPLY_ID_EXECUTE_SCRIPT:
+		case MSCRIPT_REPLY_ID_RUN_SCRIPT:
+			event.type = MSCRIPT_EVENT_SCRIPT_START;
+			break;
+
+		case MSCRIPT_REPLY_ID_TEXT:
+			event.type = MSCRIPT_EVENT_TEXT;
+			break;
+
+		case MSCRIPT_REPLY_ID_ERROR:
+			// The error message contains the error code and line number.
+			++stats->nr_of_script_errors;
+			event.type = MSCRIPT_EVENT_ERROR;
+			done = true;
+			break;
+
+		case MSCRIPT_REPLY_ID_NSCANS_START:
+			event.type = MSCRIPT_EVENT_SCAN_START;
+			break;
+
+		case MSCRIPT_REPLY_ID_NSCANS_END:
+			event.type = MSCRIPT_EVENT_SCAN_END;
+			break;
+
+		case MSCRIPT_REPLY_ID_LOOP_START:
+			event.type = MSCRIPT_EVENT_LOOP_START;
+			break;
+
+		case MSCRIPT_REPLY_ID_LOOP_END:
+			event.type = MSCRIPT_EVENT_LOOP_END;
+			break;
+
+		case MSCRIPT_REPLY_ID_ABORT:
+			// The rest of the output of the script follows, as usual.
+			event.type = MSCRIPT_EVENT_ABORTED;
+			break;
+
+		default:
+			++stats->nr_of_unexpected_lines;
+			event.type = MSCRIPT_EVENT_UNKNOWN;
+			break;
+		}
+
+		if (!acquisition->sink.handle_event(acquisition->sink.context, &event)) {
+			DEBUG_PRINTF("Acquisition stopped by sink.\n");
+			success = false;
+			break;
+		}
+
+		if (success && (acquisition->next_script != NULL)) {
+			// Continue with the next script.
+			char const * script = acquisition->next_script;
+			acquisition->next_script = NULL;
+			acquisition->prediction = prediction = NULL;
+			nr_of_runs = 0;
+			acquisition->nr_of_schemas = 0;
+			acquisition->schemas = NULL;
+			schema = NULL;
+			loop = NULL;
+			timeout = acquisition->read_timeout_ms;
+			if (!mscript_send_script(acquisition->handle, script)) {
+				++stats->nr_of_communication_errors;
+				success = false;
+				break;
+			}
+			success = false;
+			done = false;
+		}
+	}
+	stats->duration_ms = mscript_get_time_ms() - stats->start_time_ms;
+	return success;
+}
@@ -0,0 +1,198 @@
+/**
+ * \file
+ * MethodSCRIPT acquisition engine.
+ *
+ * This module reads the output of a running MethodSCRIPT from a device, line
+ * by line, and turns it into events (start of a measurement loop, a parsed
+ * data package, end of the script, etc.) that are passed to a sink. The sink
+ * decides what to do with the data, e.g. print it or store it in a file. The
+ * engine keeps all its state in an `MscriptAcquisition_t` structure, so
+ * several devices can be handled at the same time, each by its own thread.
+ *
+ * If a prediction of the script output is given (see `mscript_analyzer.h`),
+ * the read timeout of each measurement loop is based on the predicted time
+ * between two data packages. If the package layouts of the script are known
+ * (e.g. for a built-in script), they are used to parse the data packages more
+ * efficiently. Each measurement loop that the device starts is matched with
+ * its prediction in the order of execution that the analyzer found; a loop
+ * that can not be matched uses the default read timeout and no layout.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript.h"
+#include "mscript_analyzer.h"
+#include "mscript_serial_port.h"
+
+/// Default read timeout (in ms) of an acquisition.
+#define MSCRIPT_ACQUISITION_DEFAULT_TIMEOUT 5000
+
+/** Type of an acquisition event. */
+typedef enum {
+	MSCRIPT_EVENT_SCRIPT_START,     //!< Script started ("e" or "r" reply)
+	MSCRIPT_EVENT_LOOP_START,       //!< Start of a "loop" command
+	MSCRIPT_EVENT_LOOP_END,         //!< End of a "loop" command
+	MSCRIPT_EVENT_MEAS_LOOP_START,  //!< Start of a measurement loop
+	MSCRIPT_EVENT_MEAS_LOOP_END,    //!< End of a measurement loop
+	MSCRIPT_EVENT_SCAN_START,       //!< Start of a scan (when nscans > 1)
+	MSCRIPT_EVENT_SCAN_END,         //!< End of a scan (when nscans > 1)
+	MSCRIPT_EVENT_PACKAGE,          //!< A data package
+	MSCRIPT_EVENT_TEXT,             //!< Output of a "send_string" command
+	MSCRIPT_EVENT_END_OF_SCRIPT,    //!< The script has finished
+	MSCRIPT_EVENT_ERROR,            //!< An error occurred during script execution
+	MSCRIPT_EVENT_UNKNOWN,          //!< An unexpected response line
+	MSCRIPT_EVENT_GAP,              //!< Data was lost due to a reconnect (see `mscript_session.h`)
+	MSCRIPT_EVENT_ABORTED,          //!< Reply to an abort command ("Z") sent while the script runs
+} MscriptEventType_t;
+
+/** An acquisition event. */
+typedef struct {
+	MscriptEventType_t type;
+	/** The response line that caused the event (including the '\n'). */
+	char const * response;
+	/** Number of the current measurement loop (1 for the first), 0 before the first. */
+	unsigned int meas_loop_index;
+	/** Number of the package in the current measurement loop (1 for the first). */
+	unsigned int package_index;
+	/**
+	 * Prediction of the current measurement loop, or NULL if the acquisition
+	 * has no prediction or it is not known which measurement loop runs.
+	 */
+	MscriptLoopPrediction_t const * loop;
+	/** Time at which the response was received (see `mscript_get_time_us()`). */
+	uint64_t receive_time_us;
+	/** Duration of the interruption in ms (for `MSCRIPT_EVENT_GAP` only). */
+	uint32_t gap_ms;
+	/**
+	 * The parsed package (for `MSCRIPT_EVENT_PACKAGE` only, NULL otherwise).
+	 * Also NULL if `parse_packages` of the acquisition is `false`.
+	 */
+	MscriptDataPackage_t const * package;
+} MscriptEvent_t;
+
+/**
+ * Function that handles an event.
+ *
+ * \param context The context of the sink.
+ * \param event The event.
+ *
+ * \return `true` to continue, or `false` to stop the acquisition with an error.
+ */
+typedef bool (*MscriptEventHandler_t)(void * context, MscriptEvent_t const * event);
+
+/** Receiver of the events of an acquisition. */
+typedef struct {
+	MscriptEventHandler_t handle_event;
+	void * context;
+} MscriptSink_t;
+
+/** Statistics of an acquisition. */
+typedef struct {
+	/** Time at which the acquisition was started (see `mscript_get_time_ms()`). */
+	uint32_t start_time_ms;
+	/** Duration of the acquisition in milliseconds. */
+	uint32_t duration_ms;
+	/** Number of bytes received. */
+	uint64_t nr_of_bytes;
+	/** Number of lines received. */
+	uint64_t nr_of_lines;
+	/** Number of data packages received. */
+	uint64_t nr_of_packages;
+	/** Number of measurement loops started. */
+	unsigned int nr_of_meas_loops;
+	/** Number of errors reported by the device. */
+	unsigned int nr_of_script_errors;
+	/** Number of communication errors or timeouts that ended the acquisition. */
+	unsigned int nr_of_communication_errors;
+	/** Number of read timeouts, including those after which the acquisition kept waiting. */
+	unsigned int nr_of_timeouts;
+	/** Number of unexpected or invalid response lines. */
+	unsigned int nr_of_unexpected_lines;
+} MscriptAcquisitionStats_t;
+
+/** State of an acquisition. */
+typedef struct {
+	/** Handle to the serial port of the device. */
+	SerialPortHandle_t handle;
+	/** Read timeout (in ms) outside measurement loops, or if no prediction is given. */
+	uint32_t read_timeout_ms;
+	/**
+	 * `true` to keep waiting after a read timeout while the serial port is
+	 * still connected (see `mscript_serial_port_is_connected()`), e.g. for a
+	 * script that waits for an external trigger. `false` (default) to end the
+	 * acquisition with a communication error on the first timeout.
+	 */
+	bool wait_while_connected;
+	/** Prediction of the script output, or NULL. */
+	MscriptPrediction_t const * prediction;
+	/** Number of entries in `schemas`. */
+	size_t nr_of_schemas;
+	/**
+	 * Package layout of each measurement loop, in the order of the loops of
+	 * `prediction`, or NULL. Only used together with the prediction.
+	 */
+	MscriptPackageSchema_t const * schemas;
+	/**
+	 * `true` (default) to parse the data packages before passing them to the
+	 * sink, or `false` if the sink parses them itself (e.g. on another thread,
+	 * see `mscript_demux.h`).
+	 */
+	bool parse_packages;
+	/** The sink that receives the events. */
+	MscriptSink_t sink;
+	/**
+	 * Script to run when the current script has finished, or NULL. The sink
+	 * can set this (e.g. after aborting the script, see `mscript_trigger.h`);
+	 * the script is then sent to the device and the acquisition continues
+	 * with its output. Since the output of the next script is different, the
+	 * prediction and package layouts are cleared.
+	 */
+	char const * next_script;
+	/** Statistics, updated while the acquisition runs. */
+	MscriptAcquisitionStats_t stats;
+} MscriptAcquisition_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mscript_acquisition_init(MscriptAcquisition_t * acquisition, SerialPortHandle_t handle,
+	MscriptSink_t sink);
+bool mscript_acquisition_run(MscriptAcquisition_t * acquisition);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,914 @@
+/**
+ * \file
+ * Static MethodSCRIPT analyzer.
+ *
+ * See `mscript_analyzer.h` for a description of this module.
+ *
+ * The analyzer processes the script line by line, in the order of the file.
+ * It keeps track of the (known) values and variable types of all variables
+ * and of the nesting of `loop`, `meas_loop_*` and `if` blocks. Control flow is
+ * not evaluated: both branches of an `if` block are assumed to be executed,
+ * which is sufficient for the scripts this analyzer is intended for.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_analyzer.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+/// Maximum number of variables (including arrays) in a script.
+#define MAX_VARIABLES 64
+
+/// Maximum length of a variable name (excluding '\0').
+#define MAX_NAME_LENGTH 31
+
+/// Maximum nesting depth of `loop`, `meas_loop_*` and `if` blocks.
+#define MAX_NESTING_DEPTH 16
+
+/// Maximum number of tokens on one line.
+#define MAX_TOKENS 16
+
+/// Buffer size for one line of the script file.
+#define LINE_BUF_SIZE 256
+
+/// Maximum number of output variables of a measurement loop.
+#define MAX_OUTPUTS 6
+
+/**
+ * Number of periods of the applied sine wave that is measured for each
+ * frequency of an EIS measurement. Together with `EIS_POINT_OVERHEAD_S`, this
+ * gives a rough estimate of the duration of each frequency.
+ */
+#define EIS_PERIODS_PER_POINT 3
+
+/// Estimated fixed overhead (settling, calculation) per EIS frequency.
+#define EIS_POINT_OVERHEAD_S 0.05
+
+/// Number of bytes of the variable type and value of a variable in a package.
+#define VARIABLE_SIZE 10
+
+/// How the number of points and the duration of a measurement loop are derived.
+typedef enum {
+	MODEL_SWEEP, //!< Arguments: begin, end, step, scan rate
+	MODEL_CV,    //!< Arguments: begin, vertex 1, vertex 2, step, scan rate
+	MODEL_SWV,   //!< Arguments: begin, end, step, frequency
+	MODEL_TIMED, //!< Arguments: interval, run time
+	MODEL_EIS,   //!< Arguments: start frequency, end frequency, number of points
+} Model_t;
+
+/// Description of a measurement loop command.
+typedef struct {
+	char const * name;
+	size_t nr_of_outputs;
+	unsigned int output_types[MAX_OUTPUTS];
+	Model_t model;
+	/// Index of each model argument, counted from the first non-output argument.
+	unsigned int args[5];
+} Technique_t;
+
+static Technique_t const TECHNIQUES[] = {
+	{ "meas_loop_lsv", 2, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_SWEEP, { 0, 1, 2, 3 } },
+	{ "meas_loop_lsp", 2, { MSCRIPT_VARTYPE_POTENTIAL, MSCRIPT_VARTYPE_CELL_SET_CURRENT },
+		MODEL_SWEEP, { 0, 1, 2, 3 } },
+	{ "meas_loop_cv", 2, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_CV, { 0, 1, 2, 3, 4 } },
+	{ "meas_loop_dpv", 2, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_SWEEP, { 0, 1, 2, 5 } },
+	{ "meas_loop_npv", 2, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_SWEEP, { 0, 1, 2, 4 } },
+	{ "meas_loop_swv", 4, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT,
+		MSCRIPT_VARTYPE_CURRENT, MSCRIPT_VARTYPE_CURRENT }, MODEL_SWV, { 0, 1, 2, 4 } },
+	{ "meas_loop_acv", 6, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT,
+		MSCRIPT_VARTYPE_EIS_E_AC, MSCRIPT_VARTYPE_EIS_I_AC, MSCRIPT_VARTYPE_ZREAL,
+		MSCRIPT_VARTYPE_ZIMAG }, MODEL_SWEEP, { 0, 1, 2, 3 } },
+	{ "meas_loop_ca", 2, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_TIMED, { 1, 2 } },
+	{ "meas_loop_ca_alt_mux", 2, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_TIMED, { 1, 2 } },
+	{ "meas_loop_cp", 2, { MSCRIPT_VARTYPE_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_TIMED, { 1, 2 } },
+	{ "meas_loop_pad", 2, { MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, MSCRIPT_VARTYPE_CURRENT },
+		MODEL_TIMED, { 3, 4 } },
+	{ "meas_loop_ocp", 1, { MSCRIPT_VARTYPE_POTENTIAL }, MODEL_TIMED, { 0, 1 } },
+	{ "meas_loop_eis", 3, { MSCRIPT_VARTYPE_CELL_SET_FREQUENCY, MSCRIPT_VARTYPE_ZREAL,
+		MSCRIPT_VARTYPE_ZIMAG }, MODEL_EIS, { 1, 2, 3 } },
+	{ "meas_loop_geis", 3, { MSCRIPT_VARTYPE_CELL_SET_FREQUENCY, MSCRIPT_VARTYPE_ZREAL,
+		MSCRIPT_VARTYPE_ZIMAG }, MODEL_EIS, { 1, 2, 3 } },
+};
+
+/// A variable declared in the script.
+typedef struct {
+	char name[MAX_NAME_LENGTH + 1];
+	double value;
+	bool is_known;
+	unsigned int vartype;
+} Variable_t;
+
+typedef enum {
+	BLOCK_IF,
+	BLOCK_LOOP,
+	BLOCK_MEAS_LOOP,
+} BlockType_t;
+
+/// A `loop`, `meas_loop_*` or `if` block that has not been closed yet.
+typedef struct {
+	BlockType_t type;
+	/// Index of the first loop prediction inside this block.
+	size_t first_prediction;
+	/// Index of the first run (see `run_order` of the prediction) inside this block.
+	size_t first_run;
+	/// Time of measurement loops and waits inside this block (one iteration).
+	double duration_s;
+	/// Variables added to the data package inside this block (one iteration).
+	size_t nr_of_variables;
+	unsigned int variable_types[MSCRIPT_MAX_SUB_PACKAGES_PER_LINE];
+	/// Bytes of the variables (excluding separators) in the package.
+	size_t bytes_per_package;
+	bool is_exact;
+	// Loop condition (BLOCK_LOOP only).
+	Variable_t * counter;
+	char op[3];
+	double start;
+	double limit;
+	double step;
+	bool is_condition_known;
+	bool is_step_known;
+	bool has_breakloop;
+} Block_t;
+
+/// State of the analyzer.
+typedef struct {
+	MscriptPrediction_t * prediction;
+	unsigned int line_number;
+	size_t nr_of_variables;
+	Variable_t variables[MAX_VARIABLES];
+	size_t depth;
+	Block_t blocks[MAX_NESTING_DEPTH];
+	/// `false` once a measurement loop may or may not run; no more runs are stored then.
+	bool is_order_known;
+} Analyzer_t;
+
+static double get_si_prefix_factor(char prefix)
+{
+	switch (prefix) {
+	case 'a': return 1e-18;
+	case 'f': return 1e-15;
+	case 'p': return 1e-12;
+	case 'n': return 1e-9;
+	case 'u': return 1e-6;
+	case 'm': return 1e-3;
+	case 'i': return 1;
+	case 'k': return 1e3;
+	case 'M': return 1e6;
+	case 'G': return 1e9;
+	case 'T': return 1e12;
+	case 'P': return 1e15;
+	case 'E': return 1e18;
+	}
+	return 0;
+}
+
+/**
+ * Split a script line in tokens.
+ *
+ * Comments are removed. Text between parentheses or double quotes is kept
+ * together in one token, e.g. "nscans(3)" or "add_meas(0 bb we1_current)".
+ * The line is modified in place.
+ *
+ * \return The number of tokens.
+ */
+static size_t tokenize(char * line, char * tokens[MAX_TOKENS])
+{
+	size_t nr_of_tokens = 0;
+	int paren_level = 0;
+	bool in_quotes = false;
+	bool in_token = false;
+	for (char * p = line; *p != '\0'; ++p) {
+		if (!in_quotes && (*p == '#')) {
+			*p = '\0';
+			break;
+		}
+		bool is_separator = !in_quotes && (paren_level == 0)
+			&& ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'));
+		if (*p == '"') {
+			in_quotes = !in_quotes;
+		} else if (!in_quotes && (*p == '(')) {
+			++paren_level;
+		} else if (!in_quotes && (*p == ')') && (paren_level > 0)) {
+			--paren_level;
+		}
+		if (is_separator) {
+			*p = '\0';
+			in_token = false;
+		} else if (!in_token) {
+			if (nr_of_tokens == MAX_TOKENS) {
+				break;
+			}
+			tokens[nr_of_tokens++] = p;
+			in_token = true;
+		}
+	}
+	return nr_of_tokens;
+}
+
+/**
+ * Find a variable by name. Array indices ("name[i]") are ignored, so an
+ * element of an array refers to the array itself.
+ */
+static Variable_t * find_variable(Analyzer_t * a, char const * token)
+{
+	size_t len = strcspn(token, "[");
+	for (size_t i = 0; i < a->nr_of_variables; ++i) {
+		if ((strlen(a->variables[i].name) == len) && !strncmp(a->variables[i].name, token, len)) {
+			return &a->variables[i];
+		}
+	}
+	return NULL;
+}
+
+static void declare_variable(Analyzer_t * a, char const * name)
+{
+	if ((a->nr_of_variables >= MAX_VARIABLES) || (strlen(name) > MAX_NAME_LENGTH)) {
+		DEBUG_PRINTF("WARNING: Too many variables, '%s' is ignored by the analyzer.\n", name);
+		return;
+	}
+	Variable_t * var = &a->variables[a->nr_of_variables++];
+	strcpy(var->name, name);
+	var->value = 0;
+	var->is_known = false;
+	var->vartype = MSCRIPT_VARTYPE_UNKNOWN;
+}
+
+/**
+ * Get the value of an argument, which is either a literal (e.g. "-500m",
+ * "10i" or "0x20") or a variable with a known value.
+ *
+ * \return `true` if the value is known, `false` otherwise
+ */
+static bool get_value(Analyzer_t * a, char const * token, double * p_value)
+{
+	char first = token[0];
+	if (((first >= '0') && (first <= '9')) || (first == '-') || (first == '+') || (first == '.')) {
+		char * end;
+		double value;
+		if ((first == '0') && ((token[1] == 'x') || (token[1] == 'X'))) {
+			value = (double)strtol(token + 2, &end, 16);
+		} else {
+			value = strtod(token, &end);
+		}
+		if (end == token) {
+			return false;
+		}
+		if (*end != '\0') {
+			double factor = get_si_prefix_factor(*end);
+			if ((factor == 0) || (end[1] != '\0')) {
+				return false;
+			}
+			value *= factor;
+		}
+		*p_value = value;
+		return true;
+	}
+
+	Variable_t * var = find_variable(a, token);
+	if ((var == NULL) || !var->is_known) {
+		return false;
+	}
+	*p_value = var->value;
+	return true;
+}
+
+/// Get the innermost block that is not an `if` block, or NULL at top level.
+static Block_t * innermost_loop(Analyzer_t * a)
+{
+	for (size_t i = a->depth; i > 0; --i) {
+		if (a->blocks[i - 1].type != BLOCK_IF) {
+			return &a->blocks[i - 1];
+		}
+	}
+	return NULL;
+}
+
+static bool is_inside_meas_loop(Analyzer_t * a)
+{
+	for (size_t i = 0; i < a->depth; ++i) {
+		if (a->blocks[i].type == BLOCK_MEAS_LOOP) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Add the time of a measurement loop or wait command to the enclosing block.
+static void add_duration(Analyzer_t * a, double seconds)
+{
+	Block_t * block = innermost_loop(a);
+	if (block == NULL) {
+		a->prediction->total_duration_s += seconds;
+	} else if (block->type == BLOCK_LOOP) {
+		block->duration_s += seconds;
+	}
+	// Waits inside measurement loops are part of the measurement loop timing.
+}
+
+static Block_t * push_block(Analyzer_t * a, BlockType_t type)
+{
+	if (a->depth >= MAX_NESTING_DEPTH) {
+		DEBUG_PRINTF("ERROR: Line %u: blocks are nested too deep.\n", a->line_number);
+		return NULL;
+	}
+	Block_t * block = &a->blocks[a->depth++];
+	memset(block, 0, sizeof(*block));
+	block->type = type;
+	block->first_prediction = a->prediction->nr_of_loops;
+	block->first_run = a->prediction->nr_of_runs;
+	block->is_exact = true;
+	return block;
+}
+
+/// Add variables to the package of a block (`count` times the same list).
+static void add_package_variables(Block_t * block, size_t nr_of_variables,
+	unsigned int const * variable_types, size_t bytes, size_t count)
+{
+	for (size_t n = 0; n < count; ++n) {
+		for (size_t i = 0; i < nr_of_variables; ++i) {
+			if (block->nr_of_variables < MSCRIPT_MAX_SUB_PACKAGES_PER_LINE) {
+				block->variable_types[block->nr_of_variables] = variable_types[i];
+			}
+			++block->nr_of_variables;
+		}
+		block->bytes_per_package += bytes;
+	}
+}
+
+/// Get the expected number of metadata bytes sent with a variable type.
+static size_t get_metadata_size(unsigned int vartype)
+{
+	switch (vartype) {
+	case MSCRIPT_VARTYPE_CURRENT:
+	case MSCRIPT_VARTYPE_POTENTIAL:
+	case MSCRIPT_VARTYPE_ZREAL:
+	case MSCRIPT_VARTYPE_ZIMAG:
+		return 7; // ",1X" (status) + ",2XX" (range)
+	}
+	return 0;
+}
+
+static void handle_pck_add(Analyzer_t * a, char const * name)
+{
+	if (!is_inside_meas_loop(a)) {
+		// Packages outside measurement loops are not predicted.
+		return;
+	}
+	Variable_t * var = find_variable(a, name);
+	unsigned int vartype = (var != NULL) ? var->vartype : MSCRIPT_VARTYPE_UNKNOWN;
+	add_package_variables(innermost_loop(a), 1, &vartype,
+		VARIABLE_SIZE + get_metadata_size(vartype), 1);
+}
+
+/// Calculate the number of points and timing of a measurement loop.
+static void predict_loop(Analyzer_t * a, Technique_t const * technique, char * tokens[],
+	size_t nr_of_tokens, MscriptLoopPrediction_t * p)
+{
+	double v[5] = { 0 };
+	size_t nr_of_args = (technique->model == MODEL_CV) ? 5
+		: (technique->model == MODEL_TIMED) ? 2 : (technique->model == MODEL_EIS) ? 3 : 4;
+	for (size_t i = 0; i < nr_of_args; ++i) {
+		size_t index = 1 + technique->nr_of_outputs + technique->args[i];
+		if ((index >= nr_of_tokens) || !get_value(a, tokens[index], &v[i])) {
+			DEBUG_PRINTF("WARNING: Line %u: argument %u of %s is unknown.\n",
+				a->line_number, technique->args[i] + 1, technique->name);
+			p->is_exact = false;
+			return;
+		}
+	}
+
+	double points;
+	double interval;
+	switch (technique->model) {
+	case MODEL_SWEEP:
+		points = floor(fabs(v[1] - v[0]) / v[2] + 0.5) + 1;
+		interval = v[2] / v[3];
+		p->duration_s = fabs(v[1] - v[0]) / v[3];
+		p->min_point_interval_s = p->max_point_interval_s = interval;
+		break;
+	case MODEL_CV: {
+		double nscans = 1;
+		for (size_t i = 1 + technique->nr_of_outputs + 5; i < nr_of_tokens; ++i) {
+			if (!strncmp(tokens[i], "nscans(", 7)) {
+				nscans = atof(tokens[i] + 7);
+			}
+		}
+		double range = fabs(v[1] - v[0]) + fabs(v[2] - v[1]) + fabs(v[0] - v[2]);
+		points = nscans * floor(range / v[3] + 0.5) + 1;
+		interval = v[3] / v[4];
+		p->duration_s = nscans * range / v[4];
+		p->min_point_interval_s = p->max_point_interval_s = interval;
+		break;
+	}
+	case MODEL_SWV:
+		points = floor(fabs(v[1] - v[0]) / v[2] + 0.5) + 1;
+		interval = 1 / v[3];
+		p->duration_s = points * interval;
+		p->min_point_interval_s = p->max_point_interval_s = interval;
+		break;
+	case MODEL_TIMED:
+		points = floor(v[1] / v[0] + 0.5);
+		p->duration_s = v[1];
+		p->min_point_interval_s = p->max_point_interval_s = v[0];
+		break;
+	case MODEL_EIS:
+		// The frequencies are distributed logarithmically.
+		points = floor(v[2] + 0.5);
+		p->duration_s = 0;
+		p->min_point_interval_s = INFINITY;
+		p->max_point_interval_s = 0;
+		for (unsigned int i = 0; i < (unsigned int)points; ++i) {
+			double f = (points > 1) ? v[0] * pow(v[1] / v[0], i / (points - 1)) : v[0];
+			double t = EIS_PERIODS_PER_POINT / f + EIS_POINT_OVERHEAD_S;
+			p->duration_s += t;
+			p->min_point_interval_s = fmin(p->min_point_interval_s, t);
+			p->max_point_interval_s = fmax(p->max_point_interval_s, t);
+		}
+		break;
+	}
+	if (!isfinite(points) || (points < 0) || !isfinite(p->duration_s)) {
+		DEBUG_PRINTF("WARNING: Line %u: invalid arguments for %s.\n", a->line_number,
+			technique->name);
+		p->is_exact = false;
+		p->duration_s = 0;
+		return;
+	}
+	p->nr_of_points = (size_t)points;
+}
+
+/// Add a run of a measurement loop to the execution order of the script.
+static void add_run(Analyzer_t * a, size_t loop_index)
+{
+	MscriptPrediction_t * prediction = a->prediction;
+	// A measurement loop inside an `if` block may or may not run.
+	for (size_t i = 0; i < a->depth; ++i) {
+		if (a->blocks[i].type == BLOCK_IF) {
+			a->is_order_known = false;
+		}
+	}
+	if (prediction->nr_of_runs >= MSCRIPT_ANALYZER_MAX_RUNS) {
+		a->is_order_known = false;
+	}
+	if (a->is_order_known) {
+		prediction->run_order[prediction->nr_of_runs++] = (uint8_t)loop_index;
+	}
+}
+
+/**
+ * Update the execution order at the end of a `loop` block: the runs of the
+ * first iteration are repeated for the other iterations.
+ *
+ * \param iterations The number of iterations, or a negative value if unknown.
+ */
+static void repeat_runs(Analyzer_t * a, Block_t const * block, double iterations)
+{
+	MscriptPrediction_t * prediction = a->prediction;
+	if (block->first_run >= prediction->nr_of_runs) {
+		return;
+	}
+	if ((iterations < 0) || block->has_breakloop) {
+		// The runs of this block may or may not happen.
+		prediction->nr_of_runs = block->first_run;
+		a->is_order_known = false;
+		return;
+	}
+	if (iterations == 0) {
+		prediction->nr_of_runs = block->first_run;
+		return;
+	}
+	// Without a complete first iteration, only its first runs are known.
+	size_t n = prediction->nr_of_runs - block->first_run;
+	for (double i = 1; (i < iterations) && a->is_order_known; ++i) {
+		if (prediction->nr_of_runs + n > MSCRIPT_ANALYZER_MAX_RUNS) {
+			a->is_order_known = false;
+			break;
+		}
+		memcpy(&prediction->run_order[prediction->nr_of_runs],
+			&prediction->run_order[block->first_run], n);
+		prediction->nr_of_runs += n;
+	}
+}
+
+static void handle_meas_loop(Analyzer_t * a, char * tokens[], size_t nr_of_tokens)
+{
+	MscriptPrediction_t * prediction = a->prediction;
+	Block_t * block = push_block(a, BLOCK_MEAS_LOOP);
+	if ((block == NULL) || (prediction->nr_of_loops >= MSCRIPT_ANALYZER_MAX_LOOPS)) {
+		DEBUG_PRINTF("WARNING: Line %u: measurement loop is not analyzed.\n", a->line_number);
+		a->is_order_known = false;
+		return;
+	}
+	add_run(a, prediction->nr_of_loops);
+
+	MscriptLoopPrediction_t * p = &prediction->loops[prediction->nr_of_loops++];
+	memset(p, 0, sizeof(*p));
+	strncpy(p->technique, tokens[0], MSCRIPT_ANALYZER_MAX_TECHNIQUE_LENGTH);
+	p->line_number = a->line_number;
+	p->nr_of_executions = 1;
+	p->is_exact = true;
+
+	Technique_t const * technique = NULL;
+	for (size_t i = 0; i < sizeof(TECHNIQUES) / sizeof(TECHNIQUES[0]); ++i) {
+		if (!strcmp(tokens[0], TECHNIQUES[i].name)) {
+			technique = &TECHNIQUES[i];
+			break;
+		}
+	}
+	if (technique == NULL) {
+		DEBUG_PRINTF("WARNING: Line %u: unknown measurement loop %s.\n", a->line_number,
+			tokens[0]);
+		p->is_exact = false;
+		return;
+	}
+
+	// The first arguments are the output variables of the measurement loop.
+	for (size_t i = 0; (i < technique->nr_of_outputs) && (1 + i < nr_of_tokens); ++i) {
+		Variable_t * var = find_variable(a, tokens[1 + i]);
+		if (var != NULL) {
+			var->vartype = technique->output_types[i];
+			var->is_known = false;
+		}
+	}
+
+	predict_loop(a, technique, tokens, nr_of_tokens, p);
+}
+
+/// Calculate the number of iterations of a `loop` block.
+static double get_iterations(Block_t const * block)
+{
+	if (!block->is_condition_known || !block->is_step_known || (block->step == 0)) {
+		return -1;
+	}
+	double n = (block->limit - block->start) / block->step;
+	if (!strcmp(block->op, "<") || !strcmp(block->op, ">") || !strcmp(block->op, "!=")) {
+		n = ceil(n - 1e-9);
+	} else if (!strcmp(block->op, "<=") || !strcmp(block->op, ">=")) {
+		n = floor(n + 1e-9) + 1;
+	} else {
+		return -1;
+	}
+	return (n > 0) ? n : 0;
+}
+
+static void handle_endloop(Analyzer_t * a)
+{
+	// Close `if` blocks that were not closed properly.
+	while ((a->depth > 0) && (a->blocks[a->depth - 1].type == BLOCK_IF)) {
+		--a->depth;
+	}
+	if (a->depth == 0) {
+		DEBUG_PRINTF("WARNING: Line %u: endloop without loop.\n", a->line_number);
+		return;
+	}
+	Block_t block = a->blocks[--a->depth];
+	MscriptPrediction_t * prediction = a->prediction;
+
+	if (block.type == BLOCK_MEAS_LOOP) {
+		if (block.first_prediction >= prediction->nr_of_loops) {
+			return; // measurement loop was not analyzed
+		}
+		MscriptLoopPrediction_t * p = &prediction->loops[block.first_prediction];
+		p->nr_of_variables = block.nr_of_variables;
+		memcpy(p->variable_types, block.variable_types, sizeof(p->variable_types));
+		if (block.nr_of_variables > 0) {
+			// Add the 'P', the ';' separators and the '\n'.
+			p->bytes_per_package = block.bytes_per_package + block.nr_of_variables + 1;
+		}
+		p->is_exact = p->is_exact && block.is_exact;
+		if (p->min_point_interval_s > 0) {
+			p->peak_line_rate = p->bytes_per_package / p->min_point_interval_s;
+		}
+		add_duration(a, p->duration_s);
+		return;
+	}
+
+	// Plain loop: multiply everything inside by the number of iterations.
+	double iterations = get_iterations(&block);
+	bool is_exact = block.is_exact;
+	repeat_runs(a, &block, iterations);
+	if (iterations < 0) {
+		DEBUG_PRINTF("WARNING: Line %u: number of loop iterations is unknown.\n",
+			a->line_number);
+		iterations = 1;
+		is_exact = false;
+	}
+	for (size_t i = block.first_prediction; i < prediction->nr_of_loops; ++i) {
+		prediction->loops[i].nr_of_executions *= (unsigned int)iterations;
+		prediction->loops[i].is_exact = prediction->loops[i].is_exact && is_exact;
+	}
+	add_duration(a, block.duration_s * iterations);
+	if (block.counter != NULL) {
+		block.counter->value = block.start + iterations * block.step;
+		block.counter->is_known = is_exact;
+	}
+	// Variables added inside a loop inside a measurement loop belong to the
+	// package of the enclosing block.
+	Block_t * parent = innermost_loop(a);
+	if ((parent != NULL) && (block.nr_of_variables > 0)) {
+		add_package_variables(parent, block.nr_of_variables, block.variable_types,
+			block.bytes_per_package, (size_t)iterations);
+		parent->is_exact = parent->is_exact && is_exact;
+	}
+}
+
+static void handle_loop(Analyzer_t * a, char * tokens[], size_t nr_of_tokens)
+{
+	Block_t * block = push_block(a, BLOCK_LOOP);
+	if (block == NULL) {
+		return;
+	}
+	if (nr_of_tokens != 4) {
+		return;
+	}
+	block->counter = find_variable(a, tokens[1]);
+	strncpy(block->op, tokens[2], sizeof(block->op) - 1);
+	block->is_condition_known = (block->counter != NULL) && block->counter->is_known
+		&& get_value(a, tokens[3], &block->limit);
+	if (block->counter != NULL) {
+		block->start = block->counter->value;
+	}
+}
+
+/// Handle commands that modify a variable (store_var, add_var, ...).
+static void handle_variable_command(Analyzer_t * a, char * tokens[], size_t nr_of_tokens)
+{
+	char const * cmd = tokens[0];
+	Variable_t * var = find_variable(a, tokens[1]);
+	if (var == NULL) {
+		return;
+	}
+	bool is_array_element = strchr(tokens[1], '[') != NULL;
+	double value;
+	bool is_value_known = (nr_of_tokens > 2) && get_value(a, tokens[2], &value);
+
+	if (!strcmp(cmd, "store_var")) {
+		var->value = value;
+		var->is_known = is_value_known && !is_array_element;
+		if (nr_of_tokens > 3) {
+			var->vartype = MSCRIPT_VARTYPE_STR_TO_INT(tokens[3]);
+		}
+		return;
+	}
+	if (!strcmp(cmd, "add_var")) {
+		// An increment of a loop counter determines the loop step size.
+		for (size_t i = a->depth; i > 0; --i) {
+			Block_t * block = &a->blocks[i - 1];
+			if ((block->type == BLOCK_LOOP) && (block->counter == var)) {
+				block->step = value;
+				block->is_step_known = is_value_known;
+				return;
+			}
+		}
+	}
+	if (innermost_loop(a) != NULL) {
+		// The value changes in every iteration, so it is no longer known.
+		var->is_known = false;
+		return;
+	}
+	if (!var->is_known || !is_value_known) {
+		var->is_known = false;
+	} else if (!strcmp(cmd, "add_var")) {
+		var->value += value;
+	} else if (!strcmp(cmd, "sub_var")) {
+		var->value -= value;
+	} else if (!strcmp(cmd, "mul_var")) {
+		var->value *= value;
+	} else if (!strcmp(cmd, "div_var")) {
+		var->value /= value;
+	}
+}
+
+static void analyze_line(Analyzer_t * a, char * line)
+{
+	char * tokens[MAX_TOKENS];
+	size_t nr_of_tokens = tokenize(line, tokens);
+	if (nr_of_tokens == 0) {
+		return;
+	}
+	char const * cmd = tokens[0];
+
+	if (!strncmp(cmd, "meas_loop_", 10)) {
+		handle_meas_loop(a, tokens, nr_of_tokens);
+	} else if (!strcmp(cmd, "loop")) {
+		handle_loop(a, tokens, nr_of_tokens);
+	} else if (!strcmp(cmd, "endloop")) {
+		handle_endloop(a);
+	} else if (!strcmp(cmd, "if")) {
+		push_block(a, BLOCK_IF);
+	} else if (!strcmp(cmd, "endif")) {
+		if ((a->depth > 0) && (a->blocks[a->depth - 1].type == BLOCK_IF)) {
+			--a->depth;
+		}
+	} else if (!strcmp(cmd, "breakloop")) {
+		// The loop may end earlier than predicted.
+		Block_t * block = innermost_loop(a);
+		if (block != NULL) {
+			block->is_exact = false;
+			block->has_breakloop = true;
+			if ((block->type == BLOCK_MEAS_LOOP)
+				&& (block->first_prediction < a->prediction->nr_of_loops)) {
+				a->prediction->loops[block->first_prediction].is_exact = false;
+			}
+		}
+	} else if (nr_of_tokens < 2) {
+		return;
+	} else if (!strcmp(cmd, "var") || !strcmp(cmd, "array")) {
+		declare_variable(a, tokens[1]);
+	} else if (!strcmp(cmd, "pck_add")) {
+		handle_pck_add(a, tokens[1]);
+	} else if (!strcmp(cmd, "wait")) {
+		double seconds;
+		if (get_value(a, tokens[1], &seconds)) {
+			add_duration(a, seconds);
+		}
+	} else if (!strcmp(cmd, "timer_get")) {
+		Variable_t * var = find_variable(a, tokens[1]);
+		if (var != NULL) {
+			var->vartype = MSCRIPT_VARTYPE_TIME;
+			var->is_known = false;
+		}
+	} else if (!strcmp(cmd, "alter_vartype") && (nr_of_tokens > 2)) {
+		Variable_t * var = find_variable(a, tokens[1]);
+		if (var != NULL) {
+			var->vartype = MSCRIPT_VARTYPE_STR_TO_INT(tokens[2]);
+		}
+	} else if (!strcmp(cmd, "copy_var") && (nr_of_tokens > 2)) {
+		Variable_t * src = find_variable(a, tokens[1]);
+		Variable_t * dst = find_variable(a, tokens[2]);
+		if ((src != NULL) && (dst != NULL)) {
+			dst->vartype = src->vartype;
+			dst->value = src->value;
+			dst->is_known = src->is_known && (innermost_loop(a) == NULL);
+		}
+	} else if (!strcmp(cmd, "store_var") || !strcmp(cmd, "add_var") || !strcmp(cmd, "sub_var")
+		|| !strcmp(cmd, "mul_var") || !strcmp(cmd, "div_var")) {
+		handle_variable_command(a, tokens, nr_of_tokens);
+	} else if ((strstr(cmd, "_var") != NULL) || !strncmp(cmd, "get_", 4)
+		|| !strcmp(cmd, "float_to_int") || !strcmp(cmd, "int_to_float")
+		|| !strcmp(cmd, "meas") || !strcmp(cmd, "mean") || !strcmp(cmd, "mux_get_channel_count")) {
+		// Other commands that modify their first argument in a way that is
+		// not predicted by the analyzer.
+		Variable_t * var = find_variable(a, tokens[1]);
+		if (var != NULL) {
+			var->is_known = false;
+		}
+	}
+}
+
+/**
+ * Analyze a MethodSCRIPT file and predict its output.
+ *
+ * \param path Path to the MethodSCRIPT file.
+ * \param prediction[out] The prediction for the script.
+ *
+ * \return `true` on success, `false` if the file could not be read
+ */
+bool mscript_analyze_file(char const * path, MscriptPrediction_t * prediction)
+{
+	assert(path != NULL);
+	assert(prediction != NULL);
+
+	memset(prediction, 0, sizeof(*prediction));
+
+	FILE * fp = fopen(path, "r");
+	if (fp == NULL) {
+		DEBUG_PRINTF("ERROR: Could not open script file %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	Analyzer_t * a = calloc(1, sizeof(Analyzer_t));
+	if (a == NULL) {
+		fclose(fp);
+		return false;
+	}
+	a->prediction = prediction;
+	a->is_order_known = true;
+
+	char line[LINE_BUF_SIZE];
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		++a->line_number;
+		if ((strchr(line, '\n') == NULL) && !feof(fp)) {
+			// Analyze the start of a line that is too long (e.g. because of a
+			// long comment), and skip the rest instead of taking it as a new line.
+			DEBUG_PRINTF("WARNING: Line %u: line is too long and is truncated.\n",
+				a->line_number);
+			int c;
+			do {
+				c = fgetc(fp);
+			} while ((c != '\n') && (c != EOF));
+		}
+		analyze_line(a, line);
+	}
+	bool success = !ferror(fp);
+	fclose(fp);
+	free(a);
+
+	prediction->is_exact = true;
+	for (size_t i = 0; i < prediction->nr_of_loops; ++i) {
+		MscriptLoopPrediction_t const * p = &prediction->loops[i];
+		prediction->total_nr_of_packages += p->nr_of_points * p->nr_of_executions;
+		prediction->is_exact = prediction->is_exact && p->is_exact;
+	}
+	return success;
+}
+
+/**
+ * Get the prediction of a run of a measurement loop.
+ *
+ * A measurement loop that is executed several times (e.g. inside a `loop`)
+ * has one prediction, but several runs. The runs are numbered in the order in
+ * which the device starts them.
+ *
+ * \param prediction The prediction of the script.
+ * \param run_index Number of the run since the start of the script (1 for the first).
+ *
+ * \return The prediction of the measurement loop, or NULL if it is not known
+ *         which measurement loop is executed.
+ */
+MscriptLoopPrediction_t const * mscript_prediction_get_run(MscriptPrediction_t const * prediction,
+	unsigned int run_index)
+{
+	assert(prediction != NULL);
+
+	if ((run_index == 0) || (run_index > prediction->nr_of_runs)) {
+		return NULL;
+	}
+	return &prediction->loops[prediction->run_order[run_index - 1]];
+}
+
+/**
+ * Get the maximum number of bytes per second a serial link can carry.
+ *
+ * MethodSCRIPT devices use 8 data bits, no parity and 1 stop bit, so each byte
+ * takes 10 bits on the line.
+ */
+double mscript_link_capacity(int baudrate)
+{
+	return baudrate / 10.0;
+}
+
+/**
+ * Get a suitable read timeout for the lines of a measurement loop.
+ *
+ * The timeout is the given minimum timeout plus twice the longest expected
+ * time between two data packages, so slow measurements (e.g. low frequency
+ * EIS or CA with long intervals) do not cause a false timeout.
+ *
+ * \param loop The prediction of the measurement loop.
+ * \param min_timeout_ms The minimum timeout in milliseconds.
+ *
+ * \return The read timeout in milliseconds.
+ */
+uint32_t mscript_prediction_read_timeout(MscriptLoopPrediction_t const * loop,
+	uint32_t min_timeout_ms)
+{
+	double timeout_ms = min_timeout_ms + 2000.0 * loop->max_point_interval_s;
+	if (timeout_ms >= UINT32_MAX) {
+		return UINT32_MAX;
+	}
+	return (uint32_t)timeout_ms;
+}
@@ -0,0 +1,139 @@
+/**
+ * \file
+ * Static MethodSCRIPT analyzer.
+ *
+ * This module reads a MethodSCRIPT file (without sending it to a device) and
+ * predicts, for each measurement loop in the script, how many data packages
+ * it produces, what these packages contain, how long the loop takes and how
+ * much data per second is sent to the host. The prediction can be used to
+ * size buffers, to choose read timeouts and to check in advance whether the
+ * communication link is fast enough.
+ *
+ * The analysis is based on the arguments of the `meas_loop_*` commands, the
+ * `pck_add` commands within the measurement loops and the iteration counts of
+ * enclosing `loop` commands. Arguments can be literal values or variables that
+ * were set using `store_var`. Values that can only be known while the script
+ * runs (e.g. results of calculations or measurements) cannot be predicted. If
+ * such a value is needed, or if the loop contains a `breakloop` command, the
+ * prediction is marked as inexact and should be treated as an estimate (or
+ * upper limit).
+ *
+ * The prediction also contains the order in which the measurement loops are
+ * executed, so the prediction of each measurement loop that the device starts
+ * can be found (see `mscript_prediction_get_run()`). The order is only known
+ * up to the first measurement loop that may or may not run, e.g. because it
+ * is inside an `if` block or inside a `loop` with an unknown number of
+ * iterations.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript.h"
+
+/// Maximum number of measurement loops in one script that can be analyzed.
+#define MSCRIPT_ANALYZER_MAX_LOOPS 16
+
+/// Maximum length of a technique name (excluding '\0').
+#define MSCRIPT_ANALYZER_MAX_TECHNIQUE_LENGTH 23
+
+/// Maximum number of measurement loop runs of which the order is stored.
+#define MSCRIPT_ANALYZER_MAX_RUNS 1024
+
+/** Prediction of the output of one measurement loop. */
+typedef struct {
+	/** The measurement loop command, e.g. "meas_loop_lsv". */
+	char technique[MSCRIPT_ANALYZER_MAX_TECHNIQUE_LENGTH + 1];
+	/** Line number of the measurement loop command in the script file. */
+	unsigned int line_number;
+	/** Number of data packages (points) each time the loop is executed. */
+	size_t nr_of_points;
+	/** Number of times the loop is executed (due to enclosing loops). */
+	unsigned int nr_of_executions;
+	/** Number of variables in each data package. */
+	size_t nr_of_variables;
+	/**
+	 * Variable type of each variable in the data package, or
+	 * `MSCRIPT_VARTYPE_UNKNOWN` if it could not be determined. Only the first
+	 * `MSCRIPT_MAX_SUB_PACKAGES_PER_LINE` variables are stored.
+	 */
+	unsigned int variable_types[MSCRIPT_MAX_SUB_PACKAGES_PER_LINE];
+	/** Expected length of one data package line in bytes (including '\n'). */
+	size_t bytes_per_package;
+	/** Duration of one execution of the loop in seconds. */
+	double duration_s;
+	/** Shortest expected time between two data packages in seconds. */
+	double min_point_interval_s;
+	/** Longest expected time between two data packages in seconds. */
+	double max_point_interval_s;
+	/** Highest expected data rate in bytes per second. */
+	double peak_line_rate;
+	/** `true` if all values needed for the prediction were known. */
+	bool is_exact;
+} MscriptLoopPrediction_t;
+
+/** Prediction of the output of a complete script. */
+typedef struct {
+	/** Number of valid entries in `loops`, in the order of the script. */
+	size_t nr_of_loops;
+	MscriptLoopPrediction_t loops[MSCRIPT_ANALYZER_MAX_LOOPS];
+	/** Number of valid entries in `run_order`. */
+	size_t nr_of_runs;
+	/**
+	 * Index in `loops` of each measurement loop that is started, in the order
+	 * of execution. Only the runs that are known in advance are stored.
+	 */
+	uint8_t run_order[MSCRIPT_ANALYZER_MAX_RUNS];
+	/** Total number of data packages sent by all measurement loops. */
+	size_t total_nr_of_packages;
+	/** Total duration of all measurement loops and `wait` commands. */
+	double total_duration_s;
+	/** `true` if all loop predictions are exact. */
+	bool is_exact;
+} MscriptPrediction_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool mscript_analyze_file(char const * path, MscriptPrediction_t * prediction);
+MscriptLoopPrediction_t const * mscript_prediction_get_run(MscriptPrediction_t const * prediction,
+	unsigned int run_index);
+double mscript_link_capacity(int baudrate);
+uint32_t mscript_prediction_read_timeout(MscriptLoopPrediction_t const * loop,
+	uint32_t min_timeout_ms);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
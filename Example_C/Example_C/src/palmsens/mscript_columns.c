@@ -0,0 +1,505 @@
+/**
+ * \file
+ * Columnar storage of measurement data, split per channel.
+ *
+ * See `mscript_columns.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_columns.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+/// Number of rows allocated for a new channel.
+#define INITIAL_ROW_CAPACITY 256
+
+/// Number of index entries allocated for a new channel.
+#define INITIAL_LOOP_CAPACITY 16
+
+struct MscriptColumnStore {
+	/** The channels, or NULL for channels without data. */
+	MscriptChannelColumns_t * channels[MSCRIPT_COLUMN_STORE_MAX_CHANNELS];
+};
+
+/**
+ * Get the channel number of a data package.
+ *
+ * \param package The data package.
+ * \param p_channel[out] The channel number.
+ *
+ * \return `true` if the package contains a valid channel number, `false` if
+ *         it has no channel variable or the value is not a valid channel number
+ */
+bool mscript_get_package_channel(MscriptDataPackage_t const * package, unsigned int * p_channel)
+{
+	double value;
+	// Also rejects NaN.
+	if (!mscript_find_value(package, MSCRIPT_VARTYPE_CHANNEL, &value)
+		|| !((value >= 0) && (value < MSCRIPT_COLUMN_STORE_MAX_CHANNELS))
+		|| (value != floor(value))) {
+		return false;
+	}
+	*p_channel = (unsigned int)value;
+	return true;
+}
+
+/**
+ * Check if a data package contains a channel variable.
+ */
+static bool has_channel_variable(MscriptDataPackage_t const * package)
+{
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		if (package->sub_packages[i].variable_type == MSCRIPT_VARTYPE_CHANNEL) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Free the memory of a channel.
+ */
+static void free_channel(MscriptChannelColumns_t * channel)
+{
+	for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+		free(channel->columns[i].values);
+		free(channel->columns[i].status);
+		free(channel->columns[i].range);
+		mscript_minmax_summary_free(&channel->columns[i].summary);
+	}
+	free(channel->loops);
+	free(channel);
+}
+
+/**
+ * Resize the arrays of a column.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool resize_column(MscriptColumn_t * column, size_t capacity)
+{
+	double * values = realloc(column->values, capacity * sizeof(double));
+	if (values == NULL) {
+		return false;
+	}
+	column->values = values;
+	uint8_t * status = realloc(column->status, capacity);
+	if (status == NULL) {
+		return false;
+	}
+	column->status = status;
+	uint8_t * range = realloc(column->range, capacity);
+	if (range == NULL) {
+		return false;
+	}
+	column->range = range;
+	return true;
+}
+
+/**
+ * Make sure all columns of a channel have room for one more row.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool reserve_row(MscriptChannelColumns_t * channel)
+{
+	if (channel->nr_of_rows < channel->row_capacity) {
+		return true;
+	}
+	size_t capacity = 2 * channel->row_capacity;
+	for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+		if (!resize_column(&channel->columns[i], capacity)) {
+			return false;
+		}
+	}
+	channel->row_capacity = capacity;
+	return true;
+}
+
+/**
+ * Find a column of a channel, or add it if it does not exist yet.
+ *
+ * The rows that were added before the column existed are set to NaN.
+ *
+ * \return The column, or NULL if there are too many columns or on failure.
+ */
+static MscriptColumn_t * get_column(MscriptChannelColumns_t * channel,
+	unsigned int variable_type, unsigned int occurrence)
+{
+	for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+		MscriptColumn_t * column = &channel->columns[i];
+		if ((column->variable_type == variable_type) && (column->occurrence == occurrence)) {
+			return column;
+		}
+	}
+	if (channel->nr_of_columns == MSCRIPT_COLUMN_STORE_MAX_COLUMNS) {
+		return NULL;
+	}
+
+	MscriptColumn_t * column = &channel->columns[channel->nr_of_columns];
+	memset(column, 0, sizeof(MscriptColumn_t));
+	if (!resize_column(column, channel->row_capacity)) {
+		free(column->values);
+		free(column->status);
+		free(column->range);
+		return NULL;
+	}
+	column->variable_type = variable_type;
+	column->occurrence = occurrence;
+	for (size_t row = 0; row < channel->nr_of_rows; ++row) {
+		column->values[row] = NAN;
+	}
+	memset(column->status, MSCRIPT_COLUMN_NO_METADATA, channel->nr_of_rows);
+	memset(column->range, MSCRIPT_COLUMN_NO_METADATA, channel->nr_of_rows);
+	++channel->nr_of_columns;
+	return column;
+}
+
+/**
+ * Add a row to the index of a channel.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool index_row(MscriptChannelColumns_t * channel, unsigned int meas_loop_index)
+{
+	if (channel->nr_of_loops > 0) {
+		MscriptLoopIndexEntry_t * last = &channel->loops[channel->nr_of_loops - 1];
+		if (last->meas_loop_index == meas_loop_index) {
+			++last->nr_of_rows;
+			return true;
+		}
+	}
+	if (channel->nr_of_loops == channel->loop_capacity) {
+		size_t capacity = 2 * channel->loop_capacity;
+		MscriptLoopIndexEntry_t * loops = realloc(channel->loops,
+			capacity * sizeof(MscriptLoopIndexEntry_t));
+		if (loops == NULL) {
+			return false;
+		}
+		channel->loops = loops;
+		channel->loop_capacity = capacity;
+	}
+	MscriptLoopIndexEntry_t * entry = &channel->loops[channel->nr_of_loops++];
+	entry->meas_loop_index = meas_loop_index;
+	entry->first_row = channel->nr_of_rows;
+	entry->nr_of_rows = 1;
+	mscript_loop_stats_reset(&entry->stats);
+	return true;
+}
+
+/**
+ * Create a channel.
+ *
+ * \return The channel, or NULL on failure.
+ */
+static MscriptChannelColumns_t * create_channel(unsigned int number)
+{
+	MscriptChannelColumns_t * channel = calloc(1, sizeof(MscriptChannelColumns_t));
+	if (channel == NULL) {
+		return NULL;
+	}
+	channel->channel = number;
+	channel->row_capacity = INITIAL_ROW_CAPACITY;
+	channel->loop_capacity = INITIAL_LOOP_CAPACITY;
+	channel->loops = malloc(INITIAL_LOOP_CAPACITY * sizeof(MscriptLoopIndexEntry_t));
+	if (channel->loops == NULL) {
+		free(channel);
+		return NULL;
+	}
+	return channel;
+}
+
+/**
+ * Create an empty column store.
+ *
+ * \return The column store, or NULL on failure.
+ */
+MscriptColumnStore_t * mscript_column_store_create(void)
+{
+	return calloc(1, sizeof(MscriptColumnStore_t));
+}
+
+/**
+ * Free a column store and all its data.
+ */
+void mscript_column_store_destroy(MscriptColumnStore_t * store)
+{
+	for (unsigned int i = 0; i < MSCRIPT_COLUMN_STORE_MAX_CHANNELS; ++i) {
+		if (store->channels[i] != NULL) {
+			free_channel(store->channels[i]);
+		}
+	}
+	free(store);
+}
+
+/**
+ * Add a data package to the store.
+ *
+ * The package is appended as a new row to its channel. The channel variable
+ * itself is not stored.
+ *
+ * \param store The column store.
+ * \param meas_loop_index Number of the measurement loop the package belongs to.
+ * \param package The data package.
+ *
+ * \return `true` on success, `false` if the channel number is invalid or on
+ *         failure to allocate memory
+ */
+bool mscript_column_store_add_package(MscriptColumnStore_t * store, unsigned int meas_loop_index,
+	MscriptDataPackage_t const * package)
+{
+	unsigned int number = 0;
+	if (!mscript_get_package_channel(package, &number) && has_channel_variable(package)) {
+		DEBUG_PRINTF("ERROR: Invalid channel number in data package.\n");
+		return false;
+	}
+
+	MscriptChannelColumns_t * channel = store->channels[number];
+	if (channel == NULL) {
+		channel = create_channel(number);
+		if (channel == NULL) {
+			return false;
+		}
+		store->channels[number] = channel;
+	}
+	if (!reserve_row(channel)) {
+		return false;
+	}
+
+	size_t row = channel->nr_of_rows;
+	// Start with an empty row, in case the package does not have all columns.
+	for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+		channel->columns[i].values[row] = NAN;
+		channel->columns[i].status[row] = MSCRIPT_COLUMN_NO_METADATA;
+		channel->columns[i].range[row] = MSCRIPT_COLUMN_NO_METADATA;
+	}
+
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		MscriptSubPackage_t const * sub_package = &package->sub_packages[i];
+		if (sub_package->variable_type == MSCRIPT_VARTYPE_CHANNEL) {
+			continue;
+		}
+		unsigned int occurrence = 0;
+		for (size_t j = 0; j < i; ++j) {
+			if (package->sub_packages[j].variable_type == sub_package->variable_type) {
+				++occurrence;
+			}
+		}
+		MscriptColumn_t * column = get_column(channel, sub_package->variable_type, occurrence);
+		if (column == NULL) {
+			// Too many columns (or out of memory): the variable is ignored.
+			continue;
+		}
+		column->values[row] = sub_package->value;
+		if (sub_package->metadata.status >= 0) {
+			column->status[row] = (uint8_t)sub_package->metadata.status;
+		}
+		if (sub_package->metadata.range >= 0) {
+			column->range[row] = (uint8_t)sub_package->metadata.range;
+		}
+	}
+
+	if (!index_row(channel, meas_loop_index)) {
+		return false;
+	}
+	mscript_loop_stats_add_package(&channel->loops[channel->nr_of_loops - 1].stats, package);
+	++channel->nr_of_rows;
+	for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+		MscriptColumn_t * column = &channel->columns[i];
+		if (!mscript_minmax_summary_update(&column->summary, column->values, channel->nr_of_rows)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Store the data packages of an acquisition.
+ *
+ * This function is an `MscriptEventHandler_t`; use it with the column store as
+ * context as the sink of an acquisition, or call it from another sink. The
+ * packages must be parsed by the acquisition.
+ *
+ * \return `true` to continue, `false` on failure
+ */
+bool mscript_column_store_handle_event(void * context, MscriptEvent_t const * event)
+{
+	MscriptColumnStore_t * store = context;
+	if (event->type != MSCRIPT_EVENT_PACKAGE) {
+		return true;
+	}
+	assert(event->package != NULL);
+	return mscript_column_store_add_package(store, event->meas_loop_index, event->package);
+}
+
+/**
+ * Get the data of a channel.
+ *
+ * The returned data remains valid until the next package is added to the
+ * channel.
+ *
+ * \return The channel, or NULL if it has no data.
+ */
+MscriptChannelColumns_t const * mscript_column_store_get_channel(
+	MscriptColumnStore_t const * store, unsigned int channel)
+{
+	if (channel >= MSCRIPT_COLUMN_STORE_MAX_CHANNELS) {
+		return NULL;
+	}
+	return store->channels[channel];
+}
+
+/**
+ * Find the rows of a measurement loop in a channel.
+ *
+ * A binary search is used, since the index is ordered by measurement loop.
+ *
+ * \return The index entry, or NULL if the channel has no data in this loop.
+ */
+MscriptLoopIndexEntry_t const * mscript_channel_find_loop(MscriptChannelColumns_t const * channel,
+	unsigned int meas_loop_index)
+{
+	size_t low = 0;
+	size_t high = channel->nr_of_loops;
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		if (channel->loops[mid].meas_loop_index < meas_loop_index) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	if ((low < channel->nr_of_loops) && (channel->loops[low].meas_loop_index == meas_loop_index)) {
+		return &channel->loops[low];
+	}
+	return NULL;
+}
+
+/**
+ * Find the (first) column of a variable type in a channel.
+ *
+ * \return The column, or NULL if the channel has no such column.
+ */
+MscriptColumn_t const * mscript_channel_find_column(MscriptChannelColumns_t const * channel,
+	unsigned int variable_type)
+{
+	for (size_t i = 0; i < channel->nr_of_columns; ++i) {
+		if ((channel->columns[i].variable_type == variable_type)
+			&& (channel->columns[i].occurrence == 0)) {
+			return &channel->columns[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Get the values of a variable in a measurement loop of a channel.
+ *
+ * No data is copied: the view points into the arrays of the column. See
+ * `mscript_column_store_get_column()`.
+ *
+ * \param channel The channel.
+ * \param meas_loop_index The number of the measurement loop.
+ * \param variable_type The variable type (the first column of this type is used).
+ * \param[out] view The rows of the column in the measurement loop.
+ *
+ * \return `true` on success, `false` if the channel has no such column or no
+ * data in this measurement loop.
+ */
+bool mscript_channel_get_column(MscriptChannelColumns_t const * channel,
+	unsigned int meas_loop_index, unsigned int variable_type, MscriptColumnView_t * view)
+{
+	MscriptLoopIndexEntry_t const * loop = mscript_channel_find_loop(channel, meas_loop_index);
+	MscriptColumn_t const * column = mscript_channel_find_column(channel, variable_type);
+	if ((loop == NULL) || (column == NULL)) {
+		return false;
+	}
+	view->values = &column->values[loop->first_row];
+	view->status = &column->status[loop->first_row];
+	view->range = &column->range[loop->first_row];
+	view->nr_of_rows = loop->nr_of_rows;
+	return true;
+}
+
+/**
+ * Get the values of a variable in a measurement loop of a channel.
+ *
+ * The view points into the arrays of the store, so it takes the same time
+ * for any number of rows. It remains valid until the next package is added
+ * to this channel or the store is destroyed. Rows of packages that did not
+ * contain the variable are NaN.
+ *
+ * \param store The column store.
+ * \param channel The channel number (0 for packages without a channel).
+ * \param meas_loop_index The number of the measurement loop.
+ * \param variable_type The variable type (the first column of this type is used).
+ * \param[out] view The rows of the column in the measurement loop.
+ *
+ * \return `true` on success, `false` if there is no such data.
+ */
+bool mscript_column_store_get_column(MscriptColumnStore_t const * store, unsigned int channel,
+	unsigned int meas_loop_index, unsigned int variable_type, MscriptColumnView_t * view)
+{
+	MscriptChannelColumns_t const * columns = mscript_column_store_get_channel(store, channel);
+	if (columns == NULL) {
+		return false;
+	}
+	return mscript_channel_get_column(columns, meas_loop_index, variable_type, view);
+}
+
+/**
+ * Get the rows to show a range of rows of a column with a limited number of
+ * points.
+ *
+ * See `mscript_minmax_summary_query()`; the time needed depends on
+ * `max_points`, not on the number of rows in the range. To show the rows of
+ * one measurement loop, use the first row and number of rows of its index
+ * entry (see `mscript_channel_find_loop()`).
+ *
+ * \param column The column.
+ * \param first_row The first row of the range.
+ * \param nr_of_rows The number of rows in the range.
+ * \param max_points The maximum number of points (at least 2).
+ * \param[out] rows The rows to show (`max_points` entries), in ascending order.
+ *
+ * \return The number of rows
+ */
+size_t mscript_column_downsample(MscriptColumn_t const * column, size_t first_row,
+	size_t nr_of_rows, size_t max_points, size_t * rows)
+{
+	return mscript_minmax_summary_query(&column->summary, column->values, first_row,
+		nr_of_rows, max_points, rows);
+}
@@ -0,0 +1,179 @@
+/**
+ * \file
+ * Columnar storage of measurement data, split per channel.
+ *
+ * Scripts that use a multiplexer (MUX) can add the channel number to each
+ * data package, as a variable of type `MSCRIPT_VARTYPE_CHANNEL` ("ea"). This
+ * module stores the data packages of a run per channel. For each channel, the
+ * values of each variable are stored in one contiguous array (a column), and
+ * the status and range metadata in separate byte arrays. Packages without a
+ * channel variable are stored as channel 0.
+ *
+ * For each channel, an index records which rows belong to which measurement
+ * loop. Since the rows of a channel are appended in order, the rows of one
+ * measurement loop are contiguous. This way, the data of one channel in one
+ * measurement loop can be found without scanning the data of other channels
+ * or loops. The index entry also holds the statistics of each column in the
+ * measurement loop (see `mscript_stats.h`), which are updated with each row,
+ * so they are available without processing the data again.
+ *
+ * A column is identified by its variable type and its occurrence in the
+ * package, so packages that contain the same variable type more than once
+ * (e.g. the real impedance of several MUX channels) are stored in separate
+ * columns. If a package does not contain a variable that other packages of
+ * the channel have, NaN is stored.
+ *
+ * Each column also keeps a min/max summary of its values (see
+ * `mscript_downsample.h`), so any range of rows can be shown with a limited
+ * number of points using `mscript_column_downsample()`, without reading all
+ * rows of the range.
+ *
+ * `mscript_column_store_get_column()` returns the values and metadata of one
+ * variable in one measurement loop as a `MscriptColumnView_t`: pointers into
+ * the arrays of the store and the number of rows, without copying anything.
+ * Analysis stages and exporters can process these plain arrays directly,
+ * which is much more cache-friendly (and easier for the compiler to
+ * vectorize) than walking the variables of each `MscriptDataPackage_t`. The
+ * pointers remain valid until the next package is added to the channel or
+ * the store is destroyed, since adding rows may move the arrays.
+ *
+ * The store can be used as the sink of an acquisition (see
+ * `mscript_acquisition.h`), or packages can be added directly using
+ * `mscript_column_store_add_package()`. It is not thread-safe.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript.h"
+#include "mscript_acquisition.h"
+#include "mscript_downsample.h"
+#include "mscript_stats.h"
+
+/// Maximum number of channels (channel numbers 0 to MSCRIPT_COLUMN_STORE_MAX_CHANNELS - 1).
+#define MSCRIPT_COLUMN_STORE_MAX_CHANNELS 256
+
+/// Maximum number of columns per channel. Additional variables are ignored.
+#define MSCRIPT_COLUMN_STORE_MAX_COLUMNS 16
+
+/// Value in the status and range arrays if the metadata was not present.
+#define MSCRIPT_COLUMN_NO_METADATA 0xFF
+
+/** One column of a channel. */
+typedef struct {
+	/** The variable type of the column. */
+	unsigned int variable_type;
+	/** Occurrence of the variable type in the package (0 for the first). */
+	unsigned int occurrence;
+	/** The values (`nr_of_rows` entries). */
+	double * values;
+	/** Status metadata of each row, or `MSCRIPT_COLUMN_NO_METADATA`. */
+	uint8_t * status;
+	/** Range metadata of each row, or `MSCRIPT_COLUMN_NO_METADATA`. */
+	uint8_t * range;
+	/** Min/max summary of the values, updated with each row. */
+	MscriptMinMaxSummary_t summary;
+} MscriptColumn_t;
+
+/** Index entry: the rows of one measurement loop in a channel. */
+typedef struct {
+	/** Number of the measurement loop (see `MscriptEvent_t`). */
+	unsigned int meas_loop_index;
+	/** First row of the measurement loop. */
+	size_t first_row;
+	/** Number of rows of the measurement loop. */
+	size_t nr_of_rows;
+	/** Statistics of the columns in the measurement loop, updated with each row. */
+	MscriptLoopStats_t stats;
+} MscriptLoopIndexEntry_t;
+
+/** The data of one channel. */
+typedef struct {
+	unsigned int channel;
+	/** Number of rows (data packages) in each column. */
+	size_t nr_of_rows;
+	size_t nr_of_columns;
+	MscriptColumn_t columns[MSCRIPT_COLUMN_STORE_MAX_COLUMNS];
+	/** Number of entries in `loops`. */
+	size_t nr_of_loops;
+	/** The index, ordered by measurement loop. */
+	MscriptLoopIndexEntry_t * loops;
+	/** Allocated number of rows (internal). */
+	size_t row_capacity;
+	/** Allocated number of index entries (internal). */
+	size_t loop_capacity;
+} MscriptChannelColumns_t;
+
+/** The rows of one column in one measurement loop, pointing into the store. */
+typedef struct {
+	/** The values (`nr_of_rows` entries). */
+	double const * values;
+	/** Status metadata of each row, or `MSCRIPT_COLUMN_NO_METADATA`. */
+	uint8_t const * status;
+	/** Range metadata of each row, or `MSCRIPT_COLUMN_NO_METADATA`. */
+	uint8_t const * range;
+	/** Number of rows. */
+	size_t nr_of_rows;
+} MscriptColumnView_t;
+
+/** The column store. */
+typedef struct MscriptColumnStore MscriptColumnStore_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptColumnStore_t * mscript_column_store_create(void);
+void mscript_column_store_destroy(MscriptColumnStore_t * store);
+bool mscript_column_store_add_package(MscriptColumnStore_t * store, unsigned int meas_loop_index,
+	MscriptDataPackage_t const * package);
+bool mscript_column_store_handle_event(void * context, MscriptEvent_t const * event);
+MscriptChannelColumns_t const * mscript_column_store_get_channel(
+	MscriptColumnStore_t const * store, unsigned int channel);
+MscriptLoopIndexEntry_t const * mscript_channel_find_loop(MscriptChannelColumns_t const * channel,
+	unsigned int meas_loop_index);
+MscriptColumn_t const * mscript_channel_find_column(MscriptChannelColumns_t const * channel,
+	unsigned int variable_type);
+bool mscript_channel_get_column(MscriptChannelColumns_t const * channel,
+	unsigned int meas_loop_index, unsigned int variable_type, MscriptColumnView_t * view);
+bool mscript_column_store_get_column(MscriptColumnStore_t const * store, unsigned int channel,
+	unsigned int meas_loop_index, unsigned int variable_type, MscriptColumnView_t * view);
+size_t mscript_column_downsample(MscriptColumn_t const * column, size_t first_row,
+	size_t nr_of_rows, size_t max_points, size_t * rows);
+bool mscript_get_package_channel(MscriptDataPackage_t const * package, unsigned int * p_channel);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
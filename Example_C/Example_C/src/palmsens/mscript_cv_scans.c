@@ -0,0 +1,530 @@
+/**
+ * \file
+ * Per-scan segmentation and analysis of cyclic voltammetry.
+ *
+ * See `mscript_cv_scans.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_cv_scans.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+#include "mscript_thread.h"
+
+/// Number of points allocated for a new scan.
+#define INITIAL_SCAN_CAPACITY 256
+
+/// Number of scans allocated for a new measurement loop.
+#define INITIAL_NR_OF_SCANS 16
+
+/** The columns of one scan. */
+typedef struct {
+	MscriptCvScans_t * scans;
+	unsigned int index;
+	size_t count;
+	size_t capacity;
+	double * potential;
+	double * current;
+	/** The time of each point, or NULL if the packages do not contain it. */
+	double * time;
+} Scan_t;
+
+struct MscriptCvScans {
+	MscriptCvScanCallback_t callback;
+	void * context;
+	/** Time between two points (s), or 0 if unknown. */
+	double point_interval_s;
+	/** The scans of the measurement loop. Only the last one can be open. */
+	Scan_t ** scans;
+	size_t nr_of_scans;
+	size_t scan_capacity;
+	/** `true` if the last scan is still being received. */
+	bool is_scan_open;
+	/** The submitted scans. Its mutex also protects the results. */
+	MscriptWorkGroup_t group;
+	/** The results of the measurement loop, by index of the scan. */
+	MscriptCvScanResult_t * results;
+};
+
+/**
+ * Add charge to the anodic (positive) or cathodic (negative) charge of a scan.
+ */
+static void add_charge(MscriptCvScanResult_t * result, double q)
+{
+	if (q > 0.0) {
+		result->anodic_charge += q;
+	} else if (q < 0.0) {
+		result->cathodic_charge += q;
+	}
+}
+
+/**
+ * Keep a peak in the result if it is the highest of its direction so far.
+ */
+static void keep_highest_peak(MscriptCvScanResult_t * result, MscriptPeak_t const * peak)
+{
+	if ((peak->height > 0.0)
+		&& (!result->has_anodic_peak || (peak->height > result->anodic_peak.height))) {
+		result->has_anodic_peak = true;
+		result->anodic_peak = *peak;
+	} else if ((peak->height < 0.0)
+		&& (!result->has_cathodic_peak || (peak->height < result->cathodic_peak.height))) {
+		result->has_cathodic_peak = true;
+		result->cathodic_peak = *peak;
+	}
+}
+
+/**
+ * Analyze one scan: integrate the charge and find the peaks.
+ *
+ * The charge is integrated with the trapezoidal rule, using the time of each
+ * point if available, or otherwise a constant time between two points. The
+ * anodic and cathodic charge are the integrals of the positive and negative
+ * part of the current. The peaks are found with a peak detector (see
+ * `mscript_peaks.h`) with the default settings, which detects anodic peaks
+ * while scanning up and cathodic peaks while scanning down; the highest peak
+ * of each direction is reported.
+ *
+ * \param scan The scan.
+ * \param point_interval_s Time between two points (s), or 0 if unknown. Not
+ *                         used if the scan contains the time.
+ * \param[out] result The result.
+ *
+ * \return `true` on success, `false` if the scan has no points
+ */
+bool mscript_cv_scan_analyze(MscriptCvScan_t const * scan, double point_interval_s,
+	MscriptCvScanResult_t * result)
+{
+	memset(result, 0, sizeof(MscriptCvScanResult_t));
+	result->index = scan->index;
+	result->nr_of_points = scan->nr_of_points;
+	result->min_potential = NAN;
+	result->max_potential = NAN;
+	result->peak_separation = NAN;
+	bool has_time = (scan->time != NULL) || (point_interval_s > 0.0);
+	result->anodic_charge = has_time ? 0.0 : NAN;
+	result->cathodic_charge = has_time ? 0.0 : NAN;
+	if (scan->nr_of_points == 0) {
+		return false;
+	}
+
+	MscriptPeakDetector_t detector;
+	mscript_peak_detector_init(&detector);
+	MscriptPeak_t peak;
+	double const * e = scan->potential;
+	double const * i = scan->current;
+	result->min_potential = e[0];
+	result->max_potential = e[0];
+	for (size_t k = 0; k < scan->nr_of_points; ++k) {
+		result->min_potential = fmin(result->min_potential, e[k]);
+		result->max_potential = fmax(result->max_potential, e[k]);
+		if (has_time && (k > 0)) {
+			double dt = (scan->time != NULL) ? scan->time[k] - scan->time[k - 1]
+				: point_interval_s;
+			double i0 = i[k - 1];
+			double i1 = i[k];
+			if (((i0 > 0.0) && (i1 < 0.0)) || ((i0 < 0.0) && (i1 > 0.0))) {
+				// The current changes sign: split the interval at the zero
+				// crossing and classify each part by the sign of its current.
+				double f = i0 / (i0 - i1);
+				add_charge(result, 0.5 * i0 * f * dt);
+				add_charge(result, 0.5 * i1 * (1.0 - f) * dt);
+			} else {
+				// Both currents have the same sign, or one of them is exactly
+				// zero, which is a boundary of the interval and not a crossing.
+				add_charge(result, 0.5 * (i0 + i1) * dt);
+			}
+		}
+
+		if (mscript_peak_detector_add(&detector, e[k], i[k], &peak)) {
+			keep_highest_peak(result, &peak);
+		}
+	}
+	if (mscript_peak_detector_finish(&detector, &peak)) {
+		keep_highest_peak(result, &peak);
+	}
+	if (result->has_anodic_peak && result->has_cathodic_peak) {
+		result->peak_separation = result->anodic_peak.potential
+			- result->cathodic_peak.potential;
+	}
+	result->is_valid = true;
+	return true;
+}
+
+/**
+ * Free a scan.
+ */
+static void free_scan(Scan_t * scan)
+{
+	free(scan->potential);
+	free(scan->current);
+	free(scan->time);
+	free(scan);
+}
+
+/**
+ * Get the public view of a scan.
+ */
+static void get_scan_view(Scan_t const * scan, MscriptCvScan_t * p_scan)
+{
+	p_scan->index = scan->index;
+	p_scan->nr_of_points = scan->count;
+	p_scan->potential = scan->potential;
+	p_scan->current = scan->current;
+	p_scan->time = scan->time;
+}
+
+/**
+ * Analyze a scan (`MscriptWorkFunction_t`).
+ *
+ * The scan is not changed after it has been submitted, so it is read without
+ * holding the mutex.
+ */
+static void process_scan(void * arg)
+{
+	Scan_t * scan = arg;
+	MscriptCvScans_t * scans = scan->scans;
+	MscriptCvScan_t view;
+	get_scan_view(scan, &view);
+	MscriptCvScanResult_t result;
+	mscript_cv_scan_analyze(&view, scans->point_interval_s, &result);
+	if (scans->callback != NULL) {
+		scans->callback(scans->context, &result);
+	}
+
+	mscript_mutex_lock(&scans->group.mutex);
+	scans->results[result.index] = result;
+	mscript_work_group_done(&scans->group);
+	mscript_mutex_unlock(&scans->group.mutex);
+}
+
+/**
+ * Create a collector for the scans of cyclic voltammetry measurement loops.
+ *
+ * \param workers The pool of worker threads that analyzes the scans.
+ * \param callback Function that receives each result as soon as it has been
+ *                 calculated, or NULL.
+ * \param context Passed to `callback`.
+ *
+ * \return The collector, or NULL on failure.
+ */
+MscriptCvScans_t * mscript_cv_scans_create(MscriptWorkers_t * workers,
+	MscriptCvScanCallback_t callback, void * context)
+{
+	MscriptCvScans_t * scans = calloc(1, sizeof(MscriptCvScans_t));
+	if (scans == NULL) {
+		return NULL;
+	}
+	scans->scans = malloc(INITIAL_NR_OF_SCANS * sizeof(Scan_t *));
+	scans->results = malloc(INITIAL_NR_OF_SCANS * sizeof(MscriptCvScanResult_t));
+	if ((scans->scans == NULL) || (scans->results == NULL)) {
+		free(scans->scans);
+		free(scans->results);
+		free(scans);
+		return NULL;
+	}
+	scans->scan_capacity = INITIAL_NR_OF_SCANS;
+	scans->callback = callback;
+	scans->context = context;
+	mscript_work_group_init(&scans->group, workers);
+	return scans;
+}
+
+/**
+ * Free a collector. This waits until the submitted scans have been analyzed.
+ */
+void mscript_cv_scans_destroy(MscriptCvScans_t * scans)
+{
+	mscript_cv_scans_reset(scans);
+	mscript_work_group_destroy(&scans->group);
+	free(scans->scans);
+	free(scans->results);
+	free(scans);
+}
+
+/**
+ * Start a new measurement loop: wait until the submitted scans have been
+ * analyzed and discard all scans and results.
+ */
+void mscript_cv_scans_reset(MscriptCvScans_t * scans)
+{
+	mscript_cv_scans_wait(scans);
+	for (size_t i = 0; i < scans->nr_of_scans; ++i) {
+		free_scan(scans->scans[i]);
+	}
+	scans->nr_of_scans = 0;
+	scans->is_scan_open = false;
+}
+
+/**
+ * Set the time between two points, which is used to integrate the charge if
+ * the packages do not contain the time. For `meas_loop_cv`, this is the
+ * potential step divided by the scan rate (see `MscriptLoopPrediction_t`).
+ *
+ * \param scans The collector.
+ * \param point_interval_s The time between two points (s), or 0 if unknown.
+ */
+void mscript_cv_scans_set_point_interval(MscriptCvScans_t * scans, double point_interval_s)
+{
+	// The workers may be reading the interval.
+	mscript_cv_scans_wait(scans);
+	scans->point_interval_s = point_interval_s;
+}
+
+/**
+ * Start a new scan. An open scan is ended (and submitted) first.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_cv_scans_start_scan(MscriptCvScans_t * scans)
+{
+	if (!mscript_cv_scans_end_scan(scans)) {
+		return false;
+	}
+	if (scans->nr_of_scans == scans->scan_capacity) {
+		size_t capacity = 2 * scans->scan_capacity;
+		Scan_t ** p = realloc(scans->scans, capacity * sizeof(Scan_t *));
+		if (p == NULL) {
+			return false;
+		}
+		scans->scans = p;
+		// The workers may be writing their results.
+		mscript_mutex_lock(&scans->group.mutex);
+		MscriptCvScanResult_t * results = realloc(scans->results,
+			capacity * sizeof(MscriptCvScanResult_t));
+		if (results != NULL) {
+			scans->results = results;
+			scans->scan_capacity = capacity;
+		}
+		mscript_mutex_unlock(&scans->group.mutex);
+		if (results == NULL) {
+			return false;
+		}
+	}
+
+	Scan_t * scan = calloc(1, sizeof(Scan_t));
+	if (scan == NULL) {
+		return false;
+	}
+	scan->scans = scans;
+	scan->index = (unsigned int)scans->nr_of_scans;
+	scan->capacity = INITIAL_SCAN_CAPACITY;
+	scan->potential = malloc(INITIAL_SCAN_CAPACITY * sizeof(double));
+	scan->current = malloc(INITIAL_SCAN_CAPACITY * sizeof(double));
+	if ((scan->potential == NULL) || (scan->current == NULL)) {
+		free_scan(scan);
+		return false;
+	}
+	mscript_mutex_lock(&scans->group.mutex);
+	memset(&scans->results[scan->index], 0, sizeof(MscriptCvScanResult_t));
+	scans->results[scan->index].index = scan->index;
+	mscript_mutex_unlock(&scans->group.mutex);
+	scans->scans[scans->nr_of_scans++] = scan;
+	scans->is_scan_open = true;
+	return true;
+}
+
+/**
+ * Grow the columns of a scan.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+static bool grow_scan(Scan_t * scan)
+{
+	size_t capacity = 2 * scan->capacity;
+	double * p = realloc(scan->potential, capacity * sizeof(double));
+	if (p == NULL) {
+		return false;
+	}
+	scan->potential = p;
+	p = realloc(scan->current, capacity * sizeof(double));
+	if (p == NULL) {
+		return false;
+	}
+	scan->current = p;
+	if (scan->time != NULL) {
+		p = realloc(scan->time, capacity * sizeof(double));
+		if (p == NULL) {
+			return false;
+		}
+		scan->time = p;
+	}
+	scan->capacity = capacity;
+	return true;
+}
+
+/**
+ * Add a data package to the current scan. If no scan is open, a new scan is
+ * started. Packages without a potential and current are ignored.
+ *
+ * The time is stored if the first package of the scan contains it.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+bool mscript_cv_scans_add_package(MscriptCvScans_t * scans, MscriptDataPackage_t const * package)
+{
+	double potential, current, time;
+	if (!mscript_find_value(package, MSCRIPT_VARTYPE_CURRENT, &current)
+		|| (!mscript_find_value(package, MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, &potential)
+			&& !mscript_find_value(package, MSCRIPT_VARTYPE_POTENTIAL, &potential))) {
+		return true;
+	}
+	if (!scans->is_scan_open && !mscript_cv_scans_start_scan(scans)) {
+		return false;
+	}
+	Scan_t * scan = scans->scans[scans->nr_of_scans - 1];
+	bool has_time = mscript_find_value(package, MSCRIPT_VARTYPE_TIME, &time);
+	if ((scan->count == 0) && has_time) {
+		scan->time = malloc(scan->capacity * sizeof(double));
+		if (scan->time == NULL) {
+			return false;
+		}
+	}
+	if ((scan->count == scan->capacity) && !grow_scan(scan)) {
+		return false;
+	}
+	scan->potential[scan->count] = potential;
+	scan->current[scan->count] = current;
+	if (scan->time != NULL) {
+		scan->time[scan->count] = has_time ? time : NAN;
+	}
+	++scan->count;
+	return true;
+}
+
+/**
+ * End the current scan and submit it to the worker threads. Call this at the
+ * end of the scan or measurement loop; it does nothing if no scan is open.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_cv_scans_end_scan(MscriptCvScans_t * scans)
+{
+	if (!scans->is_scan_open) {
+		return true;
+	}
+	scans->is_scan_open = false;
+	Scan_t * scan = scans->scans[scans->nr_of_scans - 1];
+	return mscript_work_group_submit(&scans->group, process_scan, scan);
+}
+
+/**
+ * Wait until all submitted scans have been analyzed.
+ */
+void mscript_cv_scans_wait(MscriptCvScans_t * scans)
+{
+	mscript_work_group_wait(&scans->group);
+}
+
+/**
+ * Get the number of scans of the current measurement loop (including a scan
+ * that is still open).
+ */
+size_t mscript_cv_scans_get_nr_of_scans(MscriptCvScans_t const * scans)
+{
+	return scans->nr_of_scans;
+}
+
+/**
+ * Get the columns of a scan of the current measurement loop.
+ *
+ * The columns remain valid until the collector is reset; the columns of an
+ * open scan are only valid until the next package is added.
+ *
+ * \param scans The collector.
+ * \param index The index of the scan.
+ * \param[out] p_scan The scan.
+ *
+ * \return `true` on success, `false` if there is no such scan
+ */
+bool mscript_cv_scans_get_scan(MscriptCvScans_t const * scans, size_t index,
+	MscriptCvScan_t * p_scan)
+{
+	if (index >= scans->nr_of_scans) {
+		return false;
+	}
+	get_scan_view(scans->scans[index], p_scan);
+	return true;
+}
+
+/**
+ * Get the results of the current measurement loop, ordered by scan.
+ *
+ * Call `mscript_cv_scans_end_scan()` and `mscript_cv_scans_wait()` first; the
+ * results of scans that have not been analyzed are not valid. The results
+ * remain valid until the next scan is started or the collector is reset.
+ *
+ * \param scans The collector.
+ * \param[out] p_count The number of results.
+ *
+ * \return The results.
+ */
+MscriptCvScanResult_t const * mscript_cv_scans_get_results(MscriptCvScans_t const * scans,
+	size_t * p_count)
+{
+	*p_count = scans->nr_of_scans;
+	return scans->results;
+}
+
+/**
+ * Process the events of an acquisition.
+ *
+ * This function is an `MscriptEventHandler_t`; use it with the collector as
+ * context as the sink of an acquisition, or call it from another sink. Each
+ * measurement loop starts without scans; at the end of the loop the last
+ * scan is submitted.
+ *
+ * \return `true` to continue, `false` on failure
+ */
+bool mscript_cv_scans_handle_event(void * context, MscriptEvent_t const * event)
+{
+	MscriptCvScans_t * scans = context;
+	switch (event->type) {
+	case MSCRIPT_EVENT_MEAS_LOOP_START:
+		mscript_cv_scans_reset(scans);
+		return true;
+	case MSCRIPT_EVENT_SCAN_START:
+		return mscript_cv_scans_start_scan(scans);
+	case MSCRIPT_EVENT_SCAN_END:
+	case MSCRIPT_EVENT_MEAS_LOOP_END:
+		return mscript_cv_scans_end_scan(scans);
+	case MSCRIPT_EVENT_PACKAGE:
+		assert(event->package != NULL);
+		return mscript_cv_scans_add_package(scans, event->package);
+	default:
+		return true;
+	}
+}
@@ -0,0 +1,145 @@
+/**
+ * \file
+ * Per-scan segmentation and analysis of cyclic voltammetry.
+ *
+ * With the `nscans` option of `meas_loop_cv`, the device measures several
+ * scans in one measurement loop, and marks the start and end of each scan
+ * with the replies "C" and "-" (`MSCRIPT_EVENT_SCAN_START` and
+ * `MSCRIPT_EVENT_SCAN_END`):
+ *
+ *     meas_loop_cv p c 0m 500m -500m 10m 100m nscans(3)
+ *         pck_start
+ *         pck_add p
+ *         pck_add c
+ *         pck_end
+ *     endloop
+ *
+ * This module splits the data of the measurement loop into one set of
+ * columns (potential, current and, if the packages contain it, time) per
+ * scan while the packages are received. As soon as a scan is complete, it
+ * is submitted to a pool of worker threads (see `mscript_workers.h`), which
+ * analyzes it while the next scans are being measured:
+ *   - the charge, by integrating the current over time, separately for the
+ *     positive (anodic) and negative (cathodic) current;
+ *   - the largest anodic and cathodic peak (see `mscript_peaks.h`);
+ *   - the separation between these peaks.
+ * The charge is integrated using the time variable (`MSCRIPT_VARTYPE_TIME`)
+ * if the packages contain it, and otherwise using the time between two
+ * points (the potential step divided by the scan rate), see
+ * `mscript_cv_scans_set_point_interval()`.
+ *
+ * Packages that are not between the scan markers (e.g. of a loop without
+ * `nscans`) are collected as one scan, which ends at the end of the
+ * measurement loop. The scans remain available until the next measurement
+ * loop starts.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript.h"
+#include "mscript_acquisition.h"
+#include "mscript_peaks.h"
+#include "mscript_workers.h"
+
+/** The columns of one scan. */
+typedef struct {
+	/** Index of the scan in the measurement loop (0 for the first). */
+	unsigned int index;
+	size_t nr_of_points;
+	/** The applied potential (V) and current (A) of each point. */
+	double const * potential;
+	double const * current;
+	/** The time (s) of each point, or NULL if the packages do not contain it. */
+	double const * time;
+} MscriptCvScan_t;
+
+/** The analysis of one scan. */
+typedef struct {
+	/** Index of the scan in the measurement loop (0 for the first). */
+	unsigned int index;
+	/** `false` if the scan has not been analyzed (yet). */
+	bool is_valid;
+	size_t nr_of_points;
+	/** The range of the potential (V). */
+	double min_potential;
+	double max_potential;
+	/** Charge (C) of the positive and negative current, or NaN if the time is unknown. */
+	double anodic_charge;
+	double cathodic_charge;
+	/** The largest anodic and cathodic peak, if found. */
+	bool has_anodic_peak;
+	MscriptPeak_t anodic_peak;
+	bool has_cathodic_peak;
+	MscriptPeak_t cathodic_peak;
+	/** Anodic minus cathodic peak potential (V), or NaN if either peak is missing. */
+	double peak_separation;
+} MscriptCvScanResult_t;
+
+/**
+ * Function that receives the result of a scan as soon as it has been
+ * analyzed. It is called from one of the worker threads, so the results of
+ * the scans may arrive in any order.
+ */
+typedef void (*MscriptCvScanCallback_t)(void * context, MscriptCvScanResult_t const * result);
+
+/** Splits a measurement loop into scans and analyzes them. */
+typedef struct MscriptCvScans MscriptCvScans_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool mscript_cv_scan_analyze(MscriptCvScan_t const * scan, double point_interval_s,
+	MscriptCvScanResult_t * result);
+
+MscriptCvScans_t * mscript_cv_scans_create(MscriptWorkers_t * workers,
+	MscriptCvScanCallback_t callback, void * context);
+void mscript_cv_scans_destroy(MscriptCvScans_t * scans);
+void mscript_cv_scans_reset(MscriptCvScans_t * scans);
+void mscript_cv_scans_set_point_interval(MscriptCvScans_t * scans, double point_interval_s);
+bool mscript_cv_scans_start_scan(MscriptCvScans_t * scans);
+bool mscript_cv_scans_add_package(MscriptCvScans_t * scans, MscriptDataPackage_t const * package);
+bool mscript_cv_scans_end_scan(MscriptCvScans_t * scans);
+void mscript_cv_scans_wait(MscriptCvScans_t * scans);
+size_t mscript_cv_scans_get_nr_of_scans(MscriptCvScans_t const * scans);
+bool mscript_cv_scans_get_scan(MscriptCvScans_t const * scans, size_t index,
+	MscriptCvScan_t * p_scan);
+MscriptCvScanResult_t const * mscript_cv_scans_get_results(MscriptCvScans_t const * scans,
+	size_t * p_count);
+bool mscript_cv_scans_handle_event(void * context, MscriptEvent_t const * event);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
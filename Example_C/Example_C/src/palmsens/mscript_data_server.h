@@ -0,0 +1,158 @@
+/**
+ * \file
+ * Server that streams the live data packages to local clients over a socket.
+ *
+ * Instead of reading the CSV files while they are written, other programs can
+ * connect to this server over TCP or a UNIX domain socket and receive the
+ * data packages as soon as they are received from the device. After
+ * connecting, a client sends one line to subscribe, and may send another line
+ * at any time to change its subscription:
+ *
+ *     subscribe [device=N] [channel=N|none] [format=ndjson|binary] [policy=P]
+ *
+ * By default, the packages of all devices and channels are sent as NDJSON
+ * (one JSON object per line), e.g.
+ *
+ *     {"seq":12,"time_us":1234567,"device":1,"channel":3,"meas_loop":1,"package":4,
+ *      "values":[{"type":"ba","value":2.5e-06,"status":0,"range":3}]}
+ *
+ * where `channel` is null for packages without a channel, and `status` and
+ * `range` are only present if the package contains them. The binary format
+ * consists of frames with all numbers in little-endian byte order:
+ *
+ *     uint16 frame size in bytes, excluding this field
+ *     uint8  frame type (`MSCRIPT_DATA_FRAME_PACKAGE`)
+ *     uint8  number of values
+ *     uint64 sequence number
+ *     uint64 receive time in microseconds (see `mscript_get_time_us()`)
+ *     uint16 device
+ *     int16  channel, or -1
+ *     uint32 measurement loop (1 for the first)
+ *     uint32 package in the measurement loop (1 for the first)
+ *     per value: uint16 variable type, uint8 status, uint8 range
+ *                (0xFF if not present), float64 value
+ *
+ * The sequence number counts all packages published by the server, so a
+ * client can see from a gap that packages of its subscription were dropped.
+ *
+ * Publishing a package never waits for the network. Each package is encoded
+ * once per format and appended to a bounded send queue of each subscribed
+ * client; a background thread sends the queues. When the queue of a slow
+ * client is full, the slow client policy decides what happens: drop the new
+ * package, drop the oldest queued package (best for live plots), or
+ * disconnect the client (best for clients that must not miss data, which
+ * then know they have to reconnect). Other clients and the acquisition are
+ * never delayed by a slow client.
+ *
+ * `mscript_data_server_publish()` is thread-safe, so all devices and channels
+ * can publish to the same server.
+ *
+ * This is only available on Linux; on Windows, creating a server fails.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript_acquisition.h"
+
+/// Maximum number of connected clients.
+#define MSCRIPT_DATA_SERVER_MAX_CLIENTS 32
+
+/// Default number of packages in the send queue of each client.
+#define MSCRIPT_DATA_SERVER_DEFAULT_QUEUE_SIZE 1024
+
+/// Channel of packages without a channel.
+#define MSCRIPT_DATA_NO_CHANNEL (-1)
+
+/// Frame type of a data package in the binary format.
+#define MSCRIPT_DATA_FRAME_PACKAGE 1
+
+/** What to do when the send queue of a client is full. */
+typedef enum {
+	/** Drop the new package ("drop-newest"). */
+	MSCRIPT_SLOW_CLIENT_DROP_NEWEST,
+	/** Drop the oldest package in the queue ("drop-oldest"). */
+	MSCRIPT_SLOW_CLIENT_DROP_OLDEST,
+	/** Disconnect the client ("disconnect"). */
+	MSCRIPT_SLOW_CLIENT_DISCONNECT,
+} MscriptSlowClientPolicy_t;
+
+/** Configuration of a server. */
+typedef struct {
+	/**
+	 * Address to listen on: a path for a UNIX domain socket (containing a
+	 * '/', e.g. "/tmp/mscript.sock"), or "[HOST:]PORT" for TCP, where HOST
+	 * is an IPv4 address (default 127.0.0.1, so only local clients can
+	 * connect).
+	 */
+	char const * address;
+	/** Number of packages in the send queue of each client (about 1 kB each). */
+	size_t queue_size;
+	/** Policy of clients that do not choose one when subscribing. */
+	MscriptSlowClientPolicy_t policy;
+} MscriptDataServerConfig_t;
+
+/** Statistics of a server. */
+typedef struct {
+	/** Number of packages published. */
+	uint64_t nr_of_packages;
+	/** Number of clients that have connected. */
+	unsigned int nr_of_clients;
+	/** Number of packages queued for clients. */
+	uint64_t nr_of_queued;
+	/** Number of packages dropped because a send queue was full. */
+	uint64_t nr_of_dropped;
+	/** Number of clients disconnected because their send queue was full. */
+	unsigned int nr_of_slow_disconnects;
+} MscriptDataServerStats_t;
+
+/** A data server. */
+typedef struct MscriptDataServer MscriptDataServer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mscript_data_server_default_config(MscriptDataServerConfig_t * config);
+bool mscript_data_server_parse_policy(char const * text, MscriptSlowClientPolicy_t * p_policy);
+MscriptDataServer_t * mscript_data_server_create(MscriptDataServerConfig_t const * config);
+void mscript_data_server_destroy(MscriptDataServer_t * server);
+void mscript_data_server_publish(MscriptDataServer_t * server, unsigned int device, int channel,
+	MscriptEvent_t const * event);
+void mscript_data_server_get_stats(MscriptDataServer_t * server, MscriptDataServerStats_t * stats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,778 @@
+/**
+ * \file
+ * Data server implementation for Linux.
+ *
+ * See `mscript_data_server.h` for a description of this module.
+ *
+ * One background thread accepts the clients, reads their subscriptions and
+ * sends their queues, using non-blocking sockets and `poll()`. Publishing
+ * threads only encode the package and append it to the queues, and wake the
+ * server thread through a pipe if it is not awake already.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_data_server.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "mscript_debug_printf.h"
+#include "mscript_thread.h"
+
+/// Maximum size of an encoded package, in either format.
+#define MAX_FRAME_SIZE 1024
+
+/// Maximum length of a line received from a client.
+#define MAX_LINE_SIZE 256
+
+/// Maximum number of packages in the send queue of a client.
+#define MAX_QUEUE_SIZE 1000000
+
+/// Size of the header of a binary frame, including the size field.
+#define BINARY_HEADER_SIZE 32
+
+/// Size of each value in a binary frame.
+#define BINARY_VALUE_SIZE 12
+
+/// Maximum time to send the remaining queues when the server is stopped.
+#define STOP_TIMEOUT_MS 1000
+
+/// Value of the status and range in a binary frame if not present.
+#define NO_METADATA 0xFF
+
+/** Format in which a client receives the packages. */
+typedef enum {
+	FORMAT_NDJSON,
+	FORMAT_BINARY,
+	NR_OF_FORMATS,
+} Format_t;
+
+/** An encoded package. */
+typedef struct {
+	size_t size;
+	char data[MAX_FRAME_SIZE];
+} Frame_t;
+
+/** A connected client. The queue and subscription are protected by the mutex. */
+typedef struct {
+	/** The socket, or -1 if this entry is not used. */
+	int fd;
+	bool is_subscribed;
+	/** Device to send, or 0 for all devices. */
+	unsigned int device;
+	bool is_all_channels;
+	int channel;
+	Format_t format;
+	MscriptSlowClientPolicy_t policy;
+	/** Set to make the server thread disconnect the client. */
+	bool is_closing;
+	/** The send queue, `queue_size` entries. */
+	Frame_t * queue;
+	size_t head;
+	size_t count;
+	/** The frame being sent (only used by the server thread). */
+	Frame_t sending;
+	size_t sent;
+	/** Partial line received from the client (only used by the server thread). */
+	char line[MAX_LINE_SIZE];
+	size_t line_length;
+} Client_t;
+
+struct MscriptDataServer {
+	size_t queue_size;
+	MscriptSlowClientPolicy_t policy;
+	int listen_fd;
+	/** Path of the UNIX domain socket, to remove it, or empty for TCP. */
+	char unix_path[sizeof(struct sockaddr_un)];
+	/** Written to wake the server thread. */
+	int wake_pipe[2];
+	MscriptThread_t thread;
+	MscriptMutex_t mutex;
+	/** `true` if the server thread has been woken and not yet run. */
+	bool is_wake_pending;
+	bool is_stopping;
+	/** Time at which the server was stopped (see `mscript_get_time_ms()`). */
+	uint32_t stop_time_ms;
+	uint64_t sequence;
+	MscriptDataServerStats_t stats;
+	Client_t clients[MSCRIPT_DATA_SERVER_MAX_CLIENTS];
+};
+
+/**
+ * Get the default configuration of a server, listening on TCP port 8765 of
+ * the local host.
+ */
+void mscript_data_server_default_config(MscriptDataServerConfig_t * config)
+{
+	config->address = "8765";
+	config->queue_size = MSCRIPT_DATA_SERVER_DEFAULT_QUEUE_SIZE;
+	config->policy = MSCRIPT_SLOW_CLIENT_DROP_OLDEST;
+}
+
+/**
+ * Parse the name of a slow client policy ("drop-newest", "drop-oldest" or
+ * "disconnect").
+ *
+ * \return `true` on success, `false` if the name is not valid
+ */
+bool mscript_data_server_parse_policy(char const * text, MscriptSlowClientPolicy_t * p_policy)
+{
+	if (!strcmp(text, "drop-newest")) {
+		*p_policy = MSCRIPT_SLOW_CLIENT_DROP_NEWEST;
+	} else if (!strcmp(text, "drop-oldest")) {
+		*p_policy = MSCRIPT_SLOW_CLIENT_DROP_OLDEST;
+	} else if (!strcmp(text, "disconnect")) {
+		*p_policy = MSCRIPT_SLOW_CLIENT_DISCONNECT;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Make a file descriptor non-blocking and close it on exec.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool set_nonblocking(int fd)
+{
+	int flags = fcntl(fd, F_GETFL);
+	return (flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0)
+		&& (fcntl(fd, F_SETFD, FD_CLOEXEC) == 0);
+}
+
+/**
+ * Create the listening socket of a server.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool open_listen_socket(MscriptDataServer_t * server, char const * address)
+{
+	struct sockaddr_storage storage;
+	socklen_t length;
+	memset(&storage, 0, sizeof(storage));
+	if (strchr(address, '/') != NULL) {
+		struct sockaddr_un * un = (struct sockaddr_un *)&storage;
+		if (strlen(address) >= sizeof(un->sun_path)) {
+			DEBUG_PRINTF("ERROR: Socket path is too long: %s\n", address);
+			return false;
+		}
+		un->sun_family = AF_UNIX;
+		strcpy(un->sun_path, address);
+		strcpy(server->unix_path, address);
+		length = sizeof(struct sockaddr_un);
+		// Remove the socket of a previous run.
+		unlink(address);
+	} else {
+		struct sockaddr_in * in = (struct sockaddr_in *)&storage;
+		in->sin_family = AF_INET;
+		in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		char const * port = strrchr(address, ':');
+		if (port != NULL) {
+			char host[INET_ADDRSTRLEN] = "";
+			size_t host_length = (size_t)(port - address);
+			if (host_length < sizeof(host)) {
+				memcpy(host, address, host_length);
+				host[host_length] = '\0';
+			}
+			if (inet_pton(AF_INET, host, &in->sin_addr) != 1) {
+				DEBUG_PRINTF("ERROR: Invalid host address: %s\n", address);
+				return false;
+			}
+			++port;
+		} else {
+			port = address;
+		}
+		char * end;
+		long number = strtol(port, &end, 10);
+		if ((*port == '\0') || (*end != '\0') || (number < 1) || (number > 65535)) {
+			DEBUG_PRINTF("ERROR: Invalid port: %s\n", address);
+			return false;
+		}
+		in->sin_port = htons((uint16_t)number);
+		length = sizeof(struct sockaddr_in);
+	}
+
+	server->listen_fd = socket(storage.ss_family, SOCK_STREAM, 0);
+	if (server->listen_fd < 0) {
+		return false;
+	}
+	int reuse = 1;
+	if (storage.ss_family == AF_INET) {
+		setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	}
+	if (!set_nonblocking(server->listen_fd)
+		|| (bind(server->listen_fd, (struct sockaddr *)&storage, length) != 0)
+		|| (listen(server->listen_fd, MSCRIPT_DATA_SERVER_MAX_CLIENTS) != 0)) {
+		DEBUG_PRINTF("ERROR: Could not listen on %s: %s\n", address, strerror(errno));
+		close(server->listen_fd);
+		server->listen_fd = -1;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Wake the server thread, if it is not awake already. The mutex must be locked.
+ */
+static void wake_server(MscriptDataServer_t * server)
+{
+	if (!server->is_wake_pending) {
+		server->is_wake_pending = true;
+		char byte = 0;
+		if (write(server->wake_pipe[1], &byte, 1) < 0) {
+			DEBUG_PRINTF("ERROR: Could not wake the data server: %s\n", strerror(errno));
+		}
+	}
+}
+
+/**
+ * Disconnect a client. Called from the server thread.
+ */
+static void close_client(MscriptDataServer_t * server, Client_t * client)
+{
+	mscript_mutex_lock(&server->mutex);
+	close(client->fd);
+	client->fd = -1;
+	free(client->queue);
+	client->queue = NULL;
+	mscript_mutex_unlock(&server->mutex);
+}
+
+/**
+ * Accept a new client. Called from the server thread.
+ */
+static void accept_client(MscriptDataServer_t * server)
+{
+	int fd = accept(server->listen_fd, NULL, NULL);
+	if (fd < 0) {
+		return;
+	}
+	if (!set_nonblocking(fd)) {
+		close(fd);
+		return;
+	}
+	Frame_t * queue = malloc(server->queue_size * sizeof(Frame_t));
+	mscript_mutex_lock(&server->mutex);
+	Client_t * client = NULL;
+	for (size_t i = 0; i < MSCRIPT_DATA_SERVER_MAX_CLIENTS; ++i) {
+		if (server->clients[i].fd < 0) {
+			client = &server->clients[i];
+			break;
+		}
+	}
+	if ((client == NULL) || (queue == NULL)) {
+		mscript_mutex_unlock(&server->mutex);
+		DEBUG_PRINTF("ERROR: Too many data clients.\n");
+		free(queue);
+		close(fd);
+		return;
+	}
+	memset(client, 0, sizeof(Client_t));
+	client->fd = fd;
+	client->queue = queue;
+	client->policy = server->policy;
+	++server->stats.nr_of_clients;
+	mscript_mutex_unlock(&server->mutex);
+}
+
+/**
+ * Handle a line received from a client. The mutex must be locked.
+ *
+ * \return `true` on success, `false` if the line is not a valid subscription
+ */
+static bool handle_line(Client_t * client, char * line)
+{
+	char * save;
+	char * token = strtok_r(line, " \t\r", &save);
+	if (token == NULL) {
+		return true;
+	}
+	if (strcmp(token, "subscribe")) {
+		return false;
+	}
+	unsigned int device = 0;
+	bool is_all_channels = true;
+	int channel = MSCRIPT_DATA_NO_CHANNEL;
+	Format_t format = FORMAT_NDJSON;
+	MscriptSlowClientPolicy_t policy = client->policy;
+	while ((token = strtok_r(NULL, " \t\r", &save)) != NULL) {
+		char * value = strchr(token, '=');
+		if (value == NULL) {
+			return false;
+		}
+		*value++ = '\0';
+		if (!strcmp(token, "device")) {
+			device = (unsigned int)strtoul(value, NULL, 10);
+		} else if (!strcmp(token, "channel")) {
+			is_all_channels = !strcmp(value, "all");
+			channel = !strcmp(value, "none") ? MSCRIPT_DATA_NO_CHANNEL : atoi(value);
+		} else if (!strcmp(token, "format") && !strcmp(value, "ndjson")) {
+			format = FORMAT_NDJSON;
+		} else if (!strcmp(token, "format") && !strcmp(value, "binary")) {
+			format = FORMAT_BINARY;
+		} else if (!strcmp(token, "policy")) {
+			if (!mscript_data_server_parse_policy(value, &policy)) {
+				return false;
+			}
+		} else {
+			return false;
+		}
+	}
+	client->is_subscribed = true;
+	client->device = device;
+	client->is_all_channels = is_all_channels;
+	client->channel = channel;
+	client->format = format;
+	client->policy = policy;
+	// Packages of the previous subscription are not sent anymore.
+	client->count = 0;
+	return true;
+}
+
+/**
+ * Read the lines received from a client. Called from the server thread.
+ *
+ * \return `true` on success, `false` if the client should be disconnected
+ */
+static bool receive_lines(MscriptDataServer_t * server, Client_t * client)
+{
+	char buf[MAX_LINE_SIZE];
+	ssize_t n = recv(client->fd, buf, sizeof(buf), 0);
+	if (n == 0) {
+		return false;
+	}
+	if (n < 0) {
+		return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+	}
+	for (ssize_t i = 0; i < n; ++i) {
+		if (buf[i] != '\n') {
+			if (client->line_length == MAX_LINE_SIZE - 1) {
+				return false;
+			}
+			client->line[client->line_length++] = buf[i];
+			continue;
+		}
+		client->line[client->line_length] = '\0';
+		client->line_length = 0;
+		mscript_mutex_lock(&server->mutex);
+		bool is_valid = handle_line(client, client->line);
+		mscript_mutex_unlock(&server->mutex);
+		if (!is_valid) {
+			DEBUG_PRINTF("ERROR: Invalid request of data client.\n");
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Send the queue of a client, until the socket would block. Called from the
+ * server thread.
+ *
+ * \return `true` on success, `false` if the client should be disconnected
+ */
+static bool send_queue(MscriptDataServer_t * server, Client_t * client)
+{
+	for (;;) {
+		if (client->sent == client->sending.size) {
+			mscript_mutex_lock(&server->mutex);
+			if (client->count == 0) {
+				mscript_mutex_unlock(&server->mutex);
+				return true;
+			}
+			Frame_t const * frame = &client->queue[client->head];
+			client->sending.size = frame->size;
+			memcpy(client->sending.data, frame->data, frame->size);
+			client->head = (client->head + 1) % server->queue_size;
+			--client->count;
+			mscript_mutex_unlock(&server->mutex);
+			client->sent = 0;
+		}
+		ssize_t n = send(client->fd, client->sending.data + client->sent,
+			client->sending.size - client->sent, MSG_NOSIGNAL);
+		if (n < 0) {
+			return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+		}
+		client->sent += (size_t)n;
+	}
+}
+
+/**
+ * The server thread.
+ */
+static void run_server(void * arg)
+{
+	MscriptDataServer_t * server = arg;
+	struct pollfd fds[MSCRIPT_DATA_SERVER_MAX_CLIENTS + 2];
+	Client_t * clients[MSCRIPT_DATA_SERVER_MAX_CLIENTS];
+	for (;;) {
+		// Clients that were marked by a publishing thread are disconnected
+		// here, since only this thread uses the sockets.
+		for (size_t i = 0; i < MSCRIPT_DATA_SERVER_MAX_CLIENTS; ++i) {
+			Client_t * client = &server->clients[i];
+			mscript_mutex_lock(&server->mutex);
+			bool is_closing = (client->fd >= 0) && client->is_closing;
+			mscript_mutex_unlock(&server->mutex);
+			if (is_closing) {
+				close_client(server, client);
+			}
+		}
+
+		nfds_t nr_of_fds = 2;
+		fds[0].fd = server->wake_pipe[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = server->listen_fd;
+		fds[1].events = POLLIN;
+		bool has_pending = false;
+		mscript_mutex_lock(&server->mutex);
+		for (size_t i = 0; i < MSCRIPT_DATA_SERVER_MAX_CLIENTS; ++i) {
+			Client_t * client = &server->clients[i];
+			if (client->fd < 0) {
+				continue;
+			}
+			clients[nr_of_fds - 2] = client;
+			fds[nr_of_fds].fd = client->fd;
+			fds[nr_of_fds].events = POLLIN;
+			if ((client->count > 0) || (client->sent < client->sending.size)) {
+				fds[nr_of_fds].events |= POLLOUT;
+				has_pending = true;
+			}
+			++nr_of_fds;
+		}
+		// When stopping, the remaining queues are sent first, but a client
+		// that does not read can not delay stopping for long.
+		bool is_stopping = server->is_stopping;
+		mscript_mutex_unlock(&server->mutex);
+		if (is_stopping && (!has_pending
+			|| ((uint32_t)(mscript_get_time_ms() - server->stop_time_ms) >= STOP_TIMEOUT_MS))) {
+			break;
+		}
+
+		if (poll(fds, nr_of_fds, is_stopping ? 10 : -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			DEBUG_PRINTF("ERROR: Data server failed: %s\n", strerror(errno));
+			break;
+		}
+		if (fds[0].revents & POLLIN) {
+			char buf[64];
+			while (read(server->wake_pipe[0], buf, sizeof(buf)) > 0) {
+			}
+			mscript_mutex_lock(&server->mutex);
+			server->is_wake_pending = false;
+			mscript_mutex_unlock(&server->mutex);
+		}
+		if (fds[1].revents & POLLIN) {
+			accept_client(server);
+		}
+		for (nfds_t i = 2; i < nr_of_fds; ++i) {
+			Client_t * client = clients[i - 2];
+			short revents = fds[i].revents;
+			bool is_ok = true;
+			if (revents & (POLLIN | POLLHUP | POLLERR)) {
+				is_ok = receive_lines(server, client);
+			}
+			// Also try to send packages queued since poll() was called.
+			if (is_ok) {
+				is_ok = send_queue(server, client);
+			}
+			if (!is_ok) {
+				close_client(server, client);
+			}
+		}
+	}
+}
+
+/**
+ * Create a server and start listening.
+ *
+ * \return The server, or NULL on failure.
+ */
+MscriptDataServer_t * mscript_data_server_create(MscriptDataServerConfig_t const * config)
+{
+	if ((config->queue_size < 1) || (config->queue_size > MAX_QUEUE_SIZE)) {
+		return NULL;
+	}
+	MscriptDataServer_t * server = calloc(1, sizeof(MscriptDataServer_t));
+	if (server == NULL) {
+		return NULL;
+	}
+	server->queue_size = config->queue_size;
+	server->policy = config->policy;
+	for (size_t i = 0; i < MSCRIPT_DATA_SERVER_MAX_CLIENTS; ++i) {
+		server->clients[i].fd = -1;
+	}
+	if (!open_listen_socket(server, config->address)) {
+		free(server);
+		return NULL;
+	}
+	if (pipe(server->wake_pipe) != 0) {
+		close(server->listen_fd);
+		free(server);
+		return NULL;
+	}
+	if (!set_nonblocking(server->wake_pipe[0]) || !set_nonblocking(server->wake_pipe[1])) {
+		close(server->wake_pipe[0]);
+		close(server->wake_pipe[1]);
+		close(server->listen_fd);
+		free(server);
+		return NULL;
+	}
+	mscript_mutex_init(&server->mutex);
+	if (!mscript_thread_create(&server->thread, run_server, server)) {
+		mscript_mutex_destroy(&server->mutex);
+		close(server->wake_pipe[0]);
+		close(server->wake_pipe[1]);
+		close(server->listen_fd);
+		free(server);
+		return NULL;
+	}
+	return server;
+}
+
+/**
+ * Stop a server and disconnect all clients.
+ *
+ * The packages that are still in the send queues are sent first, for at most
+ * one second.
+ */
+void mscript_data_server_destroy(MscriptDataServer_t * server)
+{
+	mscript_mutex_lock(&server->mutex);
+	server->is_stopping = true;
+	server->stop_time_ms = mscript_get_time_ms();
+	server->is_wake_pending = false;
+	wake_server(server);
+	mscript_mutex_unlock(&server->mutex);
+	mscript_thread_join(server->thread);
+
+	for (size_t i = 0; i < MSCRIPT_DATA_SERVER_MAX_CLIENTS; ++i) {
+		if (server->clients[i].fd >= 0) {
+			close(server->clients[i].fd);
+			free(server->clients[i].queue);
+		}
+	}
+	close(server->listen_fd);
+	if (server->unix_path[0] != '\0') {
+		unlink(server->unix_path);
+	}
+	close(server->wake_pipe[0]);
+	close(server->wake_pipe[1]);
+	mscript_mutex_destroy(&server->mutex);
+	free(server);
+}
+
+/**
+ * Append a number to a binary frame, in little-endian byte order.
+ */
+static void put_uint(Frame_t * frame, uint64_t value, size_t nr_of_bytes)
+{
+	for (size_t i = 0; i < nr_of_bytes; ++i) {
+		frame->data[frame->size++] = (char)((value >> (8 * i)) & 0xFF);
+	}
+}
+
+/**
+ * Encode a package as a binary frame.
+ */
+static void encode_binary(Frame_t * frame, uint64_t sequence, unsigned int device, int channel,
+	MscriptEvent_t const * event)
+{
+	MscriptDataPackage_t const * package = event->package;
+	frame->size = 0;
+	put_uint(frame, BINARY_HEADER_SIZE - 2 + package->nr_of_sub_packages * BINARY_VALUE_SIZE, 2);
+	put_uint(frame, MSCRIPT_DATA_FRAME_PACKAGE, 1);
+	put_uint(frame, package->nr_of_sub_packages, 1);
+	put_uint(frame, sequence, 8);
+	put_uint(frame, event->receive_time_us, 8);
+	put_uint(frame, device, 2);
+	put_uint(frame, (uint16_t)(int16_t)channel, 2);
+	put_uint(frame, event->meas_loop_index, 4);
+	put_uint(frame, event->package_index, 4);
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		MscriptSubPackage_t const * sub_package = &package->sub_packages[i];
+		uint64_t bits;
+		memcpy(&bits, &sub_package->value, sizeof(bits));
+		put_uint(frame, sub_package->variable_type, 2);
+		put_uint(frame, (sub_package->metadata.status >= 0)
+			? (uint64_t)sub_package->metadata.status : NO_METADATA, 1);
+		put_uint(frame, (sub_package->metadata.range >= 0)
+			? (uint64_t)sub_package->metadata.range : NO_METADATA, 1);
+		put_uint(frame, bits, 8);
+	}
+}
+
+/**
+ * Append text to an NDJSON frame.
+ */
+static void put_text(Frame_t * frame, char const * format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(frame->data + frame->size, MAX_FRAME_SIZE - frame->size, format, args);
+	va_end(args);
+	if (n > 0) {
+		frame->size += ((size_t)n < MAX_FRAME_SIZE - frame->size)
+			? (size_t)n : MAX_FRAME_SIZE - frame->size - 1;
+	}
+}
+
+/**
+ * Encode a package as one line of NDJSON.
+ */
+static void encode_ndjson(Frame_t * frame, uint64_t sequence, unsigned int device, int channel,
+	MscriptEvent_t const * event)
+{
+	MscriptDataPackage_t const * package = event->package;
+	frame->size = 0;
+	put_text(frame, "{\"seq\":%llu,\"time_us\":%llu,\"device\":%u,\"channel\":",
+		(unsigned long long)sequence, (unsigned long long)event->receive_time_us, device);
+	if (channel == MSCRIPT_DATA_NO_CHANNEL) {
+		put_text(frame, "null");
+	} else {
+		put_text(frame, "%d", channel);
+	}
+	put_text(frame, ",\"meas_loop\":%u,\"package\":%u,\"values\":[", event->meas_loop_index,
+		event->package_index);
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		MscriptSubPackage_t const * sub_package = &package->sub_packages[i];
+		unsigned int variable_type = sub_package->variable_type;
+		put_text(frame, "%s{\"type\":\"%c%c\",\"value\":", (i > 0) ? "," : "",
+			'a' + (variable_type / 26) % 26, 'a' + variable_type % 26);
+		// JSON has no representation of NaN and infinity.
+		if (isfinite(sub_package->value)) {
+			put_text(frame, "%.15g", sub_package->value);
+		} else {
+			put_text(frame, "null");
+		}
+		if (sub_package->metadata.status >= 0) {
+			put_text(frame, ",\"status\":%d", sub_package->metadata.status);
+		}
+		if (sub_package->metadata.range >= 0) {
+			put_text(frame, ",\"range\":%d", sub_package->metadata.range);
+		}
+		put_text(frame, "}");
+	}
+	put_text(frame, "]}\n");
+}
+
+/**
+ * Send a data package to all clients that subscribed to it.
+ *
+ * This only encodes the package and appends it to the send queues of the
+ * clients; it never waits for the network.
+ *
+ * \param server The server.
+ * \param device The number of the device.
+ * \param channel The channel of a multi-channel instrument or multiplexer,
+ *                or `MSCRIPT_DATA_NO_CHANNEL`.
+ * \param event A `MSCRIPT_EVENT_PACKAGE` event with a parsed package.
+ */
+void mscript_data_server_publish(MscriptDataServer_t * server, unsigned int device, int channel,
+	MscriptEvent_t const * event)
+{
+	if ((event->type != MSCRIPT_EVENT_PACKAGE) || (event->package == NULL)) {
+		return;
+	}
+	// Encoded on first use, so each format is encoded at most once.
+	Frame_t frames[NR_OF_FORMATS];
+	bool is_encoded[NR_OF_FORMATS] = { false };
+	bool has_queued = false;
+
+	mscript_mutex_lock(&server->mutex);
+	uint64_t sequence = server->sequence++;
+	++server->stats.nr_of_packages;
+	for (size_t i = 0; i < MSCRIPT_DATA_SERVER_MAX_CLIENTS; ++i) {
+		Client_t * client = &server->clients[i];
+		if ((client->fd < 0) || !client->is_subscribed || client->is_closing
+			|| ((client->device != 0) && (client->device != device))
+			|| (!client->is_all_channels && (client->channel != channel))) {
+			continue;
+		}
+		Frame_t * frame = &frames[client->format];
+		if (!is_encoded[client->format]) {
+			if (client->format == FORMAT_BINARY) {
+				encode_binary(frame, sequence, device, channel, event);
+			} else {
+				encode_ndjson(frame, sequence, device, channel, event);
+			}
+			is_encoded[client->format] = true;
+		}
+
+		if (client->count == server->queue_size) {
+			++server->stats.nr_of_dropped;
+			if (client->policy == MSCRIPT_SLOW_CLIENT_DROP_NEWEST) {
+				continue;
+			}
+			if (client->policy == MSCRIPT_SLOW_CLIENT_DISCONNECT) {
+				client->is_closing = true;
+				++server->stats.nr_of_slow_disconnects;
+				has_queued = true;
+				continue;
+			}
+			client->head = (client->head + 1) % server->queue_size;
+			--client->count;
+		}
+		Frame_t * entry = &client->queue[(client->head + client->count) % server->queue_size];
+		entry->size = frame->size;
+		memcpy(entry->data, frame->data, frame->size);
+		++client->count;
+		++server->stats.nr_of_queued;
+		has_queued = true;
+	}
+	if (has_queued) {
+		wake_server(server);
+	}
+	mscript_mutex_unlock(&server->mutex);
+}
+
+/**
+ * Get the statistics of a server.
+ */
+void mscript_data_server_get_stats(MscriptDataServer_t * server, MscriptDataServerStats_t * stats)
+{
+	mscript_mutex_lock(&server->mutex);
+	*stats = server->stats;
+	mscript_mutex_unlock(&server->mutex);
+}
@@ -0,0 +1,90 @@
+/**
+ * \file
+ * Data server for Windows (not supported).
+ *
+ * See `mscript_data_server.h` for a description of this module. On Windows,
+ * a server can not be created.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_data_server.h"
+
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+void mscript_data_server_default_config(MscriptDataServerConfig_t * config)
+{
+	config->address = "8765";
+	config->queue_size = MSCRIPT_DATA_SERVER_DEFAULT_QUEUE_SIZE;
+	config->policy = MSCRIPT_SLOW_CLIENT_DROP_OLDEST;
+}
+
+bool mscript_data_server_parse_policy(char const * text, MscriptSlowClientPolicy_t * p_policy)
+{
+	if (!strcmp(text, "drop-newest")) {
+		*p_policy = MSCRIPT_SLOW_CLIENT_DROP_NEWEST;
+	} else if (!strcmp(text, "drop-oldest")) {
+		*p_policy = MSCRIPT_SLOW_CLIENT_DROP_OLDEST;
+	} else if (!strcmp(text, "disconnect")) {
+		*p_policy = MSCRIPT_SLOW_CLIENT_DISCONNECT;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+MscriptDataServer_t * mscript_data_server_create(MscriptDataServerConfig_t const * config)
+{
+	(void)config;
+	DEBUG_PRINTF("ERROR: The data server is not supported on Windows.\n");
+	return NULL;
+}
+
+void mscript_data_server_destroy(MscriptDataServer_t * server)
+{
+	(void)server;
+}
+
+void mscript_data_server_publish(MscriptDataServer_t * server, unsigned int device, int channel,
+	MscriptEvent_t const * event)
+{
+	(void)server;
+	(void)device;
+	(void)channel;
+	(void)event;
+}
+
+void mscript_data_server_get_stats(MscriptDataServer_t * server, MscriptDataServerStats_t * stats)
+{
+	(void)server;
+	memset(stats, 0, sizeof(MscriptDataServerStats_t));
+}
@@ -0,0 +1,425 @@
+/**
+ * \file
+ * Per-channel demultiplexer for multi-channel instruments.
+ *
+ * See `mscript_demux.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_demux.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+#include "mscript_thread.h"
+
+/** One queued event. */
+typedef struct {
+	MscriptEventType_t type;
+	unsigned int meas_loop_index;
+	unsigned int package_index;
+	uint32_t gap_ms;
+	MscriptLoopPrediction_t const * loop;
+	char response[MSCRIPT_READ_BUFFER_SIZE];
+} QueueEntry_t;
+
+/** State of one channel. */
+typedef struct {
+	unsigned int channel;
+	MscriptSink_t sink;
+	MscriptThread_t thread;
+	MscriptMutex_t mutex;
+	/** Signaled when an entry is added to the queue or `stop` is set. */
+	MscriptCondition_t queued;
+	/** Signaled when the worker has processed an entry. */
+	MscriptCondition_t processed;
+	/** Index of the oldest entry in `queue`. */
+	size_t head;
+	/** Number of entries in `queue`. */
+	size_t count;
+	bool stop;
+	/** Number of the current package in the measurement loop (for this channel). */
+	unsigned int package_index;
+	MscriptChannelStats_t stats;
+	QueueEntry_t queue[MSCRIPT_DEMUX_QUEUE_LENGTH];
+} Channel_t;
+
+struct MscriptDemux {
+	MscriptChannelSinkFactory_t create_sink;
+	void * context;
+	Channel_t * channels[MSCRIPT_DEMUX_MAX_CHANNELS];
+	/** `true` between the start and end of a measurement loop. */
+	bool is_in_meas_loop;
+	/** The `MSCRIPT_EVENT_MEAS_LOOP_START` event of the current loop. */
+	QueueEntry_t meas_loop_start;
+	/** `true` after the worker threads have been stopped. */
+	bool is_finished;
+};
+
+/**
+ * Main function of the worker thread of a channel.
+ *
+ * The entries are processed in the order they were queued, until `stop` is set
+ * and the queue is empty. The entry is processed in place; its slot is only
+ * released afterwards, so the acquisition thread does not overwrite it.
+ */
+static void channel_main(void * arg)
+{
+	Channel_t * channel = arg;
+	MscriptDataPackage_t package;
+	MscriptEvent_t event;
+	memset(&event, 0, sizeof(event));
+
+	mscript_mutex_lock(&channel->mutex);
+	for (;;) {
+		while ((channel->count == 0) && !channel->stop) {
+			mscript_condition_wait(&channel->queued, &channel->mutex);
+		}
+		if (channel->count == 0) {
+			break;
+		}
+		QueueEntry_t const * entry = &channel->queue[channel->head];
+		bool failed = channel->stats.failed;
+		mscript_mutex_unlock(&channel->mutex);
+
+		if (!failed) {
+			event.type = entry->type;
+			event.response = entry->response;
+			event.meas_loop_index = entry->meas_loop_index;
+			event.package_index = entry->package_index;
+			event.gap_ms = entry->gap_ms;
+			event.loop = entry->loop;
+			event.package = NULL;
+			if (entry->type == MSCRIPT_EVENT_PACKAGE) {
+				if (parse_data_package(entry->response, &package)) {
+					event.package = &package;
+				} else {
+					failed = true;
+				}
+			}
+			if (!failed && !channel->sink.handle_event(channel->sink.context, &event)) {
+				DEBUG_PRINTF("Channel %u stopped by sink.\n", channel->channel);
+				failed = true;
+			}
+		}
+
+		mscript_mutex_lock(&channel->mutex);
+		channel->stats.failed = failed;
+		channel->head = (channel->head + 1) % MSCRIPT_DEMUX_QUEUE_LENGTH;
+		--channel->count;
+		mscript_condition_signal(&channel->processed);
+	}
+	mscript_mutex_unlock(&channel->mutex);
+}
+
+/**
+ * Create a channel and start its worker thread.
+ *
+ * \return The channel, or NULL on failure.
+ */
+static Channel_t * create_channel(MscriptDemux_t * demux, unsigned int number)
+{
+	Channel_t * channel = calloc(1, sizeof(Channel_t));
+	if (channel == NULL) {
+		return NULL;
+	}
+	channel->channel = number;
+	if (!demux->create_sink(demux->context, number, &channel->sink)) {
+		free(channel);
+		return NULL;
+	}
+	assert(channel->sink.handle_event != NULL);
+	mscript_mutex_init(&channel->mutex);
+	mscript_condition_init(&channel->queued);
+	mscript_condition_init(&channel->processed);
+	if (!mscript_thread_create(&channel->thread, channel_main, channel)) {
+		mscript_condition_destroy(&channel->processed);
+		mscript_condition_destroy(&channel->queued);
+		mscript_mutex_destroy(&channel->mutex);
+		free(channel);
+		return NULL;
+	}
+	return channel;
+}
+
+/**
+ * Add an event to the queue of a channel, waiting if the queue is full.
+ *
+ * \param channel The channel.
+ * \param event The event.
+ * \param package_index The number of the package within the channel.
+ *
+ * \return `false` if the channel has failed, `true` otherwise
+ */
+static bool enqueue(Channel_t * channel, MscriptEvent_t const * event, unsigned int package_index)
+{
+	mscript_mutex_lock(&channel->mutex);
+	if (channel->count == MSCRIPT_DEMUX_QUEUE_LENGTH) {
+		++channel->stats.nr_of_waits;
+		while (channel->count == MSCRIPT_DEMUX_QUEUE_LENGTH) {
+			mscript_condition_wait(&channel->processed, &channel->mutex);
+		}
+	}
+	bool success = !channel->stats.failed;
+	if (success) {
+		QueueEntry_t * entry = &channel->queue[
+			(channel->head + channel->count) % MSCRIPT_DEMUX_QUEUE_LENGTH];
+		mscript_mutex_unlock(&channel->mutex);
+
+		// The worker does not use this slot until `count` is incremented.
+		entry->type = event->type;
+		entry->meas_loop_index = event->meas_loop_index;
+		entry->package_index = package_index;
+		entry->gap_ms = event->gap_ms;
+		entry->loop = event->loop;
+		strncpy(entry->response, event->response, MSCRIPT_READ_BUFFER_SIZE - 1);
+		entry->response[MSCRIPT_READ_BUFFER_SIZE - 1] = '\0';
+
+		mscript_mutex_lock(&channel->mutex);
+		++channel->count;
+		mscript_condition_signal(&channel->queued);
+	}
+	mscript_mutex_unlock(&channel->mutex);
+	return success;
+}
+
+/**
+ * Find the channel number in a data package, without parsing the package.
+ *
+ * \param response The response line containing the data package.
+ * \param p_channel[out] The channel number, or 0 if the package does not
+ *                       contain a channel variable.
+ *
+ * \return `true` on success, `false` if the channel number is invalid
+ */
+static bool find_channel(char const * response, unsigned int * p_channel)
+{
+	*p_channel = 0;
+	// Check the variable type of each sub package. The channel number is an
+	// integer value, so it is sent without SI prefix.
+	for (char const * p = response + 1; p != NULL; p = strchr(p, ';')) {
+		if (*p == ';') {
+			++p;
+		}
+		if ((p[0] == 'e') && (p[1] == 'a')) {
+			if (strlen(p) < 10) {
+				return false;
+			}
+			char value_str[8];
+			memcpy(value_str, p + 2, 7);
+			value_str[7] = '\0';
+			char * end;
+			long value = strtol(value_str, &end, 16) - MSCRIPT_PARAMETER_OFFSET;
+			if ((*end != '\0') || ((p[9] != 'i') && (p[9] != ' '))
+				|| (value < 0) || (value >= MSCRIPT_DEMUX_MAX_CHANNELS)) {
+				return false;
+			}
+			*p_channel = (unsigned int)value;
+			return true;
+		}
+	}
+	return true;
+}
+
+/**
+ * Create a demultiplexer.
+ *
+ * No worker threads are started until the first package is received.
+ *
+ * \param create_sink Function that creates the sink of a channel.
+ * \param context Context passed to `create_sink`.
+ *
+ * \return The demultiplexer, or NULL on failure.
+ */
+MscriptDemux_t * mscript_demux_create(MscriptChannelSinkFactory_t create_sink, void * context)
+{
+	assert(create_sink != NULL);
+
+	MscriptDemux_t * demux = calloc(1, sizeof(MscriptDemux_t));
+	if (demux == NULL) {
+		return NULL;
+	}
+	demux->create_sink = create_sink;
+	demux->context = context;
+	return demux;
+}
+
+/**
+ * Process all queued events and stop the worker threads.
+ *
+ * The channel sinks are not called anymore after this function returns, so
+ * their resources can be released afterwards. The statistics of the channels
+ * remain available until the demultiplexer is destroyed.
+ *
+ * \return `true` if all channels processed their events successfully,
+ *         `false` otherwise
+ */
+bool mscript_demux_finish(MscriptDemux_t * demux)
+{
+	if (!demux->is_finished) {
+		// Stop all workers first, so they finish their queues in parallel.
+		for (unsigned int i = 0; i < MSCRIPT_DEMUX_MAX_CHANNELS; ++i) {
+			Channel_t * channel = demux->channels[i];
+			if (channel != NULL) {
+				mscript_mutex_lock(&channel->mutex);
+				channel->stop = true;
+				mscript_condition_signal(&channel->queued);
+				mscript_mutex_unlock(&channel->mutex);
+			}
+		}
+		for (unsigned int i = 0; i < MSCRIPT_DEMUX_MAX_CHANNELS; ++i) {
+			if (demux->channels[i] != NULL) {
+				mscript_thread_join(demux->channels[i]->thread);
+			}
+		}
+		demux->is_finished = true;
+	}
+
+	bool success = true;
+	for (unsigned int i = 0; i < MSCRIPT_DEMUX_MAX_CHANNELS; ++i) {
+		if ((demux->channels[i] != NULL) && demux->channels[i]->stats.failed) {
+			success = false;
+		}
+	}
+	return success;
+}
+
+/**
+ * Free a demultiplexer, stopping the worker threads first if
+ * `mscript_demux_finish()` was not called.
+ */
+void mscript_demux_destroy(MscriptDemux_t * demux)
+{
+	mscript_demux_finish(demux);
+	for (unsigned int i = 0; i < MSCRIPT_DEMUX_MAX_CHANNELS; ++i) {
+		Channel_t * channel = demux->channels[i];
+		if (channel != NULL) {
+			mscript_condition_destroy(&channel->processed);
+			mscript_condition_destroy(&channel->queued);
+			mscript_mutex_destroy(&channel->mutex);
+			free(channel);
+		}
+	}
+	free(demux);
+}
+
+/**
+ * Route an event of an acquisition to the channels.
+ *
+ * This function is an `MscriptEventHandler_t`; use it with the demultiplexer
+ * as context as the sink of an acquisition, or call it from another sink.
+ *
+ * \return `true` to continue, `false` if a channel has failed
+ */
+bool mscript_demux_handle_event(void * context, MscriptEvent_t const * event)
+{
+	MscriptDemux_t * demux = context;
+	assert(!demux->is_finished);
+
+	if (event->type == MSCRIPT_EVENT_PACKAGE) {
+		unsigned int number;
+		if (!find_channel(event->response, &number)) {
+			DEBUG_PRINTF("ERROR: Invalid channel number in package: %s", event->response);
+			return false;
+		}
+		Channel_t * channel = demux->channels[number];
+		if (channel == NULL) {
+			channel = create_channel(demux, number);
+			if (channel == NULL) {
+				DEBUG_PRINTF("ERROR: Could not create channel %u.\n", number);
+				return false;
+			}
+			demux->channels[number] = channel;
+			if (demux->is_in_meas_loop) {
+				MscriptEvent_t start;
+				memset(&start, 0, sizeof(start));
+				start.type = MSCRIPT_EVENT_MEAS_LOOP_START;
+				start.response = demux->meas_loop_start.response;
+				start.meas_loop_index = demux->meas_loop_start.meas_loop_index;
+				start.loop = demux->meas_loop_start.loop;
+				enqueue(channel, &start, 0);
+			}
+		}
+		// Only the acquisition thread uses `package_index`, so no lock is needed.
+		++channel->package_index;
+		if (!enqueue(channel, event, channel->package_index)) {
+			return false;
+		}
+		// The statistics are read by other threads only after the workers are stopped.
+		++channel->stats.nr_of_packages;
+		return true;
+	}
+
+	if (event->type == MSCRIPT_EVENT_MEAS_LOOP_START) {
+		demux->is_in_meas_loop = true;
+		demux->meas_loop_start.type = event->type;
+		demux->meas_loop_start.meas_loop_index = event->meas_loop_index;
+		demux->meas_loop_start.loop = event->loop;
+		strncpy(demux->meas_loop_start.response, event->response, MSCRIPT_READ_BUFFER_SIZE - 1);
+	} else if (event->type == MSCRIPT_EVENT_MEAS_LOOP_END) {
+		demux->is_in_meas_loop = false;
+	}
+
+	// Pass all other events to all channels.
+	bool success = true;
+	for (unsigned int i = 0; i < MSCRIPT_DEMUX_MAX_CHANNELS; ++i) {
+		Channel_t * channel = demux->channels[i];
+		if (channel != NULL) {
+			if (event->type == MSCRIPT_EVENT_MEAS_LOOP_START) {
+				channel->package_index = 0;
+			}
+			if (!enqueue(channel, event, 0)) {
+				success = false;
+			}
+		}
+	}
+	return success;
+}
+
+/**
+ * Get the statistics of a channel.
+ *
+ * This function should be called after `mscript_demux_finish()`.
+ *
+ * \return `true` if the channel exists (i.e. received at least one package),
+ *         `false` otherwise
+ */
+bool mscript_demux_get_channel_stats(MscriptDemux_t const * demux, unsigned int channel,
+	MscriptChannelStats_t * p_stats)
+{
+	if ((channel >= MSCRIPT_DEMUX_MAX_CHANNELS) || (demux->channels[channel] == NULL)) {
+		return false;
+	}
+	*p_stats = demux->channels[channel]->stats;
+	return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * \file
+ * Per-channel demultiplexer for multi-channel instruments.
+ *
+ * A multi-channel instrument (such as the MultiEmStat4) sends the data of all
+ * its channels over one connection. Each data package contains the channel
+ * number as a variable of type `MSCRIPT_VARTYPE_CHANNEL` ("ea"). This module
+ * is a sink for an acquisition (see `mscript_acquisition.h`) that routes each
+ * package to a separate sink per channel. Packages without a channel variable
+ * are routed to channel 0.
+ *
+ * Each channel has its own worker thread and queue. The acquisition thread
+ * only copies the response line to the queue of the channel; parsing the
+ * package and calling the channel sink (e.g. processing and writing the data)
+ * is done by the worker thread of that channel. This way, the processing of
+ * the channels is spread over multiple cores. To also move the parsing out of
+ * the acquisition thread, set `parse_packages` of the acquisition to `false`.
+ *
+ * The channel sinks are created on demand, when the first package of a
+ * channel is received, by the function passed to `mscript_demux_create()`.
+ * All other events (e.g. the start and end of measurement loops) are passed
+ * to all channels that exist at that moment. A channel that is created within
+ * a measurement loop first receives the `MSCRIPT_EVENT_MEAS_LOOP_START` event
+ * of that loop. The `package_index` of the events counts the packages of the
+ * channel only.
+ *
+ * Each channel sink is only called from the worker thread of its channel.
+ * If the queue of a channel is full, the acquisition thread waits until the
+ * worker has processed an entry.
+ *
+ * After the acquisition, call `mscript_demux_finish()` to wait until all
+ * channels have processed their data.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript_acquisition.h"
+
+/// Maximum number of channels (channel numbers 0 to MSCRIPT_DEMUX_MAX_CHANNELS - 1).
+#define MSCRIPT_DEMUX_MAX_CHANNELS 16
+
+/// Number of response lines that can be queued for each channel.
+#define MSCRIPT_DEMUX_QUEUE_LENGTH 128
+
+/** The demultiplexer. */
+typedef struct MscriptDemux MscriptDemux_t;
+
+/**
+ * Function that creates the sink of a channel.
+ *
+ * This function is called from the acquisition thread.
+ *
+ * \param context The context passed to `mscript_demux_create()`.
+ * \param channel The channel number.
+ * \param p_sink[out] The sink of the channel.
+ *
+ * \return `true` on success, or `false` to stop the acquisition with an error.
+ */
+typedef bool (*MscriptChannelSinkFactory_t)(void * context, unsigned int channel,
+	MscriptSink_t * p_sink);
+
+/** Statistics of one channel. */
+typedef struct {
+	/** Number of data packages routed to the channel. */
+	uint64_t nr_of_packages;
+	/** Number of times the acquisition thread had to wait for the worker. */
+	uint64_t nr_of_waits;
+	/** `true` if a package could not be parsed or the sink returned `false`. */
+	bool failed;
+} MscriptChannelStats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptDemux_t * mscript_demux_create(MscriptChannelSinkFactory_t create_sink, void * context);
+bool mscript_demux_finish(MscriptDemux_t * demux);
+void mscript_demux_destroy(MscriptDemux_t * demux);
+bool mscript_demux_handle_event(void * context, MscriptEvent_t const * event);
+bool mscript_demux_get_channel_stats(MscriptDemux_t const * demux, unsigned int channel,
+	MscriptChannelStats_t * p_stats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
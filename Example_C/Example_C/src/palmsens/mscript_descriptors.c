@@ -0,0 +1,278 @@
+/**
+ * \file
+ * Descriptor tables of MethodSCRIPT variable types and metadata ranges.
+ *
+ * See `mscript_descriptors.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_descriptors.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Convert the two characters of a variable type to its index in the tables.
+#define VARTYPE_INDEX(ch1, ch2) (((ch1) - 'a') * 26 + ((ch2) - 'a'))
+
+/* List of all known variable types. Each entry consists of:
+ *   - an identifier, used to generate the names of the enum values below
+ *   - the two characters of the variable type
+ *   - the name, label, unit, quantity and print format (see
+ *     `MscriptVartypeDescriptor_t`)
+ *   - whether the range metadata of this variable type is a potential range
+ *     (only used for instruments with potential ranges).
+ */
+#define VARTYPE_LIST(X) \
+	X(aa, 'a', 'a', "UNKNOWN VAR TYPE",    NULL,         "",        NONE,        NULL,     false) \
+	X(ab, 'a', 'b', "Potential",           "E",          "V",       POTENTIAL,   "%6.3f",  true)  \
+	X(ac, 'a', 'c', "Potential_CE_vs_GND", "E_CE",       "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ad, 'a', 'd', "Potential_SE_vs_GND", "E_SE",       "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ae, 'a', 'e', "Potential_RE_vs_GND", "E_RE",       "V",       POTENTIAL,   "%6.3f",  false) \
+	X(af, 'a', 'f', "Potential_WE_vs_GND", "E_WE",       "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ag, 'a', 'g', "Potential_WE_vs_CE",  "E_WE_CE",    "V",       POTENTIAL,   "%6.3f",  false) \
+	X(as, 'a', 's', "Potential_AIN0",      "E_AIN0",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(at, 'a', 't', "Potential_AIN1",      "E_AIN1",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(au, 'a', 'u', "Potential_AIN2",      "E_AIN2",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(av, 'a', 'v', "Potential_AIN3",      "E_AIN3",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(aw, 'a', 'w', "Potential_AIN4",      "E_AIN4",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ax, 'a', 'x', "Potential_AIN5",      "E_AIN5",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ay, 'a', 'y', "Potential_AIN6",      "E_AIN6",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(az, 'a', 'z', "Potential_AIN7",      "E_AIN7",     "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ba, 'b', 'a', "Current",             "I",          "A",       CURRENT,     "%11.3E", false) \
+	X(ca, 'c', 'a', "Phase",               "phase",      "degrees", PHASE,       "%f",     false) \
+	X(cb, 'c', 'b', "Imp",                 "Z",          "ohm",     IMPEDANCE,   "%16.3f", false) \
+	X(cc, 'c', 'c', "Zreal",               "Z_real",     "ohm",     IMPEDANCE,   "%16.3f", false) \
+	X(cd, 'c', 'd', "Zimag",               "Z_imag",     "ohm",     IMPEDANCE,   "%16.3f", true)  \
+	X(ce, 'c', 'e', "EIS_TDD_E",           "E_tdd",      "V",       POTENTIAL,   "%6.3f",  false) \
+	X(cf, 'c', 'f', "EIS_TDD_I",           "I_tdd",      "A",       CURRENT,     "%11.3E", false) \
+	X(cg, 'c', 'g', "EIS_FS",              "F_s",        "Hz",      FREQUENCY,   "%6.3E",  false) \
+	X(ch, 'c', 'h', "EIS_E_AC",            "E_ac",       "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ci, 'c', 'i', "EIS_E_DC",            "E_dc",       "V",       POTENTIAL,   "%6.3f",  false) \
+	X(cj, 'c', 'j', "EIS_I_AC",            "I_ac",       "A",       CURRENT,     "%11.3E", false) \
+	X(ck, 'c', 'k', "EIS_I_DC",            "I_dc",       "A",       CURRENT,     "%11.3E", false) \
+	X(da, 'd', 'a', "Cell_set_potential",  "E_set",      "V",       POTENTIAL,   "%6.3f",  false) \
+	X(db, 'd', 'b', "Cell_set_current",    "I_set",      "A",       CURRENT,     "%11.3E", false) \
+	X(dc, 'd', 'c', "Cell_set_frequency",  "F_set",      "Hz",      FREQUENCY,   "%6.3E",  false) \
+	X(dd, 'd', 'd', "Cell_set_amplitude",  "A_set",      "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ea, 'e', 'a', "Channel",             "channel",    "",        NONE,        "%3.0f",  false) \
+	X(eb, 'e', 'b', "Time",                "time",       "s",       TIME,        "%6.3f",  false) \
+	X(ec, 'e', 'c', "Pin_msk",             "pins",       "",        NONE,        "%4.0f",  false) \
+	X(ed, 'e', 'd', "Temperature",         "T",          "degC",    TEMPERATURE, "%6.2f",  false) \
+	X(ga, 'g', 'a', "Dev_adc_offset",      "adc_offset", "",        NONE,        "%6.3f",  false) \
+	X(gb, 'g', 'b', "Dev_hs_ex",           "hs_ex",      "",        NONE,        "%6.3f",  false) \
+	X(ha, 'h', 'a', "Current_generic1",    "I",          "A",       CURRENT,     "%11.3E", false) \
+	X(hb, 'h', 'b', "Current_generic2",    "I",          "A",       CURRENT,     "%11.3E", false) \
+	X(hc, 'h', 'c', "Current_generic3",    "I",          "A",       CURRENT,     "%11.3E", false) \
+	X(hd, 'h', 'd', "Current_generic4",    "I",          "A",       CURRENT,     "%11.3E", false) \
+	X(ia, 'i', 'a', "Potential_generic1",  "E",          "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ib, 'i', 'b', "Potential_generic2",  "E",          "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ic, 'i', 'c', "Potential_generic3",  "E",          "V",       POTENTIAL,   "%6.3f",  false) \
+	X(id, 'i', 'd', "Potential_generic4",  "E",          "V",       POTENTIAL,   "%6.3f",  false) \
+	X(ja, 'j', 'a', "Misc_generic1",       "misc",       "",        NONE,        "%6.3f",  false) \
+	X(jb, 'j', 'b', "Misc_generic2",       "misc",       "",        NONE,        "%6.3f",  false) \
+	X(jc, 'j', 'c', "Misc_generic3",       "misc",       "",        NONE,        "%6.3f",  false) \
+	X(jd, 'j', 'd', "Misc_generic4",       "misc",       "",        NONE,        "%6.3f",  false)
+
+/* Index of each variable type in `descriptors`. Index 0 is used for all
+ * undefined variable types.
+ */
+enum {
+	DESCRIPTOR_UNDEFINED,
+#define X(id, ch1, ch2, name, label, unit, quantity, format, potential) DESCRIPTOR_##id,
+	VARTYPE_LIST(X)
+#undef X
+	NR_OF_DESCRIPTORS
+};
+
+/// The descriptors of all known variable types.
+static MscriptVartypeDescriptor_t const descriptors[NR_OF_DESCRIPTORS] = {
+	[DESCRIPTOR_UNDEFINED] = { "Undefined variable type", NULL, "", MSCRIPT_QUANTITY_NONE, NULL,
+		false },
+#define X(id, ch1, ch2, name, label, unit, quantity, format, potential) \
+	[DESCRIPTOR_##id] = { name, label, unit, MSCRIPT_QUANTITY_##quantity, format, potential },
+	VARTYPE_LIST(X)
+#undef X
+};
+
+/* The index in `descriptors` for each variable type. This table is one byte per
+ * variable type, instead of a full descriptor, to keep it small on
+ * microcontrollers.
+ */
+static uint8_t const descriptor_index[MSCRIPT_NR_OF_VARTYPES] = {
+#define X(id, ch1, ch2, name, label, unit, quantity, format, potential) \
+	[VARTYPE_INDEX(ch1, ch2)] = DESCRIPTOR_##id,
+	VARTYPE_LIST(X)
+#undef X
+};
+
+/* Lists of the ranges of each instrument, as designated initializers of a
+ * range table (range value -> label).
+ */
+#define EMSTAT_PICO_CURRENT_RANGES \
+	[  0] = "100 nA", \
+	[  1] =   "2 uA", \
+	[  2] =   "4 uA", \
+	[  3] =   "8 uA", \
+	[  4] =  "16 uA", \
+	[  5] =  "32 uA", \
+	[  6] =  "63 uA", \
+	[  7] = "125 uA", \
+	[  8] = "250 uA", \
+	[  9] = "500 uA", \
+	[ 10] =   "1 mA", \
+	[ 11] =   "5 mA", \
+	[128] = "100 nA (High speed)", \
+	[129] =   "1 uA (High speed)", \
+	[130] =   "6 uA (High speed)", \
+	[131] =  "13 uA (High speed)", \
+	[132] =  "25 uA (High speed)", \
+	[133] =  "50 uA (High speed)", \
+	[134] = "100 uA (High speed)", \
+	[135] = "200 uA (High speed)", \
+	[136] =   "1 mA (High speed)", \
+	[137] =   "5 mA (High speed)",
+
+#define EMSTAT4_CURRENT_RANGES \
+	/* (Multi)EmStat4 LR only: */ \
+	[  0] = "100 pA", \
+	[  3] =   "1 nA", \
+	[  6] =  "10 nA", \
+	/* (Multi)EmStat4 LR/HR: */ \
+	[  9] = "100 nA", \
+	[ 12] =   "1 uA", \
+	[ 15] =  "10 uA", \
+	[ 18] = "100 uA", \
+	[ 21] =   "1 mA", \
+	[ 24] =  "10 mA", \
+	/* (Multi)EmStat4 HR only: */ \
+	[ 27] = "100 mA",
+
+#define EMSTAT4_POTENTIAL_RANGES \
+	[  2] =  "50 mV", \
+	[  3] = "100 mV", \
+	[  4] = "200 mV", \
+	[  5] = "500 mV", \
+	[  6] =   "1 V",
+
+#define NEXUS_CURRENT_RANGES \
+	/* Potentiostat ranges */ \
+	[ 16] = "100 pA", \
+	[  0] =   "1 nA", \
+	[  1] =  "10 nA", \
+	[  2] = "100 nA", \
+	[  3] =   "1 uA", \
+	[  4] =  "10 uA", \
+	[  5] = "100 uA", \
+	[  6] =   "1 mA (tia)", \
+	[  7] =  "10 mA (tia)", \
+	[  8] =   "1 mA", \
+	[  9] =  "10 mA", \
+	[ 10] = "100 mA", \
+	[ 11] =   "1 A", \
+	/* Galvanostat ranges */ \
+	[ 32] =   "1 nA", \
+	[ 33] =  "10 nA", \
+	[ 34] = "100 nA", \
+	[ 35] =   "1 uA", \
+	[ 36] =  "10 uA", \
+	[ 37] = "100 uA", \
+	[ 38] =   "1 mA (tia)", \
+	[ 39] =  "10 mA (tia)", \
+	[ 40] =   "1 mA", \
+	[ 41] =  "10 mA", \
+	[ 42] = "100 mA", \
+	[ 43] =   "1 A",
+
+#define NEXUS_POTENTIAL_RANGES \
+	[  0] =   "1 V", \
+	[  1] = "100 mV", \
+	[  2] =  "10 mV", \
+	[  3] =   "1 mV",
+
+/* The range labels, indexed by range table, kind of range (0 = current,
+ * 1 = potential) and range value. Unknown ranges are NULL. The EmStat Pico
+ * only has current ranges, so these are used for all variable types.
+ */
+static char const * const range_labels[MSCRIPT_NR_OF_RANGE_TABLES][2][MSCRIPT_NR_OF_RANGES] = {
+	[MSCRIPT_RANGE_TABLE_EMSTAT_PICO] = {
+		{ EMSTAT_PICO_CURRENT_RANGES },
+		{ EMSTAT_PICO_CURRENT_RANGES },
+	},
+	[MSCRIPT_RANGE_TABLE_EMSTAT4] = {
+		{ EMSTAT4_CURRENT_RANGES },
+		{ EMSTAT4_POTENTIAL_RANGES },
+	},
+	[MSCRIPT_RANGE_TABLE_NEXUS] = {
+		{ NEXUS_CURRENT_RANGES },
+		{ NEXUS_POTENTIAL_RANGES },
+	},
+};
+
+/**
+ * Get the descriptor of a variable type.
+ *
+ * \param variable_type The variable type, as received from the device.
+ *
+ * \return The descriptor of the variable type. For undefined variable types,
+ *         a descriptor with the name "Undefined variable type" and without
+ *         label and format is returned (never NULL).
+ */
+MscriptVartypeDescriptor_t const * mscript_get_vartype_descriptor(unsigned int variable_type)
+{
+	if (variable_type >= MSCRIPT_NR_OF_VARTYPES) {
+		return &descriptors[DESCRIPTOR_UNDEFINED];
+	}
+	return &descriptors[descriptor_index[variable_type]];
+}
+
+/**
+ * Get the label of a range.
+ *
+ * Depending on the instrument and the variable type, the range is a current
+ * range or a potential range.
+ *
+ * \param table The range table of the instrument.
+ * \param variable_type The variable type (see MethodSCRIPT documentation).
+ * \param range The range, as received from the device.
+ *
+ * \return The label of the range (e.g. "1 mA"), or NULL if it is unknown.
+ */
+char const * mscript_get_range_label(MscriptRangeTable_t table, unsigned int variable_type,
+	int range)
+{
+	if (((unsigned int)table >= MSCRIPT_NR_OF_RANGE_TABLES) || (range < 0)
+		|| (range >= MSCRIPT_NR_OF_RANGES)) {
+		return NULL;
+	}
+	bool is_potential_range = mscript_get_vartype_descriptor(variable_type)->has_potential_range;
+	return range_labels[table][is_potential_range ? 1 : 0][range];
+}
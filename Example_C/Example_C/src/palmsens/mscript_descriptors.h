@@ -0,0 +1,110 @@
+/**
+ * \file
+ * Descriptor tables of MethodSCRIPT variable types and metadata ranges.
+ *
+ * The properties of each variable type (name, label, unit, quantity and print
+ * format) are stored in a constant table indexed by the variable type, and the
+ * labels of the ranges in constant tables indexed by the range. Looking up a
+ * property is therefore a table load instead of a `switch` statement, which
+ * matters because these functions are called for every value that is printed
+ * or written to a CSV file.
+ *
+ * The tables are generated by the preprocessor from one list per table (see
+ * `mscript_descriptors.c`). To add a variable type or range, only that list
+ * has to be extended.
+ *
+ * This file and `mscript_descriptors.c` are shared by the C library and the
+ * Arduino library (MethodSCRIPTComm). Both copies must be kept identical, so
+ * they only depend on the C standard library.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+
+/// Number of possible variable types ("aa" = 0 to "zz" = 675).
+#define MSCRIPT_NR_OF_VARTYPES 676
+
+/// Number of possible range values (the range metadata is one byte).
+#define MSCRIPT_NR_OF_RANGES 256
+
+/** The physical quantity of a variable type. */
+typedef enum {
+	MSCRIPT_QUANTITY_NONE,
+	MSCRIPT_QUANTITY_POTENTIAL,   //!< [V]
+	MSCRIPT_QUANTITY_CURRENT,     //!< [A]
+	MSCRIPT_QUANTITY_PHASE,       //!< [degrees]
+	MSCRIPT_QUANTITY_IMPEDANCE,   //!< [ohm]
+	MSCRIPT_QUANTITY_FREQUENCY,   //!< [Hz]
+	MSCRIPT_QUANTITY_TIME,        //!< [s]
+	MSCRIPT_QUANTITY_TEMPERATURE, //!< [degrees Celsius]
+} MscriptQuantity_t;
+
+/** The properties of a variable type. */
+typedef struct {
+	/** Name of the variable type (e.g. "Potential"), used as column header. */
+	char const * name;
+	/** Short label (e.g. "E"), used when printing values to the console. */
+	char const * label;
+	/** Unit of the values (e.g. "V"), or "" if the values have no unit. */
+	char const * unit;
+	/** The physical quantity. */
+	MscriptQuantity_t quantity;
+	/** Preferred `printf()` format of a value (a `double`). */
+	char const * format;
+	/** `true` if the range metadata is a potential range instead of a current range. */
+	bool has_potential_range;
+} MscriptVartypeDescriptor_t;
+
+/**
+ * The range tables. Instruments that use the same ranges share a table.
+ */
+typedef enum {
+	MSCRIPT_RANGE_TABLE_NONE,
+	MSCRIPT_RANGE_TABLE_EMSTAT_PICO,
+	MSCRIPT_RANGE_TABLE_EMSTAT4,      //!< (Multi)EmStat4 LR and HR
+	MSCRIPT_RANGE_TABLE_NEXUS,
+	MSCRIPT_NR_OF_RANGE_TABLES,
+} MscriptRangeTable_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptVartypeDescriptor_t const * mscript_get_vartype_descriptor(unsigned int variable_type);
+char const * mscript_get_range_label(MscriptRangeTable_t table, unsigned int variable_type,
+	int range);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,318 @@
+/**
+ * \file
+ * MethodSCRIPT device discovery.
+ *
+ * See `mscript_discovery.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_discovery.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+#include "mscript_serial_port.h"
+#include "mscript_thread.h"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#elif defined (__linux__)
+	#include <dirent.h>
+#endif
+
+/**
+ * Candidate baud rates, in the order they are tried. The most common ones
+ * are tried first: 230400 (EmStat Pico, EmStat4 with firmware <= 1.1) and
+ * 921600 (EmStat4).
+ */
+static int const BAUDRATES[] = { 230400, 921600, 460800, 115200, 57600 };
+
+/// Number of candidate baud rates.
+#define NR_OF_BAUDRATES (sizeof(BAUDRATES) / sizeof(BAUDRATES[0]))
+
+/// Maximum time (in ms) to discard an unexpected reply of a device.
+#define DRAIN_TIMEOUT 200
+
+/// Read timeout (in ms) of `mscript_get_firmware_version()`.
+#define FIRMWARE_VERSION_TIMEOUT 100
+
+/** Work item of one probing thread. */
+typedef struct {
+	char const * port;
+	int preferred_baudrate;
+	uint32_t timeout_ms;
+	bool found;
+	MscriptDiscoveredDevice_t device;
+} ProbeJob_t;
+
+/**
+ * Discard all data that is received until the device is silent, or until the
+ * drain window has passed.
+ */
+static void drain(SerialPortHandle_t handle)
+{
+	uint32_t start_ms = mscript_get_time_ms();
+	char c;
+	while ((mscript_serial_port_read(handle, &c) == 1)
+		&& (mscript_get_time_ms() - start_ms < DRAIN_TIMEOUT)) {
+	}
+}
+
+/**
+ * Request the firmware version at the current baud rate.
+ *
+ * The version is requested right away, so a silent port (or a port at a wrong
+ * baud rate, where no complete line is received) costs one read timeout. If
+ * the device replies quickly with another line, e.g. to the newline that was
+ * sent before, the rest of the reply is discarded and the version is
+ * requested once more.
+ */
+static bool request_firmware_version(SerialPortHandle_t handle,
+	MscriptDiscoveredDevice_t * device)
+{
+	uint32_t start_ms = mscript_get_time_ms();
+	if (mscript_get_firmware_version(handle, device->firmware_version,
+		sizeof(device->firmware_version))) {
+		return true;
+	}
+	if (mscript_get_time_ms() - start_ms >= FIRMWARE_VERSION_TIMEOUT) {
+		return false;
+	}
+	drain(handle);
+	return mscript_get_firmware_version(handle, device->firmware_version,
+		sizeof(device->firmware_version));
+}
+
+/**
+ * Compare two port names for sorting, such that "ttyUSB2" < "ttyUSB10".
+ */
+static int compare_ports(void const * a, void const * b)
+{
+	char const * pa = a;
+	char const * pb = b;
+	size_t la = strlen(pa);
+	size_t lb = strlen(pb);
+	if (la != lb) {
+		return (la < lb) ? -1 : 1;
+	}
+	return strcmp(pa, pb);
+}
+
+/**
+ * List the serial ports that could have a MethodSCRIPT device connected.
+ *
+ * \param ports[out] The names of the ports, sorted.
+ * \param max_nr_of_ports Maximum number of ports to store in `ports`.
+ *
+ * \return The number of ports found.
+ */
+size_t mscript_list_serial_ports(char ports[][MSCRIPT_DISCOVERY_MAX_PORT_LENGTH + 1],
+	size_t max_nr_of_ports)
+{
+	size_t nr_of_ports = 0;
+#if defined(_WIN32)
+	// A COM port exists if its device name can be resolved.
+	char target[256];
+	for (unsigned int i = 1; (i <= 255) && (nr_of_ports < max_nr_of_ports); ++i) {
+		char name[8];
+		snprintf(name, sizeof(name), "COM%u", i);
+		if (QueryDosDeviceA(name, target, sizeof(target)) != 0) {
+			strcpy(ports[nr_of_ports++], name);
+		}
+	}
+#elif defined (__linux__)
+	DIR * dir = opendir("/dev");
+	if (dir == NULL) {
+		return 0;
+	}
+	struct dirent * entry;
+	while (((entry = readdir(dir)) != NULL) && (nr_of_ports < max_nr_of_ports)) {
+		if (strncmp(entry->d_name, "ttyUSB", 6) && strncmp(entry->d_name, "ttyACM", 6)) {
+			continue;
+		}
+		if (strlen(entry->d_name) + 5 > MSCRIPT_DISCOVERY_MAX_PORT_LENGTH) {
+			continue;
+		}
+		strcpy(ports[nr_of_ports], "/dev/");
+		strcat(ports[nr_of_ports], entry->d_name);
+		++nr_of_ports;
+	}
+	closedir(dir);
+#endif
+	qsort(ports, nr_of_ports, sizeof(ports[0]), compare_ports);
+	return nr_of_ports;
+}
+
+/**
+ * Check if a MethodSCRIPT device is connected to a serial port, and at which
+ * baud rate.
+ *
+ * The preferred baud rate is tried first, followed by the other candidate baud
+ * rates, until the device responds with a valid firmware version, or until
+ * the deadline has passed. A newline is sent before the firmware version is
+ * requested, to terminate any partial line the device may have received. If
+ * the reply is not a firmware version, it is discarded and the version is
+ * requested once more, so data that was received at a wrong baud rate does
+ * not interfere.
+ *
+ * \param port The serial port.
+ * \param preferred_baudrate The baud rate to try first, or 0 for the default order.
+ * \param timeout_ms Deadline (in ms) for trying all baud rates.
+ * \param device[out] Information about the device, if found.
+ *
+ * \return `true` if a device was found, `false` otherwise
+ */
+bool mscript_probe_port(char const * port, int preferred_baudrate, uint32_t timeout_ms,
+	MscriptDiscoveredDevice_t * device)
+{
+	assert(port != NULL);
+	assert(device != NULL);
+
+	uint32_t start_ms = mscript_get_time_ms();
+	memset(device, 0, sizeof(MscriptDiscoveredDevice_t));
+	if (strlen(port) > MSCRIPT_DISCOVERY_MAX_PORT_LENGTH) {
+		return false;
+	}
+	strcpy(device->port, port);
+
+	// The preferred baud rate is tried first; it is skipped in the list of
+	// candidates (index -1 denotes the preferred baud rate).
+	for (int i = (preferred_baudrate > 0) ? -1 : 0; i < (int)NR_OF_BAUDRATES; ++i) {
+		int baudrate = (i < 0) ? preferred_baudrate : BAUDRATES[i];
+		if ((i >= 0) && (baudrate == preferred_baudrate)) {
+			continue;
+		}
+		if (mscript_get_time_ms() - start_ms >= timeout_ms) {
+			break;
+		}
+		SerialPortHandle_t handle = mscript_serial_port_open(port, baudrate);
+		if (handle == BAD_HANDLE) {
+			// Most likely, the port does not exist or is in use.
+			return false;
+		}
+		// Terminate any partial line the device may have received.
+		bool found = mscript_serial_port_write(handle, "\n")
+			&& request_firmware_version(handle, device);
+		if (found) {
+			device->baudrate = baudrate;
+			device->device_type = mscript_get_device_type(device->firmware_version);
+			// Older firmware might not support the serial number command.
+			if (!mscript_get_serial_number(handle, device->serial_number,
+				sizeof(device->serial_number))) {
+				device->serial_number[0] = '\0';
+			}
+			device->probe_time_ms = mscript_get_time_ms() - start_ms;
+		}
+		mscript_serial_port_close(handle);
+		if (found) {
+			DEBUG_PRINTF("Found device on %s at %d baud.\n", port, device->baudrate);
+			return true;
+		}
+	}
+	return false;
+}
+
+static void probe_main(void * arg)
+{
+	ProbeJob_t * job = arg;
+	job->found = mscript_probe_port(job->port, job->preferred_baudrate, job->timeout_ms,
+		&job->device);
+}
+
+/**
+ * Find all MethodSCRIPT devices connected to the computer.
+ *
+ * All candidate ports (see `mscript_list_serial_ports()`) are probed at the
+ * same time using `mscript_probe_port()`, so the total time is about the time
+ * needed to probe one port.
+ *
+ * \param devices[out] The devices found, in the order of their port names.
+ * \param max_nr_of_devices Maximum number of devices to store in `devices`.
+ * \param preferred_baudrate The baud rate to try first, or 0 for the default order.
+ * \param timeout_ms Deadline (in ms) for probing each port.
+ *
+ * \return The number of devices found.
+ */
+size_t mscript_discover_devices(MscriptDiscoveredDevice_t * devices, size_t max_nr_of_devices,
+	int preferred_baudrate, uint32_t timeout_ms)
+{
+	char (*ports)[MSCRIPT_DISCOVERY_MAX_PORT_LENGTH + 1] =
+		malloc(MSCRIPT_DISCOVERY_MAX_PORTS * sizeof(*ports));
+	if (ports == NULL) {
+		return 0;
+	}
+	size_t nr_of_ports = mscript_list_serial_ports(ports, MSCRIPT_DISCOVERY_MAX_PORTS);
+	if (nr_of_ports == 0) {
+		free(ports);
+		return 0;
+	}
+
+	ProbeJob_t * jobs = calloc(nr_of_ports, sizeof(ProbeJob_t));
+	MscriptThread_t * threads = calloc(nr_of_ports, sizeof(MscriptThread_t));
+	bool * is_started = calloc(nr_of_ports, sizeof(bool));
+	if ((jobs == NULL) || (threads == NULL) || (is_started == NULL)) {
+		free(ports);
+		free(jobs);
+		free(threads);
+		free(is_started);
+		return 0;
+	}
+
+	for (size_t i = 0; i < nr_of_ports; ++i) {
+		jobs[i].port = ports[i];
+		jobs[i].preferred_baudrate = preferred_baudrate;
+		jobs[i].timeout_ms = timeout_ms;
+		is_started[i] = mscript_thread_create(&threads[i], probe_main, &jobs[i]);
+		if (!is_started[i]) {
+			// Probe this port in the current thread instead.
+			probe_main(&jobs[i]);
+		}
+	}
+
+	size_t nr_of_devices = 0;
+	for (size_t i = 0; i < nr_of_ports; ++i) {
+		if (is_started[i]) {
+			mscript_thread_join(threads[i]);
+		}
+		if (jobs[i].found && (nr_of_devices < max_nr_of_devices)) {
+			devices[nr_of_devices++] = jobs[i].device;
+		}
+	}
+
+	free(ports);
+	free(jobs);
+	free(threads);
+	free(is_started);
+	return nr_of_devices;
+}
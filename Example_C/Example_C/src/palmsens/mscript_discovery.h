@@ -0,0 +1,101 @@
+/**
+ * \file
+ * MethodSCRIPT device discovery.
+ *
+ * This module finds MethodSCRIPT devices that are connected to the computer,
+ * without knowing the serial port or baud rate in advance. All candidate
+ * serial ports are probed at the same time, each by its own thread. For each
+ * port, the candidate baud rates are tried one by one: the firmware version
+ * is requested using the "t" command, with a short deadline. If a valid reply
+ * is received, the serial number is requested as well.
+ *
+ * The candidate ports are `/dev/ttyUSB*` and `/dev/ttyACM*` on Linux, and
+ * all existing COM ports on Windows.
+ *
+ * Note that probing sends commands to every candidate port, so other
+ * (non-MethodSCRIPT) devices connected to these ports also receive them.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript.h"
+
+/// Maximum length of a serial port name (excluding '\0').
+#define MSCRIPT_DISCOVERY_MAX_PORT_LENGTH 63
+
+/// Maximum length of a firmware version (excluding '\0').
+#define MSCRIPT_DISCOVERY_MAX_FIRMWARE_LENGTH 79
+
+/// Maximum length of a serial number (excluding '\0').
+#define MSCRIPT_DISCOVERY_MAX_SERIAL_LENGTH 63
+
+/// Maximum number of ports that are probed.
+#define MSCRIPT_DISCOVERY_MAX_PORTS 64
+
+/**
+ * Default deadline (in ms) for probing one port at all candidate baud rates.
+ * A silent port costs about one read timeout (100 ms) per baud rate.
+ */
+#define MSCRIPT_DISCOVERY_DEFAULT_TIMEOUT 600
+
+/** A device found by `mscript_discover_devices()`. */
+typedef struct {
+	/** The serial port, e.g. "/dev/ttyUSB0" or "COM3". */
+	char port[MSCRIPT_DISCOVERY_MAX_PORT_LENGTH + 1];
+	/** The baud rate at which the device responded. */
+	int baudrate;
+	DeviceType_t device_type;
+	char firmware_version[MSCRIPT_DISCOVERY_MAX_FIRMWARE_LENGTH + 1];
+	/** The serial number, or an empty string if it could not be read. */
+	char serial_number[MSCRIPT_DISCOVERY_MAX_SERIAL_LENGTH + 1];
+	/** Time it took to find the device, in milliseconds. */
+	uint32_t probe_time_ms;
+} MscriptDiscoveredDevice_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t mscript_list_serial_ports(char ports[][MSCRIPT_DISCOVERY_MAX_PORT_LENGTH + 1],
+	size_t max_nr_of_ports);
+bool mscript_probe_port(char const * port, int preferred_baudrate, uint32_t timeout_ms,
+	MscriptDiscoveredDevice_t * device);
+size_t mscript_discover_devices(MscriptDiscoveredDevice_t * devices, size_t max_nr_of_devices,
+	int preferred_baudrate, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
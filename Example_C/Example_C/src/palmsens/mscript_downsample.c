@@ -0,0 +1,405 @@
+/**
+ * \file
+ * Downsampling of long series of data for display.
+ *
+ * See `mscript_downsample.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_downsample.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Number of buckets allocated for a new level.
+#define INITIAL_CAPACITY 64
+
+/**
+ * Initialize an empty summary.
+ *
+ * A summary that is set to zero is also initialized.
+ */
+void mscript_minmax_summary_init(MscriptMinMaxSummary_t * summary)
+{
+	memset(summary, 0, sizeof(MscriptMinMaxSummary_t));
+}
+
+/**
+ * Free the memory of a summary. The summary is empty afterwards.
+ */
+void mscript_minmax_summary_free(MscriptMinMaxSummary_t * summary)
+{
+	for (unsigned int i = 0; i < MSCRIPT_DOWNSAMPLE_MAX_LEVELS; ++i) {
+		free(summary->levels[i].buckets);
+	}
+	mscript_minmax_summary_init(summary);
+}
+
+/**
+ * Get the number of rows in a bucket of a level (level 0 is a single row).
+ */
+static size_t get_bucket_size(unsigned int level)
+{
+	size_t size = 1;
+	for (unsigned int i = 0; i < level; ++i) {
+		size *= MSCRIPT_DOWNSAMPLE_FACTOR;
+	}
+	return size;
+}
+
+/**
+ * Merge the minimum and maximum of a bucket (or row) into another bucket.
+ *
+ * \param values The values.
+ * \param[in,out] bucket The bucket to merge into.
+ * \param[in,out] p_is_set `true` if `bucket` contains rows; set to `true`.
+ * \param other The bucket to merge.
+ */
+static void merge(double const * values, MscriptMinMaxBucket_t * bucket, bool * p_is_set,
+	MscriptMinMaxBucket_t other)
+{
+	if (!*p_is_set) {
+		*bucket = other;
+		*p_is_set = true;
+		return;
+	}
+	double min = values[other.min_row];
+	if (!isnan(min) && (isnan(values[bucket->min_row]) || (min < values[bucket->min_row]))) {
+		bucket->min_row = other.min_row;
+	}
+	double max = values[other.max_row];
+	if (!isnan(max) && (isnan(values[bucket->max_row]) || (max > values[bucket->max_row]))) {
+		bucket->max_row = other.max_row;
+	}
+}
+
+/**
+ * Make sure a level has room for one more bucket.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool reserve_bucket(MscriptMinMaxLevel_t * level)
+{
+	if (level->nr_of_buckets < level->capacity) {
+		return true;
+	}
+	size_t capacity = (level->capacity == 0) ? INITIAL_CAPACITY : 2 * level->capacity;
+	MscriptMinMaxBucket_t * buckets = realloc(level->buckets,
+		capacity * sizeof(MscriptMinMaxBucket_t));
+	if (buckets == NULL) {
+		return false;
+	}
+	level->buckets = buckets;
+	level->capacity = capacity;
+	return true;
+}
+
+/**
+ * Add the new rows of an array to the summary.
+ *
+ * The rows that have already been processed must not have been changed.
+ *
+ * \param summary The summary.
+ * \param values The values.
+ * \param nr_of_rows The number of rows in `values`.
+ *
+ * \return `true` on success, `false` on failure to allocate memory (the rows
+ *         that could not be processed are processed by the next call)
+ */
+bool mscript_minmax_summary_update(MscriptMinMaxSummary_t * summary, double const * values,
+	size_t nr_of_rows)
+{
+	while (summary->nr_of_rows < nr_of_rows) {
+		size_t end = summary->nr_of_rows + 1;
+		// Determine the levels of which a bucket is completed by this row, and
+		// reserve the memory first, so the summary remains consistent on failure.
+		unsigned int nr_of_levels = 0;
+		size_t size = MSCRIPT_DOWNSAMPLE_FACTOR;
+		while ((nr_of_levels < MSCRIPT_DOWNSAMPLE_MAX_LEVELS) && (end % size == 0)) {
+			if (!reserve_bucket(&summary->levels[nr_of_levels])) {
+				return false;
+			}
+			++nr_of_levels;
+			size *= MSCRIPT_DOWNSAMPLE_FACTOR;
+		}
+
+		for (unsigned int level = 0; level < nr_of_levels; ++level) {
+			MscriptMinMaxBucket_t bucket;
+			bool is_set = false;
+			if (level == 0) {
+				for (size_t row = end - MSCRIPT_DOWNSAMPLE_FACTOR; row < end; ++row) {
+					MscriptMinMaxBucket_t single = { row, row };
+					merge(values, &bucket, &is_set, single);
+				}
+			} else {
+				MscriptMinMaxLevel_t const * children = &summary->levels[level - 1];
+				for (size_t i = children->nr_of_buckets - MSCRIPT_DOWNSAMPLE_FACTOR;
+					i < children->nr_of_buckets; ++i) {
+					merge(values, &bucket, &is_set, children->buckets[i]);
+				}
+			}
+			MscriptMinMaxLevel_t * parent = &summary->levels[level];
+			parent->buckets[parent->nr_of_buckets++] = bucket;
+		}
+		summary->nr_of_rows = end;
+	}
+	return true;
+}
+
+/**
+ * Merge the minimum and maximum of a range of rows into a bucket.
+ *
+ * The complete buckets of the levels below `level` are used where possible,
+ * so this takes at most about `2 * MSCRIPT_DOWNSAMPLE_FACTOR` steps per level.
+ *
+ * \param summary The summary.
+ * \param values The values.
+ * \param level The number of levels that may be used.
+ * \param first The first row of the range.
+ * \param end The row after the last row of the range.
+ * \param[in,out] bucket The bucket to merge into.
+ * \param[in,out] p_is_set `true` if `bucket` contains rows.
+ */
+static void merge_range(MscriptMinMaxSummary_t const * summary, double const * values,
+	unsigned int level, size_t first, size_t end, MscriptMinMaxBucket_t * bucket,
+	bool * p_is_set)
+{
+	if (first >= end) {
+		return;
+	}
+	if (level == 0) {
+		for (size_t row = first; row < end; ++row) {
+			MscriptMinMaxBucket_t single = { row, row };
+			merge(values, bucket, p_is_set, single);
+		}
+		return;
+	}
+	size_t size = get_bucket_size(level);
+	MscriptMinMaxLevel_t const * buckets = &summary->levels[level - 1];
+	size_t first_bucket = (first + size - 1) / size;
+	size_t end_bucket = end / size;
+	if (end_bucket > buckets->nr_of_buckets) {
+		end_bucket = buckets->nr_of_buckets;
+	}
+	if (first_bucket >= end_bucket) {
+		merge_range(summary, values, level - 1, first, end, bucket, p_is_set);
+		return;
+	}
+	merge_range(summary, values, level - 1, first, first_bucket * size, bucket, p_is_set);
+	for (size_t i = first_bucket; i < end_bucket; ++i) {
+		merge(values, bucket, p_is_set, buckets->buckets[i]);
+	}
+	merge_range(summary, values, level - 1, end_bucket * size, end, bucket, p_is_set);
+}
+
+/**
+ * Get the rows to show a range of rows with at most a given number of points.
+ *
+ * If the range has at most `max_points` rows, all rows (with a value that is
+ * not NaN) are returned. Otherwise, the range is divided in at most
+ * `max_points / 2` equal buckets, and the rows of the minimum and maximum of
+ * each bucket are returned, in ascending order. The buckets are calculated
+ * from the buckets of the summary; the edges of the range (and the rows of
+ * buckets that are not complete yet) from smaller buckets.
+ *
+ * \param summary The summary.
+ * \param values The values.
+ * \param first_row The first row of the range.
+ * \param nr_of_rows The number of rows in the range. Rows that have not been
+ *                   added to the summary yet are not included.
+ * \param max_points The maximum number of points (at least 2).
+ * \param[out] rows The rows (`max_points` entries).
+ *
+ * \return The number of rows, or 0 if there are no rows in the range
+ */
+size_t mscript_minmax_summary_query(MscriptMinMaxSummary_t const * summary,
+	double const * values, size_t first_row, size_t nr_of_rows, size_t max_points,
+	size_t * rows)
+{
+	if ((first_row >= summary->nr_of_rows) || (max_points == 0)) {
+		return 0;
+	}
+	size_t end = (nr_of_rows < summary->nr_of_rows - first_row)
+		? first_row + nr_of_rows : summary->nr_of_rows;
+
+	size_t count = 0;
+	if (end - first_row <= max_points) {
+		for (size_t row = first_row; row < end; ++row) {
+			if (!isnan(values[row])) {
+				rows[count++] = row;
+			}
+		}
+		return count;
+	}
+
+	size_t max_buckets = max_points / 2;
+	if (max_buckets == 0) {
+		return 0;
+	}
+	// Find the smallest bucket size for which the range fits. The size is a
+	// multiple of the buckets of the summary, so each bucket is calculated
+	// from at most `MSCRIPT_DOWNSAMPLE_FACTOR` buckets (plus the edges).
+	size_t size = (end - first_row + max_buckets - 1) / max_buckets;
+	unsigned int level;
+	for (;;) {
+		size_t stored_size = 1;
+		for (level = 0; (level < MSCRIPT_DOWNSAMPLE_MAX_LEVELS)
+			&& (stored_size * MSCRIPT_DOWNSAMPLE_FACTOR <= size); ++level) {
+			stored_size *= MSCRIPT_DOWNSAMPLE_FACTOR;
+		}
+		size = (size + stored_size - 1) / stored_size * stored_size;
+		if ((end - 1) / size - first_row / size + 1 <= max_buckets) {
+			break;
+		}
+		size += stored_size;
+	}
+
+	for (size_t i = first_row / size; i <= (end - 1) / size; ++i) {
+		size_t start = (i * size > first_row) ? i * size : first_row;
+		size_t stop = ((i + 1) * size < end) ? (i + 1) * size : end;
+		MscriptMinMaxBucket_t bucket;
+		bool is_set = false;
+		merge_range(summary, values, level, start, stop, &bucket, &is_set);
+		if (!is_set || isnan(values[bucket.min_row])) {
+			continue; // Only NaN values.
+		}
+		if (bucket.min_row == bucket.max_row) {
+			rows[count++] = bucket.min_row;
+		} else if (bucket.min_row < bucket.max_row) {
+			rows[count++] = bucket.min_row;
+			rows[count++] = bucket.max_row;
+		} else {
+			rows[count++] = bucket.max_row;
+			rows[count++] = bucket.min_row;
+		}
+	}
+	return count;
+}
+
+/**
+ * Get a row of the input of `mscript_lttb()`.
+ */
+static size_t get_row(size_t const * rows, size_t i)
+{
+	return (rows != NULL) ? rows[i] : i;
+}
+
+/**
+ * Get an x value of the input of `mscript_lttb()`.
+ */
+static double get_x(double const * x, size_t row)
+{
+	return (x != NULL) ? x[row] : (double)row;
+}
+
+/**
+ * Select points using the Largest-Triangle-Three-Buckets algorithm.
+ *
+ * The first and last point are always selected. The other points are divided
+ * in `nr_of_points - 2` buckets, and from each bucket the point is selected
+ * that forms the largest triangle with the point selected from the previous
+ * bucket and the average of the next bucket. This keeps the visual shape of
+ * the data. It can be applied to the output of
+ * `mscript_minmax_summary_query()`, to get an exact number of points.
+ *
+ * \param x The x values (indexed by row), or NULL to use the row as x value.
+ * \param y The y values (indexed by row). The selected rows must not be NaN.
+ * \param rows The rows of the input points, in ascending order of x, or NULL
+ *             to use rows 0 to `count - 1`.
+ * \param count The number of input points.
+ * \param nr_of_points The number of points to select.
+ * \param[out] selected The rows of the selected points (`nr_of_points` entries).
+ *
+ * \return The number of selected points (less than `nr_of_points` if the
+ *         input has fewer points)
+ */
+size_t mscript_lttb(double const * x, double const * y, size_t const * rows, size_t count,
+	size_t nr_of_points, size_t * selected)
+{
+	if (nr_of_points >= count) {
+		for (size_t i = 0; i < count; ++i) {
+			selected[i] = get_row(rows, i);
+		}
+		return count;
+	}
+	if (nr_of_points < 3) {
+		if (nr_of_points > 0) {
+			selected[0] = get_row(rows, 0);
+		}
+		if (nr_of_points > 1) {
+			selected[1] = get_row(rows, count - 1);
+		}
+		return nr_of_points;
+	}
+
+	double bucket_size = (double)(count - 2) / (nr_of_points - 2);
+	size_t n = 0;
+	size_t a = get_row(rows, 0);
+	selected[n++] = a;
+	for (size_t i = 0; i < nr_of_points - 2; ++i) {
+		// The average of the next bucket (the last point for the last bucket).
+		size_t avg_start = (size_t)((i + 1) * bucket_size) + 1;
+		size_t avg_end = (size_t)((i + 2) * bucket_size) + 1;
+		if (avg_end > count) {
+			avg_end = count;
+		}
+		double avg_x = 0.0;
+		double avg_y = 0.0;
+		for (size_t j = avg_start; j < avg_end; ++j) {
+			size_t row = get_row(rows, j);
+			avg_x += get_x(x, row);
+			avg_y += y[row];
+		}
+		avg_x /= (double)(avg_end - avg_start);
+		avg_y /= (double)(avg_end - avg_start);
+
+		// The point of this bucket with the largest triangle.
+		size_t start = (size_t)(i * bucket_size) + 1;
+		size_t end = (size_t)((i + 1) * bucket_size) + 1;
+		double ax = get_x(x, a);
+		double ay = y[a];
+		double max_area = -1.0;
+		size_t next = get_row(rows, start);
+		for (size_t j = start; j < end; ++j) {
+			size_t row = get_row(rows, j);
+			double area = fabs((ax - avg_x) * (y[row] - ay) - (ax - get_x(x, row)) * (avg_y - ay));
+			if (area > max_area) {
+				max_area = area;
+				next = row;
+			}
+		}
+		selected[n++] = a = next;
+	}
+	selected[n++] = get_row(rows, count - 1);
+	return n;
+}
@@ -0,0 +1,110 @@
+/**
+ * \file
+ * Downsampling of long series of data for display.
+ *
+ * A long measurement (e.g. chronoamperometry for hours or days) can produce
+ * millions of points, while a plot only needs a few thousand. This module
+ * keeps a multi-resolution min/max summary next to the data of a column: the
+ * rows are grouped in buckets of `MSCRIPT_DOWNSAMPLE_FACTOR` rows, those in
+ * buckets of `MSCRIPT_DOWNSAMPLE_FACTOR` buckets, and so on. For each bucket,
+ * the rows of the minimum and maximum value are stored. A bucket is added
+ * when its last row has been received, so keeping the summary up to date
+ * takes constant time per row (amortized), and the summary uses about
+ * `2 / (MSCRIPT_DOWNSAMPLE_FACTOR - 1)` entries per row.
+ *
+ * To show any range of rows (any zoom level), `mscript_minmax_summary_query()`
+ * divides the range in as many buckets as fit in the requested number of
+ * points, calculates each bucket from the largest buckets of the summary that
+ * fit in it, and returns the rows of the minimum and maximum of each bucket. Since the output includes the extremes of each bucket, peaks and
+ * spikes are never lost. The time needed depends on the number of returned
+ * points, not on the size of the range.
+ *
+ * For an exact number of points that follows the shape of the data, the
+ * result can be further reduced using the Largest-Triangle-Three-Buckets
+ * algorithm (`mscript_lttb()`).
+ *
+ * The summary does not store the values itself; the caller passes the array
+ * of values (e.g. a column of `mscript_columns.h`, which keeps a summary of
+ * each column). NaN values are ignored.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Number of rows or buckets in a bucket of the next level.
+#define MSCRIPT_DOWNSAMPLE_FACTOR 16
+
+/// Number of levels (the largest buckets have `MSCRIPT_DOWNSAMPLE_FACTOR`^7 rows).
+#define MSCRIPT_DOWNSAMPLE_MAX_LEVELS 7
+
+/** The rows of the minimum and maximum value of a bucket. */
+typedef struct {
+	size_t min_row;
+	size_t max_row;
+} MscriptMinMaxBucket_t;
+
+/** One level of a min/max summary. */
+typedef struct {
+	size_t nr_of_buckets;
+	/** Allocated number of buckets (internal). */
+	size_t capacity;
+	MscriptMinMaxBucket_t * buckets;
+} MscriptMinMaxLevel_t;
+
+/** Multi-resolution min/max summary of an array of values. */
+typedef struct {
+	/** Number of rows that have been processed. */
+	size_t nr_of_rows;
+	/** `levels[i]` has buckets of `MSCRIPT_DOWNSAMPLE_FACTOR`^(i + 1) rows. */
+	MscriptMinMaxLevel_t levels[MSCRIPT_DOWNSAMPLE_MAX_LEVELS];
+} MscriptMinMaxSummary_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mscript_minmax_summary_init(MscriptMinMaxSummary_t * summary);
+void mscript_minmax_summary_free(MscriptMinMaxSummary_t * summary);
+bool mscript_minmax_summary_update(MscriptMinMaxSummary_t * summary, double const * values,
+	size_t nr_of_rows);
+size_t mscript_minmax_summary_query(MscriptMinMaxSummary_t const * summary,
+	double const * values, size_t first_row, size_t nr_of_rows, size_t max_points,
+	size_t * rows);
+size_t mscript_lttb(double const * x, double const * y, size_t const * rows, size_t count,
+	size_t nr_of_points, size_t * selected);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,580 @@
+/**
+ * \file
+ * Equivalent circuit fitting of impedance spectra.
+ *
+ * See `mscript_eis_fit.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_eis_fit.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript.h"
+#include "mscript_debug_printf.h"
+
+/// Maximum number of Levenberg-Marquardt iterations.
+#define MAX_ITERATIONS 200
+
+/// The fit has converged when an iteration improves chi square by less than this (relative).
+#define CONVERGENCE_TOLERANCE 1e-10
+
+/// Initial damping factor.
+#define INITIAL_LAMBDA 1e-3
+
+/// The fit stops when the damping factor exceeds this (no further improvement possible).
+#define MAX_LAMBDA 1e10
+
+/// Maximum change of the logarithm of a parameter in one iteration.
+#define MAX_STEP 5.0
+
+/// 2 * pi, to convert a frequency to an angular frequency.
+#define TWO_PI 6.283185307179586
+
+/** A complex number (the C99 complex type is not supported by all compilers). */
+typedef struct {
+	double re;
+	double im;
+} Complex_t;
+
+/** A spectrum waiting to be fitted. */
+typedef struct {
+	MscriptEisModel_t model;
+	size_t count;
+	MscriptEisFitCallback_t callback;
+	void * context;
+	/** Frequency, real and imaginary part, allocated together with the job. */
+	double * frequency;
+	double * z_real;
+	double * z_imag;
+} Job_t;
+
+static Complex_t complex_add(Complex_t a, Complex_t b)
+{
+	Complex_t result = { a.re + b.re, a.im + b.im };
+	return result;
+}
+
+static Complex_t complex_mul(Complex_t a, Complex_t b)
+{
+	Complex_t result = { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+	return result;
+}
+
+static Complex_t complex_div(Complex_t a, Complex_t b)
+{
+	double d = b.re * b.re + b.im * b.im;
+	Complex_t result = { (a.re * b.re + a.im * b.im) / d, (a.im * b.re - a.re * b.im) / d };
+	return result;
+}
+
+/**
+ * Get the number of parameters of a model.
+ */
+size_t mscript_eis_model_nr_of_parameters(MscriptEisModel_t model)
+{
+	return (model == MSCRIPT_EIS_MODEL_RANDLES_WARBURG) ? 4 : 3;
+}
+
+/**
+ * Get the name of a parameter (e.g. "Rct").
+ */
+char const * mscript_eis_parameter_name(MscriptEisParameter_t parameter)
+{
+	static char const * const names[MSCRIPT_EIS_FIT_MAX_PARAMETERS] = {
+		"Rs", "Rct", "Cdl", "sigma" };
+	return ((unsigned int)parameter < MSCRIPT_EIS_FIT_MAX_PARAMETERS) ? names[parameter] : "";
+}
+
+/**
+ * Get the unit of a parameter (e.g. "Ohm").
+ */
+char const * mscript_eis_parameter_unit(MscriptEisParameter_t parameter)
+{
+	static char const * const units[MSCRIPT_EIS_FIT_MAX_PARAMETERS] = {
+		"Ohm", "Ohm", "F", "Ohm/s^0.5" };
+	return ((unsigned int)parameter < MSCRIPT_EIS_FIT_MAX_PARAMETERS) ? units[parameter] : "";
+}
+
+/**
+ * Calculate the impedance of a model and, optionally, its derivative to each
+ * parameter.
+ *
+ * \param model The model.
+ * \param p The parameters.
+ * \param omega The angular frequency (rad/s).
+ * \param[out] p_z The impedance.
+ * \param[out] derivatives The derivatives, or NULL.
+ */
+static void evaluate(MscriptEisModel_t model, double const * p, double omega, Complex_t * p_z,
+	Complex_t * derivatives)
+{
+	Complex_t faradaic = { p[MSCRIPT_EIS_PARAMETER_RCT], 0.0 };
+	Complex_t warburg_unit = { 0.0, 0.0 };
+	if (model == MSCRIPT_EIS_MODEL_RANDLES_WARBURG) {
+		// Z_W = sigma * (1 - j) / sqrt(omega)
+		double factor = 1.0 / sqrt(omega);
+		warburg_unit.re = factor;
+		warburg_unit.im = -factor;
+		faradaic.re += p[MSCRIPT_EIS_PARAMETER_SIGMA] * factor;
+		faradaic.im -= p[MSCRIPT_EIS_PARAMETER_SIGMA] * factor;
+	}
+	Complex_t one = { 1.0, 0.0 };
+	Complex_t capacitive = { 0.0, omega * p[MSCRIPT_EIS_PARAMETER_CDL] };
+	Complex_t parallel = complex_div(one, complex_add(capacitive, complex_div(one, faradaic)));
+	p_z->re = p[MSCRIPT_EIS_PARAMETER_RS] + parallel.re;
+	p_z->im = parallel.im;
+
+	if (derivatives != NULL) {
+		// With Y = j*omega*Cdl + 1/Zf and Zp = 1/Y: dZp = -Zp^2 * dY.
+		Complex_t parallel2 = complex_mul(parallel, parallel);
+		Complex_t ratio = complex_div(parallel2, complex_mul(faradaic, faradaic));
+		derivatives[MSCRIPT_EIS_PARAMETER_RS] = one;
+		derivatives[MSCRIPT_EIS_PARAMETER_RCT] = ratio;
+		Complex_t d_cdl = { omega * parallel2.im, -omega * parallel2.re };
+		derivatives[MSCRIPT_EIS_PARAMETER_CDL] = d_cdl;
+		if (model == MSCRIPT_EIS_MODEL_RANDLES_WARBURG) {
+			derivatives[MSCRIPT_EIS_PARAMETER_SIGMA] = complex_mul(ratio, warburg_unit);
+		}
+	}
+}
+
+/**
+ * Calculate the impedance of a model at a frequency.
+ *
+ * \param model The model.
+ * \param parameters The parameters (see `MscriptEisParameter_t`).
+ * \param frequency The frequency (Hz).
+ * \param[out] p_z_real The real part of the impedance (Ohm).
+ * \param[out] p_z_imag The imaginary part of the impedance (Ohm).
+ */
+void mscript_eis_model_evaluate(MscriptEisModel_t model, double const * parameters,
+	double frequency, double * p_z_real, double * p_z_imag)
+{
+	Complex_t z;
+	evaluate(model, parameters, TWO_PI * frequency, &z, NULL);
+	*p_z_real = z.re;
+	*p_z_imag = z.im;
+}
+
+/**
+ * Check if a point of a spectrum can be used.
+ */
+static bool is_valid_point(double frequency, double z_real, double z_imag)
+{
+	// Also rejects NaN.
+	return (frequency > 0.0) && isfinite(z_real) && isfinite(z_imag)
+		&& ((z_real != 0.0) || (z_imag != 0.0));
+}
+
+/**
+ * Estimate the initial parameters from the spectrum.
+ *
+ * Rs is the real part at the highest frequency and Rs + Rct the real part at
+ * the lowest frequency. Cdl follows from the frequency of the top of the
+ * semicircle, where omega * Rct * Cdl = 1.
+ */
+static void estimate_parameters(MscriptEisModel_t model, double const * frequency,
+	double const * z_real, double const * z_imag, size_t count, double * p)
+{
+	size_t low = 0, high = 0, top = 0;
+	double max_modulus = 0.0;
+	bool found = false;
+	for (size_t i = 0; i < count; ++i) {
+		if (!is_valid_point(frequency[i], z_real[i], z_imag[i])) {
+			continue;
+		}
+		if (!found) {
+			low = high = top = i;
+			found = true;
+		}
+		if (frequency[i] < frequency[low]) {
+			low = i;
+		}
+		if (frequency[i] > frequency[high]) {
+			high = i;
+		}
+		if (-z_imag[i] > -z_imag[top]) {
+			top = i;
+		}
+		double modulus = hypot(z_real[i], z_imag[i]);
+		if (modulus > max_modulus) {
+			max_modulus = modulus;
+		}
+	}
+	double minimum = 1e-3 * max_modulus;
+	double rs = (z_real[high] > minimum) ? z_real[high] : minimum;
+	double rct = z_real[low] - rs;
+	if (rct < minimum) {
+		rct = minimum;
+	}
+	double omega_top = TWO_PI * frequency[top];
+	double omega_low = TWO_PI * frequency[low];
+	p[MSCRIPT_EIS_PARAMETER_RS] = rs;
+	p[MSCRIPT_EIS_PARAMETER_RCT] = rct;
+	p[MSCRIPT_EIS_PARAMETER_CDL] = 1.0 / (omega_top * rct);
+	if (model == MSCRIPT_EIS_MODEL_RANDLES_WARBURG) {
+		// Attribute part of the low frequency imaginary part to diffusion.
+		double sigma = 0.5 * fabs(z_imag[low]) * sqrt(omega_low);
+		double minimum_sigma = 1e-3 * rct * sqrt(omega_low);
+		p[MSCRIPT_EIS_PARAMETER_SIGMA] = (sigma > minimum_sigma) ? sigma : minimum_sigma;
+	}
+}
+
+/**
+ * Calculate chi square and, optionally, the normal equations of the fit.
+ *
+ * The residuals are the differences between the model and the measured real
+ * and imaginary parts, divided by the measured modulus. The Jacobian is taken
+ * to the logarithm of the parameters: d/d(ln p) = p * d/dp.
+ *
+ * \param jtj[out] J^T J, or NULL to only calculate chi square.
+ * \param jtr[out] J^T r (if `jtj` is not NULL).
+ *
+ * \return Chi square.
+ */
+static double calculate_chi_square(MscriptEisModel_t model, double const * frequency,
+	double const * z_real, double const * z_imag, size_t count, double const * p,
+	double jtj[MSCRIPT_EIS_FIT_MAX_PARAMETERS][MSCRIPT_EIS_FIT_MAX_PARAMETERS], double * jtr)
+{
+	size_t n = mscript_eis_model_nr_of_parameters(model);
+	Complex_t derivatives[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+	double chi_square = 0.0;
+	if (jtj != NULL) {
+		memset(jtj, 0, sizeof(double) * MSCRIPT_EIS_FIT_MAX_PARAMETERS
+			* MSCRIPT_EIS_FIT_MAX_PARAMETERS);
+		memset(jtr, 0, sizeof(double) * MSCRIPT_EIS_FIT_MAX_PARAMETERS);
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (!is_valid_point(frequency[i], z_real[i], z_imag[i])) {
+			continue;
+		}
+		Complex_t z;
+		evaluate(model, p, TWO_PI * frequency[i], &z, (jtj != NULL) ? derivatives : NULL);
+		double weight = 1.0 / hypot(z_real[i], z_imag[i]);
+		double r_re = (z.re - z_real[i]) * weight;
+		double r_im = (z.im - z_imag[i]) * weight;
+		chi_square += r_re * r_re + r_im * r_im;
+		if (jtj == NULL) {
+			continue;
+		}
+		double j_re[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		double j_im[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		for (size_t k = 0; k < n; ++k) {
+			j_re[k] = derivatives[k].re * p[k] * weight;
+			j_im[k] = derivatives[k].im * p[k] * weight;
+		}
+		for (size_t k = 0; k < n; ++k) {
+			for (size_t l = 0; l <= k; ++l) {
+				jtj[k][l] += j_re[k] * j_re[l] + j_im[k] * j_im[l];
+			}
+			jtr[k] += j_re[k] * r_re + j_im[k] * r_im;
+		}
+	}
+	if (jtj != NULL) {
+		for (size_t k = 0; k < n; ++k) {
+			for (size_t l = k + 1; l < n; ++l) {
+				jtj[k][l] = jtj[l][k];
+			}
+		}
+	}
+	return chi_square;
+}
+
+/**
+ * Solve the linear system `a * x = b` (n x n) using Gaussian elimination with
+ * partial pivoting. `a` and `b` are modified.
+ *
+ * \return `false` if the matrix is singular.
+ */
+static bool solve(double a[MSCRIPT_EIS_FIT_MAX_PARAMETERS][MSCRIPT_EIS_FIT_MAX_PARAMETERS],
+	double * b, double * x, size_t n)
+{
+	for (size_t col = 0; col < n; ++col) {
+		size_t pivot = col;
+		for (size_t row = col + 1; row < n; ++row) {
+			if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+				pivot = row;
+			}
+		}
+		if (a[pivot][col] == 0.0) {
+			return false;
+		}
+		for (size_t k = 0; k < n; ++k) {
+			double tmp = a[col][k];
+			a[col][k] = a[pivot][k];
+			a[pivot][k] = tmp;
+		}
+		double tmp = b[col];
+		b[col] = b[pivot];
+		b[pivot] = tmp;
+		for (size_t row = col + 1; row < n; ++row) {
+			double factor = a[row][col] / a[col][col];
+			for (size_t k = col; k < n; ++k) {
+				a[row][k] -= factor * a[col][k];
+			}
+			b[row] -= factor * b[col];
+		}
+	}
+	for (size_t row = n; row-- > 0;) {
+		double sum = b[row];
+		for (size_t k = row + 1; k < n; ++k) {
+			sum -= a[row][k] * x[k];
+		}
+		x[row] = sum / a[row][row];
+	}
+	return true;
+}
+
+/**
+ * Estimate the standard errors of the parameters from the covariance matrix,
+ * (J^T J)^-1 * chi_square / (degrees of freedom).
+ */
+static void calculate_standard_errors(MscriptEisFitResult_t * result,
+	double jtj[MSCRIPT_EIS_FIT_MAX_PARAMETERS][MSCRIPT_EIS_FIT_MAX_PARAMETERS])
+{
+	size_t n = result->nr_of_parameters;
+	size_t dof = 2 * result->nr_of_points - n;
+	for (size_t k = 0; k < n; ++k) {
+		double a[MSCRIPT_EIS_FIT_MAX_PARAMETERS][MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		double b[MSCRIPT_EIS_FIT_MAX_PARAMETERS] = { 0 };
+		double x[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		memcpy(a, jtj, sizeof(a));
+		b[k] = 1.0;
+		if ((dof == 0) || !solve(a, b, x, n) || (x[k] < 0.0)) {
+			result->standard_errors[k] = NAN;
+			continue;
+		}
+		// The variance is of ln(p), so multiply by p.
+		result->standard_errors[k] = result->parameters[k]
+			* sqrt(x[k] * result->chi_square / dof);
+	}
+}
+
+/**
+ * Fit a model to an impedance spectrum.
+ *
+ * Points with a NaN value or a frequency of 0 are ignored. The order of the
+ * points does not matter.
+ *
+ * \param model The model.
+ * \param frequency The frequency of each point (Hz).
+ * \param z_real The real part of the impedance of each point (Ohm).
+ * \param z_imag The imaginary part of the impedance of each point (Ohm).
+ * \param count The number of points.
+ * \param[out] result The result.
+ *
+ * \return `true` if the fit converged, `false` if it did not converge or the
+ *         spectrum has too few points (the result is still filled in)
+ */
+bool mscript_eis_fit(MscriptEisModel_t model, double const * frequency, double const * z_real,
+	double const * z_imag, size_t count, MscriptEisFitResult_t * result)
+{
+	memset(result, 0, sizeof(MscriptEisFitResult_t));
+	size_t n = mscript_eis_model_nr_of_parameters(model);
+	result->model = model;
+	result->nr_of_parameters = n;
+	for (size_t k = 0; k < MSCRIPT_EIS_FIT_MAX_PARAMETERS; ++k) {
+		result->parameters[k] = NAN;
+		result->standard_errors[k] = NAN;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (is_valid_point(frequency[i], z_real[i], z_imag[i])) {
+			++result->nr_of_points;
+		}
+	}
+	// Each point gives two residuals (real and imaginary part).
+	if (2 * result->nr_of_points < n) {
+		DEBUG_PRINTF("Too few points to fit the spectrum.\n");
+		result->chi_square = NAN;
+		result->rms_error = NAN;
+		return false;
+	}
+
+	double p[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+	double jtj[MSCRIPT_EIS_FIT_MAX_PARAMETERS][MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+	double jtr[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+	estimate_parameters(model, frequency, z_real, z_imag, count, p);
+	double chi_square = calculate_chi_square(model, frequency, z_real, z_imag, count, p, jtj, jtr);
+	double lambda = INITIAL_LAMBDA;
+
+	while (result->nr_of_iterations < MAX_ITERATIONS) {
+		++result->nr_of_iterations;
+		// Solve (J^T J + lambda * diag(J^T J)) delta = -J^T r.
+		double a[MSCRIPT_EIS_FIT_MAX_PARAMETERS][MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		double b[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		double delta[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		memcpy(a, jtj, sizeof(a));
+		for (size_t k = 0; k < n; ++k) {
+			a[k][k] += lambda * ((jtj[k][k] > 0.0) ? jtj[k][k] : 1e-12);
+			b[k] = -jtr[k];
+		}
+		double trial[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+		bool is_solved = solve(a, b, delta, n);
+		for (size_t k = 0; is_solved && (k < n); ++k) {
+			double step = delta[k];
+			if (step > MAX_STEP) {
+				step = MAX_STEP;
+			} else if (step < -MAX_STEP) {
+				step = -MAX_STEP;
+			}
+			trial[k] = p[k] * exp(step);
+		}
+		double trial_chi_square = is_solved ? calculate_chi_square(model, frequency, z_real,
+			z_imag, count, trial, NULL, NULL) : INFINITY;
+
+		if (trial_chi_square < chi_square) {
+			double improvement = (chi_square - trial_chi_square) / chi_square;
+			memcpy(p, trial, sizeof(p));
+			chi_square = calculate_chi_square(model, frequency, z_real, z_imag, count, p, jtj,
+				jtr);
+			lambda = (lambda > 1e-12) ? lambda / 10.0 : lambda;
+			if (improvement < CONVERGENCE_TOLERANCE) {
+				result->converged = true;
+				break;
+			}
+		} else {
+			lambda *= 10.0;
+			if (lambda > MAX_LAMBDA) {
+				// No step improves the fit: this is the minimum.
+				result->converged = true;
+				break;
+			}
+		}
+		if (chi_square == 0.0) {
+			result->converged = true;
+			break;
+		}
+	}
+
+	memcpy(result->parameters, p, n * sizeof(double));
+	result->chi_square = chi_square;
+	result->rms_error = sqrt(chi_square / (2 * result->nr_of_points));
+	calculate_standard_errors(result, jtj);
+	return result->converged;
+}
+
+/**
+ * Fit a submitted spectrum (`MscriptWorkFunction_t`).
+ */
+static void fit_job(void * arg)
+{
+	Job_t * job = arg;
+	MscriptEisFitResult_t result;
+	mscript_eis_fit(job->model, job->frequency, job->z_real, job->z_imag, job->count, &result);
+	job->callback(job->context, !isnan(result.chi_square) ? &result : NULL);
+	free(job);
+}
+
+/**
+ * Submit a spectrum to be fitted by a pool of worker threads.
+ *
+ * The data is copied, so it does not have to remain valid. The spectra are
+ * fitted in the order they are submitted, but the callbacks may be called in
+ * a different order when the pool has more than one thread.
+ *
+ * \param workers The pool of worker threads.
+ * \param model The model to fit.
+ * \param frequency The frequency of each point (Hz).
+ * \param z_real The real part of the impedance of each point (Ohm).
+ * \param z_imag The imaginary part of the impedance of each point (Ohm).
+ * \param count The number of points.
+ * \param callback Function that receives the result.
+ * \param context Passed to `callback`.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+bool mscript_eis_fit_submit(MscriptWorkers_t * workers, MscriptEisModel_t model,
+	double const * frequency, double const * z_real, double const * z_imag, size_t count,
+	MscriptEisFitCallback_t callback, void * context)
+{
+	assert(callback != NULL);
+	Job_t * job = malloc(sizeof(Job_t) + 3 * count * sizeof(double));
+	if (job == NULL) {
+		return false;
+	}
+	job->model = model;
+	job->count = count;
+	job->callback = callback;
+	job->context = context;
+	job->frequency = (double *)(job + 1);
+	job->z_real = job->frequency + count;
+	job->z_imag = job->z_real + count;
+	memcpy(job->frequency, frequency, count * sizeof(double));
+	memcpy(job->z_real, z_real, count * sizeof(double));
+	memcpy(job->z_imag, z_imag, count * sizeof(double));
+	if (!mscript_workers_submit(workers, fit_job, job)) {
+		free(job);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Submit the spectrum of a measurement loop in a column store to be fitted by
+ * a pool of worker threads.
+ *
+ * The spectrum consists of the frequency (`MSCRIPT_VARTYPE_CELL_SET_FREQUENCY`),
+ * real part (`MSCRIPT_VARTYPE_ZREAL`) and imaginary part (`MSCRIPT_VARTYPE_ZIMAG`)
+ * columns of the rows of the measurement loop.
+ *
+ * \param workers The pool of worker threads.
+ * \param model The model to fit.
+ * \param channel The channel in the column store.
+ * \param loop The measurement loop (see `mscript_channel_find_loop()`).
+ * \param callback Function that receives the result.
+ * \param context Passed to `callback`.
+ *
+ * \return `true` on success, `false` if the channel does not have the required
+ *         columns or on failure to allocate memory
+ */
+bool mscript_eis_fit_submit_loop(MscriptWorkers_t * workers, MscriptEisModel_t model,
+	MscriptChannelColumns_t const * channel, MscriptLoopIndexEntry_t const * loop,
+	MscriptEisFitCallback_t callback, void * context)
+{
+	MscriptColumnView_t frequency;
+	MscriptColumnView_t z_real;
+	MscriptColumnView_t z_imag;
+	if (!mscript_channel_get_column(channel, loop->meas_loop_index,
+			MSCRIPT_VARTYPE_CELL_SET_FREQUENCY, &frequency)
+		|| !mscript_channel_get_column(channel, loop->meas_loop_index, MSCRIPT_VARTYPE_ZREAL,
+			&z_real)
+		|| !mscript_channel_get_column(channel, loop->meas_loop_index, MSCRIPT_VARTYPE_ZIMAG,
+			&z_imag)) {
+		DEBUG_PRINTF("Channel %u has no impedance spectrum.\n", channel->channel);
+		return false;
+	}
+	return mscript_eis_fit_submit(workers, model, frequency.values, z_real.values, z_imag.values,
+		loop->nr_of_rows, callback, context);
+}
@@ -0,0 +1,142 @@
+/**
+ * \file
+ * Equivalent circuit fitting of impedance spectra.
+ *
+ * An EIS measurement (`meas_loop_eis`) returns the frequency (variable type
+ * "dc"), and the real and imaginary part of the impedance ("cc" and "cd") at
+ * each frequency. This module fits the parameters of a Randles circuit to such
+ * a spectrum:
+ *
+ *     Rs + (Cdl || (Rct + W))
+ *
+ * where Rs is the solution resistance, Cdl the double layer capacitance, Rct
+ * the charge transfer resistance and W an (optional) semi-infinite Warburg
+ * element with impedance sigma * (1 - j) / sqrt(omega).
+ *
+ * The fit uses the Levenberg-Marquardt method with an analytic Jacobian. The
+ * residuals are weighted by the modulus of the measured impedance, so all
+ * frequencies contribute equally, and the logarithm of each parameter is
+ * fitted, so the parameters are always positive. The initial values are
+ * estimated from the spectrum itself.
+ *
+ * A single spectrum can be fitted using `mscript_eis_fit()`. To fit many
+ * spectra, they are submitted to a pool of worker threads (see
+ * `mscript_workers.h`), which fits them in parallel. The spectra can be taken
+ * directly from the column store (see `mscript_columns.h`); the data is copied
+ * when a spectrum is submitted, so the store can be modified while the fits
+ * run.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript_columns.h"
+#include "mscript_workers.h"
+
+/// Maximum number of parameters of a model.
+#define MSCRIPT_EIS_FIT_MAX_PARAMETERS 4
+
+/** Equivalent circuit models. */
+typedef enum {
+	/** Rs + (Cdl || Rct). */
+	MSCRIPT_EIS_MODEL_RANDLES,
+	/** Rs + (Cdl || (Rct + W)). */
+	MSCRIPT_EIS_MODEL_RANDLES_WARBURG,
+} MscriptEisModel_t;
+
+/** Index of each parameter in `MscriptEisFitResult_t`. */
+typedef enum {
+	/** Solution resistance (Ohm). */
+	MSCRIPT_EIS_PARAMETER_RS,
+	/** Charge transfer resistance (Ohm). */
+	MSCRIPT_EIS_PARAMETER_RCT,
+	/** Double layer capacitance (F). */
+	MSCRIPT_EIS_PARAMETER_CDL,
+	/** Warburg coefficient (Ohm/sqrt(s)), only for `MSCRIPT_EIS_MODEL_RANDLES_WARBURG`. */
+	MSCRIPT_EIS_PARAMETER_SIGMA,
+} MscriptEisParameter_t;
+
+/** Result of a fit. */
+typedef struct {
+	MscriptEisModel_t model;
+	/** Number of parameters of the model. */
+	size_t nr_of_parameters;
+	/** The fitted parameters (see `MscriptEisParameter_t`). */
+	double parameters[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+	/** Estimated standard error of each parameter. */
+	double standard_errors[MSCRIPT_EIS_FIT_MAX_PARAMETERS];
+	/** Number of (valid) points in the spectrum. */
+	size_t nr_of_points;
+	/** Sum of the squared residuals, relative to the modulus of the impedance. */
+	double chi_square;
+	/** Root mean square of the relative residuals (e.g. 0.01 for 1%). */
+	double rms_error;
+	/** Number of Levenberg-Marquardt iterations. */
+	unsigned int nr_of_iterations;
+	/** `true` if the fit converged. */
+	bool converged;
+} MscriptEisFitResult_t;
+
+/**
+ * Function that receives the result of a submitted spectrum.
+ *
+ * It is called from one of the worker threads.
+ *
+ * \param context The context that was passed when the spectrum was submitted.
+ * \param result The result, or NULL if the spectrum could not be fitted.
+ */
+typedef void (*MscriptEisFitCallback_t)(void * context, MscriptEisFitResult_t const * result);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t mscript_eis_model_nr_of_parameters(MscriptEisModel_t model);
+char const * mscript_eis_parameter_name(MscriptEisParameter_t parameter);
+char const * mscript_eis_parameter_unit(MscriptEisParameter_t parameter);
+void mscript_eis_model_evaluate(MscriptEisModel_t model, double const * parameters,
+	double frequency, double * p_z_real, double * p_z_imag);
+bool mscript_eis_fit(MscriptEisModel_t model, double const * frequency, double const * z_real,
+	double const * z_imag, size_t count, MscriptEisFitResult_t * result);
+
+bool mscript_eis_fit_submit(MscriptWorkers_t * workers, MscriptEisModel_t model,
+	double const * frequency, double const * z_real, double const * z_imag, size_t count,
+	MscriptEisFitCallback_t callback, void * context);
+bool mscript_eis_fit_submit_loop(MscriptWorkers_t * workers, MscriptEisModel_t model,
+	MscriptChannelColumns_t const * channel, MscriptLoopIndexEntry_t const * loop,
+	MscriptEisFitCallback_t callback, void * context);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
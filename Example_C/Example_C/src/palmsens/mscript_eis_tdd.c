@@ -0,0 +1,517 @@
+/**
+ * \file
+ * Impedance and harmonic distortion from EIS time domain data (TDD).
+ *
+ * See `mscript_eis_tdd.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_eis_tdd.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+#include "mscript_fft.h"
+#include "mscript_thread.h"
+
+/// Number of samples allocated for a new block.
+#define INITIAL_BLOCK_CAPACITY 1024
+
+/// Number of results allocated for a new measurement loop.
+#define INITIAL_RESULT_CAPACITY 64
+
+/// Maximum number of FFT plans that are kept for reuse.
+#define MAX_CACHED_FFTS 16
+
+/** The samples of one frequency. */
+typedef struct {
+	MscriptEisTdd_t * tdd;
+	/** The result, with the values of the frequency package filled in. */
+	MscriptEisTddResult_t result;
+	size_t count;
+	size_t capacity;
+	double * potential;
+	double * current;
+} Block_t;
+
+struct MscriptEisTdd {
+	MscriptEisTddCallback_t callback;
+	void * context;
+	/** The block that is being received, or NULL. */
+	Block_t * block;
+	/** The submitted blocks. Its mutex also protects the results. */
+	MscriptWorkGroup_t group;
+	/** The results of the measurement loop, by index of the frequency. */
+	MscriptEisTddResult_t * results;
+	size_t nr_of_results;
+	size_t result_capacity;
+	/**
+	 * FFT plans that are not in use, least recently used first. Protected by
+	 * the mutex of the group.
+	 */
+	MscriptFft_t * ffts[MAX_CACHED_FFTS];
+	size_t nr_of_ffts;
+};
+
+/**
+ * Get the magnitude of a bin of a transform.
+ */
+static double magnitude(double const * re, double const * im, size_t k)
+{
+	return hypot(re[k], im[k]);
+}
+
+/**
+ * Calculate the total harmonic distortion of a signal from its transform.
+ *
+ * \return The THD, or NaN if no harmonic is below the Nyquist frequency.
+ */
+static double calculate_thd(double const * re, double const * im, size_t n, size_t k)
+{
+	double sum = 0.0;
+	bool has_harmonics = false;
+	for (size_t h = 2; h <= MSCRIPT_EIS_TDD_MAX_HARMONIC; ++h) {
+		if (h * k >= (n + 1) / 2) {
+			break;
+		}
+		double m = magnitude(re, im, h * k);
+		sum += m * m;
+		has_harmonics = true;
+	}
+	return has_harmonics ? sqrt(sum) / magnitude(re, im, k) : NAN;
+}
+
+/**
+ * Calculate the impedance and harmonic distortion of one frequency.
+ *
+ * Only the fields that are calculated from the time domain data are set; the
+ * other fields of the result (index, device impedance) are not changed.
+ *
+ * \param fft An FFT plan of length `count` (see `mscript_fft_create()`), or
+ *            NULL to create one for this call only.
+ * \param frequency The applied frequency (Hz).
+ * \param sample_frequency The sample frequency (Hz).
+ * \param potential The samples of the potential (V).
+ * \param current The samples of the current (A).
+ * \param count The number of samples of each signal.
+ * \param[out] result The result.
+ *
+ * \return `true` on success, `false` if the applied frequency is not between 0
+ *         and the Nyquist frequency, or on failure to allocate memory
+ */
+bool mscript_eis_tdd_calculate(MscriptFft_t * fft, double frequency, double sample_frequency,
+	double const * potential, double const * current, size_t count,
+	MscriptEisTddResult_t * result)
+{
+	assert((fft == NULL) || (mscript_fft_get_length(fft) == count));
+	result->is_valid = false;
+	result->frequency = frequency;
+	result->sample_frequency = sample_frequency;
+	result->nr_of_samples = count;
+	result->nr_of_periods = (sample_frequency > 0.0) ? frequency * count / sample_frequency : NAN;
+	result->z_real = result->z_imag = NAN;
+	result->potential_amplitude = result->current_amplitude = NAN;
+	result->potential_thd = result->current_thd = NAN;
+
+	// The bin of the applied frequency (also rejects NaN).
+	double bin = floor(result->nr_of_periods + 0.5);
+	if (!((bin >= 1.0) && (2.0 * bin <= (double)count))) {
+		DEBUG_PRINTF("Frequency %g Hz is not within the spectrum of the samples.\n", frequency);
+		return false;
+	}
+	size_t k = (size_t)bin;
+
+	size_t nr_of_bins = count / 2 + 1;
+	MscriptFft_t * own_fft = (fft == NULL) ? mscript_fft_create(count) : NULL;
+	if (fft == NULL) {
+		fft = own_fft;
+	}
+	double * spectra = malloc(4 * nr_of_bins * sizeof(double));
+	if ((fft == NULL) || (spectra == NULL)) {
+		if (own_fft != NULL) {
+			mscript_fft_destroy(own_fft);
+		}
+		free(spectra);
+		return false;
+	}
+	double * e_re = spectra;
+	double * e_im = e_re + nr_of_bins;
+	double * i_re = e_im + nr_of_bins;
+	double * i_im = i_re + nr_of_bins;
+	mscript_fft_real(fft, potential, e_re, e_im);
+	mscript_fft_real(fft, current, i_re, i_im);
+
+	// Z = E / I at the applied frequency.
+	double d = i_re[k] * i_re[k] + i_im[k] * i_im[k];
+	if (d > 0.0) {
+		result->z_real = (e_re[k] * i_re[k] + e_im[k] * i_im[k]) / d;
+		result->z_imag = (e_im[k] * i_re[k] - e_re[k] * i_im[k]) / d;
+		result->is_valid = true;
+	}
+	// At the Nyquist frequency the bin is not doubled.
+	double scale = (2 * k == count) ? 1.0 / count : 2.0 / count;
+	result->potential_amplitude = magnitude(e_re, e_im, k) * scale;
+	result->current_amplitude = magnitude(i_re, i_im, k) * scale;
+	result->potential_thd = calculate_thd(e_re, e_im, count, k);
+	result->current_thd = calculate_thd(i_re, i_im, count, k);
+
+	free(spectra);
+	if (own_fft != NULL) {
+		mscript_fft_destroy(own_fft);
+	}
+	return result->is_valid;
+}
+
+/**
+ * Take an FFT plan of a given length from the cache, or create one if none
+ * is available.
+ *
+ * \return The plan, or NULL on failure.
+ */
+static MscriptFft_t * take_fft(MscriptEisTdd_t * tdd, size_t count)
+{
+	MscriptFft_t * fft = NULL;
+	mscript_mutex_lock(&tdd->group.mutex);
+	for (size_t i = tdd->nr_of_ffts; i-- > 0;) {
+		if (mscript_fft_get_length(tdd->ffts[i]) == count) {
+			fft = tdd->ffts[i];
+			memmove(&tdd->ffts[i], &tdd->ffts[i + 1],
+				(tdd->nr_of_ffts - i - 1) * sizeof(MscriptFft_t *));
+			--tdd->nr_of_ffts;
+			break;
+		}
+	}
+	mscript_mutex_unlock(&tdd->group.mutex);
+	return (fft != NULL) ? fft : mscript_fft_create(count);
+}
+
+/**
+ * Return an FFT plan to the cache. If the cache is full, the least recently
+ * used plan is freed.
+ */
+static void give_back_fft(MscriptEisTdd_t * tdd, MscriptFft_t * fft)
+{
+	MscriptFft_t * evicted = NULL;
+	mscript_mutex_lock(&tdd->group.mutex);
+	if (tdd->nr_of_ffts == MAX_CACHED_FFTS) {
+		evicted = tdd->ffts[0];
+		memmove(&tdd->ffts[0], &tdd->ffts[1], (MAX_CACHED_FFTS - 1) * sizeof(MscriptFft_t *));
+		--tdd->nr_of_ffts;
+	}
+	tdd->ffts[tdd->nr_of_ffts++] = fft;
+	mscript_mutex_unlock(&tdd->group.mutex);
+	if (evicted != NULL) {
+		mscript_fft_destroy(evicted);
+	}
+}
+
+/**
+ * Free a block.
+ */
+static void free_block(Block_t * block)
+{
+	free(block->potential);
+	free(block->current);
+	free(block);
+}
+
+/**
+ * Process a block of samples (`MscriptWorkFunction_t`).
+ */
+static void process_block(void * arg)
+{
+	Block_t * block = arg;
+	MscriptEisTdd_t * tdd = block->tdd;
+	MscriptEisTddResult_t * result = &block->result;
+	// The plans are reused, since a measurement loop usually has the same
+	// number of samples for all (or most) frequencies.
+	MscriptFft_t * fft = (block->count > 0) ? take_fft(tdd, block->count) : NULL;
+	mscript_eis_tdd_calculate(fft, result->frequency, result->sample_frequency,
+		block->potential, block->current, block->count, result);
+	if (fft != NULL) {
+		give_back_fft(tdd, fft);
+	}
+	if (tdd->callback != NULL) {
+		tdd->callback(tdd->context, result);
+	}
+
+	mscript_mutex_lock(&tdd->group.mutex);
+	tdd->results[result->index] = *result;
+	mscript_work_group_done(&tdd->group);
+	mscript_mutex_unlock(&tdd->group.mutex);
+	free_block(block);
+}
+
+/**
+ * Create a collector for the time domain data of EIS measurement loops.
+ *
+ * \param workers The pool of worker threads that processes the frequencies.
+ * \param callback Function that receives each result as soon as it has been
+ *                 calculated, or NULL.
+ * \param context Passed to `callback`.
+ *
+ * \return The collector, or NULL on failure.
+ */
+MscriptEisTdd_t * mscript_eis_tdd_create(MscriptWorkers_t * workers,
+	MscriptEisTddCallback_t callback, void * context)
+{
+	MscriptEisTdd_t * tdd = calloc(1, sizeof(MscriptEisTdd_t));
+	if (tdd == NULL) {
+		return NULL;
+	}
+	tdd->results = malloc(INITIAL_RESULT_CAPACITY * sizeof(MscriptEisTddResult_t));
+	if (tdd->results == NULL) {
+		free(tdd);
+		return NULL;
+	}
+	tdd->result_capacity = INITIAL_RESULT_CAPACITY;
+	tdd->callback = callback;
+	tdd->context = context;
+	mscript_work_group_init(&tdd->group, workers);
+	return tdd;
+}
+
+/**
+ * Free a collector. This waits until the submitted frequencies have been
+ * processed; a block that has not been submitted is discarded.
+ */
+void mscript_eis_tdd_destroy(MscriptEisTdd_t * tdd)
+{
+	mscript_eis_tdd_reset(tdd);
+	mscript_work_group_destroy(&tdd->group);
+	for (size_t i = 0; i < tdd->nr_of_ffts; ++i) {
+		mscript_fft_destroy(tdd->ffts[i]);
+	}
+	free(tdd->results);
+	free(tdd);
+}
+
+/**
+ * Start a new measurement loop: wait until the submitted frequencies have been
+ * processed and discard the results and any block that has not been submitted.
+ */
+void mscript_eis_tdd_reset(MscriptEisTdd_t * tdd)
+{
+	mscript_eis_tdd_wait(tdd);
+	if (tdd->block != NULL) {
+		free_block(tdd->block);
+		tdd->block = NULL;
+	}
+	tdd->nr_of_results = 0;
+}
+
+/**
+ * Start the block of a new frequency.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+static bool start_block(MscriptEisTdd_t * tdd, double frequency, double sample_frequency,
+	MscriptDataPackage_t const * package)
+{
+	Block_t * block = calloc(1, sizeof(Block_t));
+	if (block == NULL) {
+		return false;
+	}
+	block->tdd = tdd;
+	block->capacity = INITIAL_BLOCK_CAPACITY;
+	block->potential = malloc(INITIAL_BLOCK_CAPACITY * sizeof(double));
+	block->current = malloc(INITIAL_BLOCK_CAPACITY * sizeof(double));
+
+	// Reserve the result, the workers may be using the array.
+	mscript_mutex_lock(&tdd->group.mutex);
+	if (tdd->nr_of_results == tdd->result_capacity) {
+		size_t capacity = 2 * tdd->result_capacity;
+		MscriptEisTddResult_t * results = realloc(tdd->results,
+			capacity * sizeof(MscriptEisTddResult_t));
+		if (results != NULL) {
+			tdd->results = results;
+			tdd->result_capacity = capacity;
+		}
+	}
+	bool success = (tdd->nr_of_results < tdd->result_capacity) && (block->potential != NULL)
+		&& (block->current != NULL);
+	if (success) {
+		MscriptEisTddResult_t * result = &block->result;
+		result->index = (unsigned int)tdd->nr_of_results;
+		result->is_valid = false;
+		result->frequency = frequency;
+		result->sample_frequency = sample_frequency;
+		if (!mscript_find_value(package, MSCRIPT_VARTYPE_ZREAL, &result->device_z_real)) {
+			result->device_z_real = NAN;
+		}
+		if (!mscript_find_value(package, MSCRIPT_VARTYPE_ZIMAG, &result->device_z_imag)) {
+			result->device_z_imag = NAN;
+		}
+		tdd->results[tdd->nr_of_results++] = *result;
+	}
+	mscript_mutex_unlock(&tdd->group.mutex);
+
+	if (!success) {
+		free_block(block);
+		return false;
+	}
+	tdd->block = block;
+	return true;
+}
+
+/**
+ * Add a sample to the current block.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+static bool add_sample(Block_t * block, double potential, double current)
+{
+	if (block->count == block->capacity) {
+		size_t capacity = 2 * block->capacity;
+		double * p = realloc(block->potential, capacity * sizeof(double));
+		if (p == NULL) {
+			return false;
+		}
+		block->potential = p;
+		p = realloc(block->current, capacity * sizeof(double));
+		if (p == NULL) {
+			return false;
+		}
+		block->current = p;
+		block->capacity = capacity;
+	}
+	block->potential[block->count] = potential;
+	block->current[block->count] = current;
+	++block->count;
+	return true;
+}
+
+/**
+ * Add a data package of an EIS measurement loop.
+ *
+ * A package with the sample frequency starts a new frequency (and submits
+ * the previous one); a package with a potential and current sample adds
+ * the sample to the current frequency. Other packages are ignored.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+bool mscript_eis_tdd_add_package(MscriptEisTdd_t * tdd, MscriptDataPackage_t const * package)
+{
+	double sample_frequency;
+	if (mscript_find_value(package, MSCRIPT_VARTYPE_EIS_FS, &sample_frequency)) {
+		double frequency;
+		if (!mscript_find_value(package, MSCRIPT_VARTYPE_CELL_SET_FREQUENCY, &frequency)) {
+			frequency = NAN;
+		}
+		return mscript_eis_tdd_finish(tdd)
+			&& start_block(tdd, frequency, sample_frequency, package);
+	}
+	double potential, current;
+	if ((tdd->block != NULL)
+		&& mscript_find_value(package, MSCRIPT_VARTYPE_EIS_TDD_E, &potential)
+		&& mscript_find_value(package, MSCRIPT_VARTYPE_EIS_TDD_I, &current)) {
+		return add_sample(tdd->block, potential, current);
+	}
+	return true;
+}
+
+/**
+ * Submit the current frequency to the worker threads. Call this at the end of
+ * the measurement loop.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_eis_tdd_finish(MscriptEisTdd_t * tdd)
+{
+	Block_t * block = tdd->block;
+	if (block == NULL) {
+		return true;
+	}
+	tdd->block = NULL;
+	if (!mscript_work_group_submit(&tdd->group, process_block, block)) {
+		free_block(block);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Wait until all submitted frequencies have been processed.
+ */
+void mscript_eis_tdd_wait(MscriptEisTdd_t * tdd)
+{
+	mscript_work_group_wait(&tdd->group);
+}
+
+/**
+ * Get the results of the current measurement loop, ordered by frequency.
+ *
+ * Call `mscript_eis_tdd_finish()` and `mscript_eis_tdd_wait()` first; the
+ * results of frequencies that have not been processed are not valid. The
+ * results remain valid until the next package is added or the collector is
+ * reset.
+ *
+ * \param tdd The collector.
+ * \param[out] p_count The number of results.
+ *
+ * \return The results.
+ */
+MscriptEisTddResult_t const * mscript_eis_tdd_get_results(MscriptEisTdd_t const * tdd,
+	size_t * p_count)
+{
+	*p_count = tdd->nr_of_results;
+	return tdd->results;
+}
+
+/**
+ * Process the events of an acquisition.
+ *
+ * This function is an `MscriptEventHandler_t`; use it with the collector as
+ * context as the sink of an acquisition, or call it from another sink. Each
+ * measurement loop starts with an empty list of results; at the end of the
+ * loop the last frequency is submitted.
+ *
+ * \return `true` to continue, `false` on failure
+ */
+bool mscript_eis_tdd_handle_event(void * context, MscriptEvent_t const * event)
+{
+	MscriptEisTdd_t * tdd = context;
+	switch (event->type) {
+	case MSCRIPT_EVENT_MEAS_LOOP_START:
+		mscript_eis_tdd_reset(tdd);
+		return true;
+	case MSCRIPT_EVENT_MEAS_LOOP_END:
+		return mscript_eis_tdd_finish(tdd);
+	case MSCRIPT_EVENT_PACKAGE:
+		assert(event->package != NULL);
+		return mscript_eis_tdd_add_package(tdd, event->package);
+	default:
+		return true;
+	}
+}
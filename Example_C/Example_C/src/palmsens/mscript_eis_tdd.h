@@ -0,0 +1,142 @@
+/**
+ * \file
+ * Impedance and harmonic distortion from EIS time domain data (TDD).
+ *
+ * With the `eis_tdd` option of `meas_loop_eis`, the device also returns the
+ * sampled potential and current signals at each frequency. A typical script
+ * sends one package with the frequency (variable type "dc") and the sample
+ * frequency ("cg"), followed by a loop that sends the samples of the
+ * potential ("ce") and current ("cf"):
+ *
+ *     meas_loop_eis f r j 15m 200k 20 11 0m eis_tdd(u c n s 0)
+ *         pck_start
+ *         pck_add f
+ *         pck_add s
+ *         pck_end
+ *         store_var i 0i ja
+ *         loop i < n
+ *             pck_start
+ *             pck_add u[i]
+ *             pck_add c[i]
+ *             pck_end
+ *             add_var i 1i
+ *         endloop
+ *     endloop
+ *
+ * This module collects the samples of each frequency while the packages are
+ * received. When all samples of a frequency have been received (i.e. at the
+ * next frequency or at the end of the measurement loop), the block is
+ * submitted to a pool of worker threads (see `mscript_workers.h`), which
+ * calculates the spectrum of both signals (see `mscript_fft.h`). The impedance
+ * is the ratio of the potential and current at the applied frequency, and the
+ * total harmonic distortion (THD) is calculated from the 2nd to 5th harmonic.
+ * So the frequencies are processed in parallel, while later frequencies are
+ * still being measured.
+ *
+ * The applied frequency is expected to be (close to) a bin of the transform,
+ * i.e. the block contains an integer number of periods. The number of
+ * periods is reported in the result.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript.h"
+#include "mscript_acquisition.h"
+#include "mscript_fft.h"
+#include "mscript_workers.h"
+
+/// Highest harmonic included in the total harmonic distortion.
+#define MSCRIPT_EIS_TDD_MAX_HARMONIC 5
+
+/** The result of one frequency. */
+typedef struct {
+	/** Index of the frequency in the measurement loop (0 for the first). */
+	unsigned int index;
+	/** `false` if the result could not be calculated (yet). */
+	bool is_valid;
+	/** The applied frequency (Hz). */
+	double frequency;
+	/** The sample frequency (Hz). */
+	double sample_frequency;
+	/** Number of samples of each signal. */
+	size_t nr_of_samples;
+	/** Number of periods of the applied frequency in the block. */
+	double nr_of_periods;
+	/** The impedance (Ohm), calculated from the time domain data. */
+	double z_real;
+	double z_imag;
+	/** The amplitude of the potential (V) and current (A) at the applied frequency. */
+	double potential_amplitude;
+	double current_amplitude;
+	/** Total harmonic distortion of the potential and current (e.g. 0.01 for 1%). */
+	double potential_thd;
+	double current_thd;
+	/** The impedance reported by the device (Ohm), or NaN if not in the package. */
+	double device_z_real;
+	double device_z_imag;
+} MscriptEisTddResult_t;
+
+/**
+ * Function that receives the result of a frequency as soon as it has been
+ * calculated. It is called from one of the worker threads, so the results of
+ * the frequencies may arrive in any order.
+ */
+typedef void (*MscriptEisTddCallback_t)(void * context, MscriptEisTddResult_t const * result);
+
+/** Collects and processes the time domain data of a measurement loop. */
+typedef struct MscriptEisTdd MscriptEisTdd_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool mscript_eis_tdd_calculate(MscriptFft_t * fft, double frequency, double sample_frequency,
+	double const * potential, double const * current, size_t count,
+	MscriptEisTddResult_t * result);
+
+MscriptEisTdd_t * mscript_eis_tdd_create(MscriptWorkers_t * workers,
+	MscriptEisTddCallback_t callback, void * context);
+void mscript_eis_tdd_destroy(MscriptEisTdd_t * tdd);
+void mscript_eis_tdd_reset(MscriptEisTdd_t * tdd);
+bool mscript_eis_tdd_add_package(MscriptEisTdd_t * tdd, MscriptDataPackage_t const * package);
+bool mscript_eis_tdd_finish(MscriptEisTdd_t * tdd);
+void mscript_eis_tdd_wait(MscriptEisTdd_t * tdd);
+MscriptEisTddResult_t const * mscript_eis_tdd_get_results(MscriptEisTdd_t const * tdd,
+	size_t * p_count);
+bool mscript_eis_tdd_handle_event(void * context, MscriptEvent_t const * event);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
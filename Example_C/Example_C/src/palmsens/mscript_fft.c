@@ -0,0 +1,350 @@
+/**
+ * \file
+ * Fast Fourier transform of real data.
+ *
+ * See `mscript_fft.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_fft.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+/// pi.
+#define PI 3.141592653589793
+
+/// 2 * pi.
+#define TWO_PI 6.283185307179586
+
+/** A complex transform of a power-of-two length. */
+typedef struct {
+	size_t m;
+	/** Twiddle factors exp(-2 pi i k / m), k = 0 .. m/2 - 1. */
+	double * cos_table;
+	double * sin_table;
+	/** Bit reversal permutation. */
+	size_t * bit_reverse;
+} ComplexFft_t;
+
+struct MscriptFft {
+	size_t n;
+	/** `true` if n is a power of two (and at least 2). */
+	bool is_power_of_two;
+	ComplexFft_t complex;
+	/** Working memory of the complex transform (`complex.m` values each). */
+	double * work_re;
+	double * work_im;
+	/** Power of two: twiddle factors exp(-2 pi i k / n), k = 0 .. n/2. */
+	double * split_cos;
+	double * split_sin;
+	/** Bluestein: chirp exp(-pi i k^2 / n), k = 0 .. n-1. */
+	double * chirp_re;
+	double * chirp_im;
+	/** Bluestein: transform of the conjugated chirp filter. */
+	double * filter_re;
+	double * filter_im;
+};
+
+static bool is_power_of_two(size_t n)
+{
+	return (n >= 2) && ((n & (n - 1)) == 0);
+}
+
+/**
+ * Initialize a complex transform of length m (a power of two).
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+static bool complex_fft_init(ComplexFft_t * fft, size_t m)
+{
+	fft->m = m;
+	fft->cos_table = malloc((m / 2 + 1) * sizeof(double));
+	fft->sin_table = malloc((m / 2 + 1) * sizeof(double));
+	fft->bit_reverse = malloc(m * sizeof(size_t));
+	if ((fft->cos_table == NULL) || (fft->sin_table == NULL) || (fft->bit_reverse == NULL)) {
+		return false;
+	}
+	for (size_t k = 0; k < m / 2; ++k) {
+		fft->cos_table[k] = cos(TWO_PI * k / m);
+		fft->sin_table[k] = -sin(TWO_PI * k / m);
+	}
+	unsigned int bits = 0;
+	while (((size_t)1 << bits) < m) {
+		++bits;
+	}
+	for (size_t i = 0; i < m; ++i) {
+		size_t reversed = 0;
+		for (unsigned int b = 0; b < bits; ++b) {
+			if (i & ((size_t)1 << b)) {
+				reversed |= (size_t)1 << (bits - 1 - b);
+			}
+		}
+		fft->bit_reverse[i] = reversed;
+	}
+	return true;
+}
+
+static void complex_fft_free(ComplexFft_t * fft)
+{
+	free(fft->cos_table);
+	free(fft->sin_table);
+	free(fft->bit_reverse);
+}
+
+/**
+ * In-place complex transform (iterative radix-2, decimation in time).
+ *
+ * \param inverse `true` for the inverse transform (without the 1/m scaling).
+ */
+static void complex_fft(ComplexFft_t const * fft, double * re, double * im, bool inverse)
+{
+	size_t m = fft->m;
+	for (size_t i = 0; i < m; ++i) {
+		size_t j = fft->bit_reverse[i];
+		if (j > i) {
+			double t = re[i];
+			re[i] = re[j];
+			re[j] = t;
+			t = im[i];
+			im[i] = im[j];
+			im[j] = t;
+		}
+	}
+	double sign = inverse ? -1.0 : 1.0;
+	for (size_t size = 2; size <= m; size *= 2) {
+		size_t half = size / 2;
+		size_t step = m / size;
+		for (size_t start = 0; start < m; start += size) {
+			for (size_t k = 0; k < half; ++k) {
+				double w_re = fft->cos_table[k * step];
+				double w_im = sign * fft->sin_table[k * step];
+				size_t a = start + k;
+				size_t b = a + half;
+				double t_re = re[b] * w_re - im[b] * w_im;
+				double t_im = re[b] * w_im + im[b] * w_re;
+				re[b] = re[a] - t_re;
+				im[b] = im[a] - t_im;
+				re[a] += t_re;
+				im[a] += t_im;
+			}
+		}
+	}
+}
+
+/**
+ * Create a plan for the transform of n real samples.
+ *
+ * \return The plan, or NULL if n is 0 or on failure to allocate memory.
+ */
+MscriptFft_t * mscript_fft_create(size_t n)
+{
+	if (n == 0) {
+		return NULL;
+	}
+	MscriptFft_t * fft = calloc(1, sizeof(MscriptFft_t));
+	if (fft == NULL) {
+		return NULL;
+	}
+	fft->n = n;
+	fft->is_power_of_two = is_power_of_two(n);
+
+	bool success;
+	if (fft->is_power_of_two) {
+		// The n real samples are transformed as n/2 complex samples.
+		size_t m = n / 2;
+		fft->split_cos = malloc((m + 1) * sizeof(double));
+		fft->split_sin = malloc((m + 1) * sizeof(double));
+		fft->work_re = malloc(m * sizeof(double));
+		fft->work_im = malloc(m * sizeof(double));
+		success = (fft->split_cos != NULL) && (fft->split_sin != NULL)
+			&& (fft->work_re != NULL) && (fft->work_im != NULL)
+			&& complex_fft_init(&fft->complex, m);
+		for (size_t k = 0; success && (k <= m); ++k) {
+			fft->split_cos[k] = cos(TWO_PI * k / n);
+			fft->split_sin[k] = -sin(TWO_PI * k / n);
+		}
+	} else {
+		// Bluestein: the convolution needs a length of at least 2n - 1.
+		size_t m = 1;
+		while (m < 2 * n - 1) {
+			m *= 2;
+		}
+		fft->chirp_re = malloc(n * sizeof(double));
+		fft->chirp_im = malloc(n * sizeof(double));
+		fft->filter_re = calloc(m, sizeof(double));
+		fft->filter_im = calloc(m, sizeof(double));
+		fft->work_re = malloc(m * sizeof(double));
+		fft->work_im = malloc(m * sizeof(double));
+		success = (fft->chirp_re != NULL) && (fft->chirp_im != NULL)
+			&& (fft->filter_re != NULL) && (fft->filter_im != NULL)
+			&& (fft->work_re != NULL) && (fft->work_im != NULL)
+			&& complex_fft_init(&fft->complex, m);
+		if (success) {
+			for (size_t k = 0; k < n; ++k) {
+				// pi * k^2 / n, using k^2 mod 2n to keep the angle accurate for large k.
+				double angle = PI * (double)((k * k) % (2 * n)) / n;
+				fft->chirp_re[k] = cos(angle);
+				fft->chirp_im[k] = -sin(angle);
+			}
+			fft->filter_re[0] = fft->chirp_re[0];
+			fft->filter_im[0] = -fft->chirp_im[0];
+			for (size_t k = 1; k < n; ++k) {
+				fft->filter_re[k] = fft->filter_re[m - k] = fft->chirp_re[k];
+				fft->filter_im[k] = fft->filter_im[m - k] = -fft->chirp_im[k];
+			}
+			complex_fft(&fft->complex, fft->filter_re, fft->filter_im, false);
+		}
+	}
+	if (!success) {
+		mscript_fft_destroy(fft);
+		return NULL;
+	}
+	return fft;
+}
+
+/**
+ * Free a plan.
+ */
+void mscript_fft_destroy(MscriptFft_t * fft)
+{
+	complex_fft_free(&fft->complex);
+	free(fft->work_re);
+	free(fft->work_im);
+	free(fft->split_cos);
+	free(fft->split_sin);
+	free(fft->chirp_re);
+	free(fft->chirp_im);
+	free(fft->filter_re);
+	free(fft->filter_im);
+	free(fft);
+}
+
+/**
+ * Get the number of samples of a plan.
+ */
+size_t mscript_fft_get_length(MscriptFft_t const * fft)
+{
+	return fft->n;
+}
+
+/**
+ * Transform n real samples (power of two) using a complex transform of n/2.
+ */
+static void real_fft_power_of_two(MscriptFft_t * fft, double const * input, double * re,
+	double * im)
+{
+	size_t m = fft->n / 2;
+	double * z_re = fft->work_re;
+	double * z_im = fft->work_im;
+	for (size_t k = 0; k < m; ++k) {
+		z_re[k] = input[2 * k];
+		z_im[k] = input[2 * k + 1];
+	}
+	if (m > 1) {
+		complex_fft(&fft->complex, z_re, z_im, false);
+	}
+	// Separate the transforms of the even and odd samples:
+	// X[k] = E[k] + exp(-2 pi i k / n) O[k], with
+	// E[k] = (Z[k] + conj(Z[m-k])) / 2 and O[k] = (Z[k] - conj(Z[m-k])) / 2i.
+	for (size_t k = 0; k <= m; ++k) {
+		size_t a = (k == m) ? 0 : k;
+		size_t b = (k == 0) ? 0 : m - k;
+		double e_re = 0.5 * (z_re[a] + z_re[b]);
+		double e_im = 0.5 * (z_im[a] - z_im[b]);
+		double o_re = 0.5 * (z_im[a] + z_im[b]);
+		double o_im = -0.5 * (z_re[a] - z_re[b]);
+		double w_re = fft->split_cos[k];
+		double w_im = fft->split_sin[k];
+		re[k] = e_re + w_re * o_re - w_im * o_im;
+		im[k] = e_im + w_re * o_im + w_im * o_re;
+	}
+}
+
+/**
+ * Transform n real samples (any length) using Bluestein's algorithm.
+ */
+static void real_fft_bluestein(MscriptFft_t * fft, double const * input, double * re,
+	double * im)
+{
+	size_t n = fft->n;
+	size_t m = fft->complex.m;
+	double * a_re = fft->work_re;
+	double * a_im = fft->work_im;
+	for (size_t k = 0; k < n; ++k) {
+		a_re[k] = input[k] * fft->chirp_re[k];
+		a_im[k] = input[k] * fft->chirp_im[k];
+	}
+	memset(&a_re[n], 0, (m - n) * sizeof(double));
+	memset(&a_im[n], 0, (m - n) * sizeof(double));
+	complex_fft(&fft->complex, a_re, a_im, false);
+	for (size_t k = 0; k < m; ++k) {
+		double t_re = a_re[k] * fft->filter_re[k] - a_im[k] * fft->filter_im[k];
+		double t_im = a_re[k] * fft->filter_im[k] + a_im[k] * fft->filter_re[k];
+		a_re[k] = t_re;
+		a_im[k] = t_im;
+	}
+	complex_fft(&fft->complex, a_re, a_im, true);
+	for (size_t k = 0; k <= n / 2; ++k) {
+		double c_re = a_re[k] / m;
+		double c_im = a_im[k] / m;
+		re[k] = c_re * fft->chirp_re[k] - c_im * fft->chirp_im[k];
+		im[k] = c_re * fft->chirp_im[k] + c_im * fft->chirp_re[k];
+	}
+}
+
+/**
+ * Calculate the spectrum of n real samples.
+ *
+ * Bin k corresponds to the frequency k * fs / n, where fs is the sample
+ * frequency. The transform is not scaled: a sine wave with amplitude A at
+ * bin k (0 < k < n/2) gives a bin with magnitude A * n / 2.
+ *
+ * \param fft The plan for n samples.
+ * \param input The samples (n values).
+ * \param[out] re Real part of bins 0 to n/2 (n/2 + 1 values).
+ * \param[out] im Imaginary part of bins 0 to n/2 (n/2 + 1 values).
+ */
+void mscript_fft_real(MscriptFft_t * fft, double const * input, double * re, double * im)
+{
+	if (fft->n == 1) {
+		re[0] = input[0];
+		im[0] = 0.0;
+	} else if (fft->is_power_of_two) {
+		real_fft_power_of_two(fft, input, re, im);
+	} else {
+		real_fft_bluestein(fft, input, re, im);
+	}
+}
@@ -0,0 +1,68 @@
+/**
+ * \file
+ * Fast Fourier transform of real data.
+ *
+ * Calculates the spectrum (bins 0 to n/2) of n real samples. When n is a power
+ * of two, the samples are transformed as a complex sequence of half the
+ * length, which halves the amount of work. Other lengths (e.g. the number of
+ * samples of an EIS time domain measurement, which depends on the frequency)
+ * are transformed using Bluestein's algorithm, which turns the transform into
+ * a convolution calculated with power-of-two transforms, so every length takes
+ * O(n log n) time.
+ *
+ * A plan (`MscriptFft_t`) contains the precalculated twiddle factors and the
+ * working memory for one length. Creating a plan takes O(n) time; reuse it to
+ * transform many blocks of the same length. A plan must not be used by more
+ * than one thread at the same time.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** A plan for the transform of one length. */
+typedef struct MscriptFft MscriptFft_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptFft_t * mscript_fft_create(size_t n);
+void mscript_fft_destroy(MscriptFft_t * fft);
+size_t mscript_fft_get_length(MscriptFft_t const * fft);
+void mscript_fft_real(MscriptFft_t * fft, double const * input, double * re, double * im);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
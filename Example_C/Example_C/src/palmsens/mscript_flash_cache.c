@@ -0,0 +1,284 @@
+/**
+ * \file
+ * MethodSCRIPT flash cache.
+ *
+ * See `mscript_flash_cache.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_flash_cache.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript.h"
+#include "mscript_debug_printf.h"
+
+/// FNV-1a 64-bit offset basis.
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ULL
+
+/// FNV-1a 64-bit prime.
+#define FNV1A_64_PRIME 0x100000001b3ULL
+
+/// Size of the buffer for one line of the cache file.
+#define CACHE_LINE_BUF_SIZE (MSCRIPT_FLASH_CACHE_MAX_SERIAL_LENGTH + 1 + 16 + 3)
+
+/**
+ * Calculate a hash of the contents of a MethodSCRIPT file.
+ *
+ * The 64-bit FNV-1a hash is used. Carriage return characters are ignored, so
+ * the result does not depend on the line ending style of the file.
+ *
+ * \param path Path to the MethodSCRIPT file.
+ * \param p_hash[out] The calculated hash.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_hash_file(char const * path, uint64_t * p_hash)
+{
+	assert(path != NULL);
+	assert(p_hash != NULL);
+
+	FILE * fp = fopen(path, "rb");
+	if (fp == NULL) {
+		DEBUG_PRINTF("ERROR: Could not open script file %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	uint64_t hash = FNV1A_64_OFFSET_BASIS;
+	int c;
+	while ((c = fgetc(fp)) != EOF) {
+		if (c == '\r') {
+			continue;
+		}
+		hash ^= (uint8_t)c;
+		hash *= FNV1A_64_PRIME;
+	}
+	bool success = !ferror(fp);
+	fclose(fp);
+
+	*p_hash = hash;
+	return success;
+}
+
+/**
+ * Parse one line of the cache file.
+ *
+ * \return `true` if the line is valid, `false` otherwise
+ */
+static bool parse_cache_line(char const * line, char * serial_number, uint64_t * p_hash)
+{
+	char const * separator = strchr(line, ' ');
+	if ((separator == NULL) || (separator == line)) {
+		return false;
+	}
+	size_t len = (size_t)(separator - line);
+	if (len > MSCRIPT_FLASH_CACHE_MAX_SERIAL_LENGTH) {
+		return false;
+	}
+	memcpy(serial_number, line, len);
+	serial_number[len] = '\0';
+
+	char * end;
+	*p_hash = strtoull(separator + 1, &end, 16);
+	return end != separator + 1;
+}
+
+/**
+ * Look up the hash of the script that is stored in a device.
+ *
+ * \param cache_path Path to the cache file.
+ * \param serial_number Serial number of the device.
+ * \param p_hash[out] The hash of the script stored in the device.
+ *
+ * \return `true` if the device was found in the cache, `false` otherwise
+ */
+bool mscript_flash_cache_lookup(char const * cache_path, char const * serial_number,
+	uint64_t * p_hash)
+{
+	assert(cache_path != NULL);
+	assert(serial_number != NULL);
+	assert(p_hash != NULL);
+
+	FILE * fp = fopen(cache_path, "r");
+	if (fp == NULL) {
+		// A missing cache file just means nothing has been cached yet.
+		return false;
+	}
+
+	bool found = false;
+	char line[CACHE_LINE_BUF_SIZE];
+	char entry_serial[MSCRIPT_FLASH_CACHE_MAX_SERIAL_LENGTH + 1];
+	uint64_t entry_hash;
+	while (!found && (fgets(line, sizeof(line), fp) != NULL)) {
+		if (parse_cache_line(line, entry_serial, &entry_hash)
+			&& !strcmp(entry_serial, serial_number)) {
+			*p_hash = entry_hash;
+			found = true;
+		}
+	}
+	fclose(fp);
+	return found;
+}
+
+/**
+ * Record the hash of the script that is stored in a device.
+ *
+ * The entry of the device is replaced if it exists, or added otherwise. The
+ * entries of other devices are kept. The new cache is written to a temporary
+ * file first, so an interrupted update does not corrupt the cache.
+ *
+ * \param cache_path Path to the cache file.
+ * \param serial_number Serial number of the device.
+ * \param hash The hash of the script stored in the device.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_flash_cache_update(char const * cache_path, char const * serial_number,
+	uint64_t hash)
+{
+	assert(cache_path != NULL);
+	assert(serial_number != NULL);
+
+	if (strlen(serial_number) > MSCRIPT_FLASH_CACHE_MAX_SERIAL_LENGTH) {
+		DEBUG_PRINTF("ERROR: Serial number is too long for the flash cache.\n");
+		return false;
+	}
+
+	size_t tmp_path_size = strlen(cache_path) + 5;
+	char * tmp_path = malloc(tmp_path_size);
+	if (tmp_path == NULL) {
+		return false;
+	}
+	snprintf(tmp_path, tmp_path_size, "%s.tmp", cache_path);
+
+	FILE * fp_out = fopen(tmp_path, "w");
+	if (fp_out == NULL) {
+		DEBUG_PRINTF("ERROR: Could not create %s: %s\n", tmp_path, strerror(errno));
+		free(tmp_path);
+		return false;
+	}
+
+	// Copy the entries of all other devices.
+	FILE * fp_in = fopen(cache_path, "r");
+	if (fp_in != NULL) {
+		char line[CACHE_LINE_BUF_SIZE];
+		char entry_serial[MSCRIPT_FLASH_CACHE_MAX_SERIAL_LENGTH + 1];
+		uint64_t entry_hash;
+		while (fgets(line, sizeof(line), fp_in) != NULL) {
+			if (parse_cache_line(line, entry_serial, &entry_hash)
+				&& strcmp(entry_serial, serial_number)) {
+				fprintf(fp_out, "%s %016" PRIx64 "\n", entry_serial, entry_hash);
+			}
+		}
+		fclose(fp_in);
+	}
+
+	fprintf(fp_out, "%s %016" PRIx64 "\n", serial_number, hash);
+	bool success = !ferror(fp_out);
+	if (fclose(fp_out)) {
+		success = false;
+	}
+
+	// Replace the old cache file. (On Windows, rename() fails if the
+	// destination exists, so remove it first.)
+	if (success) {
+		remove(cache_path);
+		if (rename(tmp_path, cache_path)) {
+			DEBUG_PRINTF("ERROR: Could not update %s: %s\n", cache_path, strerror(errno));
+			success = false;
+		}
+	}
+	if (!success) {
+		remove(tmp_path);
+	}
+	free(tmp_path);
+	return success;
+}
+
+/**
+ * Run a MethodSCRIPT from flash, uploading it only if it has changed.
+ *
+ * The serial number of the device is read and the hash of the script is
+ * compared with the hash recorded in the cache file. If they are equal, the
+ * script stored in flash is started directly. Otherwise, the script is stored
+ * in flash first and the cache file is updated.
+ *
+ * After this function returns successfully, the response of the script should
+ * be processed in the same way as after sending a script using
+ * `mscript_send_file()`.
+ *
+ * \param handle Handle to the serial port.
+ * \param cache_path Path to the cache file.
+ * \param script_path Path to the MethodSCRIPT file.
+ * \param p_uploaded[out] Set to `true` if the script had to be uploaded.
+ *                        May be NULL.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_flash_cache_run_file(SerialPortHandle_t handle, char const * cache_path,
+	char const * script_path, bool * p_uploaded)
+{
+	char serial_number[MSCRIPT_FLASH_CACHE_MAX_SERIAL_LENGTH + 1];
+	if (!mscript_get_serial_number(handle, serial_number, sizeof(serial_number))) {
+		return false;
+	}
+
+	uint64_t hash;
+	if (!mscript_hash_file(script_path, &hash)) {
+		return false;
+	}
+
+	uint64_t cached_hash;
+	bool upload = !mscript_flash_cache_lookup(cache_path, serial_number, &cached_hash)
+		|| (cached_hash != hash);
+	if (upload) {
+		DEBUG_PRINTF("Storing script in flash of device %s.\n", serial_number);
+		// Invalidate the entry first, so an interrupted upload is not mistaken
+		// for a valid one the next time.
+		mscript_flash_cache_update(cache_path, serial_number, 0);
+		if (!mscript_store_file_in_flash(handle, script_path)) {
+			return false;
+		}
+		// Failing to update the cache only means the next run uploads again.
+		mscript_flash_cache_update(cache_path, serial_number, hash);
+	}
+	if (p_uploaded != NULL) {
+		*p_uploaded = upload;
+	}
+
+	return mscript_run_from_flash(handle);
+}
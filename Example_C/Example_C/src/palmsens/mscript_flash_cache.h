@@ -0,0 +1,74 @@
+/**
+ * \file
+ * MethodSCRIPT flash cache.
+ *
+ * Large scripts can take a noticeable time to upload, especially over slow
+ * links such as Bluetooth. The functions in this module store a script in the
+ * flash memory of the device and keep a record on the host of which script
+ * (identified by a hash of its contents) is stored in which device (identified
+ * by its serial number). When the same script is run again on the same device,
+ * it is started from flash without uploading it again.
+ *
+ * The record is a plain text file with one line per device:
+ *
+ *     <serial number> <hash as 16 hexadecimal digits>
+ *
+ * Note that the host cannot detect if the flash contents of the device were
+ * changed by another host or application. In that case, simply delete the
+ * cache file to force a new upload.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mscript_serial_port.h"
+
+/// Maximum length of a serial number in the cache file (excluding '\0').
+#define MSCRIPT_FLASH_CACHE_MAX_SERIAL_LENGTH 63
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool mscript_hash_file(char const * path, uint64_t * p_hash);
+bool mscript_flash_cache_lookup(char const * cache_path, char const * serial_number,
+	uint64_t * p_hash);
+bool mscript_flash_cache_update(char const * cache_path, char const * serial_number,
+	uint64_t hash);
+bool mscript_flash_cache_run_file(SerialPortHandle_t handle, char const * cache_path,
+	char const * script_path, bool * p_uploaded);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,286 @@
+/**
+ * \file
+ * Firmware upload to the bootloader of a MethodSCRIPT device.
+ *
+ * See `mscript_fw_upload.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_fw_upload.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript.h"
+#include "mscript_debug_printf.h"
+
+/// Size of one "data" command: "data", length, data, checksum and '\n'.
+#define DATA_COMMAND_SIZE (4 + 2 + 2 * MSCRIPT_FW_UPLOAD_BLOCK_SIZE + 4 + 1)
+
+/// Default time to wait for a reply, as in the Python example.
+#define DEFAULT_TIMEOUT_MS 15000
+
+/**
+ * Compute the Fletcher-16 checksum of a block, as expected by the bootloader.
+ */
+uint16_t mscript_fw_fletcher16(uint8_t const * data, size_t size)
+{
+	unsigned int sum1 = 0;
+	unsigned int sum2 = 0;
+	for (size_t i = 0; i < size; ++i) {
+		sum1 = (sum1 + data[i]) % 255;
+		sum2 = (sum1 + sum2) % 255;
+	}
+	return (uint16_t)((sum2 << 8) | sum1);
+}
+
+/**
+ * Get the default settings: no pipelining (a window of 1 block) and a
+ * timeout of 15 s.
+ */
+void mscript_fw_upload_default_config(MscriptFwUploadConfig_t * config)
+{
+	config->window = 1;
+	config->timeout_ms = DEFAULT_TIMEOUT_MS;
+	config->progress = NULL;
+	config->context = NULL;
+}
+
+/**
+ * Read the reply to a command.
+ *
+ * \return `true` if a reply without error was received, `false` on error or
+ *         timeout (the error reply is stored in the statistics)
+ */
+static bool read_reply(SerialPortHandle_t handle, uint32_t timeout_ms, char const * command,
+	MscriptFwUploadStats_t * stats)
+{
+	char reply[MSCRIPT_FW_UPLOAD_REPLY_SIZE];
+	if (!mscript_serial_port_read_line(handle, reply, sizeof(reply), timeout_ms)) {
+		stats->failed_command = command;
+		stats->error_reply[0] = '\0';
+		return false;
+	}
+	if (strchr(reply, '!') != NULL) {
+		DEBUG_PRINTF("ERROR: bootloader replied %s to %s.\n", reply, command);
+		stats->failed_command = command;
+		strcpy(stats->error_reply, reply);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Send a command and read its reply.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool send_command(SerialPortHandle_t handle, char const * command, uint32_t timeout_ms,
+	MscriptFwUploadStats_t * stats)
+{
+	char line[16];
+	snprintf(line, sizeof(line), "%s\n", command);
+	if (!mscript_serial_port_write(handle, line)) {
+		stats->failed_command = command;
+		stats->error_reply[0] = '\0';
+		return false;
+	}
+	return read_reply(handle, timeout_ms, command, stats);
+}
+
+/**
+ * Format the "data" command of one block.
+ *
+ * \return The length of the command.
+ */
+static size_t format_block(uint8_t const * data, size_t size, char * buf)
+{
+	static char const hex[] = "0123456789abcdef";
+	char * p = buf;
+	memcpy(p, "data", 4);
+	p += 4;
+	*p++ = hex[size >> 4];
+	*p++ = hex[size & 0xF];
+	for (size_t i = 0; i < size; ++i) {
+		*p++ = hex[data[i] >> 4];
+		*p++ = hex[data[i] & 0xF];
+	}
+	uint16_t checksum = mscript_fw_fletcher16(data, size);
+	for (int shift = 12; shift >= 0; shift -= 4) {
+		*p++ = hex[(checksum >> shift) & 0xF];
+	}
+	*p++ = '\n';
+	*p = '\0';
+	return (size_t)(p - buf);
+}
+
+/**
+ * Send all blocks of the firmware, with up to `window` blocks waiting for
+ * their reply.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool send_blocks(SerialPortHandle_t handle, uint8_t const * firmware, size_t size,
+	MscriptFwUploadConfig_t const * config, MscriptFwUploadStats_t * stats)
+{
+	size_t window = config->window;
+	if (window < 1) {
+		window = 1;
+	} else if (window > MSCRIPT_FW_UPLOAD_MAX_WINDOW) {
+		window = MSCRIPT_FW_UPLOAD_MAX_WINDOW;
+	}
+	char * buf = malloc(window * DATA_COMMAND_SIZE + 1);
+	if (buf == NULL) {
+		stats->failed_command = "data";
+		return false;
+	}
+
+	size_t nr_of_blocks = (size + MSCRIPT_FW_UPLOAD_BLOCK_SIZE - 1) / MSCRIPT_FW_UPLOAD_BLOCK_SIZE;
+	size_t nr_of_sent_blocks = 0;
+	bool success = true;
+	while (success && (stats->nr_of_blocks < nr_of_blocks)) {
+		// Refill the window when half of it has been acknowledged, so the
+		// blocks are written in batches.
+		size_t nr_of_pending = nr_of_sent_blocks - stats->nr_of_blocks;
+		if ((nr_of_sent_blocks < nr_of_blocks) && (nr_of_pending <= window / 2)) {
+			size_t length = 0;
+			while ((nr_of_sent_blocks < nr_of_blocks)
+				&& (nr_of_sent_blocks - stats->nr_of_blocks < window)) {
+				size_t offset = nr_of_sent_blocks * MSCRIPT_FW_UPLOAD_BLOCK_SIZE;
+				size_t block_size = (size - offset < MSCRIPT_FW_UPLOAD_BLOCK_SIZE)
+					? size - offset : MSCRIPT_FW_UPLOAD_BLOCK_SIZE;
+				length += format_block(&firmware[offset], block_size, &buf[length]);
+				++nr_of_sent_blocks;
+			}
+			++stats->nr_of_writes;
+			if (!mscript_serial_port_write(handle, buf)) {
+				stats->failed_command = "data";
+				stats->error_reply[0] = '\0';
+				success = false;
+				break;
+			}
+		}
+
+		success = read_reply(handle, config->timeout_ms, "data", stats);
+		if (success) {
+			size_t end = (stats->nr_of_blocks + 1) * MSCRIPT_FW_UPLOAD_BLOCK_SIZE;
+			stats->nr_of_bytes = (end < size) ? end : size;
+			++stats->nr_of_blocks;
+			if (config->progress != NULL) {
+				config->progress(config->context, stats->nr_of_bytes, size);
+			}
+		}
+	}
+	free(buf);
+	return success;
+}
+
+/**
+ * Upload firmware to a device in bootloader mode, and start it.
+ *
+ * \param handle The serial port of the device.
+ * \param firmware The firmware binary.
+ * \param size The size of the firmware.
+ * \param config The settings, or NULL for the default settings (see
+ *               `mscript_fw_upload_default_config()`).
+ * \param[out] stats The statistics of the upload, also if it failed.
+ *
+ * \return `true` on success, `false` on failure (see `failed_command` and
+ *         `error_reply` of the statistics)
+ */
+bool mscript_fw_upload(SerialPortHandle_t handle, uint8_t const * firmware, size_t size,
+	MscriptFwUploadConfig_t const * config, MscriptFwUploadStats_t * stats)
+{
+	MscriptFwUploadConfig_t default_config;
+	if (config == NULL) {
+		mscript_fw_upload_default_config(&default_config);
+		config = &default_config;
+	}
+	memset(stats, 0, sizeof(MscriptFwUploadStats_t));
+	uint32_t t0 = mscript_get_time_ms();
+
+	// End a previous upload if there is one, just in case. The bootloader
+	// replies with an error if there is none.
+	if (!send_command(handle, "endfw", config->timeout_ms, stats)
+		&& (stats->error_reply[0] == '\0')) {
+		return false;
+	}
+	stats->failed_command = NULL;
+	stats->error_reply[0] = '\0';
+
+	if (!send_command(handle, "startfw", config->timeout_ms, stats)) {
+		return false;
+	}
+	uint32_t t1 = mscript_get_time_ms();
+	stats->erase_time_ms = t1 - t0;
+
+	bool success = send_blocks(handle, firmware, size, config, stats);
+	uint32_t t2 = mscript_get_time_ms();
+	stats->data_time_ms = t2 - t1;
+	stats->bytes_per_second = (stats->data_time_ms > 0)
+		? 1000.0 * stats->nr_of_bytes / stats->data_time_ms : 0.0;
+	if (success) {
+		success = send_command(handle, "endfw", config->timeout_ms, stats)
+			&& send_command(handle, "boot", config->timeout_ms, stats);
+	}
+	stats->total_time_ms = mscript_get_time_ms() - t0;
+	return success;
+}
+
+/**
+ * Read a firmware binary.
+ *
+ * \param path The path of the file.
+ * \param[out] p_size The size of the firmware.
+ *
+ * \return The firmware, to be freed with `free()`, or NULL on failure.
+ */
+uint8_t * mscript_fw_read_file(char const * path, size_t * p_size)
+{
+	FILE * file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+	uint8_t * firmware = NULL;
+	long size = -1;
+	if ((fseek(file, 0, SEEK_END) == 0) && ((size = ftell(file)) > 0)
+		&& (fseek(file, 0, SEEK_SET) == 0)) {
+		firmware = malloc((size_t)size);
+	}
+	if ((firmware != NULL) && (fread(firmware, 1, (size_t)size, file) != (size_t)size)) {
+		free(firmware);
+		firmware = NULL;
+	}
+	fclose(file);
+	*p_size = (firmware != NULL) ? (size_t)size : 0;
+	return firmware;
+}
@@ -0,0 +1,135 @@
+/**
+ * \file
+ * Firmware upload to the bootloader of a MethodSCRIPT device.
+ *
+ * This is the C version of `fw_upload_lib.program()` of the Python bootloader
+ * example (ExampleBootloader_Python), using the same serial port functions as
+ * the MethodSCRIPT communication. The device must already be in bootloader
+ * mode (e.g. after the "dlfw" command). The upload consists of these
+ * commands, to each of which the bootloader replies with one line (containing
+ * a '!' on error):
+ *
+ *     endfw                    end a previous upload, if any (errors ignored)
+ *     startfw                  erase the firmware
+ *     data<n><data><checksum>  one block of at most 50 bytes: the number of
+ *                              bytes (2 hex digits), the bytes (2 hex digits
+ *                              each) and their Fletcher-16 checksum (4 hex
+ *                              digits)
+ *     endfw                    finish the upload
+ *     boot                     start the new firmware
+ *
+ * Since the bootloader handles the commands in order and replies to each of
+ * them, the blocks can be pipelined: with a window of N blocks, up to N
+ * blocks are sent before their replies are read, so the upload does not wait
+ * for the round trip of the connection after each block. The blocks are
+ * written in batches of half the window, which saves a system call (and often
+ * a USB transfer) per block. The bootloader must be able to buffer the blocks
+ * of the window; without flow control, a window of 1 (the behavior of the
+ * Python example) is the safe choice.
+ *
+ * The functions only use the serial port handle and their own state, so
+ * several devices can be updated at the same time, each from its own thread.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript_serial_port.h"
+
+/// Maximum number of bytes of firmware in one "data" command.
+#define MSCRIPT_FW_UPLOAD_BLOCK_SIZE 50
+
+/// Size of the buffer of a reply of the bootloader.
+#define MSCRIPT_FW_UPLOAD_REPLY_SIZE 64
+
+/// Maximum number of blocks that are sent before their replies are read.
+#define MSCRIPT_FW_UPLOAD_MAX_WINDOW 64
+
+/**
+ * Function that is called after each acknowledged block, to show the progress.
+ *
+ * \param context The context of the upload.
+ * \param nr_of_bytes Number of bytes acknowledged so far.
+ * \param total_nr_of_bytes Size of the firmware.
+ */
+typedef void (*MscriptFwUploadProgress_t)(void * context, size_t nr_of_bytes,
+	size_t total_nr_of_bytes);
+
+/** Settings of an upload. */
+typedef struct {
+	/** Maximum number of unacknowledged blocks (1 to `MSCRIPT_FW_UPLOAD_MAX_WINDOW`). */
+	size_t window;
+	/** Time to wait for each reply in ms (erasing the firmware can take several seconds). */
+	uint32_t timeout_ms;
+	/** Called after each acknowledged block, or NULL. */
+	MscriptFwUploadProgress_t progress;
+	void * context;
+} MscriptFwUploadConfig_t;
+
+/** Statistics of an upload. */
+typedef struct {
+	/** Number of bytes of firmware acknowledged by the bootloader. */
+	size_t nr_of_bytes;
+	/** Number of blocks acknowledged by the bootloader. */
+	size_t nr_of_blocks;
+	/** Number of writes to the serial port for the blocks. */
+	size_t nr_of_writes;
+	/** Time to erase the firmware (the "startfw" command) in ms. */
+	uint32_t erase_time_ms;
+	/** Time to send all blocks in ms. */
+	uint32_t data_time_ms;
+	/** Total time of the upload in ms. */
+	uint32_t total_time_ms;
+	/** Firmware bytes per second while sending the blocks. */
+	double bytes_per_second;
+	/** The command that failed (e.g. "startfw"), or NULL if the upload succeeded. */
+	char const * failed_command;
+	/** The error reply of the bootloader, or an empty string on a timeout. */
+	char error_reply[MSCRIPT_FW_UPLOAD_REPLY_SIZE];
+} MscriptFwUploadStats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint16_t mscript_fw_fletcher16(uint8_t const * data, size_t size);
+void mscript_fw_upload_default_config(MscriptFwUploadConfig_t * config);
+bool mscript_fw_upload(SerialPortHandle_t handle, uint8_t const * firmware, size_t size,
+	MscriptFwUploadConfig_t const * config, MscriptFwUploadStats_t * stats);
+uint8_t * mscript_fw_read_file(char const * path, size_t * p_size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
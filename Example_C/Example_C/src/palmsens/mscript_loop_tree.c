@@ -0,0 +1,423 @@
+/**
+ * \file
+ * Hierarchical result tree of a run.
+ *
+ * See `mscript_loop_tree.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_loop_tree.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Size of a block of the arena. Larger allocations get their own block.
+#define BLOCK_SIZE (1024 * 1024)
+
+/// Alignment of all allocations from the arena.
+#define ALIGNMENT 8
+
+/// The package records are stored in pages of 2^PAGE_SHIFT records.
+#define PAGE_SHIFT 12
+#define PACKAGES_PER_PAGE ((size_t)1 << PAGE_SHIFT)
+
+/** A block of the arena, followed by its data. */
+typedef struct Block {
+	struct Block * next;
+	size_t size;
+	size_t used;
+} Block_t;
+
+/// Size of the block header, rounded up to the alignment.
+#define BLOCK_HEADER_SIZE ((sizeof(Block_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT)
+
+struct MscriptLoopTree {
+	/** The blocks of the arena, the current block first. */
+	Block_t * blocks;
+	/** Total size of the blocks. */
+	size_t memory_size;
+	MscriptScope_t root;
+	/** The innermost open scope. */
+	MscriptScope_t * current;
+	size_t nr_of_scopes;
+	/** The pages of package records (allocated from the arena). */
+	MscriptTreePackage_t ** pages;
+	size_t page_capacity;
+	size_t nr_of_packages;
+};
+
+/**
+ * Allocate memory from the arena of a tree.
+ *
+ * \return The memory, or NULL on failure.
+ */
+static void * arena_alloc(MscriptLoopTree_t * tree, size_t size)
+{
+	size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	Block_t * block = tree->blocks;
+	if ((block == NULL) || (block->size - block->used < size)) {
+		size_t block_size = (size > BLOCK_SIZE - BLOCK_HEADER_SIZE)
+			? size + BLOCK_HEADER_SIZE : BLOCK_SIZE;
+		block = malloc(block_size);
+		if (block == NULL) {
+			return NULL;
+		}
+		block->size = block_size;
+		block->used = BLOCK_HEADER_SIZE;
+		block->next = tree->blocks;
+		tree->blocks = block;
+		tree->memory_size += block_size;
+	}
+	void * memory = (char *)block + block->used;
+	block->used += size;
+	return memory;
+}
+
+/**
+ * Initialize the root scope of a tree.
+ */
+static void init_root(MscriptLoopTree_t * tree)
+{
+	memset(&tree->root, 0, sizeof(MscriptScope_t));
+	tree->root.type = MSCRIPT_SCOPE_ROOT;
+	tree->root.is_open = true;
+	tree->current = &tree->root;
+}
+
+/**
+ * Create an empty tree.
+ *
+ * \return The tree, or NULL on failure.
+ */
+MscriptLoopTree_t * mscript_loop_tree_create(void)
+{
+	MscriptLoopTree_t * tree = calloc(1, sizeof(MscriptLoopTree_t));
+	if (tree == NULL) {
+		return NULL;
+	}
+	init_root(tree);
+	return tree;
+}
+
+/**
+ * Free a tree, including all its scopes and packages.
+ */
+void mscript_loop_tree_destroy(MscriptLoopTree_t * tree)
+{
+	mscript_loop_tree_reset(tree);
+	free(tree->pages);
+	free(tree);
+}
+
+/**
+ * Remove all scopes and packages, e.g. to reuse the tree for the next run.
+ */
+void mscript_loop_tree_reset(MscriptLoopTree_t * tree)
+{
+	while (tree->blocks != NULL) {
+		Block_t * next = tree->blocks->next;
+		free(tree->blocks);
+		tree->blocks = next;
+	}
+	tree->memory_size = 0;
+	tree->nr_of_scopes = 0;
+	tree->nr_of_packages = 0;
+	init_root(tree);
+}
+
+/**
+ * Open a scope inside the current scope.
+ *
+ * \param tree The tree.
+ * \param type The type of the scope (not `MSCRIPT_SCOPE_ROOT`).
+ * \param id The reply that opened the scope (e.g. "M0007"), or NULL. Only
+ *           the first 5 characters are stored, up to the end of the line.
+ * \param meas_loop_index Number of the measurement loop, or 0 if not known.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+bool mscript_loop_tree_open_scope(MscriptLoopTree_t * tree, MscriptScopeType_t type,
+	char const * id, unsigned int meas_loop_index)
+{
+	MscriptScope_t * scope = arena_alloc(tree, sizeof(MscriptScope_t));
+	if (scope == NULL) {
+		return false;
+	}
+	memset(scope, 0, sizeof(MscriptScope_t));
+	scope->type = type;
+	for (size_t i = 0; (id != NULL) && (i < sizeof(scope->id) - 1) && (id[i] != '\0')
+		&& (id[i] != '\n') && (id[i] != '\r'); ++i) {
+		scope->id[i] = id[i];
+	}
+	scope->meas_loop_index = meas_loop_index;
+	scope->is_open = true;
+	scope->first_package = tree->nr_of_packages;
+
+	MscriptScope_t * parent = tree->current;
+	scope->parent = parent;
+	scope->depth = parent->depth + 1;
+	if (parent->last_child != NULL) {
+		parent->last_child->next_sibling = scope;
+	} else {
+		parent->first_child = scope;
+	}
+	parent->last_child = scope;
+	++parent->nr_of_children;
+	++tree->nr_of_scopes;
+	tree->current = scope;
+	return true;
+}
+
+/**
+ * Close the innermost open scope of a type, and all scopes inside it that
+ * were not closed (which only happens if the output was incomplete).
+ *
+ * \return `true` if a scope was closed, `false` if no scope of this type is
+ *         open
+ */
+bool mscript_loop_tree_close_scope(MscriptLoopTree_t * tree, MscriptScopeType_t type)
+{
+	MscriptScope_t * scope = tree->current;
+	while ((scope != &tree->root) && (scope->type != type)) {
+		scope = scope->parent;
+	}
+	if (scope == &tree->root) {
+		return false;
+	}
+	for (MscriptScope_t * s = tree->current; s != scope->parent; s = s->parent) {
+		s->is_open = false;
+	}
+	tree->current = scope->parent;
+	return true;
+}
+
+/**
+ * Add a data package to the current scope.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+bool mscript_loop_tree_add_package(MscriptLoopTree_t * tree,
+	MscriptDataPackage_t const * package)
+{
+	size_t page = tree->nr_of_packages >> PAGE_SHIFT;
+	if ((tree->nr_of_packages & (PACKAGES_PER_PAGE - 1)) == 0) {
+		if (page == tree->page_capacity) {
+			size_t capacity = (tree->page_capacity == 0) ? 16 : 2 * tree->page_capacity;
+			MscriptTreePackage_t ** pages = realloc(tree->pages,
+				capacity * sizeof(MscriptTreePackage_t *));
+			if (pages == NULL) {
+				return false;
+			}
+			tree->pages = pages;
+			tree->page_capacity = capacity;
+		}
+		tree->pages[page] = arena_alloc(tree, PACKAGES_PER_PAGE * sizeof(MscriptTreePackage_t));
+		if (tree->pages[page] == NULL) {
+			return false;
+		}
+	}
+
+	size_t nr_of_values = package->nr_of_sub_packages;
+	MscriptTreeValue_t * values = NULL;
+	if (nr_of_values > 0) {
+		values = arena_alloc(tree, nr_of_values * sizeof(MscriptTreeValue_t));
+		if (values == NULL) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i < nr_of_values; ++i) {
+		MscriptSubPackage_t const * sub_package = &package->sub_packages[i];
+		values[i].value = sub_package->value;
+		values[i].variable_type = (uint16_t)sub_package->variable_type;
+		values[i].status = (sub_package->metadata.status >= 0)
+			? (uint8_t)sub_package->metadata.status : MSCRIPT_LOOP_TREE_NO_METADATA;
+		values[i].range = (sub_package->metadata.range >= 0)
+			? (uint8_t)sub_package->metadata.range : MSCRIPT_LOOP_TREE_NO_METADATA;
+	}
+
+	MscriptTreePackage_t * record = &tree->pages[page][tree->nr_of_packages
+		& (PACKAGES_PER_PAGE - 1)];
+	record->scope = tree->current;
+	record->values = values;
+	record->nr_of_values = nr_of_values;
+	++tree->nr_of_packages;
+	for (MscriptScope_t * scope = tree->current; scope != NULL; scope = scope->parent) {
+		++scope->nr_of_packages;
+	}
+	return true;
+}
+
+/**
+ * Handle an event of an acquisition: open and close the scopes and add the
+ * data packages. Other events are ignored, as are replies that close a scope
+ * that is not open.
+ *
+ * \param context The tree (`MscriptLoopTree_t *`).
+ * \param event The event.
+ *
+ * \return `true` to continue, `false` on failure to allocate memory
+ */
+bool mscript_loop_tree_handle_event(void * context, MscriptEvent_t const * event)
+{
+	MscriptLoopTree_t * tree = context;
+	switch (event->type) {
+	case MSCRIPT_EVENT_LOOP_START:
+		return mscript_loop_tree_open_scope(tree, MSCRIPT_SCOPE_LOOP, event->response, 0);
+	case MSCRIPT_EVENT_MEAS_LOOP_START:
+		return mscript_loop_tree_open_scope(tree, MSCRIPT_SCOPE_MEAS_LOOP, event->response,
+			event->meas_loop_index);
+	case MSCRIPT_EVENT_SCAN_START:
+		return mscript_loop_tree_open_scope(tree, MSCRIPT_SCOPE_SCAN, event->response,
+			event->meas_loop_index);
+	case MSCRIPT_EVENT_LOOP_END:
+		mscript_loop_tree_close_scope(tree, MSCRIPT_SCOPE_LOOP);
+		return true;
+	case MSCRIPT_EVENT_MEAS_LOOP_END:
+		mscript_loop_tree_close_scope(tree, MSCRIPT_SCOPE_MEAS_LOOP);
+		return true;
+	case MSCRIPT_EVENT_SCAN_END:
+		mscript_loop_tree_close_scope(tree, MSCRIPT_SCOPE_SCAN);
+		return true;
+	case MSCRIPT_EVENT_PACKAGE:
+		return (event->package == NULL) || mscript_loop_tree_add_package(tree, event->package);
+	default:
+		return true;
+	}
+}
+
+/**
+ * Get the root scope, which contains the complete run.
+ */
+MscriptScope_t const * mscript_loop_tree_get_root(MscriptLoopTree_t const * tree)
+{
+	return &tree->root;
+}
+
+/**
+ * Get the next scope in depth-first order: the first child of the scope if
+ * it has one, otherwise the next sibling of the scope or of the nearest
+ * enclosing scope that has one.
+ *
+ * \return The next scope, or NULL if this was the last scope.
+ */
+MscriptScope_t const * mscript_loop_tree_next_scope(MscriptScope_t const * scope)
+{
+	if (scope->first_child != NULL) {
+		return scope->first_child;
+	}
+	for (; scope != NULL; scope = scope->parent) {
+		if (scope->next_sibling != NULL) {
+			return scope->next_sibling;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Get the number of packages in the tree.
+ */
+size_t mscript_loop_tree_get_nr_of_packages(MscriptLoopTree_t const * tree)
+{
+	return tree->nr_of_packages;
+}
+
+/**
+ * Get the number of scopes in the tree, excluding the root.
+ */
+size_t mscript_loop_tree_get_nr_of_scopes(MscriptLoopTree_t const * tree)
+{
+	return tree->nr_of_scopes;
+}
+
+/**
+ * Get the size of the memory allocated for the scopes and packages.
+ */
+size_t mscript_loop_tree_get_memory_size(MscriptLoopTree_t const * tree)
+{
+	return tree->memory_size + tree->page_capacity * sizeof(MscriptTreePackage_t *);
+}
+
+/**
+ * Get a package by its number (0 for the first package of the run).
+ *
+ * \return The package, or NULL if there is no such package.
+ */
+MscriptTreePackage_t const * mscript_loop_tree_get_package(MscriptLoopTree_t const * tree,
+	size_t index)
+{
+	if (index >= tree->nr_of_packages) {
+		return NULL;
+	}
+	return &tree->pages[index >> PAGE_SHIFT][index & (PACKAGES_PER_PAGE - 1)];
+}
+
+/**
+ * Extract the values of one variable type of the packages of a scope
+ * (including its child scopes), e.g. the currents of one scan. If a package
+ * contains the variable type more than once, the first value is used; if it
+ * does not contain the variable type, NaN is stored.
+ *
+ * \param tree The tree.
+ * \param scope The scope.
+ * \param variable_type The variable type.
+ * \param[out] values The values.
+ * \param max_values The size of `values`.
+ *
+ * \return The number of values stored in `values`.
+ */
+size_t mscript_loop_tree_get_column(MscriptLoopTree_t const * tree, MscriptScope_t const * scope,
+	unsigned int variable_type, double * values, size_t max_values)
+{
+	size_t count = (scope->nr_of_packages < max_values) ? scope->nr_of_packages : max_values;
+	size_t index = scope->first_package;
+	size_t i = 0;
+	while (i < count) {
+		// The packages of one page are contiguous.
+		MscriptTreePackage_t const * page = tree->pages[index >> PAGE_SHIFT];
+		size_t offset = index & (PACKAGES_PER_PAGE - 1);
+		size_t end = (PACKAGES_PER_PAGE - offset < count - i)
+			? PACKAGES_PER_PAGE : offset + count - i;
+		for (; offset < end; ++offset, ++index, ++i) {
+			MscriptTreePackage_t const * package = &page[offset];
+			double value = NAN;
+			for (size_t j = 0; j < package->nr_of_values; ++j) {
+				if (package->values[j].variable_type == variable_type) {
+					value = package->values[j].value;
+					break;
+				}
+			}
+			values[i] = value;
+		}
+	}
+	return count;
+}
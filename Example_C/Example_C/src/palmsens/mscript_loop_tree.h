@@ -0,0 +1,157 @@
+/**
+ * \file
+ * Hierarchical result tree of a run.
+ *
+ * The output of a script is nested: a "loop" command is enclosed by the
+ * replies `L` and `+`, a measurement loop by `M` and `*`, and each scan of a
+ * measurement loop with the "nscans" argument by `C` and `-`. This module
+ * keeps that structure, like the `MScriptLoop` tree of the Python library:
+ * the tree consists of scopes, each with its child scopes and data packages,
+ * under a root scope that contains the complete run.
+ *
+ * All scopes, packages and values are allocated from one growable arena per
+ * tree, a list of large memory blocks that are only freed together. This way,
+ * adding a package does not call `malloc()` (except once for every block of
+ * the arena), and the memory is freed at once when the tree is destroyed or
+ * reset. Pointers to scopes and packages stay valid until then.
+ *
+ * The packages are numbered in the order they are received. Since the scopes
+ * are properly nested, the packages of a scope (including those of its child
+ * scopes) are a contiguous range of these numbers: `first_package` to
+ * `first_package + nr_of_packages - 1`. This makes iterating over the
+ * packages of any scope, and extracting a column of values with
+ * `mscript_loop_tree_get_column()`, a simple loop. The scopes can be visited
+ * in order with `mscript_loop_tree_next_scope()`.
+ *
+ * The tree can be used as the sink of an acquisition (see
+ * `mscript_acquisition.h`), or built using `mscript_loop_tree_open_scope()`,
+ * `mscript_loop_tree_close_scope()` and `mscript_loop_tree_add_package()`.
+ * It is not thread-safe.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript.h"
+#include "mscript_acquisition.h"
+
+/// Value of `status` and `range` of a value if the metadata was not present.
+#define MSCRIPT_LOOP_TREE_NO_METADATA 0xFF
+
+/** Type of a scope. */
+typedef enum {
+	/** The complete run. */
+	MSCRIPT_SCOPE_ROOT,
+	/** A "loop" command (`L` ... `+`). */
+	MSCRIPT_SCOPE_LOOP,
+	/** A measurement loop (`M` ... `*`). */
+	MSCRIPT_SCOPE_MEAS_LOOP,
+	/** A scan of a measurement loop (`C` ... `-`). */
+	MSCRIPT_SCOPE_SCAN,
+} MscriptScopeType_t;
+
+/** A value of a package in the tree. */
+typedef struct {
+	double value;
+	uint16_t variable_type;
+	/** Status metadata, or `MSCRIPT_LOOP_TREE_NO_METADATA`. */
+	uint8_t status;
+	/** Range metadata, or `MSCRIPT_LOOP_TREE_NO_METADATA`. */
+	uint8_t range;
+} MscriptTreeValue_t;
+
+struct MscriptScope;
+
+/** A data package in the tree. */
+typedef struct {
+	/** The innermost scope that contains the package. */
+	struct MscriptScope const * scope;
+	/** The values of the package. */
+	MscriptTreeValue_t const * values;
+	size_t nr_of_values;
+} MscriptTreePackage_t;
+
+/** A scope: the root, a loop, a measurement loop or a scan. */
+typedef struct MscriptScope {
+	MscriptScopeType_t type;
+	/** The reply that opened the scope (e.g. "M0007"), empty for the root. */
+	char id[6];
+	/** Number of the measurement loop (see `MscriptEvent_t`), or 0 if not known. */
+	unsigned int meas_loop_index;
+	/** Nesting depth (0 for the root). */
+	unsigned int depth;
+	/** `true` until the reply that closes the scope has been received. */
+	bool is_open;
+	/** The enclosing scope, or NULL for the root. */
+	struct MscriptScope * parent;
+	/** The child scopes, in order. */
+	struct MscriptScope * first_child;
+	struct MscriptScope * last_child;
+	struct MscriptScope * next_sibling;
+	size_t nr_of_children;
+	/** The packages of the scope and its child scopes. */
+	size_t first_package;
+	size_t nr_of_packages;
+} MscriptScope_t;
+
+/** The tree of a run. */
+typedef struct MscriptLoopTree MscriptLoopTree_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptLoopTree_t * mscript_loop_tree_create(void);
+void mscript_loop_tree_destroy(MscriptLoopTree_t * tree);
+void mscript_loop_tree_reset(MscriptLoopTree_t * tree);
+bool mscript_loop_tree_open_scope(MscriptLoopTree_t * tree, MscriptScopeType_t type,
+	char const * id, unsigned int meas_loop_index);
+bool mscript_loop_tree_close_scope(MscriptLoopTree_t * tree, MscriptScopeType_t type);
+bool mscript_loop_tree_add_package(MscriptLoopTree_t * tree,
+	MscriptDataPackage_t const * package);
+bool mscript_loop_tree_handle_event(void * context, MscriptEvent_t const * event);
+MscriptScope_t const * mscript_loop_tree_get_root(MscriptLoopTree_t const * tree);
+MscriptScope_t const * mscript_loop_tree_next_scope(MscriptScope_t const * scope);
+size_t mscript_loop_tree_get_nr_of_packages(MscriptLoopTree_t const * tree);
+size_t mscript_loop_tree_get_nr_of_scopes(MscriptLoopTree_t const * tree);
+size_t mscript_loop_tree_get_memory_size(MscriptLoopTree_t const * tree);
+MscriptTreePackage_t const * mscript_loop_tree_get_package(MscriptLoopTree_t const * tree,
+	size_t index);
+size_t mscript_loop_tree_get_column(MscriptLoopTree_t const * tree, MscriptScope_t const * scope,
+	unsigned int variable_type, double * values, size_t max_values);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
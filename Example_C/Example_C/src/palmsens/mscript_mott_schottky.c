@@ -0,0 +1,327 @@
+/**
+ * \file
+ * Mott-Schottky analysis.
+ *
+ * See `mscript_mott_schottky.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_mott_schottky.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TWO_PI 6.283185307179586
+
+/// Elementary charge (C).
+#define ELEMENTARY_CHARGE 1.602176634e-19
+
+/// Vacuum permittivity (F/m).
+#define VACUUM_PERMITTIVITY 8.8541878128e-12
+
+/// Boltzmann constant (J/K).
+#define BOLTZMANN_CONSTANT 1.380649e-23
+
+/// Minimum number of points of a fit.
+#define MIN_FIT_POINTS 3
+
+/// Initial capacity of the point array.
+#define INITIAL_CAPACITY 64
+
+/** Running sums of a straight line fit (co-moments around the means). */
+typedef struct {
+	size_t count;
+	double mean_x;
+	double mean_y;
+	double sxx;
+	double syy;
+	double sxy;
+} LineFit_t;
+
+struct MscriptMottSchottky {
+	MscriptMottSchottkyConfig_t config;
+	MscriptMottSchottkyPoint_t * points;
+	size_t nr_of_points;
+	size_t capacity;
+	/** The fit of the current window. */
+	LineFit_t fit;
+	/** The best fit so far. */
+	MscriptMottSchottkyResult_t best;
+};
+
+/**
+ * Get the default settings: an area of 1 cm^2, a relative permittivity of 10,
+ * 25 degrees Celsius and a linear region of 5 points.
+ */
+void mscript_mott_schottky_default_config(MscriptMottSchottkyConfig_t * config)
+{
+	config->area = 1e-4;
+	config->relative_permittivity = 10.0;
+	config->temperature = 298.15;
+	config->window = 5;
+}
+
+/**
+ * Create the Mott-Schottky analysis of one electrode.
+ *
+ * \param config The settings, or NULL for the default settings (see
+ *               `mscript_mott_schottky_default_config()`). A window of less
+ *               than 3 points (but not 0) is increased to 3 points.
+ *
+ * \return The analysis, or NULL on failure.
+ */
+MscriptMottSchottky_t * mscript_mott_schottky_create(MscriptMottSchottkyConfig_t const * config)
+{
+	MscriptMottSchottky_t * analysis = calloc(1, sizeof(MscriptMottSchottky_t));
+	if (analysis == NULL) {
+		return NULL;
+	}
+	if (config != NULL) {
+		analysis->config = *config;
+	} else {
+		mscript_mott_schottky_default_config(&analysis->config);
+	}
+	if ((analysis->config.window > 0) && (analysis->config.window < MIN_FIT_POINTS)) {
+		analysis->config.window = MIN_FIT_POINTS;
+	}
+	return analysis;
+}
+
+/**
+ * Free an analysis.
+ */
+void mscript_mott_schottky_destroy(MscriptMottSchottky_t * analysis)
+{
+	free(analysis->points);
+	free(analysis);
+}
+
+/**
+ * Discard all points.
+ */
+void mscript_mott_schottky_reset(MscriptMottSchottky_t * analysis)
+{
+	analysis->nr_of_points = 0;
+	memset(&analysis->fit, 0, sizeof(LineFit_t));
+	memset(&analysis->best, 0, sizeof(MscriptMottSchottkyResult_t));
+}
+
+/**
+ * Add a point to a line fit.
+ */
+static void line_fit_add(LineFit_t * fit, double x, double y)
+{
+	++fit->count;
+	double dx = x - fit->mean_x;
+	double dy = y - fit->mean_y;
+	fit->mean_x += dx / fit->count;
+	fit->mean_y += dy / fit->count;
+	fit->sxx += dx * (x - fit->mean_x);
+	fit->syy += dy * (y - fit->mean_y);
+	fit->sxy += dx * (y - fit->mean_y);
+}
+
+/**
+ * Remove a point that was added before from a line fit.
+ */
+static void line_fit_remove(LineFit_t * fit, double x, double y)
+{
+	if (fit->count <= 1) {
+		memset(fit, 0, sizeof(LineFit_t));
+		return;
+	}
+	--fit->count;
+	double dx = x - fit->mean_x;
+	double dy = y - fit->mean_y;
+	fit->mean_x -= dx / fit->count;
+	fit->mean_y -= dy / fit->count;
+	fit->sxx -= dx * (x - fit->mean_x);
+	fit->syy -= dy * (y - fit->mean_y);
+	fit->sxy -= dx * (y - fit->mean_y);
+}
+
+/**
+ * Keep the fit of the current window if it is better than the best fit so
+ * far, and calculate the flat-band potential and doping density from it.
+ */
+static void update_best_fit(MscriptMottSchottky_t * analysis)
+{
+	LineFit_t const * fit = &analysis->fit;
+	if ((fit->count < MIN_FIT_POINTS) || !(fit->sxx > 0.0) || !(fit->syy > 0.0)) {
+		return;
+	}
+	double r_squared = fit->sxy * fit->sxy / (fit->sxx * fit->syy);
+	MscriptMottSchottkyResult_t * best = &analysis->best;
+	// Without a window, the fit of all points replaces the previous one.
+	if (best->is_valid && (analysis->config.window > 0) && (r_squared <= best->r_squared)) {
+		return;
+	}
+
+	best->is_valid = true;
+	best->nr_of_points = fit->count;
+	best->first_point = analysis->nr_of_points - fit->count;
+	best->min_potential = INFINITY;
+	best->max_potential = -INFINITY;
+	for (size_t i = best->first_point; i < analysis->nr_of_points; ++i) {
+		double potential = analysis->points[i].potential;
+		best->min_potential = (potential < best->min_potential) ? potential : best->min_potential;
+		best->max_potential = (potential > best->max_potential) ? potential : best->max_potential;
+	}
+	best->slope = fit->sxy / fit->sxx;
+	best->intercept = fit->mean_y - best->slope * fit->mean_x;
+	best->r_squared = r_squared;
+	best->is_n_type = best->slope > 0.0;
+
+	// 1/C^2 is 0 at E = E_fb + kT/e (n-type) or E = E_fb - kT/e (p-type).
+	double thermal_voltage = BOLTZMANN_CONSTANT * analysis->config.temperature
+		/ ELEMENTARY_CHARGE;
+	double intercept_potential = -best->intercept / best->slope;
+	best->flat_band_potential = best->is_n_type ? intercept_potential - thermal_voltage
+		: intercept_potential + thermal_voltage;
+	double area = analysis->config.area;
+	best->doping_density = 2.0 / (ELEMENTARY_CHARGE * analysis->config.relative_permittivity
+		* VACUUM_PERMITTIVITY * area * area * fabs(best->slope));
+}
+
+/**
+ * Add a point: the DC potential and the imaginary part of the impedance at
+ * one frequency. Points without a capacitive impedance (Z'' >= 0) are
+ * ignored.
+ *
+ * \param analysis The analysis.
+ * \param potential The DC potential (V).
+ * \param frequency The frequency (Hz).
+ * \param z_imag The imaginary part of the impedance (Ohm).
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+bool mscript_mott_schottky_add(MscriptMottSchottky_t * analysis, double potential,
+	double frequency, double z_imag)
+{
+	if (!(frequency > 0.0) || !(z_imag < 0.0) || !isfinite(potential)) {
+		return true;
+	}
+	if (analysis->nr_of_points == analysis->capacity) {
+		size_t capacity = (analysis->capacity == 0) ? INITIAL_CAPACITY : 2 * analysis->capacity;
+		MscriptMottSchottkyPoint_t * points = realloc(analysis->points,
+			capacity * sizeof(MscriptMottSchottkyPoint_t));
+		if (points == NULL) {
+			return false;
+		}
+		analysis->points = points;
+		analysis->capacity = capacity;
+	}
+	MscriptMottSchottkyPoint_t * point = &analysis->points[analysis->nr_of_points++];
+	double omega_z = TWO_PI * frequency * z_imag;
+	point->potential = potential;
+	point->frequency = frequency;
+	point->capacitance = -1.0 / omega_z;
+	point->inverse_c2 = omega_z * omega_z;
+
+	line_fit_add(&analysis->fit, point->potential, point->inverse_c2);
+	size_t window = analysis->config.window;
+	if ((window > 0) && (analysis->fit.count > window)) {
+		MscriptMottSchottkyPoint_t const * oldest = &analysis->points[analysis->nr_of_points
+			- window - 1];
+		line_fit_remove(&analysis->fit, oldest->potential, oldest->inverse_c2);
+	}
+	update_best_fit(analysis);
+	return true;
+}
+
+/**
+ * Find the DC potential of a package: the measured DC potential of the EIS
+ * measurement if available, otherwise the applied or measured potential.
+ *
+ * \return `true` if the package contains a potential.
+ */
+static bool find_potential(MscriptDataPackage_t const * package, double * p_potential)
+{
+	return mscript_find_value(package, MSCRIPT_VARTYPE_EIS_E_DC, p_potential)
+		|| mscript_find_value(package, MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, p_potential)
+		|| mscript_find_value(package, MSCRIPT_VARTYPE_POTENTIAL, p_potential);
+}
+
+/**
+ * Check if a package contains a point of a Mott-Schottky plot: a potential,
+ * the frequency and the imaginary part of the impedance.
+ */
+bool mscript_mott_schottky_is_package(MscriptDataPackage_t const * package)
+{
+	double value;
+	return find_potential(package, &value)
+		&& mscript_find_value(package, MSCRIPT_VARTYPE_CELL_SET_FREQUENCY, &value)
+		&& mscript_find_value(package, MSCRIPT_VARTYPE_ZIMAG, &value);
+}
+
+/**
+ * Add the point of a data package. Packages that do not contain a point (see
+ * `mscript_mott_schottky_is_package()`) are ignored.
+ *
+ * \return `true` on success, `false` on failure to allocate memory
+ */
+bool mscript_mott_schottky_add_package(MscriptMottSchottky_t * analysis,
+	MscriptDataPackage_t const * package)
+{
+	double potential, frequency, z_imag;
+	if (!find_potential(package, &potential)
+		|| !mscript_find_value(package, MSCRIPT_VARTYPE_CELL_SET_FREQUENCY, &frequency)
+		|| !mscript_find_value(package, MSCRIPT_VARTYPE_ZIMAG, &z_imag)) {
+		return true;
+	}
+	return mscript_mott_schottky_add(analysis, potential, frequency, z_imag);
+}
+
+/**
+ * Get the points (including the 1/C^2 column) added so far.
+ *
+ * \param analysis The analysis.
+ * \param[out] p_points The points, valid until the next point is added.
+ *
+ * \return The number of points.
+ */
+size_t mscript_mott_schottky_get_points(MscriptMottSchottky_t const * analysis,
+	MscriptMottSchottkyPoint_t const ** p_points)
+{
+	*p_points = analysis->points;
+	return analysis->nr_of_points;
+}
+
+/**
+ * Get the fit of the linear region found so far.
+ */
+void mscript_mott_schottky_get_result(MscriptMottSchottky_t const * analysis,
+	MscriptMottSchottkyResult_t * result)
+{
+	*result = analysis->best;
+}
@@ -0,0 +1,140 @@
+/**
+ * \file
+ * Mott-Schottky analysis.
+ *
+ * A Mott-Schottky measurement steps the DC potential of a semiconductor
+ * electrode and measures the impedance at one frequency at each potential
+ * (see `MSExample030-Mott_Schottkey.mscr`). The space charge capacitance
+ * follows from the imaginary part of the impedance:
+ *
+ *     C = -1 / (2 * pi * f * Z'')
+ *
+ * and in the depletion region 1/C^2 is a linear function of the potential:
+ *
+ *     1/C^2 = 2 / (e * eps_r * eps_0 * A^2 * N) * (E - E_fb - k * T / e)
+ *
+ * with N the doping density, A the electrode area and E_fb the flat-band
+ * potential. The slope is positive for an n-type and negative for a p-type
+ * semiconductor (then the sign of the `k * T / e` term is reversed too).
+ *
+ * This module calculates the capacitance and 1/C^2 of each point as soon as
+ * it is received and keeps the 1/C^2 column. The linear region is found
+ * incrementally: a window of the last points is fitted with a straight line,
+ * using running sums that are updated when a point enters or leaves the
+ * window, and the window with the best fit (highest r^2) so far gives the
+ * flat-band potential and doping density. With a window size of 0, all
+ * points are fitted.
+ *
+ * An analysis only holds the data of one electrode and shares no data with
+ * other analyses, so the electrodes of a multi-channel instrument or
+ * multiplexer can each be analyzed in their own thread.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript.h"
+
+/** Settings of a Mott-Schottky analysis. */
+typedef struct {
+	/** Area of the electrode (m^2). */
+	double area;
+	/** Relative permittivity of the semiconductor. */
+	double relative_permittivity;
+	/** Temperature (K). */
+	double temperature;
+	/** Number of points of the linear region, or 0 to fit all points. */
+	size_t window;
+} MscriptMottSchottkyConfig_t;
+
+/** A point of a Mott-Schottky plot. */
+typedef struct {
+	/** The DC potential (V). */
+	double potential;
+	/** The frequency (Hz). */
+	double frequency;
+	/** The space charge capacitance (F). */
+	double capacitance;
+	/** 1/C^2 (F^-2). */
+	double inverse_c2;
+} MscriptMottSchottkyPoint_t;
+
+/** Result of the fit of the linear region. */
+typedef struct {
+	/** `false` if there are not enough points (with different potentials) yet. */
+	bool is_valid;
+	/** Index of the first point of the linear region. */
+	size_t first_point;
+	/** Number of points of the linear region. */
+	size_t nr_of_points;
+	/** Potential range of the linear region (V). */
+	double min_potential;
+	double max_potential;
+	/** Slope (F^-2/V) and intercept (F^-2) of 1/C^2 versus the potential. */
+	double slope;
+	double intercept;
+	/** Coefficient of determination of the fit. */
+	double r_squared;
+	/** `true` for an n-type semiconductor (positive slope). */
+	bool is_n_type;
+	/** The flat-band potential (V). */
+	double flat_band_potential;
+	/** The doping density (m^-3). */
+	double doping_density;
+} MscriptMottSchottkyResult_t;
+
+/** The Mott-Schottky analysis of one electrode. */
+typedef struct MscriptMottSchottky MscriptMottSchottky_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mscript_mott_schottky_default_config(MscriptMottSchottkyConfig_t * config);
+MscriptMottSchottky_t * mscript_mott_schottky_create(MscriptMottSchottkyConfig_t const * config);
+void mscript_mott_schottky_destroy(MscriptMottSchottky_t * analysis);
+void mscript_mott_schottky_reset(MscriptMottSchottky_t * analysis);
+bool mscript_mott_schottky_add(MscriptMottSchottky_t * analysis, double potential,
+	double frequency, double z_imag);
+bool mscript_mott_schottky_add_package(MscriptMottSchottky_t * analysis,
+	MscriptDataPackage_t const * package);
+bool mscript_mott_schottky_is_package(MscriptDataPackage_t const * package);
+size_t mscript_mott_schottky_get_points(MscriptMottSchottky_t const * analysis,
+	MscriptMottSchottkyPoint_t const ** p_points);
+void mscript_mott_schottky_get_result(MscriptMottSchottky_t const * analysis,
+	MscriptMottSchottkyResult_t * result);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
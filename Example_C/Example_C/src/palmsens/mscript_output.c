@@ -0,0 +1,451 @@
+/**
+ * \file
+ * Shared, asynchronous output writer.
+ *
+ * See `mscript_output.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_output.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+#include "mscript_thread.h"
+
+/** A block of output data of one file. */
+typedef struct OutputBlock {
+	/** Next block in the queue or free list. */
+	struct OutputBlock * next;
+	/** The file the data belongs to. */
+	MscriptOutputFile_t * file;
+	/** Number of bytes used in `data`. */
+	size_t size;
+	/** Flush the file after writing this block. */
+	bool flush;
+	/** Close the file after writing this block. */
+	bool close;
+	/** The data (`block_size` bytes). */
+	char data[];
+} OutputBlock_t;
+
+struct MscriptOutput {
+	MscriptMutex_t mutex;
+	/** Signaled when a block is added to the queue or `stop` is set. */
+	MscriptCondition_t queued;
+	/** Signaled when a block is returned to the free list. */
+	MscriptCondition_t freed;
+	OutputBlock_t * queue_head;
+	OutputBlock_t * queue_tail;
+	OutputBlock_t * free_list;
+	size_t block_size;
+	size_t nr_of_blocks;
+	size_t max_nr_of_blocks;
+	bool stop;
+	MscriptThread_t thread;
+	MscriptOutputStats_t stats;
+};
+
+struct MscriptOutputFile {
+	MscriptOutput_t * output;
+	FILE * fp;
+	/** `true` if `fp` was opened by this module and must be closed. */
+	bool owns_fp;
+	/** The block that is currently being filled, or NULL. */
+	OutputBlock_t * block;
+	/** `true` if data could not be added to the output. */
+	bool failed;
+};
+
+/**
+ * Get an empty block, waiting for the writer if all blocks are in use.
+ */
+static OutputBlock_t * get_free_block(MscriptOutput_t * output, MscriptOutputFile_t * file)
+{
+	mscript_mutex_lock(&output->mutex);
+	OutputBlock_t * block = output->free_list;
+	if (block != NULL) {
+		output->free_list = block->next;
+	} else if (output->nr_of_blocks < output->max_nr_of_blocks) {
+		block = malloc(sizeof(OutputBlock_t) + output->block_size);
+		if (block != NULL) {
+			++output->nr_of_blocks;
+		}
+	} else {
+		++output->stats.nr_of_waits;
+		while (output->free_list == NULL) {
+			mscript_condition_wait(&output->freed, &output->mutex);
+		}
+		block = output->free_list;
+		output->free_list = block->next;
+	}
+	mscript_mutex_unlock(&output->mutex);
+
+	if (block != NULL) {
+		block->next = NULL;
+		block->file = file;
+		block->size = 0;
+		block->flush = false;
+		block->close = false;
+	}
+	return block;
+}
+
+/**
+ * Hand over the current block of a file to the writer thread.
+ */
+static void submit_block(MscriptOutputFile_t * file, bool flush, bool close)
+{
+	OutputBlock_t * block = file->block;
+	file->block = NULL;
+	block->flush = flush;
+	block->close = close;
+
+	MscriptOutput_t * output = file->output;
+	mscript_mutex_lock(&output->mutex);
+	if (output->queue_tail == NULL) {
+		output->queue_head = block;
+	} else {
+		output->queue_tail->next = block;
+	}
+	output->queue_tail = block;
+	mscript_condition_signal(&output->queued);
+	mscript_mutex_unlock(&output->mutex);
+}
+
+/**
+ * Make sure the file has a block to write to.
+ *
+ * \return `true` on success, `false` if no block could be allocated
+ */
+static bool ensure_block(MscriptOutputFile_t * file)
+{
+	if (file->block == NULL) {
+		file->block = get_free_block(file->output, file);
+		if (file->block == NULL) {
+			file->failed = true;
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Write one block to its file. Called by the writer thread.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool write_block(OutputBlock_t * block)
+{
+	MscriptOutputFile_t * file = block->file;
+	bool success = true;
+	if ((block->size > 0) && (fwrite(block->data, 1, block->size, file->fp) != block->size)) {
+		DEBUG_PRINTF("ERROR: Failed to write output file: %s\n", strerror(errno));
+		success = false;
+	}
+	if (block->flush || block->close) {
+		if (fflush(file->fp)) {
+			success = false;
+		}
+	}
+	if (block->close) {
+		if (file->owns_fp && fclose(file->fp)) {
+			DEBUG_PRINTF("ERROR: Failed to close output file: %s\n", strerror(errno));
+			success = false;
+		}
+		free(file);
+	}
+	return success;
+}
+
+/**
+ * Main function of the writer thread.
+ *
+ * Blocks are written in the order they were submitted, until `stop` is set
+ * and the queue is empty.
+ */
+static void writer_main(void * arg)
+{
+	MscriptOutput_t * output = arg;
+	mscript_mutex_lock(&output->mutex);
+	for (;;) {
+		while ((output->queue_head == NULL) && !output->stop) {
+			mscript_condition_wait(&output->queued, &output->mutex);
+		}
+		OutputBlock_t * block = output->queue_head;
+		if (block == NULL) {
+			break;
+		}
+		output->queue_head = block->next;
+		if (output->queue_head == NULL) {
+			output->queue_tail = NULL;
+		}
+		mscript_mutex_unlock(&output->mutex);
+
+		size_t size = block->size;
+		bool success = write_block(block);
+
+		mscript_mutex_lock(&output->mutex);
+		output->stats.nr_of_bytes += size;
+		++output->stats.nr_of_blocks;
+		if (!success) {
+			++output->stats.nr_of_errors;
+		}
+		block->next = output->free_list;
+		output->free_list = block;
+		mscript_condition_signal(&output->freed);
+	}
+	mscript_mutex_unlock(&output->mutex);
+}
+
+/**
+ * Create an output writer and start its writer thread.
+ *
+ * \param block_size Size of each block in bytes. This is also the maximum
+ *                   length of the text written by one `mscript_output_printf()`.
+ * \param max_nr_of_blocks Maximum number of blocks. Each open file uses one
+ *                   block while it is being filled, so this should be larger
+ *                   than the number of files that are open at the same time.
+ *
+ * \return The output writer, or NULL on failure.
+ */
+MscriptOutput_t * mscript_output_create(size_t block_size, size_t max_nr_of_blocks)
+{
+	assert(block_size > 0);
+	assert(max_nr_of_blocks > 0);
+
+	MscriptOutput_t * output = calloc(1, sizeof(MscriptOutput_t));
+	if (output == NULL) {
+		return NULL;
+	}
+	output->block_size = block_size;
+	output->max_nr_of_blocks = max_nr_of_blocks;
+	mscript_mutex_init(&output->mutex);
+	mscript_condition_init(&output->queued);
+	mscript_condition_init(&output->freed);
+	if (!mscript_thread_create(&output->thread, writer_main, output)) {
+		mscript_condition_destroy(&output->freed);
+		mscript_condition_destroy(&output->queued);
+		mscript_mutex_destroy(&output->mutex);
+		free(output);
+		return NULL;
+	}
+	return output;
+}
+
+/**
+ * Write all remaining data, stop the writer thread and free the writer.
+ *
+ * All files must be closed before calling this function.
+ *
+ * \param output The output writer.
+ * \param p_stats[out] Statistics of the writer. May be NULL.
+ *
+ * \return `true` if all data was written successfully, `false` otherwise
+ */
+bool mscript_output_destroy(MscriptOutput_t * output, MscriptOutputStats_t * p_stats)
+{
+	mscript_mutex_lock(&output->mutex);
+	output->stop = true;
+	mscript_condition_signal(&output->queued);
+	mscript_mutex_unlock(&output->mutex);
+	mscript_thread_join(output->thread);
+
+	while (output->free_list != NULL) {
+		OutputBlock_t * block = output->free_list;
+		output->free_list = block->next;
+		free(block);
+	}
+	bool success = output->stats.nr_of_errors == 0;
+	if (p_stats != NULL) {
+		*p_stats = output->stats;
+	}
+	mscript_condition_destroy(&output->freed);
+	mscript_condition_destroy(&output->queued);
+	mscript_mutex_destroy(&output->mutex);
+	free(output);
+	return success;
+}
+
+/**
+ * Create (or truncate) a file and open it for output.
+ *
+ * \return The output file, or NULL on failure.
+ */
+MscriptOutputFile_t * mscript_output_open(MscriptOutput_t * output, char const * path)
+{
+	FILE * fp = fopen(path, "wb");
+	if (fp == NULL) {
+		return NULL;
+	}
+	MscriptOutputFile_t * file = mscript_output_open_stream(output, fp);
+	if (file == NULL) {
+		fclose(fp);
+		return NULL;
+	}
+	file->owns_fp = true;
+	return file;
+}
+
+/**
+ * Open an output file that writes to a stream that is already open, such as
+ * `stdout`. The stream is not closed by `mscript_output_close()`.
+ *
+ * \return The output file, or NULL on failure.
+ */
+MscriptOutputFile_t * mscript_output_open_stream(MscriptOutput_t * output, FILE * fp)
+{
+	assert(output != NULL);
+	assert(fp != NULL);
+
+	MscriptOutputFile_t * file = calloc(1, sizeof(MscriptOutputFile_t));
+	if (file == NULL) {
+		return NULL;
+	}
+	file->output = output;
+	file->fp = fp;
+	return file;
+}
+
+/**
+ * Write data to an output file.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_output_write(MscriptOutputFile_t * file, char const * data, size_t size)
+{
+	size_t block_size = file->output->block_size;
+	while (size > 0) {
+		if (!ensure_block(file)) {
+			return false;
+		}
+		OutputBlock_t * block = file->block;
+		size_t n = block_size - block->size;
+		if (n > size) {
+			n = size;
+		}
+		memcpy(block->data + block->size, data, n);
+		block->size += n;
+		data += n;
+		size -= n;
+		if (block->size == block_size) {
+			submit_block(file, false, false);
+		}
+	}
+	return true;
+}
+
+/**
+ * Write formatted text to an output file.
+ *
+ * The formatted text must fit in one block. It is never split over two
+ * blocks.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_output_printf(MscriptOutputFile_t * file, char const * format, ...)
+{
+	size_t block_size = file->output->block_size;
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (!ensure_block(file)) {
+			return false;
+		}
+		OutputBlock_t * block = file->block;
+		size_t available = block_size - block->size;
+		va_list args;
+		va_start(args, format);
+		// vsnprintf() always writes a terminating zero, so one byte of the
+		// available space can not be used.
+		int len = vsnprintf(block->data + block->size, available, format, args);
+		va_end(args);
+		if (len < 0) {
+			file->failed = true;
+			return false;
+		}
+		if ((size_t)len < available) {
+			block->size += (size_t)len;
+			return true;
+		}
+		if (block->size == 0) {
+			// Does not even fit in an empty block.
+			break;
+		}
+		submit_block(file, false, false);
+	}
+	DEBUG_PRINTF("ERROR: Output text does not fit in one block.\n");
+	file->failed = true;
+	return false;
+}
+
+/**
+ * Hand over the data written so far to the writer thread, and let it flush
+ * the stream after writing. This is useful for console output.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_output_flush(MscriptOutputFile_t * file)
+{
+	if (file->block == NULL) {
+		return !file->failed;
+	}
+	submit_block(file, true, false);
+	return !file->failed;
+}
+
+/**
+ * Close an output file.
+ *
+ * The remaining data is written and the file is closed by the writer thread.
+ * The `file` must not be used after calling this function. Errors that occur
+ * while writing are reported by `mscript_output_destroy()`.
+ *
+ * \return `false` if data could not be added to the output, `true` otherwise
+ */
+bool mscript_output_close(MscriptOutputFile_t * file)
+{
+	bool success = !file->failed;
+	if (!ensure_block(file)) {
+		// Without a block, the writer can not close the file. Since all
+		// blocks are allocated, this can only happen if malloc() fails, in
+		// which case the remaining data is lost anyway.
+		if (file->owns_fp) {
+			fclose(file->fp);
+		}
+		free(file);
+		return false;
+	}
+	submit_block(file, false, true);
+	return success;
+}
@@ -0,0 +1,91 @@
+/**
+ * \file
+ * Shared, asynchronous output writer.
+ *
+ * When data of many devices is stored at the same time, writing each file
+ * directly from the thread that receives the data can delay the processing of
+ * that device (e.g. when the disk is busy), and every open file has its own
+ * stdio buffer. This module collects the output of all files in fixed-size
+ * blocks taken from a common pool, and a single writer thread writes the full
+ * blocks to disk. The producer threads only format text into memory.
+ *
+ * Each output file must be written by one thread at a time. Text written using
+ * one call to `mscript_output_printf()` is never split over two blocks, so if
+ * several output files share the same stream (e.g. the console), complete
+ * lines of different files are never mixed.
+ *
+ * If all blocks are in use, the producers wait until the writer has written a
+ * block, which limits the memory usage to `max_nr_of_blocks * block_size`.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** The shared output writer. */
+typedef struct MscriptOutput MscriptOutput_t;
+
+/** An output file, written through an `MscriptOutput_t`. */
+typedef struct MscriptOutputFile MscriptOutputFile_t;
+
+/** Statistics of an output writer. */
+typedef struct {
+	/** Number of bytes written to all files. */
+	uint64_t nr_of_bytes;
+	/** Number of blocks written to all files. */
+	uint64_t nr_of_blocks;
+	/** Number of write errors. */
+	unsigned int nr_of_errors;
+	/** Number of times a producer had to wait for a free block. */
+	uint64_t nr_of_waits;
+} MscriptOutputStats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptOutput_t * mscript_output_create(size_t block_size, size_t max_nr_of_blocks);
+bool mscript_output_destroy(MscriptOutput_t * output, MscriptOutputStats_t * p_stats);
+MscriptOutputFile_t * mscript_output_open(MscriptOutput_t * output, char const * path);
+MscriptOutputFile_t * mscript_output_open_stream(MscriptOutput_t * output, FILE * fp);
+bool mscript_output_write(MscriptOutputFile_t * file, char const * data, size_t size);
+bool mscript_output_printf(MscriptOutputFile_t * file, char const * format, ...);
+bool mscript_output_flush(MscriptOutputFile_t * file);
+bool mscript_output_close(MscriptOutputFile_t * file);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,411 @@
+/**
+ * \file
+ * Streaming peak detection of voltammetric data.
+ *
+ * See `mscript_peaks.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_peaks.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include "mscript_descriptors.h"
+
+/// Maximum number of samples of the running mean of the noise level.
+#define NOISE_AVERAGE_LENGTH 16
+
+/// Number of samples of the noise level needed before peaks are detected.
+#define MIN_NOISE_SAMPLES 8
+
+/**
+ * Initialize a peak detector with the default settings.
+ *
+ * The settings (`min_height`, `noise_factor`, etc.) can be changed after
+ * calling this function, before the first point is added.
+ */
+void mscript_peak_detector_init(MscriptPeakDetector_t * detector)
+{
+	assert(detector != NULL);
+
+	memset(detector, 0, sizeof(MscriptPeakDetector_t));
+	detector->min_height = 0.0;
+	detector->noise_factor = 5.0;
+	detector->smoothing = 5;
+	detector->min_points = 3;
+	detector->baseline_delay = 8;
+	detector->min_baseline_points = 5;
+	detector->baseline_decay = 0.95;
+	detector->polarity = MSCRIPT_PEAK_POLARITY_SCAN;
+}
+
+/**
+ * Reset the state of a peak detector, e.g. to start a new scan.
+ *
+ * The settings are not changed. A peak that was not completed is discarded;
+ * use `mscript_peak_detector_finish()` to report it instead.
+ */
+void mscript_peak_detector_reset(MscriptPeakDetector_t * detector)
+{
+	size_t offset = offsetof(MscriptPeakDetector_t, raw);
+	memset((char *)detector + offset, 0, sizeof(MscriptPeakDetector_t) - offset);
+}
+
+/**
+ * Clamp an unsigned value to the range [`min`, `max`].
+ */
+static unsigned int clamp(unsigned int value, unsigned int min, unsigned int max)
+{
+	return (value < min) ? min : (value > max) ? max : value;
+}
+
+/**
+ * Get the sign of the peaks that are detected (1 or -1).
+ */
+static double get_peak_sign(MscriptPeakDetector_t const * detector)
+{
+	switch (detector->polarity) {
+	case MSCRIPT_PEAK_POLARITY_POSITIVE:
+		return 1.0;
+	case MSCRIPT_PEAK_POLARITY_NEGATIVE:
+		return -1.0;
+	case MSCRIPT_PEAK_POLARITY_SCAN:
+		break;
+	}
+	return (detector->direction < 0) ? -1.0 : 1.0;
+}
+
+/**
+ * Add a point to the weighted linear fit of the baseline.
+ */
+static void add_baseline_point(MscriptPeakDetector_t * detector, MscriptPeakPoint_t const * point)
+{
+	double decay = detector->baseline_decay;
+	double x = point->potential;
+	double y = point->current;
+	detector->sum_w = detector->sum_w * decay + 1.0;
+	detector->sum_x = detector->sum_x * decay + x;
+	detector->sum_y = detector->sum_y * decay + y;
+	detector->sum_xx = detector->sum_xx * decay + x * x;
+	detector->sum_xy = detector->sum_xy * decay + x * y;
+	++detector->nr_of_baseline_points;
+}
+
+/**
+ * Get the value of the baseline at a potential.
+ */
+static double get_baseline(MscriptPeakDetector_t const * detector, double potential)
+{
+	double w = detector->sum_w;
+	double mean_x = detector->sum_x / w;
+	double mean_y = detector->sum_y / w;
+	double var_x = detector->sum_xx / w - mean_x * mean_x;
+	// If all points have (nearly) the same potential, use a constant baseline.
+	if (var_x <= 1e-12 * (detector->sum_xx / w)) {
+		return mean_y;
+	}
+	double slope = (detector->sum_xy / w - mean_x * mean_y) / var_x;
+	return mean_y + slope * (potential - mean_x);
+}
+
+/**
+ * Get the integral of the current between two points (trapezoidal rule).
+ */
+static double integrate(MscriptPeakPoint_t const * a, MscriptPeakPoint_t const * b)
+{
+	return fabs(b->potential - a->potential) * (a->current + b->current) / 2.0;
+}
+
+/**
+ * Restart the baseline estimation, e.g. after a peak.
+ */
+static void restart_baseline(MscriptPeakDetector_t * detector)
+{
+	detector->sum_w = detector->sum_x = detector->sum_y = 0.0;
+	detector->sum_xx = detector->sum_xy = 0.0;
+	detector->nr_of_baseline_points = 0;
+	detector->nr_of_delayed = 0;
+	detector->in_peak = false;
+	detector->run = 0;
+}
+
+/**
+ * Complete the current peak, using the line between its start and `end` as
+ * baseline.
+ *
+ * \return `true` if the peak is high enough, `false` if it is ignored.
+ */
+static bool complete_peak(MscriptPeakDetector_t * detector, MscriptPeak_t * p_peak)
+{
+	MscriptPeakPoint_t const * start = &detector->start;
+	MscriptPeakPoint_t const * end = &detector->end;
+	MscriptPeakPoint_t const * top = &detector->top;
+	double sign = get_peak_sign(detector);
+
+	double baseline = start->current;
+	if (end->potential != start->potential) {
+		baseline += (top->potential - start->potential) / (end->potential - start->potential)
+			* (end->current - start->current);
+	}
+	double height = top->current - baseline;
+	double area = detector->end_integral
+		- fabs(end->potential - start->potential) * (start->current + end->current) / 2.0;
+	restart_baseline(detector);
+
+	if ((sign * height <= 0.0) || (sign * height < detector->min_height)) {
+		return false;
+	}
+	p_peak->potential = top->potential;
+	p_peak->height = height;
+	p_peak->area = area;
+	p_peak->start_potential = start->potential;
+	p_peak->end_potential = end->potential;
+	return true;
+}
+
+/**
+ * Process a smoothed point.
+ *
+ * \return `true` if a peak was completed, `false` otherwise.
+ */
+static bool process_point(MscriptPeakDetector_t * detector, MscriptPeakPoint_t const * point,
+	MscriptPeak_t * p_peak)
+{
+	unsigned int min_points = clamp(detector->min_points, 1, MSCRIPT_PEAK_MAX_WINDOW);
+	unsigned int delay = clamp(detector->baseline_delay, min_points, MSCRIPT_PEAK_MAX_WINDOW);
+	double sign = get_peak_sign(detector);
+	double threshold = fmax(detector->min_height, detector->noise_factor * detector->noise);
+	MscriptPeakPoint_t const * last = (detector->nr_of_points > 0) ? &detector->last : point;
+	bool found = false;
+
+	if (!detector->in_peak) {
+		// Points are added to the baseline after a delay, so that the rising
+		// edge of a peak can be removed before it affects the baseline.
+		if (detector->nr_of_delayed >= delay) {
+			add_baseline_point(detector, &detector->delayed[0]);
+			--detector->nr_of_delayed;
+			memmove(&detector->delayed[0], &detector->delayed[1],
+				detector->nr_of_delayed * sizeof(MscriptPeakPoint_t));
+		}
+		detector->delayed[detector->nr_of_delayed++] = *point;
+
+		if (detector->nr_of_baseline_points < detector->min_baseline_points) {
+			detector->run = 0;
+			detector->last_residual = NAN;
+		} else {
+			double residual = sign * (point->current - get_baseline(detector, point->potential));
+			bool is_ready = detector->nr_of_noise_samples >= MIN_NOISE_SAMPLES;
+			if (is_ready && (residual > threshold)) {
+				// Possible start of a peak.
+				if (detector->run == 0) {
+					detector->start = *last;
+					detector->integral = 0.0;
+					detector->top_residual = -INFINITY;
+				}
+				detector->integral += integrate(last, point);
+				if (residual > detector->top_residual) {
+					detector->top = *point;
+					detector->top_residual = residual;
+				}
+				if (++detector->run >= min_points) {
+					// The points of the peak are never added to the baseline.
+					detector->in_peak = true;
+					detector->nr_of_delayed = 0;
+					detector->run = 0;
+				}
+			} else {
+				detector->run = 0;
+				if (!isnan(detector->last_residual)) {
+					unsigned int n = ++detector->nr_of_noise_samples;
+					if (n > NOISE_AVERAGE_LENGTH) {
+						n = NOISE_AVERAGE_LENGTH;
+					}
+					detector->noise += (fabs(residual - detector->last_residual)
+						- detector->noise) / n;
+				}
+			}
+			detector->last_residual = residual;
+		}
+	} else {
+		// Inside a peak, the baseline is not updated.
+		double residual = sign * (point->current - get_baseline(detector, point->potential));
+		detector->integral += integrate(last, point);
+		if (residual > detector->top_residual) {
+			detector->top = *point;
+			detector->top_residual = residual;
+			detector->run = 0;
+		} else if (residual < threshold / 2.0) {
+			// Back at the baseline.
+			detector->end = *point;
+			detector->end_integral = detector->integral;
+			found = complete_peak(detector, p_peak);
+		} else if (residual >= detector->last_residual) {
+			// No longer decreasing; the peak ends at the valley if the residual
+			// does not decrease again.
+			if (detector->run == 0) {
+				detector->end = *last;
+				detector->end_integral = detector->integral - integrate(last, point);
+			}
+			if (++detector->run >= min_points) {
+				found = complete_peak(detector, p_peak);
+				detector->last_residual = NAN;
+			}
+		} else {
+			detector->run = 0;
+		}
+		if (detector->in_peak) {
+			detector->last_residual = residual;
+		}
+	}
+
+	detector->last = *point;
+	++detector->nr_of_points;
+	return found;
+}
+
+/**
+ * Complete a peak that is still in progress at the end of a scan.
+ */
+static bool flush_peak(MscriptPeakDetector_t * detector, MscriptPeak_t * p_peak)
+{
+	if (!detector->in_peak) {
+		return false;
+	}
+	detector->end = detector->last;
+	detector->end_integral = detector->integral;
+	return complete_peak(detector, p_peak);
+}
+
+/**
+ * Add a data point to a peak detector.
+ *
+ * If the scan direction changes (in cyclic voltammetry), the peak in
+ * progress is completed and the baseline estimation is restarted.
+ *
+ * \param detector The peak detector.
+ * \param potential The potential of the point [V].
+ * \param current The current of the point [A].
+ * \param[out] p_peak The peak, if a peak was completed.
+ *
+ * \return `true` if a peak was completed, `false` otherwise.
+ */
+bool mscript_peak_detector_add(MscriptPeakDetector_t * detector, double potential,
+	double current, MscriptPeak_t * p_peak)
+{
+	bool found = false;
+
+	// Check for a change of the scan direction.
+	if (detector->nr_of_raw > 0) {
+		double dx = potential - detector->last_potential;
+		if (dx != 0.0) {
+			int direction = (dx > 0.0) ? 1 : -1;
+			if ((detector->direction != 0) && (direction != detector->direction)) {
+				found = flush_peak(detector, p_peak);
+				mscript_peak_detector_reset(detector);
+			}
+			detector->direction = direction;
+		}
+	}
+	detector->last_potential = potential;
+
+	// Moving average of the input.
+	unsigned int smoothing = clamp(detector->smoothing, 1, MSCRIPT_PEAK_MAX_WINDOW);
+	if (detector->nr_of_raw >= smoothing) {
+		detector->raw_potential_sum -= detector->raw[0].potential;
+		detector->raw_current_sum -= detector->raw[0].current;
+		--detector->nr_of_raw;
+		memmove(&detector->raw[0], &detector->raw[1],
+			detector->nr_of_raw * sizeof(MscriptPeakPoint_t));
+	}
+	detector->raw[detector->nr_of_raw].potential = potential;
+	detector->raw[detector->nr_of_raw].current = current;
+	++detector->nr_of_raw;
+	detector->raw_potential_sum += potential;
+	detector->raw_current_sum += current;
+	if (detector->nr_of_raw < smoothing) {
+		return found;
+	}
+
+	MscriptPeakPoint_t point;
+	point.potential = detector->raw_potential_sum / smoothing;
+	point.current = detector->raw_current_sum / smoothing;
+	if (process_point(detector, &point, p_peak)) {
+		found = true;
+	}
+	return found;
+}
+
+/**
+ * Add a data package to a peak detector.
+ *
+ * The first potential and the first current variable of the package (see
+ * `mscript_descriptors.h`) are used. Packages without a potential or current
+ * are ignored.
+ *
+ * \return `true` if a peak was completed, `false` otherwise.
+ */
+bool mscript_peak_detector_add_package(MscriptPeakDetector_t * detector,
+	MscriptDataPackage_t const * package, MscriptPeak_t * p_peak)
+{
+	double const * potential = NULL;
+	double const * current = NULL;
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		MscriptSubPackage_t const * sub_package = &package->sub_packages[i];
+		MscriptQuantity_t quantity =
+			mscript_get_vartype_descriptor(sub_package->variable_type)->quantity;
+		if ((quantity == MSCRIPT_QUANTITY_POTENTIAL) && (potential == NULL)) {
+			potential = &sub_package->value;
+		} else if ((quantity == MSCRIPT_QUANTITY_CURRENT) && (current == NULL)) {
+			current = &sub_package->value;
+		}
+	}
+	if ((potential == NULL) || (current == NULL)) {
+		return false;
+	}
+	return mscript_peak_detector_add(detector, *potential, *current, p_peak);
+}
+
+/**
+ * Finish a scan.
+ *
+ * A peak that is still in progress is completed, and the detector is reset
+ * for the next scan.
+ *
+ * \return `true` if a peak was completed, `false` otherwise.
+ */
+bool mscript_peak_detector_finish(MscriptPeakDetector_t * detector, MscriptPeak_t * p_peak)
+{
+	bool found = flush_peak(detector, p_peak);
+	mscript_peak_detector_reset(detector);
+	return found;
+}
@@ -0,0 +1,165 @@
+/**
+ * \file
+ * Streaming peak detection of voltammetric data.
+ *
+ * This module finds the peaks in the output of voltammetric techniques (e.g.
+ * `meas_loop_swv`, `meas_loop_dpv` and `meas_loop_cv`) while the data packages
+ * arrive, so a peak is reported as soon as it is complete. Each point is
+ * processed in constant time and the detector only keeps a small, fixed
+ * amount of state (no allocations), so the scans of many devices and channels
+ * can be processed at the same time on one core.
+ *
+ * The current is first smoothed with a short moving average. The baseline is
+ * estimated by a weighted linear fit of the preceding points, in which older
+ * points get less weight. To keep the rising edge of a peak out of the fit,
+ * points are only added to the baseline after a short delay. A peak starts
+ * when the current deviates from the baseline by more than a threshold (based
+ * on the estimated noise level and `min_height`) for `min_points` points. The
+ * peak ends when the current returns to the baseline, or at the valley before
+ * the next peak. The height and area of the peak are then determined with
+ * respect to the straight line between the start and end of the peak.
+ *
+ * In cyclic voltammetry, a change of the scan direction ends the current peak
+ * and restarts the baseline estimation. By default, peaks in the direction of
+ * the scan are detected (oxidation peaks in the forward scan and reduction
+ * peaks in the reverse scan).
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript.h"
+
+/// Maximum length of the smoothing window and the baseline delay (in points).
+#define MSCRIPT_PEAK_MAX_WINDOW 16
+
+/** The direction of the peaks to detect. */
+typedef enum {
+	MSCRIPT_PEAK_POLARITY_SCAN,     //!< Positive when scanning up, negative when scanning down
+	MSCRIPT_PEAK_POLARITY_POSITIVE, //!< Positive (anodic) peaks only
+	MSCRIPT_PEAK_POLARITY_NEGATIVE, //!< Negative (cathodic) peaks only
+} MscriptPeakPolarity_t;
+
+/** A detected peak. */
+typedef struct {
+	/** Potential at the top of the peak [V]. */
+	double potential;
+	/** Current at the top of the peak relative to the baseline [A] (negative for negative peaks). */
+	double height;
+	/** Area between the peak and the baseline [V*A] (negative for negative peaks). */
+	double area;
+	/** Potential at the start of the peak [V]. */
+	double start_potential;
+	/** Potential at the end of the peak [V]. */
+	double end_potential;
+} MscriptPeak_t;
+
+/** A smoothed data point (internal). */
+typedef struct {
+	double potential;
+	double current;
+} MscriptPeakPoint_t;
+
+/** State of a peak detector. */
+typedef struct {
+	/** Minimum height of a peak [A]. */
+	double min_height;
+	/** The threshold for the start of a peak, as a multiple of the noise level. */
+	double noise_factor;
+	/** Number of points of the moving average (1 = no smoothing). */
+	unsigned int smoothing;
+	/** Number of consecutive points needed to start or end a peak. */
+	unsigned int min_points;
+	/** Number of points before a point is added to the baseline (at least `min_points`). */
+	unsigned int baseline_delay;
+	/** Number of baseline points needed before peaks are detected. */
+	unsigned int min_baseline_points;
+	/** Weight of the previous baseline points for each new point (0 to 1). */
+	double baseline_decay;
+	/** The direction of the peaks to detect. */
+	MscriptPeakPolarity_t polarity;
+
+	/* The remaining fields are the internal state of the detector. */
+
+	/** Moving average of the input. */
+	MscriptPeakPoint_t raw[MSCRIPT_PEAK_MAX_WINDOW];
+	unsigned int nr_of_raw;
+	double raw_potential_sum;
+	double raw_current_sum;
+	/** The previous input point. */
+	double last_potential;
+	/** Direction of the scan (1 = up, -1 = down, 0 = unknown). */
+	int direction;
+	/** Smoothed points that have not been added to the baseline yet. */
+	MscriptPeakPoint_t delayed[MSCRIPT_PEAK_MAX_WINDOW];
+	unsigned int nr_of_delayed;
+	/** Weighted sums of the linear fit of the baseline. */
+	double sum_w, sum_x, sum_y, sum_xx, sum_xy;
+	unsigned int nr_of_baseline_points;
+	/** Estimated noise level (mean absolute change of the residual). */
+	double noise;
+	unsigned int nr_of_noise_samples;
+	/** The previous smoothed point and its residual. */
+	MscriptPeakPoint_t last;
+	double last_residual;
+	unsigned int nr_of_points;
+	/** Number of consecutive points that meet the start or end condition. */
+	unsigned int run;
+	bool in_peak;
+	/** Start of the (possible) peak and the integral of the current since then. */
+	MscriptPeakPoint_t start;
+	double integral;
+	/** Top of the peak. */
+	MscriptPeakPoint_t top;
+	double top_residual;
+	/** Possible end of the peak and the integral up to that point. */
+	MscriptPeakPoint_t end;
+	double end_integral;
+} MscriptPeakDetector_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mscript_peak_detector_init(MscriptPeakDetector_t * detector);
+void mscript_peak_detector_reset(MscriptPeakDetector_t * detector);
+bool mscript_peak_detector_add(MscriptPeakDetector_t * detector, double potential,
+	double current, MscriptPeak_t * p_peak);
+bool mscript_peak_detector_add_package(MscriptPeakDetector_t * detector,
+	MscriptDataPackage_t const * package, MscriptPeak_t * p_peak);
+bool mscript_peak_detector_finish(MscriptPeakDetector_t * detector, MscriptPeak_t * p_peak);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,461 @@
+/**
+ * \file
+ * Savitzky-Golay smoothing and differentiation of measurement data.
+ *
+ * See `mscript_savgol.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_savgol.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+#if !defined(MSCRIPT_SAVGOL_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) \
+	|| defined(_M_X64))
+#define HAVE_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define HAVE_AVX2 0
+#endif
+
+/// Maximum number of points in the window.
+#define MAX_WINDOW (2 * MSCRIPT_SAVGOL_MAX_HALF_WIDTH + 1)
+
+/// Number of new points that are processed at once by a stream.
+#define BLOCK_SIZE 4096
+
+struct MscriptSavgol {
+	unsigned int half_width;
+	unsigned int window;
+	unsigned int derivative;
+	bool use_simd;
+	/**
+	 * Coefficients for the value at each position in the window. Row
+	 * `half_width` is used for all points with a complete window, the other
+	 * rows for the first and last points.
+	 */
+	double coefficients[MAX_WINDOW][MAX_WINDOW];
+
+	/* State of the stream. */
+
+	/** The last received points (at most `window - 1 + BLOCK_SIZE`). */
+	double buffer[MAX_WINDOW + BLOCK_SIZE];
+	size_t nr_of_buffered;
+	/** Index in `buffer` of the first point without output. */
+	size_t next;
+	/** `true` once the first complete window has been received. */
+	bool is_started;
+};
+
+/**
+ * Solve the linear system `a * x = b` in place (`b` is replaced by `x`),
+ * using Gaussian elimination with partial pivoting.
+ *
+ * \return `false` if the matrix is singular.
+ */
+static bool solve(double a[MSCRIPT_SAVGOL_MAX_ORDER + 1][MSCRIPT_SAVGOL_MAX_ORDER + 1],
+	double * b, unsigned int n)
+{
+	for (unsigned int col = 0; col < n; ++col) {
+		unsigned int pivot = col;
+		for (unsigned int row = col + 1; row < n; ++row) {
+			if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+				pivot = row;
+			}
+		}
+		if (fabs(a[pivot][col]) < 1e-12) {
+			return false;
+		}
+		if (pivot != col) {
+			for (unsigned int k = 0; k < n; ++k) {
+				double tmp = a[col][k];
+				a[col][k] = a[pivot][k];
+				a[pivot][k] = tmp;
+			}
+			double tmp = b[col];
+			b[col] = b[pivot];
+			b[pivot] = tmp;
+		}
+		for (unsigned int row = col + 1; row < n; ++row) {
+			double factor = a[row][col] / a[col][col];
+			for (unsigned int k = col; k < n; ++k) {
+				a[row][k] -= factor * a[col][k];
+			}
+			b[row] -= factor * b[col];
+		}
+	}
+	for (unsigned int row = n; row-- > 0;) {
+		for (unsigned int k = row + 1; k < n; ++k) {
+			b[row] -= a[row][k] * b[k];
+		}
+		b[row] /= a[row][row];
+	}
+	return true;
+}
+
+/**
+ * Calculate the coefficients for the value (or derivative) at each position
+ * in the window.
+ *
+ * The polynomial is fitted as a function of u = j / half_width, where j is
+ * the position relative to the center of the window, to keep the normal
+ * equations well-conditioned.
+ *
+ * \return `false` if the coefficients could not be calculated.
+ */
+static bool calculate_coefficients(MscriptSavgol_t * filter, unsigned int order, double spacing)
+{
+	unsigned int m = filter->half_width;
+	unsigned int n = order + 1;
+	double scale = pow(1.0 / (m * spacing), filter->derivative);
+
+	for (unsigned int position = 0; position < filter->window; ++position) {
+		// Normal equations: (A^T A) w = v, where A[j][r] = u_j^r and v[r] is
+		// the derivative of u^r at the position.
+		double ata[MSCRIPT_SAVGOL_MAX_ORDER + 1][MSCRIPT_SAVGOL_MAX_ORDER + 1];
+		double w[MSCRIPT_SAVGOL_MAX_ORDER + 1];
+		for (unsigned int r = 0; r < n; ++r) {
+			for (unsigned int c = 0; c < n; ++c) {
+				double sum = 0.0;
+				for (unsigned int j = 0; j < filter->window; ++j) {
+					double u = ((double)j - m) / m;
+					sum += pow(u, r + c);
+				}
+				ata[r][c] = sum;
+			}
+			double t = ((double)position - m) / m;
+			if (r < filter->derivative) {
+				w[r] = 0.0;
+			} else {
+				double factor = 1.0;
+				for (unsigned int k = 0; k < filter->derivative; ++k) {
+					factor *= r - k;
+				}
+				w[r] = factor * pow(t, r - filter->derivative);
+			}
+		}
+		if (!solve(ata, w, n)) {
+			return false;
+		}
+		for (unsigned int j = 0; j < filter->window; ++j) {
+			double u = ((double)j - m) / m;
+			double sum = 0.0;
+			for (unsigned int r = 0; r < n; ++r) {
+				sum += w[r] * pow(u, r);
+			}
+			filter->coefficients[position][j] = sum * scale;
+		}
+	}
+	return true;
+}
+
+/**
+ * Create a Savitzky-Golay filter.
+ *
+ * \param half_width Half the width of the window (1 to `MSCRIPT_SAVGOL_MAX_HALF_WIDTH`).
+ * \param order The order of the polynomial (less than `2 * half_width + 1`).
+ * \param derivative 0 for smoothing, 1 for the first derivative, etc. (at most `order`).
+ * \param spacing The distance between two points (e.g. the potential step),
+ *                which scales the derivative.
+ *
+ * \return The new filter, or NULL on failure.
+ */
+MscriptSavgol_t * mscript_savgol_create(unsigned int half_width, unsigned int order,
+	unsigned int derivative, double spacing)
+{
+	if ((half_width < 1) || (half_width > MSCRIPT_SAVGOL_MAX_HALF_WIDTH)
+		|| (order > MSCRIPT_SAVGOL_MAX_ORDER) || (order >= 2 * half_width + 1)
+		|| (derivative > order) || (spacing == 0.0)) {
+		DEBUG_PRINTF("Invalid Savitzky-Golay filter parameters.\n");
+		return NULL;
+	}
+	MscriptSavgol_t * filter = malloc(sizeof(MscriptSavgol_t));
+	if (filter == NULL) {
+		return NULL;
+	}
+	filter->half_width = half_width;
+	filter->window = 2 * half_width + 1;
+	filter->derivative = derivative;
+	filter->use_simd = mscript_savgol_has_simd();
+	if (!calculate_coefficients(filter, order, spacing)) {
+		free(filter);
+		return NULL;
+	}
+	mscript_savgol_reset(filter);
+	return filter;
+}
+
+/**
+ * Destroy a Savitzky-Golay filter.
+ */
+void mscript_savgol_destroy(MscriptSavgol_t * filter)
+{
+	free(filter);
+}
+
+/**
+ * Check if the vectorized (AVX2) implementation can be used on this computer.
+ */
+bool mscript_savgol_has_simd(void)
+{
+#if HAVE_AVX2
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	bool has_fma = (info[2] & (1 << 12)) != 0;
+	bool has_os_support = ((info[2] & (1 << 27)) != 0) && ((_xgetbv(0) & 6) == 6);
+	__cpuidex(info, 7, 0);
+	bool has_avx2 = (info[1] & (1 << 5)) != 0;
+	return has_fma && has_avx2 && has_os_support;
+#else
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#else
+	return false;
+#endif
+}
+
+/**
+ * Enable or disable the vectorized implementation (e.g. to compare the
+ * performance). It can only be enabled if it is supported.
+ */
+void mscript_savgol_use_simd(MscriptSavgol_t * filter, bool use_simd)
+{
+	filter->use_simd = use_simd && mscript_savgol_has_simd();
+}
+
+/**
+ * Reset the stream of a filter, to start filtering a new series of points.
+ */
+void mscript_savgol_reset(MscriptSavgol_t * filter)
+{
+	filter->nr_of_buffered = 0;
+	filter->next = 0;
+	filter->is_started = false;
+}
+
+/**
+ * Calculate `output[i] = sum(coefficients[k] * input[i + k])` for `count`
+ * points (scalar implementation).
+ */
+static void convolve_scalar(double const * coefficients, unsigned int window,
+	double const * input, double * output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		double sum = 0.0;
+		for (unsigned int k = 0; k < window; ++k) {
+			sum += coefficients[k] * input[i + k];
+		}
+		output[i] = sum;
+	}
+}
+
+#if HAVE_AVX2
+/**
+ * Calculate `output[i] = sum(coefficients[k] * input[i + k])` for `count`
+ * points (AVX2 implementation). Eight points are calculated per iteration,
+ * using two independent accumulators.
+ */
+TARGET_AVX2
+static void convolve_avx2(double const * coefficients, unsigned int window,
+	double const * input, double * output, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256d sum0 = _mm256_setzero_pd();
+		__m256d sum1 = _mm256_setzero_pd();
+		for (unsigned int k = 0; k < window; ++k) {
+			__m256d c = _mm256_broadcast_sd(&coefficients[k]);
+			sum0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(&input[i + k]), sum0);
+			sum1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(&input[i + k + 4]), sum1);
+		}
+		_mm256_storeu_pd(&output[i], sum0);
+		_mm256_storeu_pd(&output[i + 4], sum1);
+	}
+	for (; i + 4 <= count; i += 4) {
+		__m256d sum = _mm256_setzero_pd();
+		for (unsigned int k = 0; k < window; ++k) {
+			__m256d c = _mm256_broadcast_sd(&coefficients[k]);
+			sum = _mm256_fmadd_pd(c, _mm256_loadu_pd(&input[i + k]), sum);
+		}
+		_mm256_storeu_pd(&output[i], sum);
+	}
+	convolve_scalar(coefficients, window, &input[i], &output[i], count - i);
+}
+#endif
+
+/**
+ * Apply the coefficients of the center of the window to `count` points.
+ */
+static void convolve(MscriptSavgol_t const * filter, double const * input, double * output,
+	size_t count)
+{
+	double const * coefficients = filter->coefficients[filter->half_width];
+#if HAVE_AVX2
+	if (filter->use_simd) {
+		convolve_avx2(coefficients, filter->window, input, output, count);
+		return;
+	}
+#endif
+	convolve_scalar(coefficients, filter->window, input, output, count);
+}
+
+/**
+ * Calculate the value at a position in a complete window.
+ */
+static double evaluate(MscriptSavgol_t const * filter, unsigned int position,
+	double const * window_start)
+{
+	double sum = 0.0;
+	for (unsigned int k = 0; k < filter->window; ++k) {
+		sum += filter->coefficients[position][k] * window_start[k];
+	}
+	return sum;
+}
+
+/**
+ * Add points to the stream of a filter.
+ *
+ * The output of a point is available when `half_width` points after it have
+ * been received, so the output lags behind the input. The remaining output
+ * is returned by `mscript_savgol_finish()` at the end of the series.
+ *
+ * \param filter The filter.
+ * \param input The new points.
+ * \param count Number of new points.
+ * \param[out] output Receives the output values (at most `count` values).
+ *
+ * \return The number of values written to `output`.
+ */
+size_t mscript_savgol_process(MscriptSavgol_t * filter, double const * input, size_t count,
+	double * output)
+{
+	unsigned int m = filter->half_width;
+	size_t nr_of_outputs = 0;
+
+	while (count > 0) {
+		size_t n = (count < BLOCK_SIZE) ? count : BLOCK_SIZE;
+		memcpy(&filter->buffer[filter->nr_of_buffered], input, n * sizeof(double));
+		filter->nr_of_buffered += n;
+		input += n;
+		count -= n;
+
+		if (filter->nr_of_buffered < filter->window) {
+			continue;
+		}
+		// The first points use the polynomial of the first window.
+		if (!filter->is_started) {
+			for (unsigned int position = 0; position < m; ++position) {
+				output[nr_of_outputs++] = evaluate(filter, position, filter->buffer);
+			}
+			filter->next = m;
+			filter->is_started = true;
+		}
+		// All points with a complete window.
+		size_t end = filter->nr_of_buffered - m;
+		if (end > filter->next) {
+			convolve(filter, &filter->buffer[filter->next - m], &output[nr_of_outputs],
+				end - filter->next);
+			nr_of_outputs += end - filter->next;
+			filter->next = end;
+		}
+		// Keep the last complete window for the next block and for the last points.
+		size_t shift = filter->nr_of_buffered - filter->window;
+		memmove(filter->buffer, &filter->buffer[shift], filter->window * sizeof(double));
+		filter->nr_of_buffered = filter->window;
+		filter->next -= shift;
+	}
+	return nr_of_outputs;
+}
+
+/**
+ * Finish the stream of a filter.
+ *
+ * This returns the output of the last points, which use the polynomial of the
+ * last window, and resets the stream. If fewer points than the window size
+ * were received, the filter can not be applied: the points are returned
+ * unchanged when smoothing, or as NaN for a derivative.
+ *
+ * \param filter The filter.
+ * \param[out] output Receives the output values (at most `2 * half_width` values).
+ *
+ * \return The number of values written to `output`.
+ */
+size_t mscript_savgol_finish(MscriptSavgol_t * filter, double * output)
+{
+	size_t nr_of_outputs = 0;
+	if (filter->is_started) {
+		double const * window_start = &filter->buffer[filter->nr_of_buffered - filter->window];
+		size_t first = filter->nr_of_buffered - filter->window;
+		for (size_t i = filter->next; i < filter->nr_of_buffered; ++i) {
+			output[nr_of_outputs++] = evaluate(filter, (unsigned int)(i - first), window_start);
+		}
+	} else {
+		for (size_t i = 0; i < filter->nr_of_buffered; ++i) {
+			output[nr_of_outputs++] = (filter->derivative == 0) ? filter->buffer[i] : NAN;
+		}
+	}
+	mscript_savgol_reset(filter);
+	return nr_of_outputs;
+}
+
+/**
+ * Apply a filter to a complete series of points.
+ *
+ * This is equivalent to `mscript_savgol_process()` followed by
+ * `mscript_savgol_finish()`. Any stream in progress is discarded.
+ *
+ * \param filter The filter.
+ * \param input The points.
+ * \param count Number of points.
+ * \param[out] output Receives `count` values (must not overlap with `input`).
+ */
+void mscript_savgol_apply(MscriptSavgol_t * filter, double const * input, size_t count,
+	double * output)
+{
+	mscript_savgol_reset(filter);
+	size_t n = mscript_savgol_process(filter, input, count, output);
+	n += mscript_savgol_finish(filter, &output[n]);
+	assert(n == count);
+	(void)n;
+}
@@ -0,0 +1,90 @@
+/**
+ * \file
+ * Savitzky-Golay smoothing and differentiation of measurement data.
+ *
+ * A Savitzky-Golay filter fits a polynomial to the points in a window around
+ * each point, using least squares, and replaces the point by the value (or
+ * derivative) of that polynomial. Compared to a moving average, it preserves
+ * the height and width of peaks much better. This is the same kind of filter
+ * that the `smooth` command of MethodSCRIPT applies on the device; running
+ * it on the host allows larger windows and keeps the raw data available.
+ *
+ * The filter is a convolution with fixed coefficients, which are calculated
+ * once when the filter is created. The first and last `half_width` points,
+ * for which the window is incomplete, are calculated from the polynomial
+ * fitted to the first and last complete window.
+ *
+ * The filter can be applied to a complete array (e.g. a column of
+ * `mscript_columns.h`) or as a streaming stage: the data is passed in chunks
+ * of any size as it arrives, and each output value becomes available as soon
+ * as the `half_width` points after it have been received.
+ *
+ * On x86 processors that support AVX2 and FMA, the convolution is vectorized
+ * (4 points per instruction). This is detected at runtime, so the same
+ * executable also runs on other processors, using the scalar implementation.
+ * Define `MSCRIPT_SAVGOL_NO_SIMD` to build without the AVX2 implementation.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Maximum half width of the window (the window is 2 * half_width + 1 points).
+#define MSCRIPT_SAVGOL_MAX_HALF_WIDTH 32
+
+/// Maximum order of the fitted polynomial.
+#define MSCRIPT_SAVGOL_MAX_ORDER 8
+
+/** A Savitzky-Golay filter, including the state of a stream. */
+typedef struct MscriptSavgol MscriptSavgol_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptSavgol_t * mscript_savgol_create(unsigned int half_width, unsigned int order,
+	unsigned int derivative, double spacing);
+void mscript_savgol_destroy(MscriptSavgol_t * filter);
+bool mscript_savgol_has_simd(void);
+void mscript_savgol_use_simd(MscriptSavgol_t * filter, bool use_simd);
+void mscript_savgol_reset(MscriptSavgol_t * filter);
+size_t mscript_savgol_process(MscriptSavgol_t * filter, double const * input, size_t count,
+	double * output);
+size_t mscript_savgol_finish(MscriptSavgol_t * filter, double * output);
+void mscript_savgol_apply(MscriptSavgol_t * filter, double const * input, size_t count,
+	double * output);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,390 @@
+/**
+ * \file
+ * Averaging of repeated scans.
+ *
+ * See `mscript_scan_average.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_scan_average.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+/// Maximum number of bins of each direction. Points outside are ignored.
+#define MAX_BINS (1024 * 1024)
+
+/// Number of bins allocated for the first bin of a direction.
+#define INITIAL_BIN_CAPACITY 64
+
+/** The values of all scans at one potential. */
+typedef struct {
+	/** Number of the last scan that added a value (0 = none). */
+	unsigned int last_scan;
+	unsigned int count;
+	double mean;
+	/** Sum of squared differences from the mean. */
+	double m2;
+} Bin_t;
+
+/**
+ * The bins of one scan direction, for bin numbers `first` to `first + count - 1`.
+ *
+ * The bins are stored in a larger array, so the branch can grow at both ends
+ * without reallocating for every bin. The unused bins of the array are zero.
+ */
+typedef struct {
+	Bin_t * storage;
+	size_t capacity;
+	/** The bins, at index `offset` of `storage`. */
+	Bin_t * bins;
+	size_t offset;
+	long first;
+	size_t count;
+} Branch_t;
+
+struct MscriptScanAverage {
+	unsigned int variable_type;
+	/** Width of a bin (V), or 0 if not known yet. */
+	double step;
+	/** `true` if the step was given when the average was created. */
+	bool is_step_fixed;
+	/** The potential of bin 0. */
+	double origin;
+	bool has_origin;
+	/** The bins of increasing and decreasing potential. */
+	Branch_t branches[2];
+	/** Number of completed scans. */
+	unsigned int nr_of_scans;
+	/** `true` if the current scan has points. */
+	bool is_scan_open;
+	/** The first point of the scan, while its direction is not known yet. */
+	bool has_pending;
+	double pending_potential;
+	double pending_value;
+	/** The previous potential of the scan and the direction of the scan there. */
+	double last_potential;
+	int direction;
+};
+
+/**
+ * Create a running average of repeated scans.
+ *
+ * \param variable_type The variable to average, e.g. `MSCRIPT_VARTYPE_CURRENT`.
+ * \param step The potential step of the scans (V), or 0 to use the first step
+ *             found in the data.
+ *
+ * \return The average, or NULL on failure.
+ */
+MscriptScanAverage_t * mscript_scan_average_create(unsigned int variable_type, double step)
+{
+	MscriptScanAverage_t * average = calloc(1, sizeof(MscriptScanAverage_t));
+	if (average == NULL) {
+		return NULL;
+	}
+	average->variable_type = variable_type;
+	average->step = fabs(step);
+	average->is_step_fixed = step != 0.0;
+	return average;
+}
+
+/**
+ * Free an average.
+ */
+void mscript_scan_average_destroy(MscriptScanAverage_t * average)
+{
+	mscript_scan_average_reset(average);
+	free(average);
+}
+
+/**
+ * Discard all scans.
+ */
+void mscript_scan_average_reset(MscriptScanAverage_t * average)
+{
+	for (size_t i = 0; i < 2; ++i) {
+		free(average->branches[i].storage);
+		memset(&average->branches[i], 0, sizeof(Branch_t));
+	}
+	if (!average->is_step_fixed) {
+		average->step = 0.0;
+	}
+	average->has_origin = false;
+	average->nr_of_scans = 0;
+	average->is_scan_open = false;
+	average->has_pending = false;
+}
+
+/**
+ * Find the bin of a potential, growing the branch if needed.
+ *
+ * \return The bin, or NULL if the potential is too far from the other bins
+ *         or on failure to allocate memory.
+ */
+static Bin_t * get_bin(MscriptScanAverage_t * average, int direction, double potential)
+{
+	if (!average->has_origin) {
+		average->origin = potential;
+		average->has_origin = true;
+	}
+	double position = (average->step > 0.0) ? (potential - average->origin) / average->step : 0.0;
+	if (!(fabs(position) < MAX_BINS)) {
+		return NULL;
+	}
+	long number = lround(position);
+	Branch_t * branch = &average->branches[(direction < 0) ? 1 : 0];
+	if ((branch->count > 0) && (number >= branch->first)
+		&& (number < branch->first + (long)branch->count)) {
+		return &branch->bins[number - branch->first];
+	}
+
+	// Extend the branch to include the new bin.
+	bool is_growing_down = (branch->count == 0) ? (direction < 0) : (number < branch->first);
+	long first = (branch->count == 0) ? number : (number < branch->first) ? number : branch->first;
+	long end = (branch->count == 0) ? number + 1 : (number >= branch->first + (long)branch->count)
+		? number + 1 : branch->first + (long)branch->count;
+	if (end - first > MAX_BINS) {
+		return NULL;
+	}
+	size_t count = (size_t)(end - first);
+	// The bin number of the first element of the storage.
+	long base = branch->first - (long)branch->offset;
+	if ((branch->count == 0) || (first < base) || (end > base + (long)branch->capacity)) {
+		// Double the storage, with the free space at the end where the
+		// branch grows, and move the bins to their new position.
+		size_t capacity = (branch->capacity < INITIAL_BIN_CAPACITY / 2)
+			? INITIAL_BIN_CAPACITY : 2 * branch->capacity;
+		if (capacity < count) {
+			capacity = count;
+		}
+		Bin_t * storage = realloc(branch->storage, capacity * sizeof(Bin_t));
+		if (storage == NULL) {
+			return NULL;
+		}
+		size_t offset = is_growing_down ? capacity - count : 0;
+		size_t old_offset = offset + (size_t)(branch->first - first);
+		if (branch->count == 0) {
+			old_offset = offset;
+		}
+		memmove(&storage[old_offset], &storage[branch->offset], branch->count * sizeof(Bin_t));
+		memset(storage, 0, old_offset * sizeof(Bin_t));
+		memset(&storage[old_offset + branch->count], 0,
+			(capacity - old_offset - branch->count) * sizeof(Bin_t));
+		branch->storage = storage;
+		branch->capacity = capacity;
+		base = first - (long)offset;
+	}
+	branch->offset = (size_t)(first - base);
+	branch->bins = &branch->storage[branch->offset];
+	branch->first = first;
+	branch->count = count;
+	return &branch->bins[number - first];
+}
+
+/**
+ * Add a value to the bin of a potential, if the current scan has not added a
+ * value to it yet.
+ */
+static void add_to_bin(MscriptScanAverage_t * average, int direction, double potential,
+	double value)
+{
+	Bin_t * bin = get_bin(average, direction, potential);
+	unsigned int scan = average->nr_of_scans + 1;
+	if ((bin == NULL) || (bin->last_scan == scan) || isnan(value)) {
+		return;
+	}
+	bin->last_scan = scan;
+	++bin->count;
+	double delta = value - bin->mean;
+	bin->mean += delta / bin->count;
+	bin->m2 += delta * (value - bin->mean);
+}
+
+/**
+ * Add a point of the current scan.
+ *
+ * The direction of the first point of a scan is only known when the
+ * potential changes, so it is added together with the next point. Points
+ * that are too far from the other points are ignored.
+ *
+ * \param average The average.
+ * \param potential The applied potential (V).
+ * \param value The value to average.
+ *
+ * \return `true` (the function does not fail; points that can not be stored
+ *         are ignored)
+ */
+bool mscript_scan_average_add(MscriptScanAverage_t * average, double potential, double value)
+{
+	if (!average->is_scan_open) {
+		average->is_scan_open = true;
+		average->has_pending = true;
+		average->pending_potential = potential;
+		average->pending_value = value;
+		average->last_potential = potential;
+		average->direction = 0;
+		return true;
+	}
+
+	double delta = potential - average->last_potential;
+	if (delta != 0.0) {
+		average->direction = (delta > 0.0) ? 1 : -1;
+		if (average->step == 0.0) {
+			average->step = fabs(delta);
+		}
+	}
+	average->last_potential = potential;
+	if (average->has_pending) {
+		if (average->direction == 0) {
+			// Same potential as the first point: only the first value is used.
+			return true;
+		}
+		average->has_pending = false;
+		add_to_bin(average, average->direction, average->pending_potential,
+			average->pending_value);
+	}
+	add_to_bin(average, average->direction, potential, value);
+	return true;
+}
+
+/**
+ * Add a data package of the current scan. Packages without a potential
+ * (`MSCRIPT_VARTYPE_CELL_SET_POTENTIAL` or `MSCRIPT_VARTYPE_POTENTIAL`) or
+ * without the averaged variable are ignored.
+ *
+ * \return `true` (see `mscript_scan_average_add()`)
+ */
+bool mscript_scan_average_add_package(MscriptScanAverage_t * average,
+	MscriptDataPackage_t const * package)
+{
+	double potential, value;
+	if (!mscript_find_value(package, average->variable_type, &value)
+		|| (!mscript_find_value(package, MSCRIPT_VARTYPE_CELL_SET_POTENTIAL, &potential)
+			&& !mscript_find_value(package, MSCRIPT_VARTYPE_POTENTIAL, &potential))) {
+		return true;
+	}
+	return mscript_scan_average_add(average, potential, value);
+}
+
+/**
+ * End the current scan. After this, the averaged curve includes the scan.
+ *
+ * \return `true` if the scan had any points, `false` if it was empty
+ */
+bool mscript_scan_average_end_scan(MscriptScanAverage_t * average)
+{
+	if (!average->is_scan_open) {
+		return false;
+	}
+	if (average->has_pending) {
+		// The potential never changed.
+		add_to_bin(average, 1, average->pending_potential, average->pending_value);
+		average->has_pending = false;
+	}
+	average->is_scan_open = false;
+	++average->nr_of_scans;
+	return true;
+}
+
+/**
+ * Get the number of completed scans.
+ */
+unsigned int mscript_scan_average_get_nr_of_scans(MscriptScanAverage_t const * average)
+{
+	return average->nr_of_scans;
+}
+
+/**
+ * Get the number of points of the averaged curve, i.e. the number of bins that
+ * have at least one value.
+ */
+size_t mscript_scan_average_get_nr_of_points(MscriptScanAverage_t const * average)
+{
+	size_t nr_of_points = 0;
+	for (size_t i = 0; i < 2; ++i) {
+		Branch_t const * branch = &average->branches[i];
+		for (size_t j = 0; j < branch->count; ++j) {
+			nr_of_points += (branch->bins[j].count > 0) ? 1 : 0;
+		}
+	}
+	return nr_of_points;
+}
+
+/**
+ * Convert a bin to a point of the averaged curve.
+ */
+static void get_point(MscriptScanAverage_t const * average, Branch_t const * branch, size_t j,
+	int direction, MscriptAveragePoint_t * point)
+{
+	Bin_t const * bin = &branch->bins[j];
+	point->potential = average->origin + (double)(branch->first + (long)j) * average->step;
+	point->direction = direction;
+	point->nr_of_scans = bin->count;
+	point->mean = bin->mean;
+	point->std_error = (bin->count > 1)
+		? sqrt(bin->m2 / (bin->count - 1) / bin->count) : NAN;
+}
+
+/**
+ * Get the averaged curve.
+ *
+ * The points of increasing potential are returned first (from low to high
+ * potential), followed by the points of decreasing potential (from high to
+ * low), so a cyclic voltammogram is a closed curve. Points of the current
+ * scan are included.
+ *
+ * \param average The average.
+ * \param[out] points The points.
+ * \param max_points The size of `points`.
+ *
+ * \return The number of points stored in `points`.
+ */
+size_t mscript_scan_average_get_curve(MscriptScanAverage_t const * average,
+	MscriptAveragePoint_t * points, size_t max_points)
+{
+	size_t nr_of_points = 0;
+	Branch_t const * up = &average->branches[0];
+	for (size_t j = 0; (j < up->count) && (nr_of_points < max_points); ++j) {
+		if (up->bins[j].count > 0) {
+			get_point(average, up, j, 1, &points[nr_of_points++]);
+		}
+	}
+	Branch_t const * down = &average->branches[1];
+	for (size_t j = down->count; (j > 0) && (nr_of_points < max_points); --j) {
+		if (down->bins[j - 1].count > 0) {
+			get_point(average, down, j - 1, -1, &points[nr_of_points++]);
+		}
+	}
+	return nr_of_points;
+}
@@ -0,0 +1,94 @@
+/**
+ * \file
+ * Averaging of repeated scans.
+ *
+ * To measure a small signal, a voltammetric scan (e.g. SWV, DPV or CV) is
+ * often repeated many times and the scans are averaged. This module keeps
+ * the running mean and standard error of each point of the scan while the
+ * data is received, so the scans do not have to be stored: the memory used
+ * depends on the number of points of one scan, not on the number of scans.
+ *
+ * The points of the scans are aligned by their applied potential. The
+ * potential range is divided in bins of one potential step (by default the
+ * first step found in the data), starting at the first potential. Since a
+ * cyclic voltammetry scan passes each potential twice, the points measured
+ * while the potential increases and decreases are kept in separate bins.
+ * Each scan adds at most one value to each bin; the mean and variance of
+ * each bin are updated using Welford's method.
+ *
+ * The averaged curve can be read after every scan, see
+ * `mscript_scan_average_get_curve()`.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript.h"
+
+/** A point of an averaged scan. */
+typedef struct {
+	/** The applied potential of the bin (V). */
+	double potential;
+	/** 1 if the potential increases, -1 if it decreases. */
+	int direction;
+	/** Number of scans that have a value in this bin. */
+	unsigned int nr_of_scans;
+	/** The mean of the values. */
+	double mean;
+	/** The standard error of the mean, or NaN if there is only one value. */
+	double std_error;
+} MscriptAveragePoint_t;
+
+/** Running average of repeated scans. */
+typedef struct MscriptScanAverage MscriptScanAverage_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptScanAverage_t * mscript_scan_average_create(unsigned int variable_type, double step);
+void mscript_scan_average_destroy(MscriptScanAverage_t * average);
+void mscript_scan_average_reset(MscriptScanAverage_t * average);
+bool mscript_scan_average_add(MscriptScanAverage_t * average, double potential, double value);
+bool mscript_scan_average_add_package(MscriptScanAverage_t * average,
+	MscriptDataPackage_t const * package);
+bool mscript_scan_average_end_scan(MscriptScanAverage_t * average);
+unsigned int mscript_scan_average_get_nr_of_scans(MscriptScanAverage_t const * average);
+size_t mscript_scan_average_get_nr_of_points(MscriptScanAverage_t const * average);
+size_t mscript_scan_average_get_curve(MscriptScanAverage_t const * average,
+	MscriptAveragePoint_t * points, size_t max_points);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
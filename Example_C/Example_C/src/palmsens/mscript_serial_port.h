@@ -90,6 +90,17 @@ bool mscript_serial_port_write(SerialPortHandle_t handle, char const * buf);
  */
 int mscript_serial_port_read(SerialPortHandle_t handle, char * p_character);
 
+/**
+ * Check if the serial port is still connected, e.g. that the USB cable of the
+ * device was not unplugged. Nothing is sent to the device, so this can be
+ * used while a script is running.
+ *
+ * \param handle a valid handle to the serial port connection
+ *
+ * \return `true` if the port is connected, `false` otherwise
+ */
+bool mscript_serial_port_is_connected(SerialPortHandle_t handle);
+
 /**
  * Close the serial port.
  *
@@ -38,6 +38,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
 #include <termios.h>
@@ -169,6 +170,22 @@ bool mscript_serial_port_write(SerialPortHandle_t handle, char const * buf)
 	return success;
 }
 
+bool mscript_serial_port_is_connected(SerialPortHandle_t handle)
+{
+	assert(handle >= 0);
+
+	// A removed USB serial device fails the terminal requests (EIO) or hangs up.
+	struct termios tty;
+	if (tcgetattr(handle, &tty) != 0) {
+		return false;
+	}
+	struct pollfd pfd = { .fd = handle, .events = POLLIN, .revents = 0 };
+	if (poll(&pfd, 1, 0) < 0) {
+		return false;
+	}
+	return (pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) == 0;
+}
+
 int mscript_serial_port_read(SerialPortHandle_t handle, char * p_character)
 {
 	assert(handle >= 0);
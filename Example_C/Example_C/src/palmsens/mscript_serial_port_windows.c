@@ -146,6 +146,16 @@ bool mscript_serial_port_write(SerialPortHandle_t handle, char const * buf)
 	return success;
 }
 
+bool mscript_serial_port_is_connected(SerialPortHandle_t handle)
+{
+	assert(handle != INVALID_HANDLE_VALUE);
+
+	// This fails once the (USB) device of the port has been removed.
+	DWORD errors;
+	COMSTAT status;
+	return ClearCommError(handle, &errors, &status) != 0;
+}
+
 int mscript_serial_port_read(SerialPortHandle_t handle, char * p_character)
 {
 	assert(handle != INVALID_HANDLE_VALUE);
@@ -0,0 +1,194 @@
+/**
+ * \file
+ * Supervised acquisition session with automatic reconnect.
+ *
+ * See `mscript_session.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_session.h"
+
+#include <assert.h>
+#include <string.h>
+#include "mscript_debug_printf.h"
+
+/// Buffer size for the firmware version and serial number.
+#define ID_BUF_SIZE 80
+
+/**
+ * Initialize a session.
+ *
+ * The acquisition is initialized as by `mscript_acquisition_init()`; its
+ * settings (e.g. the prediction) can be changed after calling this function.
+ *
+ * \param session The session to initialize.
+ * \param port The serial port of the device (used to reconnect).
+ * \param baudrate The baud rate of the device.
+ * \param handle Handle to the serial port, on which the script was started.
+ * \param sink The sink that receives the events.
+ * \param restart Function that restarts the script after reconnecting.
+ * \param context Context passed to `restart`.
+ */
+void mscript_session_init(MscriptSession_t * session, char const * port, int baudrate,
+	SerialPortHandle_t handle, MscriptSink_t sink, MscriptRestartFunction_t restart,
+	void * context)
+{
+	assert(port != NULL);
+	assert(restart != NULL);
+
+	memset(session, 0, sizeof(MscriptSession_t));
+	session->port = port;
+	session->baudrate = baudrate;
+	session->initial_backoff_ms = MSCRIPT_SESSION_DEFAULT_INITIAL_BACKOFF;
+	session->max_backoff_ms = MSCRIPT_SESSION_DEFAULT_MAX_BACKOFF;
+	session->max_downtime_ms = MSCRIPT_SESSION_DEFAULT_MAX_DOWNTIME;
+	session->restart = restart;
+	session->context = context;
+	mscript_acquisition_init(&session->acquisition, handle, sink);
+	session->acquisition.wait_while_connected = true;
+}
+
+/**
+ * Bring a reconnected device in a known state and check its identity.
+ *
+ * \return `true` if the device is ready and is the expected device
+ */
+static bool reidentify(MscriptSession_t const * session, SerialPortHandle_t handle)
+{
+	if (!mscript_abort_and_sync(handle, MSCRIPT_SESSION_SYNC_DEADLINE, NULL)) {
+		return false;
+	}
+	char buf[ID_BUF_SIZE];
+	if (!mscript_get_firmware_version(handle, buf, sizeof(buf))) {
+		return false;
+	}
+	if (session->serial_number != NULL) {
+		if (!mscript_get_serial_number(handle, buf, sizeof(buf))) {
+			return false;
+		}
+		if (strcmp(buf, session->serial_number)) {
+			DEBUG_PRINTF("ERROR: Found device %s on %s instead of %s.\n", buf, session->port,
+				session->serial_number);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Reopen the serial port and re-identify the device.
+ *
+ * \param session The session.
+ * \param t_lost Time at which the connection was lost.
+ *
+ * \return Handle to the serial port, or `BAD_HANDLE` if the connection could
+ *         not be restored within `max_downtime_ms`.
+ */
+static SerialPortHandle_t reconnect(MscriptSession_t * session, uint32_t t_lost)
+{
+	uint32_t backoff = session->initial_backoff_ms;
+	for (;;) {
+		uint32_t downtime = mscript_get_time_ms() - t_lost;
+		if ((session->max_downtime_ms != 0) && (downtime >= session->max_downtime_ms)) {
+			DEBUG_PRINTF("ERROR: Could not reconnect to %s within %lu ms.\n", session->port,
+				(unsigned long)session->max_downtime_ms);
+			return BAD_HANDLE;
+		}
+		mscript_sleep_ms(backoff);
+		backoff = (backoff < session->max_backoff_ms / 2) ? 2 * backoff : session->max_backoff_ms;
+
+		SerialPortHandle_t handle = mscript_serial_port_open(session->port, session->baudrate);
+		if (handle != BAD_HANDLE) {
+			if (reidentify(session, handle)) {
+				return handle;
+			}
+			mscript_serial_port_close(handle);
+		}
+		++session->stats.nr_of_failed_attempts;
+	}
+}
+
+/**
+ * Run the acquisition, reconnecting and restarting the script when the
+ * connection is lost.
+ *
+ * The statistics of the acquisition cover the complete session, including
+ * the time without connection.
+ *
+ * \return `true` if the script finished successfully, `false` otherwise
+ */
+bool mscript_session_run(MscriptSession_t * session)
+{
+	MscriptAcquisition_t * acquisition = &session->acquisition;
+	uint32_t t_start = mscript_get_time_ms();
+	bool success;
+	for (;;) {
+		unsigned int nr_of_communication_errors = acquisition->stats.nr_of_communication_errors;
+		success = mscript_acquisition_run(acquisition);
+		if (success
+			|| (acquisition->stats.nr_of_communication_errors == nr_of_communication_errors)) {
+			// Finished, or stopped by a script error or the sink.
+			break;
+		}
+
+		uint32_t t_lost = mscript_get_time_ms();
+		DEBUG_PRINTF("Connection to %s lost, reconnecting...\n", session->port);
+		mscript_serial_port_close(acquisition->handle);
+		acquisition->handle = reconnect(session, t_lost);
+		if ((acquisition->handle == BAD_HANDLE)
+			|| !session->restart(session->context, acquisition->handle)) {
+			break;
+		}
+
+		uint32_t downtime = mscript_get_time_ms() - t_lost;
+		++session->stats.nr_of_reconnects;
+		session->stats.total_downtime_ms += downtime;
+		if (downtime > session->stats.longest_downtime_ms) {
+			session->stats.longest_downtime_ms = downtime;
+		}
+
+		// Let the sink know that data is missing.
+		MscriptEvent_t event;
+		memset(&event, 0, sizeof(event));
+		event.type = MSCRIPT_EVENT_GAP;
+		event.response = "";
+		event.receive_time_us = mscript_get_time_us();
+		event.meas_loop_index = acquisition->stats.nr_of_meas_loops;
+		event.gap_ms = downtime;
+		if (!acquisition->sink.handle_event(acquisition->sink.context, &event)) {
+			break;
+		}
+	}
+	acquisition->stats.start_time_ms = t_start;
+	acquisition->stats.duration_ms = mscript_get_time_ms() - t_start;
+	return success;
+}
@@ -0,0 +1,140 @@
+/**
+ * \file
+ * Supervised acquisition session with automatic reconnect.
+ *
+ * Long-running scripts (e.g. monitoring for days) should not be lost because
+ * of a short interruption of the connection, such as a USB glitch. A session
+ * runs an acquisition (see `mscript_acquisition.h`) and, when the connection
+ * is lost, it:
+ *   1. closes the serial port;
+ *   2. tries to reopen the port, waiting longer after each failed attempt
+ *      (exponential backoff), until `max_downtime_ms` has passed;
+ *   3. aborts a possibly running script and re-identifies the device (see
+ *      `mscript_abort_and_sync()`), checking the serial number if known;
+ *   4. restarts the script using the `restart` function;
+ *   5. passes an `MSCRIPT_EVENT_GAP` event, with the duration of the
+ *      interruption, to the sink and continues the acquisition.
+ *
+ * The sink receives all data of the session as one continuous acquisition:
+ * the statistics accumulate and the measurement loops keep counting, so
+ * results can be appended to the same output. Data sent by the device while
+ * the connection was lost is not recovered, which is why the gap is marked.
+ *
+ * The connection is lost when reading from or writing to the port fails. A
+ * read timeout alone is not enough, since a script can be silent for a long
+ * time (e.g. while it waits for a trigger with `await_int`): after a timeout,
+ * the session checks whether the port is still connected (see
+ * `mscript_serial_port_is_connected()`) and keeps waiting if it is. This is
+ * done by setting `wait_while_connected` of the acquisition.
+ *
+ * Script errors, or a sink that returns `false`, end the session as usual.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mscript.h"
+#include "mscript_acquisition.h"
+#include "mscript_serial_port.h"
+
+/// Default time to wait (in ms) before the first reconnect attempt.
+#define MSCRIPT_SESSION_DEFAULT_INITIAL_BACKOFF 100
+
+/// Default maximum time to wait (in ms) between two reconnect attempts.
+#define MSCRIPT_SESSION_DEFAULT_MAX_BACKOFF 5000
+
+/// Default maximum duration (in ms) of an interruption before giving up.
+#define MSCRIPT_SESSION_DEFAULT_MAX_DOWNTIME (10 * 60 * 1000)
+
+/// Maximum time (in ms) for the device to become ready after reconnecting.
+#define MSCRIPT_SESSION_SYNC_DEADLINE 2000
+
+/**
+ * Function that restarts the script after reconnecting.
+ *
+ * \param context The context of the session.
+ * \param handle Handle to the serial port of the device.
+ *
+ * \return `true` on success, `false` on failure
+ */
+typedef bool (*MscriptRestartFunction_t)(void * context, SerialPortHandle_t handle);
+
+/** Statistics of the reconnects of a session. */
+typedef struct {
+	/** Number of times the connection was restored. */
+	unsigned int nr_of_reconnects;
+	/** Number of attempts to reconnect that failed. */
+	unsigned int nr_of_failed_attempts;
+	/** Total time without connection in ms. */
+	uint32_t total_downtime_ms;
+	/** Longest time without connection in ms. */
+	uint32_t longest_downtime_ms;
+} MscriptSessionStats_t;
+
+/** State of a session. */
+typedef struct {
+	/** The serial port and baud rate of the device. */
+	char const * port;
+	int baudrate;
+	/** Serial number of the device, to check it is the same after reconnecting, or NULL. */
+	char const * serial_number;
+	/** Time to wait (in ms) before the first reconnect attempt. Doubles after each attempt. */
+	uint32_t initial_backoff_ms;
+	/** Maximum time to wait (in ms) between two reconnect attempts. */
+	uint32_t max_backoff_ms;
+	/** Maximum duration (in ms) of an interruption, 0 to never give up. */
+	uint32_t max_downtime_ms;
+	/** Function that restarts the script after reconnecting. */
+	MscriptRestartFunction_t restart;
+	void * context;
+	/**
+	 * The acquisition. Its `handle` is replaced after a reconnect, and is
+	 * `BAD_HANDLE` if the connection could not be restored.
+	 */
+	MscriptAcquisition_t acquisition;
+	MscriptSessionStats_t stats;
+} MscriptSession_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mscript_session_init(MscriptSession_t * session, char const * port, int baudrate,
+	SerialPortHandle_t handle, MscriptSink_t sink, MscriptRestartFunction_t restart,
+	void * context);
+bool mscript_session_run(MscriptSession_t * session);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,134 @@
+/**
+ * \file
+ * Ring buffer in shared memory, to publish live data to other processes.
+ *
+ * Only one process can own the serial port of a device, but several local
+ * processes may need the live data, e.g. a plotting program, a quality check
+ * and an archiver. The acquisition process creates a named ring of data
+ * packages in POSIX shared memory (`mscript_shm_ring_create()`) and publishes
+ * each parsed package in it. Any number of readers can open the ring by its
+ * name (`mscript_shm_reader_open()`) at any time and read the packages
+ * directly from the shared memory.
+ *
+ * Each package gets a sequence number. The writer never waits for readers:
+ * when the ring is full, the oldest package is overwritten. Each slot of the
+ * ring holds the sequence number of its package, which the writer changes
+ * before and after writing it. A reader copies a package out of its slot and
+ * then checks that the sequence number has not changed, so a reader that
+ * falls behind detects that its packages were overwritten (an overrun) and
+ * skips to the oldest package that is still available. Readers do not write
+ * to the shared memory at all, so they can not slow down or block the
+ * acquisition, regardless of their number.
+ *
+ * A package in the ring has a fixed size and layout (`MscriptShmPackage_t`),
+ * so the readers must be built with the same version of this header. The
+ * ring records the layout, and readers with a different layout are refused.
+ *
+ * Publishing is thread-safe, so all devices of a process can publish to the
+ * same ring. A reader must only be used by one thread.
+ *
+ * This is only available on Linux (POSIX); on Windows, creating or opening a
+ * ring fails.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript.h"
+#include "mscript_acquisition.h"
+
+/// Default number of packages in a ring.
+#define MSCRIPT_SHM_RING_DEFAULT_SIZE 65536
+
+/// Value of `channel` for packages without a channel.
+#define MSCRIPT_SHM_NO_CHANNEL (-1)
+
+/// Value of the status and range of a value if the metadata was not present.
+#define MSCRIPT_SHM_NO_METADATA 0xFF
+
+/** One value of a published package. */
+typedef struct {
+	double value;
+	uint16_t variable_type;
+	/** Status metadata, or `MSCRIPT_SHM_NO_METADATA`. */
+	uint8_t status;
+	/** Current range metadata, or `MSCRIPT_SHM_NO_METADATA`. */
+	uint8_t range;
+} MscriptShmValue_t;
+
+/** A published data package. */
+typedef struct {
+	/** Sequence number (0 for the first package published in the ring). */
+	uint64_t sequence;
+	/** Time at which the package was received (see `mscript_get_time_us()`). */
+	uint64_t receive_time_us;
+	/** Number of the device that measured the package. */
+	uint32_t device;
+	/** Channel of a multi-channel instrument or multiplexer, or `MSCRIPT_SHM_NO_CHANNEL`. */
+	int32_t channel;
+	/** Number of the measurement loop (1 for the first). */
+	uint32_t meas_loop_index;
+	/** Number of the package in the measurement loop (1 for the first). */
+	uint32_t package_index;
+	/** Number of entries in `values`. */
+	uint32_t nr_of_values;
+	MscriptShmValue_t values[MSCRIPT_MAX_SUB_PACKAGES_PER_LINE];
+} MscriptShmPackage_t;
+
+/** The writing side of a ring. */
+typedef struct MscriptShmRing MscriptShmRing_t;
+
+/** A reader of a ring. */
+typedef struct MscriptShmReader MscriptShmReader_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptShmRing_t * mscript_shm_ring_create(char const * name, size_t nr_of_packages);
+void mscript_shm_ring_destroy(MscriptShmRing_t * ring);
+bool mscript_shm_ring_publish(MscriptShmRing_t * ring, unsigned int device, int channel,
+	MscriptEvent_t const * event);
+uint64_t mscript_shm_ring_get_nr_of_packages(MscriptShmRing_t * ring);
+
+MscriptShmReader_t * mscript_shm_reader_open(char const * name);
+void mscript_shm_reader_close(MscriptShmReader_t * reader);
+bool mscript_shm_reader_read(MscriptShmReader_t * reader, MscriptShmPackage_t * package,
+	uint64_t * p_nr_lost);
+bool mscript_shm_reader_is_closed(MscriptShmReader_t const * reader);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,422 @@
+/**
+ * \file
+ * Shared memory ring buffer implementation for Linux (POSIX).
+ *
+ * See `mscript_shm_ring.h` for a description of this module.
+ *
+ * The shared memory starts with a header, followed by the slots. The slot of
+ * package `n` is `n % nr_of_slots`. Its `state` is `2 * n + 1` while the
+ * package is written and `2 * n + 2` when it is complete (a seqlock per
+ * slot), and `write_sequence` in the header is the number of packages that
+ * have been completed. The writer only uses atomic stores with release
+ * semantics, and a reader only loads, so the readers need no write access.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_shm_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mscript_debug_printf.h"
+#include "mscript_thread.h"
+
+/// Identifies a ring of this module ("MSRB").
+#define RING_MAGIC 0x4D535242u
+
+/// Incremented when the layout of the shared memory changes.
+#define RING_VERSION 1
+
+/// Maximum number of slots of a ring.
+#define MAX_NR_OF_SLOTS (1u << 24)
+
+/// Maximum length of the name of a ring, including the terminating '\0'.
+#define MAX_NAME_SIZE 256
+
+/** Start of the shared memory. */
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	/** Size of `MscriptShmPackage_t`, to refuse readers with a different layout. */
+	uint32_t package_size;
+	/** Number of slots, a power of 2. */
+	uint32_t nr_of_slots;
+	/** Number of packages that have been published. */
+	_Atomic uint64_t write_sequence;
+	/** Set when the writer destroys the ring. */
+	_Atomic uint32_t is_closed;
+} RingHeader_t;
+
+/** One slot of the ring. */
+typedef struct {
+	/** `2 * sequence + 1` while the package is written, `2 * sequence + 2` after. */
+	_Atomic uint64_t state;
+	MscriptShmPackage_t package;
+} RingSlot_t;
+
+/** The mapped shared memory. */
+typedef struct {
+	RingHeader_t * header;
+	RingSlot_t * slots;
+	size_t size;
+} RingMapping_t;
+
+struct MscriptShmRing {
+	char name[MAX_NAME_SIZE];
+	RingMapping_t mapping;
+	/** Serializes the publishing threads of this process. */
+	MscriptMutex_t mutex;
+};
+
+struct MscriptShmReader {
+	RingMapping_t mapping;
+	/** Number of slots, as validated when the ring was opened. */
+	uint64_t nr_of_slots;
+	/** Sequence number of the next package to read. */
+	uint64_t next_sequence;
+};
+
+// The atomics are shared between processes, so they must not use a lock. The
+// readers map the memory read-only, which also requires that loading a 64-bit
+// atomic does not write (true on x86-64 and 64-bit ARM).
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64-bit atomics must be lock-free");
+
+/**
+ * Get the size of the shared memory of a ring.
+ */
+static size_t get_ring_size(uint32_t nr_of_slots)
+{
+	return sizeof(RingHeader_t) + (size_t)nr_of_slots * sizeof(RingSlot_t);
+}
+
+/**
+ * Map the shared memory of a ring.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool map_ring(int fd, size_t size, int protection, RingMapping_t * mapping)
+{
+	void * memory = mmap(NULL, size, protection, MAP_SHARED, fd, 0);
+	if (memory == MAP_FAILED) {
+		DEBUG_PRINTF("ERROR: Could not map shared memory: %s\n", strerror(errno));
+		return false;
+	}
+	mapping->header = memory;
+	mapping->slots = (RingSlot_t *)((char *)memory + sizeof(RingHeader_t));
+	mapping->size = size;
+	return true;
+}
+
+/**
+ * Create a ring in shared memory.
+ *
+ * An existing ring with the same name is replaced; readers of that ring see
+ * that it is closed (see `mscript_shm_reader_is_closed()`).
+ *
+ * \param name The name of the shared memory object, starting with a '/'
+ *             (e.g. "/mscript"). It appears in /dev/shm.
+ * \param nr_of_packages The number of packages the ring can hold, rounded up
+ *             to a power of 2, or 0 for `MSCRIPT_SHM_RING_DEFAULT_SIZE`.
+ *
+ * \return The ring, or NULL on failure.
+ */
+MscriptShmRing_t * mscript_shm_ring_create(char const * name, size_t nr_of_packages)
+{
+	if (nr_of_packages == 0) {
+		nr_of_packages = MSCRIPT_SHM_RING_DEFAULT_SIZE;
+	}
+	if ((name[0] != '/') || (strlen(name) >= MAX_NAME_SIZE)
+		|| (nr_of_packages > MAX_NR_OF_SLOTS)) {
+		DEBUG_PRINTF("ERROR: Invalid name or size of shared memory ring.\n");
+		return NULL;
+	}
+	uint32_t nr_of_slots = 2;
+	while (nr_of_slots < nr_of_packages) {
+		nr_of_slots *= 2;
+	}
+
+	MscriptShmRing_t * ring = calloc(1, sizeof(MscriptShmRing_t));
+	if (ring == NULL) {
+		return NULL;
+	}
+	strcpy(ring->name, name);
+
+	// Mark an existing ring as closed, then create a new one, so readers of
+	// the old ring do not wait forever.
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd >= 0) {
+		struct stat st;
+		RingMapping_t old;
+		if ((fstat(fd, &st) == 0) && ((size_t)st.st_size >= sizeof(RingHeader_t))
+			&& map_ring(fd, sizeof(RingHeader_t), PROT_READ | PROT_WRITE, &old)) {
+			if (old.header->magic == RING_MAGIC) {
+				atomic_store_explicit(&old.header->is_closed, 1, memory_order_release);
+			}
+			munmap(old.header, old.size);
+		}
+		close(fd);
+		shm_unlink(name);
+	}
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) {
+		DEBUG_PRINTF("ERROR: Could not create shared memory %s: %s\n", name, strerror(errno));
+		free(ring);
+		return NULL;
+	}
+	size_t size = get_ring_size(nr_of_slots);
+	bool success = (ftruncate(fd, (off_t)size) == 0)
+		&& map_ring(fd, size, PROT_READ | PROT_WRITE, &ring->mapping);
+	close(fd);
+	if (!success) {
+		shm_unlink(name);
+		free(ring);
+		return NULL;
+	}
+
+	// The memory is zero-filled, so all slots are empty (state 0). The magic
+	// number is set last, so readers that open the ring early refuse it.
+	RingHeader_t * header = ring->mapping.header;
+	header->version = RING_VERSION;
+	header->package_size = sizeof(MscriptShmPackage_t);
+	header->nr_of_slots = nr_of_slots;
+	atomic_thread_fence(memory_order_release);
+	header->magic = RING_MAGIC;
+	mscript_mutex_init(&ring->mutex);
+	return ring;
+}
+
+/**
+ * Close and remove a ring.
+ *
+ * Readers that have the ring open can still read the remaining packages, and
+ * then see that it is closed.
+ */
+void mscript_shm_ring_destroy(MscriptShmRing_t * ring)
+{
+	atomic_store_explicit(&ring->mapping.header->is_closed, 1, memory_order_release);
+	munmap(ring->mapping.header, ring->mapping.size);
+	shm_unlink(ring->name);
+	mscript_mutex_destroy(&ring->mutex);
+	free(ring);
+}
+
+/**
+ * Publish a data package in a ring.
+ *
+ * This never waits for readers; if the ring is full, the oldest package is
+ * overwritten.
+ *
+ * \param ring The ring.
+ * \param device The number of the device.
+ * \param channel The channel of a multi-channel instrument or multiplexer,
+ *                or `MSCRIPT_SHM_NO_CHANNEL`.
+ * \param event A `MSCRIPT_EVENT_PACKAGE` event with a parsed package.
+ *
+ * \return `true` on success, `false` if the event has no parsed package.
+ */
+bool mscript_shm_ring_publish(MscriptShmRing_t * ring, unsigned int device, int channel,
+	MscriptEvent_t const * event)
+{
+	MscriptDataPackage_t const * package = event->package;
+	if ((event->type != MSCRIPT_EVENT_PACKAGE) || (package == NULL)) {
+		return false;
+	}
+	mscript_mutex_lock(&ring->mutex);
+	RingHeader_t * header = ring->mapping.header;
+	uint64_t sequence = atomic_load_explicit(&header->write_sequence, memory_order_relaxed);
+	RingSlot_t * slot = &ring->mapping.slots[sequence & (header->nr_of_slots - 1)];
+	atomic_store_explicit(&slot->state, 2 * sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	MscriptShmPackage_t * shm_package = &slot->package;
+	shm_package->sequence = sequence;
+	shm_package->receive_time_us = event->receive_time_us;
+	shm_package->device = device;
+	shm_package->channel = channel;
+	shm_package->meas_loop_index = event->meas_loop_index;
+	shm_package->package_index = event->package_index;
+	shm_package->nr_of_values = (uint32_t)package->nr_of_sub_packages;
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		MscriptSubPackage_t const * sub_package = &package->sub_packages[i];
+		MscriptShmValue_t * value = &shm_package->values[i];
+		value->value = sub_package->value;
+		value->variable_type = (uint16_t)sub_package->variable_type;
+		value->status = (sub_package->metadata.status >= 0)
+			? (uint8_t)sub_package->metadata.status : MSCRIPT_SHM_NO_METADATA;
+		value->range = (sub_package->metadata.range >= 0)
+			? (uint8_t)sub_package->metadata.range : MSCRIPT_SHM_NO_METADATA;
+	}
+
+	atomic_store_explicit(&slot->state, 2 * sequence + 2, memory_order_release);
+	atomic_store_explicit(&header->write_sequence, sequence + 1, memory_order_release);
+	mscript_mutex_unlock(&ring->mutex);
+	return true;
+}
+
+/**
+ * Get the number of packages that have been published in a ring.
+ */
+uint64_t mscript_shm_ring_get_nr_of_packages(MscriptShmRing_t * ring)
+{
+	return atomic_load_explicit(&ring->mapping.header->write_sequence, memory_order_relaxed);
+}
+
+/**
+ * Open a ring to read the packages that are published from now on.
+ *
+ * The shared memory is mapped read-only.
+ *
+ * \param name The name that was passed to `mscript_shm_ring_create()`.
+ *
+ * \return The reader, or NULL if the ring does not exist or has a different
+ *         layout.
+ */
+MscriptShmReader_t * mscript_shm_reader_open(char const * name)
+{
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0) {
+		DEBUG_PRINTF("ERROR: Could not open shared memory %s: %s\n", name, strerror(errno));
+		return NULL;
+	}
+	MscriptShmReader_t * reader = calloc(1, sizeof(MscriptShmReader_t));
+	struct stat st;
+	RingMapping_t mapping;
+	bool success = (reader != NULL) && (fstat(fd, &st) == 0)
+		&& ((size_t)st.st_size >= sizeof(RingHeader_t))
+		&& map_ring(fd, (size_t)st.st_size, PROT_READ, &mapping);
+	close(fd);
+	if (!success) {
+		free(reader);
+		return NULL;
+	}
+
+	// The number of slots is used as a mask for the slot index, so it must be
+	// a power of two, and all slots must be within the mapped memory.
+	RingHeader_t const * header = mapping.header;
+	uint32_t nr_of_slots = header->nr_of_slots;
+	if ((header->magic != RING_MAGIC) || (header->version != RING_VERSION)
+		|| (header->package_size != sizeof(MscriptShmPackage_t))
+		|| (nr_of_slots == 0) || ((nr_of_slots & (nr_of_slots - 1)) != 0)
+		|| (nr_of_slots > MAX_NR_OF_SLOTS)
+		|| (mapping.size < get_ring_size(nr_of_slots))) {
+		DEBUG_PRINTF("ERROR: Shared memory %s is not a compatible ring.\n", name);
+		munmap(mapping.header, mapping.size);
+		free(reader);
+		return NULL;
+	}
+	atomic_thread_fence(memory_order_acquire);
+	reader->mapping = mapping;
+	reader->nr_of_slots = nr_of_slots;
+	reader->next_sequence = atomic_load_explicit(&mapping.header->write_sequence,
+		memory_order_acquire);
+	return reader;
+}
+
+/**
+ * Close a reader.
+ */
+void mscript_shm_reader_close(MscriptShmReader_t * reader)
+{
+	munmap(reader->mapping.header, reader->mapping.size);
+	free(reader);
+}
+
+/**
+ * Read the next package from a ring, if one is available.
+ *
+ * This does not wait: if no new package has been published, it returns
+ * `false` immediately, and the caller can poll again later. If the writer
+ * has overwritten packages that were not read yet, these are skipped and
+ * their number is returned in `p_nr_lost`.
+ *
+ * \param reader The reader.
+ * \param[out] package The package.
+ * \param[out] p_nr_lost The number of packages lost just before this one
+ *             because of an overrun (0 normally). May be NULL.
+ *
+ * \return `true` if a package was read, `false` if there is no new package.
+ */
+bool mscript_shm_reader_read(MscriptShmReader_t * reader, MscriptShmPackage_t * package,
+	uint64_t * p_nr_lost)
+{
+	RingHeader_t * header = reader->mapping.header;
+	uint64_t nr_of_slots = reader->nr_of_slots;
+	uint64_t nr_lost = 0;
+	for (;;) {
+		uint64_t end = atomic_load_explicit(&header->write_sequence, memory_order_acquire);
+		if (reader->next_sequence >= end) {
+			break;
+		}
+		if (end - reader->next_sequence > nr_of_slots) {
+			// Overrun: skip to the oldest package that is still in the ring.
+			nr_lost += end - nr_of_slots - reader->next_sequence;
+			reader->next_sequence = end - nr_of_slots;
+		}
+
+		RingSlot_t * slot = &reader->mapping.slots[reader->next_sequence & (nr_of_slots - 1)];
+		uint64_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+		if (state == 2 * reader->next_sequence + 2) {
+			memcpy(package, &slot->package, sizeof(MscriptShmPackage_t));
+			atomic_thread_fence(memory_order_acquire);
+			if (atomic_load_explicit(&slot->state, memory_order_relaxed) == state) {
+				++reader->next_sequence;
+				if (p_nr_lost != NULL) {
+					*p_nr_lost = nr_lost;
+				}
+				return true;
+			}
+		}
+		// The slot was overwritten while it was read; skip this package.
+		++nr_lost;
+		++reader->next_sequence;
+	}
+	if (p_nr_lost != NULL) {
+		*p_nr_lost = nr_lost;
+	}
+	return false;
+}
+
+/**
+ * Check whether the writer has closed the ring.
+ *
+ * Once it is closed, no more packages will be published; the writer may have
+ * created a new ring with the same name, which can be opened again.
+ */
+bool mscript_shm_reader_is_closed(MscriptShmReader_t const * reader)
+{
+	return atomic_load_explicit(&reader->mapping.header->is_closed, memory_order_acquire) != 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * \file
+ * Shared memory ring buffer for Windows (not supported).
+ *
+ * See `mscript_shm_ring.h` for a description of this module. The ring uses
+ * POSIX shared memory, so on Windows a ring can not be created or opened.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_shm_ring.h"
+
+#include "mscript_debug_printf.h"
+
+MscriptShmRing_t * mscript_shm_ring_create(char const * name, size_t nr_of_packages)
+{
+	(void)name;
+	(void)nr_of_packages;
+	DEBUG_PRINTF("ERROR: Shared memory rings are not supported on Windows.\n");
+	return NULL;
+}
+
+void mscript_shm_ring_destroy(MscriptShmRing_t * ring)
+{
+	(void)ring;
+}
+
+bool mscript_shm_ring_publish(MscriptShmRing_t * ring, unsigned int device, int channel,
+	MscriptEvent_t const * event)
+{
+	(void)ring;
+	(void)device;
+	(void)channel;
+	(void)event;
+	return false;
+}
+
+uint64_t mscript_shm_ring_get_nr_of_packages(MscriptShmRing_t * ring)
+{
+	(void)ring;
+	return 0;
+}
+
+MscriptShmReader_t * mscript_shm_reader_open(char const * name)
+{
+	(void)name;
+	DEBUG_PRINTF("ERROR: Shared memory rings are not supported on Windows.\n");
+	return NULL;
+}
+
+void mscript_shm_reader_close(MscriptShmReader_t * reader)
+{
+	(void)reader;
+}
+
+bool mscript_shm_reader_read(MscriptShmReader_t * reader, MscriptShmPackage_t * package,
+	uint64_t * p_nr_lost)
+{
+	(void)reader;
+	(void)package;
+	(void)p_nr_lost;
+	return false;
+}
+
+bool mscript_shm_reader_is_closed(MscriptShmReader_t const * reader)
+{
+	(void)reader;
+	return true;
+}
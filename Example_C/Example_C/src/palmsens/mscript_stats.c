@@ -0,0 +1,234 @@
+/**
+ * \file
+ * Online statistics of the columns of a measurement loop.
+ *
+ * See `mscript_stats.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_stats.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * Reset the statistics of a variable.
+ *
+ * A statistics structure that is set to zero is also in the reset state.
+ */
+void mscript_stats_reset(MscriptStats_t * stats)
+{
+	memset(stats, 0, sizeof(MscriptStats_t));
+}
+
+/**
+ * Add a value to the statistics.
+ *
+ * \param stats The statistics.
+ * \param x The x value for the slope (e.g. the time).
+ * \param value The value. NaN values are ignored.
+ * \param status The status metadata of the value, or a negative value if the
+ *               value has no status metadata.
+ */
+void mscript_stats_add(MscriptStats_t * stats, double x, double value, int status)
+{
+	if (isnan(value)) {
+		return;
+	}
+	size_t n = ++stats->nr_of_values;
+	if (n == 1) {
+		stats->min = stats->max = value;
+	} else if (value < stats->min) {
+		stats->min = value;
+	} else if (value > stats->max) {
+		stats->max = value;
+	}
+
+	// Welford's update of the means, the sums of squares and the co-moment.
+	double dx = x - stats->mean_x;
+	double dy = value - stats->mean;
+	stats->mean_x += dx / n;
+	stats->mean += dy / n;
+	stats->m2 += dy * (value - stats->mean);
+	stats->m2_x += dx * (x - stats->mean_x);
+	stats->c_xy += dx * (value - stats->mean);
+
+	if (status >= 0) {
+		++stats->nr_of_status_values;
+		for (unsigned int i = 0; i < MSCRIPT_STATS_NR_OF_STATUS_FLAGS; ++i) {
+			if (status & (1 << i)) {
+				++stats->status_counts[i];
+			}
+		}
+	}
+}
+
+/**
+ * Get the (sample) variance of the values.
+ *
+ * \return The variance, or NaN if there are less than two values.
+ */
+double mscript_stats_variance(MscriptStats_t const * stats)
+{
+	if (stats->nr_of_values < 2) {
+		return NAN;
+	}
+	return stats->m2 / (stats->nr_of_values - 1);
+}
+
+/**
+ * Get the (sample) standard deviation of the values.
+ *
+ * \return The standard deviation, or NaN if there are less than two values.
+ */
+double mscript_stats_std_dev(MscriptStats_t const * stats)
+{
+	return sqrt(mscript_stats_variance(stats));
+}
+
+/**
+ * Get the slope of the least squares line through the values.
+ *
+ * \return The slope (per unit of x), or NaN if all x values are equal.
+ */
+double mscript_stats_slope(MscriptStats_t const * stats)
+{
+	if (!(stats->m2_x > 0.0)) {
+		return NAN;
+	}
+	return stats->c_xy / stats->m2_x;
+}
+
+/**
+ * Get the intercept (at x = 0) of the least squares line through the values.
+ *
+ * \return The intercept, or NaN if all x values are equal.
+ */
+double mscript_stats_intercept(MscriptStats_t const * stats)
+{
+	return stats->mean - mscript_stats_slope(stats) * stats->mean_x;
+}
+
+/**
+ * Reset the statistics of a measurement loop.
+ */
+void mscript_loop_stats_reset(MscriptLoopStats_t * loop_stats)
+{
+	memset(loop_stats, 0, sizeof(MscriptLoopStats_t));
+}
+
+/**
+ * Find the statistics of a column, or add the column if it does not exist yet.
+ *
+ * \return The statistics, or NULL if there are too many columns.
+ */
+static MscriptStats_t * get_stats(MscriptLoopStats_t * loop_stats, unsigned int variable_type,
+	unsigned int occurrence)
+{
+	for (size_t i = 0; i < loop_stats->nr_of_columns; ++i) {
+		MscriptColumnStats_t * column = &loop_stats->columns[i];
+		if ((column->variable_type == variable_type) && (column->occurrence == occurrence)) {
+			return &column->stats;
+		}
+	}
+	if (loop_stats->nr_of_columns == MSCRIPT_STATS_MAX_COLUMNS) {
+		return NULL;
+	}
+	MscriptColumnStats_t * column = &loop_stats->columns[loop_stats->nr_of_columns++];
+	column->variable_type = variable_type;
+	column->occurrence = occurrence;
+	mscript_stats_reset(&column->stats);
+	return &column->stats;
+}
+
+/**
+ * Add the values of a data package to the statistics of a measurement loop.
+ *
+ * The x value of all variables in the package is the time, if the package
+ * contains a time variable. Since the packages of a measurement loop have the
+ * same variables, this is determined by the first package.
+ */
+void mscript_loop_stats_add_package(MscriptLoopStats_t * loop_stats,
+	MscriptDataPackage_t const * package)
+{
+	if (loop_stats->nr_of_packages == 0) {
+		loop_stats->has_time = false;
+		for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+			if (package->sub_packages[i].variable_type == MSCRIPT_VARTYPE_TIME) {
+				loop_stats->has_time = true;
+			}
+		}
+	}
+	double x = (double)loop_stats->nr_of_packages;
+	if (loop_stats->has_time) {
+		if (!mscript_find_value(package, MSCRIPT_VARTYPE_TIME, &x)) {
+			x = NAN;
+		}
+	}
+
+	for (size_t i = 0; i < package->nr_of_sub_packages; ++i) {
+		MscriptSubPackage_t const * sub_package = &package->sub_packages[i];
+		if (sub_package->variable_type == MSCRIPT_VARTYPE_CHANNEL) {
+			continue;
+		}
+		unsigned int occurrence = 0;
+		for (size_t j = 0; j < i; ++j) {
+			if (package->sub_packages[j].variable_type == sub_package->variable_type) {
+				++occurrence;
+			}
+		}
+		MscriptStats_t * stats = get_stats(loop_stats, sub_package->variable_type, occurrence);
+		// A package without a time value is skipped, so all statistics of a
+		// column are based on the same values.
+		if ((stats != NULL) && !isnan(x)) {
+			mscript_stats_add(stats, x, sub_package->value, sub_package->metadata.status);
+		}
+	}
+	++loop_stats->nr_of_packages;
+}
+
+/**
+ * Find the statistics of a column.
+ *
+ * \return The statistics, or NULL if the column does not exist.
+ */
+MscriptStats_t const * mscript_loop_stats_find(MscriptLoopStats_t const * loop_stats,
+	unsigned int variable_type, unsigned int occurrence)
+{
+	for (size_t i = 0; i < loop_stats->nr_of_columns; ++i) {
+		MscriptColumnStats_t const * column = &loop_stats->columns[i];
+		if ((column->variable_type == variable_type) && (column->occurrence == occurrence)) {
+			return &column->stats;
+		}
+	}
+	return NULL;
+}
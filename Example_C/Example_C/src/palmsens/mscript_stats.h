@@ -0,0 +1,129 @@
+/**
+ * \file
+ * Online statistics of the columns of a measurement loop.
+ *
+ * For long measurements (e.g. chronoamperometry or open circuit potential
+ * monitoring) it is often sufficient to know the mean, spread, extremes and
+ * drift of each variable, and how often the device reported a status flag
+ * (e.g. an overload). This module keeps these statistics up to date with each
+ * data package, without storing the data itself. Each value is processed in
+ * constant time and the state has a fixed size (no allocations), so the
+ * statistics can be read at any time during the measurement.
+ *
+ * The mean and variance are calculated using Welford's algorithm, which does
+ * not lose precision when the mean is large compared to the spread (e.g. a
+ * potential of 1 V with noise of a few µV). The slope is calculated in the
+ * same way, from the running co-moment of the value and its x value. The x
+ * value is the time (`MSCRIPT_VARTYPE_TIME`) if the package contains it, and
+ * otherwise the index of the package in the measurement loop (starting at 0).
+ *
+ * As in `mscript_columns.h`, a column is identified by its variable type and
+ * its occurrence in the package. NaN values are not included in the
+ * statistics. The channel variable (`MSCRIPT_VARTYPE_CHANNEL`) is not a
+ * measured value and is ignored.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript.h"
+
+/// Maximum number of columns. Additional variables are ignored.
+#define MSCRIPT_STATS_MAX_COLUMNS 16
+
+/// Number of status flags that are counted (see `MSCRIPT_STATUS_TIMING_ERROR` etc.).
+#define MSCRIPT_STATS_NR_OF_STATUS_FLAGS 4
+
+/** Statistics of one variable. */
+typedef struct {
+	/** Number of values (NaN values are not counted). */
+	size_t nr_of_values;
+	double mean;
+	double min;
+	double max;
+	/** Sum of the squared deviations from the mean (internal). */
+	double m2;
+	/** Mean of the x values (internal). */
+	double mean_x;
+	/** Sum of the squared deviations of the x values from their mean (internal). */
+	double m2_x;
+	/** Sum of the products of the deviations of x and the value (internal). */
+	double c_xy;
+	/** Number of values with status metadata. */
+	size_t nr_of_status_values;
+	/**
+	 * Number of values with each status flag. The index is the bit number of
+	 * the flag, e.g. `status_counts[1]` counts `MSCRIPT_STATUS_OVERLOAD`.
+	 */
+	size_t status_counts[MSCRIPT_STATS_NR_OF_STATUS_FLAGS];
+} MscriptStats_t;
+
+/** Statistics of one column. */
+typedef struct {
+	/** The variable type of the column. */
+	unsigned int variable_type;
+	/** Occurrence of the variable type in the package (0 for the first). */
+	unsigned int occurrence;
+	MscriptStats_t stats;
+} MscriptColumnStats_t;
+
+/** Statistics of all columns of a measurement loop. */
+typedef struct {
+	/** Number of data packages. */
+	size_t nr_of_packages;
+	/** `true` if the x values of the slopes are times, `false` if they are package indices. */
+	bool has_time;
+	size_t nr_of_columns;
+	MscriptColumnStats_t columns[MSCRIPT_STATS_MAX_COLUMNS];
+} MscriptLoopStats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mscript_stats_reset(MscriptStats_t * stats);
+void mscript_stats_add(MscriptStats_t * stats, double x, double value, int status);
+double mscript_stats_variance(MscriptStats_t const * stats);
+double mscript_stats_std_dev(MscriptStats_t const * stats);
+double mscript_stats_slope(MscriptStats_t const * stats);
+double mscript_stats_intercept(MscriptStats_t const * stats);
+void mscript_loop_stats_reset(MscriptLoopStats_t * loop_stats);
+void mscript_loop_stats_add_package(MscriptLoopStats_t * loop_stats,
+	MscriptDataPackage_t const * package);
+MscriptStats_t const * mscript_loop_stats_find(MscriptLoopStats_t const * loop_stats,
+	unsigned int variable_type, unsigned int occurrence);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,88 @@
+/**
+ * \file
+ * Threads and synchronization.
+ *
+ * This module provides a minimal, platform independent interface to create
+ * threads and to synchronize them using mutexes and condition variables. It is
+ * used by the modules that process data from several devices or channels
+ * concurrently. Like the serial port, it has a common interface with separate
+ * implementations for Linux (POSIX threads) and Windows.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32)	// Windows (32-bit or 64-bit)
+	#include <windows.h>
+	typedef HANDLE MscriptThread_t;
+	typedef CRITICAL_SECTION MscriptMutex_t;
+	typedef CONDITION_VARIABLE MscriptCondition_t;
+#elif defined (__linux__) // Linux
+	#include <pthread.h>
+	typedef pthread_t MscriptThread_t;
+	typedef pthread_mutex_t MscriptMutex_t;
+	typedef pthread_cond_t MscriptCondition_t;
+#else // Other (unsupported) operating system.
+	#error "Unsupported platform."
+#endif
+
+/** Function executed by a thread. */
+typedef void (*MscriptThreadFunction_t)(void * arg);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool mscript_thread_create(MscriptThread_t * p_thread, MscriptThreadFunction_t function,
+	void * arg);
+void mscript_thread_join(MscriptThread_t thread);
+unsigned int mscript_get_nr_of_processors(void);
+
+void mscript_mutex_init(MscriptMutex_t * mutex);
+void mscript_mutex_destroy(MscriptMutex_t * mutex);
+void mscript_mutex_lock(MscriptMutex_t * mutex);
+void mscript_mutex_unlock(MscriptMutex_t * mutex);
+
+void mscript_condition_init(MscriptCondition_t * condition);
+void mscript_condition_destroy(MscriptCondition_t * condition);
+void mscript_condition_wait(MscriptCondition_t * condition, MscriptMutex_t * mutex);
+bool mscript_condition_wait_timeout(MscriptCondition_t * condition, MscriptMutex_t * mutex,
+	uint32_t timeout_ms);
+void mscript_condition_signal(MscriptCondition_t * condition);
+void mscript_condition_broadcast(MscriptCondition_t * condition);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,189 @@
+/**
+ * \file
+ * Threads and synchronization implementation for Linux (POSIX threads).
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_thread.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mscript_debug_printf.h"
+
+/** Function and argument of a new thread, passed to `thread_main()`. */
+typedef struct {
+	MscriptThreadFunction_t function;
+	void * arg;
+} ThreadStart_t;
+
+static void * thread_main(void * p)
+{
+	ThreadStart_t start = *(ThreadStart_t *)p;
+	free(p);
+	start.function(start.arg);
+	return NULL;
+}
+
+/**
+ * Create a thread that executes `function(arg)`.
+ *
+ * \param p_thread[out] The created thread, to be passed to `mscript_thread_join()`.
+ * \param function The function to execute.
+ * \param arg Argument passed to the function.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_thread_create(MscriptThread_t * p_thread, MscriptThreadFunction_t function,
+	void * arg)
+{
+	assert(p_thread != NULL);
+	assert(function != NULL);
+
+	ThreadStart_t * start = malloc(sizeof(ThreadStart_t));
+	if (start == NULL) {
+		return false;
+	}
+	start->function = function;
+	start->arg = arg;
+	int result = pthread_create(p_thread, NULL, thread_main, start);
+	if (result != 0) {
+		DEBUG_PRINTF("ERROR: Failed to create thread: %s\n", strerror(result));
+		free(start);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Wait until a thread has finished.
+ */
+void mscript_thread_join(MscriptThread_t thread)
+{
+	pthread_join(thread, NULL);
+}
+
+/**
+ * Get the number of processors (cores) that are available.
+ *
+ * \return The number of processors, at least 1.
+ */
+unsigned int mscript_get_nr_of_processors(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? (unsigned int)n : 1;
+}
+
+void mscript_mutex_init(MscriptMutex_t * mutex)
+{
+	pthread_mutex_init(mutex, NULL);
+}
+
+void mscript_mutex_destroy(MscriptMutex_t * mutex)
+{
+	pthread_mutex_destroy(mutex);
+}
+
+void mscript_mutex_lock(MscriptMutex_t * mutex)
+{
+	pthread_mutex_lock(mutex);
+}
+
+void mscript_mutex_unlock(MscriptMutex_t * mutex)
+{
+	pthread_mutex_unlock(mutex);
+}
+
+void mscript_condition_init(MscriptCondition_t * condition)
+{
+	// Use the monotonic clock for timeouts, so they are not affected by
+	// changes of the system time.
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(condition, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+void mscript_condition_destroy(MscriptCondition_t * condition)
+{
+	pthread_cond_destroy(condition);
+}
+
+/**
+ * Wait until the condition is signaled.
+ *
+ * The mutex must be locked by the caller. It is unlocked while waiting and
+ * locked again before this function returns. As with all condition variables,
+ * the caller should check its condition again after waking up.
+ */
+void mscript_condition_wait(MscriptCondition_t * condition, MscriptMutex_t * mutex)
+{
+	pthread_cond_wait(condition, mutex);
+}
+
+/**
+ * Wait until the condition is signaled or the timeout expires.
+ *
+ * See `mscript_condition_wait()`.
+ *
+ * \return `false` if the timeout expired, `true` otherwise
+ */
+bool mscript_condition_wait_timeout(MscriptCondition_t * condition, MscriptMutex_t * mutex,
+	uint32_t timeout_ms)
+{
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+		// Without a start time there is no deadline; report a timeout.
+		return false;
+	}
+	ts.tv_sec += timeout_ms / 1000;
+	ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec += 1;
+		ts.tv_nsec -= 1000000000L;
+	}
+	return pthread_cond_timedwait(condition, mutex, &ts) != ETIMEDOUT;
+}
+
+void mscript_condition_signal(MscriptCondition_t * condition)
+{
+	pthread_cond_signal(condition);
+}
+
+void mscript_condition_broadcast(MscriptCondition_t * condition)
+{
+	pthread_cond_broadcast(condition);
+}
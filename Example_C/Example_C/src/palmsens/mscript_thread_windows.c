@@ -0,0 +1,175 @@
+/**
+ * \file
+ * Threads and synchronization implementation for Windows.
+ *
+ * Condition variables require Windows Vista or later.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_thread.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <windows.h>
+#include "mscript_debug_printf.h"
+
+/** Function and argument of a new thread, passed to `thread_main()`. */
+typedef struct {
+	MscriptThreadFunction_t function;
+	void * arg;
+} ThreadStart_t;
+
+static DWORD WINAPI thread_main(LPVOID p)
+{
+	ThreadStart_t start = *(ThreadStart_t *)p;
+	free(p);
+	start.function(start.arg);
+	return 0;
+}
+
+/**
+ * Create a thread that executes `function(arg)`.
+ *
+ * \param p_thread[out] The created thread, to be passed to `mscript_thread_join()`.
+ * \param function The function to execute.
+ * \param arg Argument passed to the function.
+ *
+ * \return `true` on success, `false` on failure
+ */
+bool mscript_thread_create(MscriptThread_t * p_thread, MscriptThreadFunction_t function,
+	void * arg)
+{
+	assert(p_thread != NULL);
+	assert(function != NULL);
+
+	ThreadStart_t * start = malloc(sizeof(ThreadStart_t));
+	if (start == NULL) {
+		return false;
+	}
+	start->function = function;
+	start->arg = arg;
+	*p_thread = CreateThread(NULL, 0, thread_main, start, 0, NULL);
+	if (*p_thread == NULL) {
+		DEBUG_PRINTF("ERROR: Failed to create thread (error %lu).\n", GetLastError());
+		free(start);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Wait until a thread has finished.
+ */
+void mscript_thread_join(MscriptThread_t thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+/**
+ * Get the number of processors (cores) that are available.
+ *
+ * \return The number of processors, at least 1.
+ */
+unsigned int mscript_get_nr_of_processors(void)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0) ? (unsigned int)info.dwNumberOfProcessors : 1;
+}
+
+void mscript_mutex_init(MscriptMutex_t * mutex)
+{
+	InitializeCriticalSection(mutex);
+}
+
+void mscript_mutex_destroy(MscriptMutex_t * mutex)
+{
+	DeleteCriticalSection(mutex);
+}
+
+void mscript_mutex_lock(MscriptMutex_t * mutex)
+{
+	EnterCriticalSection(mutex);
+}
+
+void mscript_mutex_unlock(MscriptMutex_t * mutex)
+{
+	LeaveCriticalSection(mutex);
+}
+
+void mscript_condition_init(MscriptCondition_t * condition)
+{
+	InitializeConditionVariable(condition);
+}
+
+void mscript_condition_destroy(MscriptCondition_t * condition)
+{
+	// Condition variables do not need to be deleted on Windows.
+	(void)condition;
+}
+
+/**
+ * Wait until the condition is signaled.
+ *
+ * The mutex must be locked by the caller. It is unlocked while waiting and
+ * locked again before this function returns. As with all condition variables,
+ * the caller should check its condition again after waking up.
+ */
+void mscript_condition_wait(MscriptCondition_t * condition, MscriptMutex_t * mutex)
+{
+	SleepConditionVariableCS(condition, mutex, INFINITE);
+}
+
+/**
+ * Wait until the condition is signaled or the timeout expires.
+ *
+ * See `mscript_condition_wait()`.
+ *
+ * \return `false` if the timeout expired, `true` otherwise
+ */
+bool mscript_condition_wait_timeout(MscriptCondition_t * condition, MscriptMutex_t * mutex,
+	uint32_t timeout_ms)
+{
+	return SleepConditionVariableCS(condition, mutex, timeout_ms)
+		|| (GetLastError() != ERROR_TIMEOUT);
+}
+
+void mscript_condition_signal(MscriptCondition_t * condition)
+{
+	WakeConditionVariable(condition);
+}
+
+void mscript_condition_broadcast(MscriptCondition_t * condition)
+{
+	WakeAllConditionVariable(condition);
+}
@@ -0,0 +1,446 @@
+/**
+ * \file
+ * Host-side triggers that react to the measured data.
+ *
+ * See `mscript_trigger.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_trigger.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_columns.h"
+#include "mscript_debug_printf.h"
+#include "mscript_serial_port.h"
+
+/** State of a trigger. */
+typedef struct {
+	MscriptTriggerConfig_t config;
+	/** The last values and their x values (circular buffer). */
+	double values[MSCRIPT_TRIGGER_MAX_WINDOW];
+	double x[MSCRIPT_TRIGGER_MAX_WINDOW];
+	unsigned int nr_of_values;
+	unsigned int next;
+	/** Number of consecutive packages that met the condition. */
+	unsigned int run;
+	/** `true` if the trigger has fired and the condition is still met. */
+	bool is_fired;
+} Trigger_t;
+
+struct MscriptTriggerEngine {
+	MscriptAcquisition_t * acquisition;
+	/** The original sink of the acquisition, which receives all events. */
+	MscriptSink_t sink;
+	MscriptTriggerCallback_t callback;
+	void * context;
+	Trigger_t triggers[MSCRIPT_TRIGGER_MAX_TRIGGERS];
+	size_t nr_of_triggers;
+	/** `true` if the current script has been aborted. */
+	bool is_aborted;
+	MscriptTriggerStats_t stats;
+};
+
+/**
+ * Parse the SI prefix after a number (e.g. "u" in "1u").
+ *
+ * \return The multiplier, or 1 if there is no prefix.
+ */
+static double parse_si_prefix(char const ** p_text)
+{
+	static char const prefixes[] = "afpnumkMG";
+	static double const multipliers[] = { 1e-18, 1e-15, 1e-12, 1e-9, 1e-6, 1e-3, 1e3, 1e6, 1e9 };
+	char const * p = ((**p_text) != '\0') ? strchr(prefixes, **p_text) : NULL;
+	if (p == NULL) {
+		return 1.0;
+	}
+	++*p_text;
+	return multipliers[p - prefixes];
+}
+
+/**
+ * Parse an unsigned integer.
+ *
+ * \return `true` on success, `false` if there is no number
+ */
+static bool parse_unsigned(char const ** p_text, unsigned int * p_value)
+{
+	char * end;
+	unsigned long value = strtoul(*p_text, &end, 10);
+	if ((end == *p_text) || !isdigit((unsigned char)**p_text)) {
+		return false;
+	}
+	*p_text = end;
+	*p_value = (unsigned int)value;
+	return true;
+}
+
+/**
+ * Parse the description of a trigger.
+ *
+ * The format is `QUANTITY(VARTYPE[@CHANNEL][,WINDOW])<THRESHOLD` or `>`,
+ * where QUANTITY is "mean" or "slope", or `VARTYPE[@CHANNEL]<THRESHOLD` for
+ * the value itself. The threshold may have an SI prefix. For example:
+ *   - "ba>1u": the current is above 1 µA;
+ *   - "mean(ba@3,5)<-2n": the mean of the last 5 currents of channel 3 is
+ *     below -2 nA;
+ *   - "slope(ab,10)>0.01": the potential increases by more than 10 mV per
+ *     second (or per package).
+ *
+ * The other fields of the configuration are set to their defaults: one
+ * package must meet the condition, and the action is
+ * `MSCRIPT_TRIGGER_ACTION_NONE`.
+ *
+ * \param text The description.
+ * \param[out] config The configuration.
+ *
+ * \return `true` on success, `false` if the description is invalid
+ */
+bool mscript_trigger_parse(char const * text, MscriptTriggerConfig_t * config)
+{
+	memset(config, 0, sizeof(MscriptTriggerConfig_t));
+	config->channel = MSCRIPT_TRIGGER_ALL_CHANNELS;
+	config->quantity = MSCRIPT_TRIGGER_VALUE;
+	config->window = 1;
+	config->min_count = 1;
+	config->action = MSCRIPT_TRIGGER_ACTION_NONE;
+
+	char const * p = text;
+	bool has_parenthesis = false;
+	if (!strncmp(p, "mean(", 5)) {
+		config->quantity = MSCRIPT_TRIGGER_MEAN;
+		p += 5;
+		has_parenthesis = true;
+	} else if (!strncmp(p, "slope(", 6)) {
+		config->quantity = MSCRIPT_TRIGGER_SLOPE;
+		p += 6;
+		has_parenthesis = true;
+	}
+
+	if (!islower((unsigned char)p[0]) || !islower((unsigned char)p[1])) {
+		return false;
+	}
+	config->variable_type = MSCRIPT_VARTYPE(p[0], p[1]);
+	p += 2;
+	if (*p == '@') {
+		unsigned int channel;
+		++p;
+		if (!parse_unsigned(&p, &channel) || (channel > 255)) {
+			return false;
+		}
+		config->channel = (int)channel;
+	}
+	if (has_parenthesis) {
+		if (*p == ',') {
+			++p;
+			if (!parse_unsigned(&p, &config->window)) {
+				return false;
+			}
+		} else {
+			config->window = 5;
+		}
+		if ((*p++ != ')') || (config->window < 2)
+			|| (config->window > MSCRIPT_TRIGGER_MAX_WINDOW)) {
+			return false;
+		}
+	}
+
+	if (*p == '>') {
+		config->comparison = MSCRIPT_TRIGGER_ABOVE;
+	} else if (*p == '<') {
+		config->comparison = MSCRIPT_TRIGGER_BELOW;
+	} else {
+		return false;
+	}
+	++p;
+	char * end;
+	config->threshold = strtod(p, &end);
+	if (end == p) {
+		return false;
+	}
+	p = end;
+	config->threshold *= parse_si_prefix(&p);
+	return *p == '\0';
+}
+
+/**
+ * Clear the window and state of a trigger.
+ */
+static void reset_trigger(Trigger_t * trigger)
+{
+	trigger->nr_of_values = 0;
+	trigger->next = 0;
+	trigger->run = 0;
+	trigger->is_fired = false;
+}
+
+/**
+ * Add a value to the window of a trigger and calculate its quantity.
+ *
+ * \return The quantity, or NaN if the window is not full yet.
+ */
+static double update_quantity(Trigger_t * trigger, double x, double value)
+{
+	unsigned int window = trigger->config.window;
+	if (trigger->config.quantity == MSCRIPT_TRIGGER_VALUE) {
+		return value;
+	}
+	trigger->values[trigger->next] = value;
+	trigger->x[trigger->next] = x;
+	trigger->next = (trigger->next + 1) % window;
+	if (trigger->nr_of_values < window) {
+		++trigger->nr_of_values;
+	}
+	if (trigger->nr_of_values < window) {
+		return NAN;
+	}
+
+	// The window is small, so the sums are calculated again for each value,
+	// which avoids accumulating rounding errors.
+	double mean_x = 0.0;
+	double mean = 0.0;
+	for (unsigned int i = 0; i < window; ++i) {
+		mean_x += trigger->x[i];
+		mean += trigger->values[i];
+	}
+	mean_x /= window;
+	mean /= window;
+	if (trigger->config.quantity == MSCRIPT_TRIGGER_MEAN) {
+		return mean;
+	}
+	double sxx = 0.0;
+	double sxy = 0.0;
+	for (unsigned int i = 0; i < window; ++i) {
+		double dx = trigger->x[i] - mean_x;
+		sxx += dx * dx;
+		sxy += dx * (trigger->values[i] - mean);
+	}
+	return (sxx > 0.0) ? sxy / sxx : NAN;
+}
+
+/**
+ * Perform the action of a trigger.
+ *
+ * \return `true` if the action has been performed.
+ */
+static bool perform_action(MscriptTriggerEngine_t * engine, Trigger_t const * trigger)
+{
+	MscriptTriggerConfig_t const * config = &trigger->config;
+	if ((config->action == MSCRIPT_TRIGGER_ACTION_NONE) || engine->is_aborted) {
+		// There is nothing (more) to do.
+		return false;
+	}
+	if (!mscript_serial_port_write(engine->acquisition->handle, "Z\n")) {
+		DEBUG_PRINTF("ERROR: Could not send abort command.\n");
+		return false;
+	}
+	engine->is_aborted = true;
+	++engine->stats.nr_of_aborts;
+	if ((config->action == MSCRIPT_TRIGGER_ACTION_SCRIPT) && (config->script != NULL)) {
+		engine->acquisition->next_script = config->script;
+	}
+	return true;
+}
+
+/**
+ * Evaluate the triggers on a data package.
+ */
+static void evaluate(MscriptTriggerEngine_t * engine, MscriptEvent_t const * event,
+	MscriptDataPackage_t const * package)
+{
+	unsigned int channel;
+	bool has_channel = mscript_get_package_channel(package, &channel);
+	double time;
+	double x = mscript_find_value(package, MSCRIPT_VARTYPE_TIME, &time)
+		? time : event->package_index;
+
+	for (size_t i = 0; i < engine->nr_of_triggers; ++i) {
+		Trigger_t * trigger = &engine->triggers[i];
+		MscriptTriggerConfig_t const * config = &trigger->config;
+		double value;
+		if (((config->channel != MSCRIPT_TRIGGER_ALL_CHANNELS)
+				&& (!has_channel || ((int)channel != config->channel)))
+			|| !mscript_find_value(package, config->variable_type, &value)) {
+			continue;
+		}
+		double quantity = update_quantity(trigger, x, value);
+		bool is_met = (config->comparison == MSCRIPT_TRIGGER_ABOVE)
+			? (quantity > config->threshold) : (quantity < config->threshold);
+		if (!is_met) {
+			trigger->run = 0;
+			trigger->is_fired = false;
+			continue;
+		}
+		if ((++trigger->run < config->min_count) || trigger->is_fired) {
+			continue;
+		}
+
+		trigger->is_fired = true;
+		++engine->stats.nr_of_fires;
+		MscriptTriggerEvent_t trigger_event;
+		trigger_event.trigger_index = i;
+		trigger_event.config = config;
+		trigger_event.meas_loop_index = event->meas_loop_index;
+		trigger_event.package_index = event->package_index;
+		trigger_event.value = quantity;
+		trigger_event.is_action_done = perform_action(engine, trigger);
+		trigger_event.latency_us = mscript_get_time_us() - event->receive_time_us;
+		if (engine->callback != NULL) {
+			engine->callback(engine->context, &trigger_event);
+		}
+	}
+}
+
+/**
+ * Evaluate the triggers and pass the event to the original sink.
+ *
+ * This function is an `MscriptEventHandler_t`.
+ */
+static bool handle_event(void * context, MscriptEvent_t const * event)
+{
+	MscriptTriggerEngine_t * engine = context;
+	switch (event->type) {
+	case MSCRIPT_EVENT_SCRIPT_START:
+		engine->is_aborted = false;
+		// fall through
+	case MSCRIPT_EVENT_MEAS_LOOP_START:
+		for (size_t i = 0; i < engine->nr_of_triggers; ++i) {
+			reset_trigger(&engine->triggers[i]);
+		}
+		break;
+
+	case MSCRIPT_EVENT_PACKAGE: {
+		// The packages are parsed here if the acquisition does not parse them
+		// (e.g. when the channels are processed by other threads).
+		MscriptDataPackage_t package;
+		MscriptDataPackage_t const * p_package = event->package;
+		if ((p_package == NULL) && parse_data_package(event->response, &package)) {
+			p_package = &package;
+		}
+		if (p_package != NULL) {
+			evaluate(engine, event, p_package);
+			uint64_t latency = mscript_get_time_us() - event->receive_time_us;
+			++engine->stats.nr_of_packages;
+			engine->stats.total_latency_us += latency;
+			if (latency > engine->stats.max_latency_us) {
+				engine->stats.max_latency_us = latency;
+			}
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+	return engine->sink.handle_event(engine->sink.context, event);
+}
+
+/**
+ * Create a trigger engine and insert it between an acquisition and its sink.
+ *
+ * The sink of the acquisition must be set before calling this function. The
+ * original sink is restored by `mscript_trigger_engine_destroy()`.
+ *
+ * \param acquisition The acquisition.
+ * \param callback The function to call when a trigger fires, or NULL.
+ * \param context The context of the callback.
+ *
+ * \return The trigger engine, or NULL on failure.
+ */
+MscriptTriggerEngine_t * mscript_trigger_engine_create(MscriptAcquisition_t * acquisition,
+	MscriptTriggerCallback_t callback, void * context)
+{
+	MscriptTriggerEngine_t * engine = calloc(1, sizeof(MscriptTriggerEngine_t));
+	if (engine == NULL) {
+		return NULL;
+	}
+	engine->acquisition = acquisition;
+	engine->sink = acquisition->sink;
+	engine->callback = callback;
+	engine->context = context;
+	acquisition->sink.handle_event = handle_event;
+	acquisition->sink.context = engine;
+	return engine;
+}
+
+/**
+ * Remove a trigger engine from its acquisition and free it.
+ */
+void mscript_trigger_engine_destroy(MscriptTriggerEngine_t * engine)
+{
+	engine->acquisition->sink = engine->sink;
+	free(engine);
+}
+
+/**
+ * Add a trigger.
+ *
+ * \param engine The trigger engine.
+ * \param config The configuration of the trigger, which is copied. The
+ *               follow-up script, if any, must remain valid.
+ *
+ * \return `true` on success, `false` if there are too many triggers or the
+ *         configuration is invalid
+ */
+bool mscript_trigger_engine_add(MscriptTriggerEngine_t * engine,
+	MscriptTriggerConfig_t const * config)
+{
+	if (engine->nr_of_triggers == MSCRIPT_TRIGGER_MAX_TRIGGERS) {
+		return false;
+	}
+	if ((config->quantity != MSCRIPT_TRIGGER_VALUE)
+		&& ((config->window < 2) || (config->window > MSCRIPT_TRIGGER_MAX_WINDOW))) {
+		return false;
+	}
+	if ((config->action == MSCRIPT_TRIGGER_ACTION_SCRIPT) && (config->script == NULL)) {
+		return false;
+	}
+	Trigger_t * trigger = &engine->triggers[engine->nr_of_triggers++];
+	trigger->config = *config;
+	if (trigger->config.min_count == 0) {
+		trigger->config.min_count = 1;
+	}
+	reset_trigger(trigger);
+	return true;
+}
+
+/**
+ * Get the statistics of a trigger engine.
+ */
+void mscript_trigger_engine_get_stats(MscriptTriggerEngine_t const * engine,
+	MscriptTriggerStats_t * p_stats)
+{
+	*p_stats = engine->stats;
+}
@@ -0,0 +1,180 @@
+/**
+ * \file
+ * Host-side triggers that react to the measured data.
+ *
+ * A MethodSCRIPT can test the measured values itself, e.g. to stop a
+ * measurement when the current exceeds a limit (see
+ * "MSExample034-Trigger_on_measured_current.mscr"). This module evaluates such
+ * conditions on the host instead, so they can be more complex, can be
+ * changed without changing the script, and can combine the data of several
+ * channels or devices (using the callback).
+ *
+ * A trigger compares a quantity of one variable with a threshold:
+ *   - the value itself;
+ *   - the mean of the last `window` values;
+ *   - the slope of the least squares line through the last `window` values,
+ *     per second if the packages contain the time (`MSCRIPT_VARTYPE_TIME`),
+ *     and otherwise per package.
+ * It fires when the condition has been met for `min_count` consecutive
+ * packages, and fires again only after the condition has not been met. When
+ * it fires, it can abort the script, or abort the script and run a follow-up
+ * script on the same connection (see `next_script` of
+ * `MscriptAcquisition_t`).
+ *
+ * The trigger engine is inserted between the acquisition and its sink. The
+ * triggers are evaluated on each data package as soon as it has been parsed,
+ * before the package is passed to the sink (which may e.g. write files), and
+ * the abort command is sent immediately. The time from receiving the package
+ * until the decision is measured for every package, and the time until the
+ * abort command has been sent for every trigger that fires.
+ *
+ * The triggers stay active while the follow-up script runs, so a trigger
+ * can fire again on its output.
+ *
+ * The windows are cleared at the start of each measurement loop. A trigger
+ * with a channel number only uses the packages of that channel (see
+ * `mscript_get_package_channel()`).
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mscript.h"
+#include "mscript_acquisition.h"
+
+/// Maximum number of triggers of an engine.
+#define MSCRIPT_TRIGGER_MAX_TRIGGERS 16
+
+/// Maximum number of values in the window of a trigger.
+#define MSCRIPT_TRIGGER_MAX_WINDOW 64
+
+/// Channel of a trigger that uses the packages of all channels.
+#define MSCRIPT_TRIGGER_ALL_CHANNELS (-1)
+
+/** The quantity that is compared with the threshold. */
+typedef enum {
+	MSCRIPT_TRIGGER_VALUE, //!< The value
+	MSCRIPT_TRIGGER_MEAN,  //!< Mean of the last `window` values
+	MSCRIPT_TRIGGER_SLOPE, //!< Slope of the last `window` values
+} MscriptTriggerQuantity_t;
+
+/** The comparison with the threshold. */
+typedef enum {
+	MSCRIPT_TRIGGER_ABOVE, //!< Fires if the quantity is above the threshold
+	MSCRIPT_TRIGGER_BELOW, //!< Fires if the quantity is below the threshold
+} MscriptTriggerComparison_t;
+
+/** What to do when a trigger fires. */
+typedef enum {
+	MSCRIPT_TRIGGER_ACTION_NONE,   //!< Only call the callback
+	MSCRIPT_TRIGGER_ACTION_ABORT,  //!< Abort the script
+	MSCRIPT_TRIGGER_ACTION_SCRIPT, //!< Abort the script and run `script`
+} MscriptTriggerAction_t;
+
+/** Configuration of a trigger. */
+typedef struct {
+	/** The variable type of the value (the first occurrence in the package is used). */
+	unsigned int variable_type;
+	/** The channel, or `MSCRIPT_TRIGGER_ALL_CHANNELS`. */
+	int channel;
+	MscriptTriggerQuantity_t quantity;
+	MscriptTriggerComparison_t comparison;
+	double threshold;
+	/** Number of values for the mean and slope (2 to `MSCRIPT_TRIGGER_MAX_WINDOW`). */
+	unsigned int window;
+	/** Number of consecutive packages that must meet the condition (at least 1). */
+	unsigned int min_count;
+	MscriptTriggerAction_t action;
+	/** The follow-up script (for `MSCRIPT_TRIGGER_ACTION_SCRIPT`), see `mscript_send_script()`. */
+	char const * script;
+} MscriptTriggerConfig_t;
+
+/** Information about a trigger that fired, passed to the callback. */
+typedef struct {
+	/** Index of the trigger (in the order in which they were added). */
+	size_t trigger_index;
+	MscriptTriggerConfig_t const * config;
+	/** The measurement loop and package that caused the trigger to fire. */
+	unsigned int meas_loop_index;
+	unsigned int package_index;
+	/** The quantity that met the condition. */
+	double value;
+	/** `true` if the action has been performed (i.e. the abort command has been sent). */
+	bool is_action_done;
+	/** Time from receiving the package until the action was done, in µs. */
+	uint64_t latency_us;
+} MscriptTriggerEvent_t;
+
+/**
+ * Function that is called when a trigger fires, from the thread of the
+ * acquisition, after the action has been performed.
+ *
+ * \param context The context of the engine.
+ * \param event Information about the trigger.
+ */
+typedef void (*MscriptTriggerCallback_t)(void * context, MscriptTriggerEvent_t const * event);
+
+/** Statistics of a trigger engine. */
+typedef struct {
+	/** Number of packages on which the triggers were evaluated. */
+	uint64_t nr_of_packages;
+	/** Total and maximum time from receiving a package until the decision, in µs. */
+	uint64_t total_latency_us;
+	uint64_t max_latency_us;
+	/** Number of times a trigger fired. */
+	unsigned int nr_of_fires;
+	/** Number of times the script was aborted. */
+	unsigned int nr_of_aborts;
+} MscriptTriggerStats_t;
+
+/** A trigger engine. */
+typedef struct MscriptTriggerEngine MscriptTriggerEngine_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool mscript_trigger_parse(char const * text, MscriptTriggerConfig_t * config);
+MscriptTriggerEngine_t * mscript_trigger_engine_create(MscriptAcquisition_t * acquisition,
+	MscriptTriggerCallback_t callback, void * context);
+void mscript_trigger_engine_destroy(MscriptTriggerEngine_t * engine);
+bool mscript_trigger_engine_add(MscriptTriggerEngine_t * engine,
+	MscriptTriggerConfig_t const * config);
+void mscript_trigger_engine_get_stats(MscriptTriggerEngine_t const * engine,
+	MscriptTriggerStats_t * p_stats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
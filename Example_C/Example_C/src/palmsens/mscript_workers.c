@@ -0,0 +1,279 @@
+/**
+ * \file
+ * Pool of worker threads.
+ *
+ * See `mscript_workers.h` for a description of this module.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#include "mscript_workers.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include "mscript_debug_printf.h"
+#include "mscript_thread.h"
+
+/** A work item waiting to be processed. */
+typedef struct WorkItem {
+	struct WorkItem * next;
+	MscriptWorkFunction_t function;
+	void * arg;
+} WorkItem_t;
+
+struct MscriptWorkers {
+	MscriptMutex_t mutex;
+	/** Signaled when a work item is queued or `stop` is set. */
+	MscriptCondition_t queued;
+	/** Signaled when all work items have been processed. */
+	MscriptCondition_t idle;
+	/** The queue of work items (oldest first). */
+	WorkItem_t * head;
+	WorkItem_t * tail;
+	/** Number of work items that are queued or being processed. */
+	size_t nr_of_pending;
+	bool stop;
+	unsigned int nr_of_threads;
+	MscriptThread_t threads[MSCRIPT_WORKERS_MAX_THREADS];
+};
+
+/**
+ * Main function of a worker thread.
+ *
+ * The work items are processed until `stop` is set and the queue is empty.
+ */
+static void worker_main(void * arg)
+{
+	MscriptWorkers_t * workers = arg;
+	mscript_mutex_lock(&workers->mutex);
+	for (;;) {
+		while ((workers->head == NULL) && !workers->stop) {
+			mscript_condition_wait(&workers->queued, &workers->mutex);
+		}
+		WorkItem_t * item = workers->head;
+		if (item == NULL) {
+			break;
+		}
+		workers->head = item->next;
+		if (workers->head == NULL) {
+			workers->tail = NULL;
+		}
+		mscript_mutex_unlock(&workers->mutex);
+
+		item->function(item->arg);
+		free(item);
+
+		mscript_mutex_lock(&workers->mutex);
+		if (--workers->nr_of_pending == 0) {
+			mscript_condition_broadcast(&workers->idle);
+		}
+	}
+	mscript_mutex_unlock(&workers->mutex);
+}
+
+/**
+ * Create a pool and start its worker threads.
+ *
+ * \param nr_of_threads The number of worker threads, or 0 to use one thread
+ *                      per processor.
+ *
+ * \return The pool, or NULL on failure.
+ */
+MscriptWorkers_t * mscript_workers_create(unsigned int nr_of_threads)
+{
+	if (nr_of_threads == 0) {
+		nr_of_threads = mscript_get_nr_of_processors();
+	}
+	if (nr_of_threads > MSCRIPT_WORKERS_MAX_THREADS) {
+		nr_of_threads = MSCRIPT_WORKERS_MAX_THREADS;
+	}
+	MscriptWorkers_t * workers = calloc(1, sizeof(MscriptWorkers_t));
+	if (workers == NULL) {
+		return NULL;
+	}
+	mscript_mutex_init(&workers->mutex);
+	mscript_condition_init(&workers->queued);
+	mscript_condition_init(&workers->idle);
+	for (unsigned int i = 0; i < nr_of_threads; ++i) {
+		if (!mscript_thread_create(&workers->threads[i], worker_main, workers)) {
+			DEBUG_PRINTF("Could not start worker thread %u.\n", i);
+			break;
+		}
+		++workers->nr_of_threads;
+	}
+	if (workers->nr_of_threads == 0) {
+		mscript_workers_destroy(workers);
+		return NULL;
+	}
+	return workers;
+}
+
+/**
+ * Wait until all submitted work items have been processed, then stop the
+ * worker threads and free the pool.
+ */
+void mscript_workers_destroy(MscriptWorkers_t * workers)
+{
+	mscript_mutex_lock(&workers->mutex);
+	workers->stop = true;
+	mscript_condition_broadcast(&workers->queued);
+	mscript_mutex_unlock(&workers->mutex);
+	for (unsigned int i = 0; i < workers->nr_of_threads; ++i) {
+		mscript_thread_join(workers->threads[i]);
+	}
+	assert(workers->head == NULL);
+	mscript_condition_destroy(&workers->idle);
+	mscript_condition_destroy(&workers->queued);
+	mscript_mutex_destroy(&workers->mutex);
+	free(workers);
+}
+
+/**
+ * Get the number of worker threads of a pool.
+ */
+unsigned int mscript_workers_get_nr_of_threads(MscriptWorkers_t const * workers)
+{
+	return workers->nr_of_threads;
+}
+
+/**
+ * Submit a work item.
+ *
+ * The function is called with the argument from one of the worker threads.
+ *
+ * \return `true` on success, `false` on failure to allocate memory (the
+ *         function is not called)
+ */
+bool mscript_workers_submit(MscriptWorkers_t * workers, MscriptWorkFunction_t function,
+	void * arg)
+{
+	assert(function != NULL);
+	WorkItem_t * item = malloc(sizeof(WorkItem_t));
+	if (item == NULL) {
+		return false;
+	}
+	item->next = NULL;
+	item->function = function;
+	item->arg = arg;
+
+	mscript_mutex_lock(&workers->mutex);
+	if (workers->tail != NULL) {
+		workers->tail->next = item;
+	} else {
+		workers->head = item;
+	}
+	workers->tail = item;
+	++workers->nr_of_pending;
+	mscript_condition_signal(&workers->queued);
+	mscript_mutex_unlock(&workers->mutex);
+	return true;
+}
+
+/**
+ * Wait until all submitted work items have been processed.
+ */
+void mscript_workers_wait(MscriptWorkers_t * workers)
+{
+	mscript_mutex_lock(&workers->mutex);
+	while (workers->nr_of_pending > 0) {
+		mscript_condition_wait(&workers->idle, &workers->mutex);
+	}
+	mscript_mutex_unlock(&workers->mutex);
+}
+
+/**
+ * Initialize a group of work items that are processed by a pool.
+ */
+void mscript_work_group_init(MscriptWorkGroup_t * group, MscriptWorkers_t * workers)
+{
+	group->workers = workers;
+	group->nr_of_pending = 0;
+	mscript_mutex_init(&group->mutex);
+	mscript_condition_init(&group->processed);
+}
+
+/**
+ * Wait until the work items of a group have been processed and free its
+ * resources.
+ */
+void mscript_work_group_destroy(MscriptWorkGroup_t * group)
+{
+	mscript_work_group_wait(group);
+	mscript_condition_destroy(&group->processed);
+	mscript_mutex_destroy(&group->mutex);
+}
+
+/**
+ * Submit a work item of a group. The function must call
+ * `mscript_work_group_done()` when it has finished.
+ *
+ * \return `true` on success, `false` on failure to allocate memory (the
+ *         function is not called)
+ */
+bool mscript_work_group_submit(MscriptWorkGroup_t * group, MscriptWorkFunction_t function,
+	void * arg)
+{
+	mscript_mutex_lock(&group->mutex);
+	++group->nr_of_pending;
+	mscript_mutex_unlock(&group->mutex);
+	if (!mscript_workers_submit(group->workers, function, arg)) {
+		mscript_mutex_lock(&group->mutex);
+		--group->nr_of_pending;
+		mscript_mutex_unlock(&group->mutex);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Mark a work item of a group as processed.
+ *
+ * Call this at the end of the work function, with the mutex of the group
+ * locked, so the results that it stores are visible to the waiting thread.
+ */
+void mscript_work_group_done(MscriptWorkGroup_t * group)
+{
+	assert(group->nr_of_pending > 0);
+	--group->nr_of_pending;
+	mscript_condition_broadcast(&group->processed);
+}
+
+/**
+ * Wait until all submitted work items of a group have been processed.
+ */
+void mscript_work_group_wait(MscriptWorkGroup_t * group)
+{
+	mscript_mutex_lock(&group->mutex);
+	while (group->nr_of_pending > 0) {
+		mscript_condition_wait(&group->processed, &group->mutex);
+	}
+	mscript_mutex_unlock(&group->mutex);
+}
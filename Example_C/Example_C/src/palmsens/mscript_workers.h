@@ -0,0 +1,96 @@
+/**
+ * \file
+ * Pool of worker threads.
+ *
+ * Processing stages that do heavy calculations on complete blocks of data
+ * (e.g. fitting an impedance spectrum, see `mscript_eis_fit.h`) submit each
+ * block as a work item to a pool of worker threads, so the thread that
+ * receives the data is not delayed and the blocks are processed in parallel.
+ * One pool can be shared by all stages and all devices.
+ *
+ * Work items are started in the order they are submitted. Each work item is
+ * a function and an argument; the function is responsible for freeing the
+ * argument if necessary.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mscript_thread.h"
+
+/// Maximum number of threads of a pool.
+#define MSCRIPT_WORKERS_MAX_THREADS 64
+
+/** Function that processes a work item, called from a worker thread. */
+typedef void (*MscriptWorkFunction_t)(void * arg);
+
+/** A pool of worker threads. */
+typedef struct MscriptWorkers MscriptWorkers_t;
+
+/**
+ * The work items that one client (e.g., a collector of measurement data) has
+ * submitted to a pool, so the client can wait for its own items only.
+ *
+ * The mutex also protects the data that the work items write (e.g., their
+ * results); see `mscript_work_group_done()`.
+ */
+typedef struct {
+	MscriptWorkers_t * workers;
+	MscriptMutex_t mutex;
+	/** Signaled when a work item has been processed. */
+	MscriptCondition_t processed;
+	/** Number of submitted work items that have not been processed yet. */
+	size_t nr_of_pending;
+} MscriptWorkGroup_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MscriptWorkers_t * mscript_workers_create(unsigned int nr_of_threads);
+void mscript_workers_destroy(MscriptWorkers_t * workers);
+unsigned int mscript_workers_get_nr_of_threads(MscriptWorkers_t const * workers);
+bool mscript_workers_submit(MscriptWorkers_t * workers, MscriptWorkFunction_t function,
+	void * arg);
+void mscript_workers_wait(MscriptWorkers_t * workers);
+void mscript_work_group_init(MscriptWorkGroup_t * group, MscriptWorkers_t * workers);
+void mscript_work_group_destroy(MscriptWorkGroup_t * group);
+bool mscript_work_group_submit(MscriptWorkGroup_t * group, MscriptWorkFunction_t function,
+	void * arg);
+void mscript_work_group_done(MscriptWorkGroup_t * group);
+void mscript_work_group_wait(MscriptWorkGroup_t * group);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,220 @@
+/**
+ * \file
+ * Benchmark of the min/max summary and LTTB downsampling.
+ *
+ * This tool builds the min/max summary of `mscript_downsample.h` for a noisy
+ * signal of 10 million points (or the number of points given on the command
+ * line), added in small chunks as during a measurement. It then shows ranges
+ * of decreasing size (zooming in) with at most 2000 points, and compares the
+ * time with a scan of all rows of the range. For each range, it checks that
+ * the returned rows are in the range, in ascending order, and include the
+ * minimum and maximum of the range. Finally, the points of the complete range
+ * are reduced to exactly 1000 points with LTTB.
+ *
+ * Build and run it using "make benchmark".
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mscript_downsample.h"
+
+/// Default number of points.
+#define DEFAULT_NR_OF_POINTS 10000000
+
+/// Number of points per chunk when building the summary.
+#define CHUNK_SIZE 37
+
+/// Maximum number of points to show.
+#define MAX_POINTS 2000
+
+/// Number of points selected with LTTB.
+#define LTTB_POINTS 1000
+
+/// Number of times each query is repeated (the fastest is reported).
+#define NR_OF_REPEATS 5
+
+/**
+ * Get the current time in seconds.
+ */
+static double get_time(void)
+{
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Find the minimum and maximum of a range by scanning all rows.
+ */
+static void scan_range(double const * values, size_t first, size_t end, double * p_min,
+	double * p_max)
+{
+	double min = INFINITY;
+	double max = -INFINITY;
+	for (size_t row = first; row < end; ++row) {
+		if (values[row] < min) {
+			min = values[row];
+		}
+		if (values[row] > max) {
+			max = values[row];
+		}
+	}
+	*p_min = min;
+	*p_max = max;
+}
+
+/**
+ * Query a range and check the result.
+ *
+ * \return `false` if the result is not correct.
+ */
+static bool run(MscriptMinMaxSummary_t const * summary, double const * values, size_t first,
+	size_t count, size_t * rows)
+{
+	double query_time = INFINITY;
+	size_t nr_of_rows = 0;
+	for (int i = 0; i < NR_OF_REPEATS; ++i) {
+		double start = get_time();
+		nr_of_rows = mscript_minmax_summary_query(summary, values, first, count, MAX_POINTS,
+			rows);
+		double elapsed = get_time() - start;
+		if (elapsed < query_time) {
+			query_time = elapsed;
+		}
+	}
+
+	double start = get_time();
+	double min, max;
+	scan_range(values, first, first + count, &min, &max);
+	double scan_time = get_time() - start;
+
+	bool success = (nr_of_rows > 0) && (nr_of_rows <= MAX_POINTS);
+	double found_min = INFINITY;
+	double found_max = -INFINITY;
+	for (size_t i = 0; i < nr_of_rows; ++i) {
+		if ((rows[i] < first) || (rows[i] >= first + count) || ((i > 0) && (rows[i] <= rows[i - 1]))) {
+			success = false;
+		}
+		if (values[rows[i]] < found_min) {
+			found_min = values[rows[i]];
+		}
+		if (values[rows[i]] > found_max) {
+			found_max = values[rows[i]];
+		}
+	}
+	if ((found_min != min) || (found_max != max)) {
+		success = false;
+	}
+	printf("%10zu rows from %10zu: %4zu points in %8.3f ms, scan %8.3f ms %s\n", count, first,
+		nr_of_rows, query_time * 1e3, scan_time * 1e3, success ? "OK" : "FAILED");
+	return success;
+}
+
+int main(int argc, char ** argv)
+{
+	size_t count = DEFAULT_NR_OF_POINTS;
+	if (argc > 1) {
+		count = strtoul(argv[1], NULL, 10);
+	}
+	if (count < 1) {
+		fprintf(stderr, "USAGE: %s [NR_OF_POINTS]\n", argv[0]);
+		return 1;
+	}
+
+	double * values = malloc(count * sizeof(double));
+	size_t * rows = malloc(MAX_POINTS * sizeof(size_t));
+	size_t * selected = malloc(LTTB_POINTS * sizeof(size_t));
+	if ((values == NULL) || (rows == NULL) || (selected == NULL)) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+
+	// A chronoamperometry-like signal: a slow random walk with noise and a
+	// few short spikes.
+	srand(1);
+	double level = 1e-6;
+	for (size_t i = 0; i < count; ++i) {
+		level += 1e-10 * ((double)rand() / RAND_MAX - 0.5);
+		values[i] = level + 1e-9 * ((double)rand() / RAND_MAX - 0.5);
+		if (rand() % 1000000 == 0) {
+			values[i] += 1e-7;
+		}
+	}
+
+	MscriptMinMaxSummary_t summary;
+	mscript_minmax_summary_init(&summary);
+	double start = get_time();
+	for (size_t end = 0; end < count; ) {
+		end = (count - end < CHUNK_SIZE) ? count : end + CHUNK_SIZE;
+		if (!mscript_minmax_summary_update(&summary, values, end)) {
+			fprintf(stderr, "Out of memory.\n");
+			return 1;
+		}
+	}
+	double update_time = get_time() - start;
+	printf("%zu points, summary built in %.2f ms (%.1f ns/point)\n\n", count,
+		update_time * 1e3, update_time / count * 1e9);
+
+	// Zoom in on the middle of the data.
+	bool success = true;
+	for (size_t range = count; range > 0; range /= 10) {
+		size_t first = (count - range) / 2 + (range > 1 ? 1 : 0) * (rand() % 7);
+		if (first + range > count) {
+			first = count - range;
+		}
+		if (!run(&summary, values, first, range, rows)) {
+			success = false;
+		}
+	}
+
+	size_t nr_of_rows = mscript_minmax_summary_query(&summary, values, 0, count, MAX_POINTS, rows);
+	start = get_time();
+	size_t nr_of_selected = mscript_lttb(NULL, values, rows, nr_of_rows, LTTB_POINTS, selected);
+	double lttb_time = get_time() - start;
+	printf("\nLTTB: %zu of %zu points selected in %.3f ms\n", nr_of_selected, nr_of_rows,
+		lttb_time * 1e3);
+
+	mscript_minmax_summary_free(&summary);
+	free(values);
+	free(rows);
+	free(selected);
+	if (!success) {
+		printf("\nFAILED: the summary does not match the data.\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * \file
+ * Firmware upload to one or more devices.
+ *
+ * This tool uploads a firmware binary to the bootloader of one or more
+ * MethodSCRIPT devices (see `mscript_fw_upload.h`), like the Python example
+ * fw_upload_serial_port.py. Each device is updated from its own thread, so a
+ * number of devices takes about as long as one device. The devices must
+ * already be in bootloader mode.
+ *
+ *     fw_upload [--window N] [--baudrate BAUDRATE] FIRMWARE PORT [PORT]...
+ *
+ * With --window, up to N blocks are sent before their replies are read
+ * (default 1, i.e. wait for the reply to each block). The default baud rate
+ * is 230400. At the end, the upload time and speed of each device are
+ * printed.
+ *
+ * Build it using "make fw_upload".
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript_fw_upload.h"
+#include "mscript_serial_port.h"
+#include "mscript_thread.h"
+
+/// Maximum number of devices that are updated at the same time.
+#define MAX_NR_OF_DEVICES 64
+
+/// Default baud rate of the bootloader, as in the Python example.
+#define DEFAULT_BAUDRATE 230400
+
+/** The upload to one device. */
+typedef struct {
+	char const * port;
+	int baudrate;
+	uint8_t const * firmware;
+	size_t size;
+	MscriptFwUploadConfig_t config;
+	/** The last progress that was printed, in percent. */
+	unsigned int percentage;
+	MscriptThread_t thread;
+	bool success;
+	MscriptFwUploadStats_t stats;
+} Upload_t;
+
+/**
+ * Print the progress of an upload in steps of 10%.
+ */
+static void print_progress(void * context, size_t nr_of_bytes, size_t total_nr_of_bytes)
+{
+	Upload_t * upload = context;
+	unsigned int percentage = (unsigned int)(100 * nr_of_bytes / total_nr_of_bytes) / 10 * 10;
+	if (percentage > upload->percentage) {
+		upload->percentage = percentage;
+		printf("[%s] %u%%\n", upload->port, percentage);
+	}
+}
+
+/**
+ * Update one device, called from the thread of the device.
+ */
+static void run_upload(void * arg)
+{
+	Upload_t * upload = arg;
+	SerialPortHandle_t handle = mscript_serial_port_open(upload->port, upload->baudrate);
+	if (handle == BAD_HANDLE) {
+		printf("[%s] ERROR: Could not open serial port.\n", upload->port);
+		return;
+	}
+	printf("[%s] Erasing and uploading...\n", upload->port);
+	upload->success = mscript_fw_upload(handle, upload->firmware, upload->size,
+		&upload->config, &upload->stats);
+	mscript_serial_port_close(handle);
+	if (!upload->success) {
+		if (upload->stats.error_reply[0] != '\0') {
+			printf("[%s] ERROR: \"%s\" failed: %s", upload->port, upload->stats.failed_command,
+				upload->stats.error_reply);
+		} else {
+			printf("[%s] ERROR: \"%s\" failed: no reply.\n", upload->port,
+				upload->stats.failed_command);
+		}
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	size_t window = 1;
+	int baudrate = DEFAULT_BAUDRATE;
+	int arg_index = 1;
+	for (; arg_index + 1 < argc; arg_index += 2) {
+		if (!strcmp(argv[arg_index], "--window")) {
+			window = (size_t)strtoul(argv[arg_index + 1], NULL, 10);
+		} else if (!strcmp(argv[arg_index], "--baudrate")) {
+			baudrate = atoi(argv[arg_index + 1]);
+		} else {
+			break;
+		}
+	}
+	int nr_of_devices = argc - arg_index - 1;
+	if ((nr_of_devices < 1) || (nr_of_devices > MAX_NR_OF_DEVICES) || (window < 1)
+		|| (window > MSCRIPT_FW_UPLOAD_MAX_WINDOW)) {
+		printf("USAGE: %s [--window N] [--baudrate BAUDRATE] FIRMWARE PORT [PORT]...\n"
+			"    N: 1 to %d blocks (default 1), BAUDRATE: default %d, at most %d ports.\n",
+			argv[0], MSCRIPT_FW_UPLOAD_MAX_WINDOW, DEFAULT_BAUDRATE, MAX_NR_OF_DEVICES);
+		return EXIT_FAILURE;
+	}
+
+	size_t size;
+	uint8_t * firmware = mscript_fw_read_file(argv[arg_index], &size);
+	if (firmware == NULL) {
+		printf("ERROR: Could not read %s\n", argv[arg_index]);
+		return EXIT_FAILURE;
+	}
+	printf("Uploading %lu bytes to %d device(s), window of %lu block(s).\n",
+		(unsigned long)size, nr_of_devices, (unsigned long)window);
+
+	static Upload_t uploads[MAX_NR_OF_DEVICES];
+	for (int i = 0; i < nr_of_devices; ++i) {
+		Upload_t * upload = &uploads[i];
+		upload->port = argv[arg_index + 1 + i];
+		upload->baudrate = baudrate;
+		upload->firmware = firmware;
+		upload->size = size;
+		mscript_fw_upload_default_config(&upload->config);
+		upload->config.window = window;
+		upload->config.progress = print_progress;
+		upload->config.context = upload;
+		if (!mscript_thread_create(&upload->thread, run_upload, upload)) {
+			printf("[%s] ERROR: Could not start thread.\n", upload->port);
+			upload->port = NULL;
+		}
+	}
+
+	int nr_of_failures = 0;
+	for (int i = 0; i < nr_of_devices; ++i) {
+		if (uploads[i].port != NULL) {
+			mscript_thread_join(uploads[i].thread);
+		}
+		nr_of_failures += uploads[i].success ? 0 : 1;
+	}
+	printf("\n%-20s %6s %10s %10s %10s %8s %s\n", "Port", "Result", "Bytes", "Erase ms",
+		"Data ms", "Writes", "Bytes/s");
+	for (int i = 0; i < nr_of_devices; ++i) {
+		Upload_t const * upload = &uploads[i];
+		printf("%-20s %6s %10lu %10lu %10lu %8lu %.0f\n",
+			(upload->port != NULL) ? upload->port : argv[arg_index + 1 + i],
+			upload->success ? "OK" : "FAILED", (unsigned long)upload->stats.nr_of_bytes,
+			(unsigned long)upload->stats.erase_time_ms, (unsigned long)upload->stats.data_time_ms,
+			(unsigned long)upload->stats.nr_of_writes, upload->stats.bytes_per_second);
+	}
+	free(firmware);
+	return (nr_of_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,205 @@
+/**
+ * \file
+ * Benchmark of the loop tree.
+ *
+ * This tool builds the loop tree of `mscript_loop_tree.h` for a run of
+ * 2 million data packages (or the number given on the command line) with
+ * the structure of a script that repeats a cyclic voltammetry measurement
+ * with 3 scans in a loop: `L`, then 100 times `M`, 3 times `C` ... `-` and
+ * `*`, and finally `+`. For comparison, the same packages are also stored
+ * with one `malloc()` per package. It then extracts the current of every
+ * scan, and checks the structure of the tree and the extracted values.
+ *
+ * Build and run it using "make benchmark".
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mscript_loop_tree.h"
+
+/// Default number of packages.
+#define DEFAULT_NR_OF_PACKAGES 2000000
+
+/// Number of measurement loops in the loop.
+#define NR_OF_MEAS_LOOPS 100
+
+/// Number of scans per measurement loop.
+#define NR_OF_SCANS 3
+
+/**
+ * Get the current time in seconds.
+ */
+static double get_time(void)
+{
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Fill the package with the given number.
+ */
+static void make_package(size_t index, MscriptDataPackage_t * package)
+{
+	package->nr_of_sub_packages = 2;
+	package->sub_packages[0].variable_type = MSCRIPT_VARTYPE_CELL_SET_POTENTIAL;
+	package->sub_packages[0].value = (double)(index % 1000) * 1e-3;
+	package->sub_packages[0].metadata.status = -1;
+	package->sub_packages[0].metadata.range = -1;
+	package->sub_packages[1].variable_type = MSCRIPT_VARTYPE_CURRENT;
+	package->sub_packages[1].value = (double)index * 1e-9;
+	package->sub_packages[1].metadata.status = 0;
+	package->sub_packages[1].metadata.range = 5;
+}
+
+int main(int argc, char ** argv)
+{
+	size_t count = DEFAULT_NR_OF_PACKAGES;
+	if (argc > 1) {
+		count = strtoul(argv[1], NULL, 10);
+	}
+	size_t points_per_scan = count / (NR_OF_MEAS_LOOPS * NR_OF_SCANS);
+	if (points_per_scan < 1) {
+		fprintf(stderr, "USAGE: %s [NR_OF_PACKAGES] (at least %d)\n", argv[0],
+			NR_OF_MEAS_LOOPS * NR_OF_SCANS);
+		return 1;
+	}
+	count = points_per_scan * NR_OF_MEAS_LOOPS * NR_OF_SCANS;
+
+	// One malloc() per package, as a tree of separately allocated nodes would do.
+	MscriptDataPackage_t package;
+	MscriptDataPackage_t ** copies = malloc(count * sizeof(MscriptDataPackage_t *));
+	if (copies == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	double start = get_time();
+	for (size_t i = 0; i < count; ++i) {
+		make_package(i, &package);
+		copies[i] = malloc(sizeof(MscriptDataPackage_t));
+		if (copies[i] == NULL) {
+			fprintf(stderr, "Out of memory.\n");
+			return 1;
+		}
+		memcpy(copies[i], &package, sizeof(MscriptDataPackage_t));
+	}
+	double malloc_time = get_time() - start;
+	for (size_t i = 0; i < count; ++i) {
+		free(copies[i]);
+	}
+	free(copies);
+
+	MscriptLoopTree_t * tree = mscript_loop_tree_create();
+	if (tree == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	start = get_time();
+	bool success = mscript_loop_tree_open_scope(tree, MSCRIPT_SCOPE_LOOP, "L", 0);
+	size_t index = 0;
+	for (unsigned int m = 0; success && (m < NR_OF_MEAS_LOOPS); ++m) {
+		success = mscript_loop_tree_open_scope(tree, MSCRIPT_SCOPE_MEAS_LOOP, "M0002", m + 1);
+		for (unsigned int c = 0; success && (c < NR_OF_SCANS); ++c) {
+			success = mscript_loop_tree_open_scope(tree, MSCRIPT_SCOPE_SCAN, "C0000", m + 1);
+			for (size_t i = 0; success && (i < points_per_scan); ++i) {
+				make_package(index++, &package);
+				success = mscript_loop_tree_add_package(tree, &package);
+			}
+			mscript_loop_tree_close_scope(tree, MSCRIPT_SCOPE_SCAN);
+		}
+		mscript_loop_tree_close_scope(tree, MSCRIPT_SCOPE_MEAS_LOOP);
+	}
+	mscript_loop_tree_close_scope(tree, MSCRIPT_SCOPE_LOOP);
+	double build_time = get_time() - start;
+	if (!success) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	printf("%zu packages in %zu scopes\n", mscript_loop_tree_get_nr_of_packages(tree),
+		mscript_loop_tree_get_nr_of_scopes(tree));
+	printf("malloc per package: %8.2f ms (%5.1f ns/package)\n", malloc_time * 1e3,
+		malloc_time / count * 1e9);
+	printf("loop tree:          %8.2f ms (%5.1f ns/package), %.1f MB (%.1f bytes/package)\n",
+		build_time * 1e3, build_time / count * 1e9,
+		mscript_loop_tree_get_memory_size(tree) / 1048576.0,
+		(double)mscript_loop_tree_get_memory_size(tree) / count);
+
+	// Extract the current of each scan and check the values, which are the
+	// package numbers.
+	double * currents = malloc(points_per_scan * sizeof(double));
+	if (currents == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	size_t nr_of_scans = 0;
+	size_t expected_first = 0;
+	double extract_time = 0.0;
+	for (MscriptScope_t const * scope = mscript_loop_tree_get_root(tree); scope != NULL;
+		scope = mscript_loop_tree_next_scope(scope)) {
+		if (scope->is_open != (scope->type == MSCRIPT_SCOPE_ROOT)) {
+			success = false;
+		}
+		if (scope->type != MSCRIPT_SCOPE_SCAN) {
+			continue;
+		}
+		start = get_time();
+		size_t n = mscript_loop_tree_get_column(tree, scope, MSCRIPT_VARTYPE_CURRENT, currents,
+			points_per_scan);
+		extract_time += get_time() - start;
+		if ((n != points_per_scan) || (scope->first_package != expected_first)
+			|| (scope->depth != 3) || (scope->parent->nr_of_packages
+				!= NR_OF_SCANS * points_per_scan)) {
+			success = false;
+		}
+		for (size_t i = 0; i < n; ++i) {
+			if (currents[i] != (double)(expected_first + i) * 1e-9) {
+				success = false;
+			}
+		}
+		expected_first += n;
+		++nr_of_scans;
+	}
+	success = success && (nr_of_scans == NR_OF_MEAS_LOOPS * NR_OF_SCANS)
+		&& (mscript_loop_tree_get_root(tree)->nr_of_packages == count);
+	printf("column of %zu scans: %8.2f ms (%5.2f ns/value) %s\n", nr_of_scans,
+		extract_time * 1e3, extract_time / count * 1e9, success ? "OK" : "FAILED");
+
+	free(currents);
+	mscript_loop_tree_destroy(tree);
+	return success ? 0 : 1;
+}
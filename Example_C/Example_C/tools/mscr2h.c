@@ -0,0 +1,356 @@
+/**
+ * \file
+ * MethodSCRIPT to C header converter.
+ *
+ * This build tool converts a MethodSCRIPT file into a C header file, so the
+ * script can be compiled into an application instead of being read from file
+ * at runtime. The generated header contains:
+ *   - the script with comments, indentation and blank lines removed, as a
+ *     string that can be sent to the device using `mscript_send_script()`;
+ *   - the expected package layout of each measurement loop, as predicted by
+ *     the MethodSCRIPT analyzer (see `mscript_analyzer.h`), which can be
+ *     passed to `parse_data_package_with_schema()`;
+ *   - an `MscriptBuiltinScript_t` structure that combines the above.
+ *
+ * Usage:
+ *
+ *     mscr2h SCRIPT.mscr OUTPUT.h
+ *         Generate the header for one script.
+ *
+ *     mscr2h --index OUTPUT.h SCRIPT.mscr...
+ *         Generate a header that includes the headers of all given scripts
+ *         and defines a table `MSCRIPT_BUILTIN_SCRIPTS` of all of them.
+ *
+ * The identifiers in the generated header are derived from the file name of
+ * the script, e.g. "scripts/example_LSV_10k.mscr" results in
+ * `SCRIPT_EXAMPLE_LSV_10K`, `SCRIPT_EXAMPLE_LSV_10K_LOOPS` and
+ * `SCRIPT_EXAMPLE_LSV_10K_BUILTIN`.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to,
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript.h"
+#include "mscript_analyzer.h"
+#include "mscript_flash_cache.h"
+
+/// Maximum length of a script line (the device accepts at most 128 characters).
+#define MAX_LINE_LENGTH 256
+
+/// Maximum length of an identifier derived from a script name.
+#define MAX_IDENTIFIER_LENGTH 80
+
+static char const help_text[] =
+	"USAGE: %s SCRIPT.mscr OUTPUT.h\n"
+	"       %s --index OUTPUT.h SCRIPT.mscr...\n"
+	;
+
+/**
+ * Get the name of a script from its path, i.e. the file name without
+ * directory and extension.
+ */
+static void get_script_name(char const * path, char * name, size_t name_size)
+{
+	char const * start = path;
+	for (char const * p = path; *p != '\0'; ++p) {
+		if ((*p == '/') || (*p == '\\')) {
+			start = p + 1;
+		}
+	}
+	char const * end = strrchr(start, '.');
+	size_t len = (end != NULL) ? (size_t)(end - start) : strlen(start);
+	if (len >= name_size) {
+		len = name_size - 1;
+	}
+	memcpy(name, start, len);
+	name[len] = '\0';
+}
+
+/**
+ * Derive a C identifier from a script path, e.g. "SCRIPT_EXAMPLE_LSV_10K".
+ */
+static void get_identifier(char const * path, char * identifier, size_t identifier_size)
+{
+	char name[MAX_IDENTIFIER_LENGTH];
+	get_script_name(path, name, sizeof(name));
+	int len = snprintf(identifier, identifier_size, "SCRIPT_%s", name);
+	for (int i = 0; (i < len) && (identifier[i] != '\0'); ++i) {
+		identifier[i] = isalnum((unsigned char)identifier[i])
+			? (char)toupper((unsigned char)identifier[i]) : '_';
+	}
+}
+
+/**
+ * Remove comments and leading and trailing whitespace from a script line.
+ *
+ * Comments start with a '#' that is not inside a quoted string. The line is
+ * modified in place.
+ *
+ * \return The minified line, which is empty if nothing remains.
+ */
+static char * minify_line(char * line)
+{
+	bool in_quotes = false;
+	for (char * p = line; *p != '\0'; ++p) {
+		if (*p == '"') {
+			in_quotes = !in_quotes;
+		} else if (!in_quotes && (*p == '#')) {
+			*p = '\0';
+			break;
+		}
+	}
+	while ((*line == ' ') || (*line == '\t')) {
+		++line;
+	}
+	size_t len = strlen(line);
+	while ((len > 0) && isspace((unsigned char)line[len - 1])) {
+		line[--len] = '\0';
+	}
+	return line;
+}
+
+/**
+ * Write a line of the script as C string literal.
+ */
+static void write_string_literal(FILE * fp, char const * line)
+{
+	fprintf(fp, "\t\"");
+	for (char const * p = line; *p != '\0'; ++p) {
+		if ((*p == '"') || (*p == '\\')) {
+			fputc('\\', fp);
+		}
+		fputc(*p, fp);
+	}
+	fprintf(fp, "\\n\"\n");
+}
+
+/**
+ * Write the minified script as string constant.
+ *
+ * The script ends at the first empty line, like it does on the device. Lines
+ * that only contain whitespace or comments are removed.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool write_script(FILE * fp, char const * script_path, char const * identifier)
+{
+	FILE * fp_in = fopen(script_path, "r");
+	if (fp_in == NULL) {
+		fprintf(stderr, "ERROR: Could not open %s: %s\n", script_path, strerror(errno));
+		return false;
+	}
+
+	fprintf(fp, "static char const %s[] =\n", identifier);
+	char line[MAX_LINE_LENGTH];
+	while (fgets(line, sizeof(line), fp_in) != NULL) {
+		if ((strchr(line, '\n') == NULL) && !feof(fp_in)) {
+			fprintf(stderr, "ERROR: Line too long in %s.\n", script_path);
+			fclose(fp_in);
+			return false;
+		}
+		if ((line[0] == '\n') || ((line[0] == '\r') && (line[1] == '\n'))) {
+			break;
+		}
+		char * minified = minify_line(line);
+		if (*minified != '\0') {
+			write_string_literal(fp, minified);
+		}
+	}
+	fprintf(fp, "\t\"\\n\";\n\n");
+
+	bool success = !ferror(fp_in);
+	if (!success) {
+		fprintf(stderr, "ERROR: Could not read %s.\n", script_path);
+	}
+	fclose(fp_in);
+	return success;
+}
+
+/**
+ * Write the package layout of each measurement loop.
+ *
+ * Loops of which not all variable types are known, or which contain more
+ * variables than fit in a data package structure, get an empty layout (0 sub
+ * packages), so their packages are parsed without a schema.
+ */
+static void write_loops(FILE * fp, char const * identifier,
+	MscriptPrediction_t const * prediction)
+{
+	fprintf(fp, "static MscriptPackageSchema_t const %s_LOOPS[] = {\n", identifier);
+	if (prediction->nr_of_loops == 0) {
+		// An empty initializer list is not allowed in C.
+		fprintf(fp, "\t{ 0 },\n");
+	}
+	for (size_t i = 0; i < prediction->nr_of_loops; ++i) {
+		MscriptLoopPrediction_t const * loop = &prediction->loops[i];
+		bool is_known = (loop->nr_of_variables > 0)
+			&& (loop->nr_of_variables <= MSCRIPT_MAX_SUB_PACKAGES_PER_LINE);
+		for (size_t j = 0; is_known && (j < loop->nr_of_variables); ++j) {
+			if (loop->variable_types[j] == MSCRIPT_VARTYPE_UNKNOWN) {
+				is_known = false;
+			}
+		}
+		if (!is_known) {
+			fprintf(fp, "\t{ 0 }, // %s (line %u): layout not known\n", loop->technique,
+				loop->line_number);
+			continue;
+		}
+		fprintf(fp, "\t{ %lu, {", (unsigned long)loop->nr_of_variables);
+		for (size_t j = 0; j < loop->nr_of_variables; ++j) {
+			unsigned int vartype = loop->variable_types[j];
+			fprintf(fp, "%s MSCRIPT_VARTYPE('%c', '%c')", (j > 0) ? "," : "",
+				'a' + vartype / 26, 'a' + vartype % 26);
+		}
+		fprintf(fp, " } }, // %s (line %u)\n", loop->technique, loop->line_number);
+	}
+	fprintf(fp, "};\n\n");
+}
+
+/**
+ * Generate the header file for one script.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool generate_script_header(char const * script_path, char const * output_path)
+{
+	MscriptPrediction_t prediction;
+	if (!mscript_analyze_file(script_path, &prediction)) {
+		fprintf(stderr, "ERROR: Could not analyze %s.\n", script_path);
+		return false;
+	}
+	uint64_t hash;
+	if (!mscript_hash_file(script_path, &hash)) {
+		return false;
+	}
+
+	char name[MAX_IDENTIFIER_LENGTH];
+	char identifier[MAX_IDENTIFIER_LENGTH];
+	get_script_name(script_path, name, sizeof(name));
+	get_identifier(script_path, identifier, sizeof(identifier));
+
+	FILE * fp = fopen(output_path, "w");
+	if (fp == NULL) {
+		fprintf(stderr, "ERROR: Could not create %s: %s\n", output_path, strerror(errno));
+		return false;
+	}
+	fprintf(fp, "// Generated by mscr2h from %s. Do not edit.\n", script_path);
+	fprintf(fp, "#pragma once\n\n");
+	fprintf(fp, "#include \"palmsens/mscript.h\"\n\n");
+
+	bool success = write_script(fp, script_path, identifier);
+	if (success) {
+		write_loops(fp, identifier, &prediction);
+		fprintf(fp, "static MscriptBuiltinScript_t const %s_BUILTIN = {\n", identifier);
+		fprintf(fp, "\t\"%s\",\n", name);
+		fprintf(fp, "\t%s,\n", identifier);
+		fprintf(fp, "\t0x%016" PRIx64 "ULL,\n", hash);
+		fprintf(fp, "\t%lu,\n", (unsigned long)prediction.nr_of_loops);
+		fprintf(fp, "\t%s_LOOPS,\n", identifier);
+		fprintf(fp, "};\n");
+	}
+
+	if (ferror(fp)) {
+		success = false;
+	}
+	if (fclose(fp)) {
+		success = false;
+	}
+	if (!success) {
+		fprintf(stderr, "ERROR: Could not write %s.\n", output_path);
+		remove(output_path);
+	}
+	return success;
+}
+
+/**
+ * Generate the index header that lists all scripts.
+ *
+ * \return `true` on success, `false` on failure
+ */
+static bool generate_index_header(char const * output_path, int nr_of_scripts,
+	char * script_paths[])
+{
+	FILE * fp = fopen(output_path, "w");
+	if (fp == NULL) {
+		fprintf(stderr, "ERROR: Could not create %s: %s\n", output_path, strerror(errno));
+		return false;
+	}
+	fprintf(fp, "// Generated by mscr2h. Do not edit.\n");
+	fprintf(fp, "#pragma once\n\n");
+	fprintf(fp, "#include \"palmsens/mscript.h\"\n");
+	for (int i = 0; i < nr_of_scripts; ++i) {
+		char name[MAX_IDENTIFIER_LENGTH];
+		get_script_name(script_paths[i], name, sizeof(name));
+		fprintf(fp, "#include \"%s.h\"\n", name);
+	}
+
+	fprintf(fp, "\n/// All scripts that were compiled into the application.\n");
+	fprintf(fp, "static MscriptBuiltinScript_t const * const MSCRIPT_BUILTIN_SCRIPTS[] = {\n");
+	for (int i = 0; i < nr_of_scripts; ++i) {
+		char identifier[MAX_IDENTIFIER_LENGTH];
+		get_identifier(script_paths[i], identifier, sizeof(identifier));
+		fprintf(fp, "\t&%s_BUILTIN,\n", identifier);
+	}
+	// Terminate the table, which also avoids an empty initializer list.
+	fprintf(fp, "\tNULL,\n");
+	fprintf(fp, "};\n");
+
+	bool success = !ferror(fp);
+	if (fclose(fp)) {
+		success = false;
+	}
+	if (!success) {
+		fprintf(stderr, "ERROR: Could not write %s.\n", output_path);
+		remove(output_path);
+	}
+	return success;
+}
+
+int main(int argc, char * argv[])
+{
+	bool success;
+	if ((argc >= 3) && !strcmp(argv[1], "--index")) {
+		success = generate_index_header(argv[2], argc - 3, argv + 3);
+	} else if (argc == 3) {
+		success = generate_script_header(argv[1], argv[2]);
+	} else {
+		fprintf(stderr, help_text, argv[0], argv[0]);
+		return EXIT_FAILURE;
+	}
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,217 @@
+/**
+ * \file
+ * Benchmark of the Savitzky-Golay filter.
+ *
+ * This tool measures the speed of `mscript_savgol.h` on a noisy signal of
+ * 1 million points (or the number of points given on the command line). It
+ * compares the scalar and the vectorized implementation, checks that both
+ * give the same result, and checks that filtering the signal as a stream in
+ * small chunks gives the same result as filtering the complete array.
+ *
+ * Build and run it using "make benchmark".
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mscript_savgol.h"
+
+/// Default number of points.
+#define DEFAULT_NR_OF_POINTS 1000000
+
+/// Number of times each measurement is repeated (the fastest is reported).
+#define NR_OF_REPEATS 5
+
+/// Number of points per chunk in the streaming test.
+#define CHUNK_SIZE 37
+
+/**
+ * Get the current time in seconds.
+ */
+static double get_time(void)
+{
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Get the largest absolute difference between two arrays.
+ */
+static double max_difference(double const * a, double const * b, size_t count)
+{
+	double max = 0.0;
+	for (size_t i = 0; i < count; ++i) {
+		double diff = fabs(a[i] - b[i]);
+		if (diff > max) {
+			max = diff;
+		}
+	}
+	return max;
+}
+
+/**
+ * Apply a filter to the complete array and return the shortest time of
+ * several runs.
+ */
+static double time_apply(MscriptSavgol_t * filter, double const * input, size_t count,
+	double * output)
+{
+	double best = INFINITY;
+	for (int i = 0; i < NR_OF_REPEATS; ++i) {
+		double start = get_time();
+		mscript_savgol_apply(filter, input, count, output);
+		double elapsed = get_time() - start;
+		if (elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+/**
+ * Filter the array as a stream, in small chunks.
+ */
+static void apply_streaming(MscriptSavgol_t * filter, double const * input, size_t count,
+	double * output)
+{
+	size_t nr_of_outputs = 0;
+	mscript_savgol_reset(filter);
+	for (size_t i = 0; i < count; i += CHUNK_SIZE) {
+		size_t n = (count - i < CHUNK_SIZE) ? count - i : CHUNK_SIZE;
+		nr_of_outputs += mscript_savgol_process(filter, &input[i], n, &output[nr_of_outputs]);
+	}
+	mscript_savgol_finish(filter, &output[nr_of_outputs]);
+}
+
+/**
+ * Run the benchmark for one filter configuration.
+ *
+ * \return `false` if the results of the implementations differ.
+ */
+static bool run(char const * name, unsigned int half_width, unsigned int order,
+	unsigned int derivative, double spacing, double const * input, size_t count,
+	double * output, double * reference)
+{
+	MscriptSavgol_t * filter = mscript_savgol_create(half_width, order, derivative, spacing);
+	if (filter == NULL) {
+		fprintf(stderr, "Could not create the filter.\n");
+		return false;
+	}
+	bool success = true;
+	// Results are relative to the magnitude of the output.
+	double tolerance = (derivative == 0) ? 1e-9 : 1e-9 / spacing;
+
+	mscript_savgol_use_simd(filter, false);
+	double scalar_time = time_apply(filter, input, count, reference);
+	printf("%-26s scalar: %8.2f ms (%7.1f Mpoints/s)\n", name, scalar_time * 1e3,
+		count / scalar_time * 1e-6);
+
+	if (mscript_savgol_has_simd()) {
+		mscript_savgol_use_simd(filter, true);
+		double simd_time = time_apply(filter, input, count, output);
+		double diff = max_difference(output, reference, count);
+		printf("%-26s AVX2:   %8.2f ms (%7.1f Mpoints/s, %.1fx, max. difference %.1E)\n", "",
+			simd_time * 1e3, count / simd_time * 1e-6, scalar_time / simd_time, diff);
+		if (diff > tolerance) {
+			success = false;
+		}
+	}
+
+	apply_streaming(filter, input, count, output);
+	double diff = max_difference(output, reference, count);
+	printf("%-26s stream: max. difference %.1E\n", "", diff);
+	if (diff > tolerance) {
+		success = false;
+	}
+
+	mscript_savgol_destroy(filter);
+	return success;
+}
+
+int main(int argc, char ** argv)
+{
+	size_t count = DEFAULT_NR_OF_POINTS;
+	if (argc > 1) {
+		count = strtoul(argv[1], NULL, 10);
+	}
+	if (count < 1) {
+		fprintf(stderr, "USAGE: %s [NR_OF_POINTS]\n", argv[0]);
+		return 1;
+	}
+
+	double * input = malloc(count * sizeof(double));
+	double * output = malloc(count * sizeof(double));
+	double * reference = malloc(count * sizeof(double));
+	if ((input == NULL) || (output == NULL) || (reference == NULL)) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+
+	// A voltammogram-like signal: a few Gaussian peaks on a sloping baseline,
+	// with uniform noise.
+	double const spacing = 1e-5; // V
+	srand(1);
+	for (size_t i = 0; i < count; ++i) {
+		double x = (double)i / count;
+		double signal = 1e-6 * x;
+		for (int peak = 1; peak <= 3; ++peak) {
+			double d = (x - 0.25 * peak) / 0.02;
+			signal += 2e-6 * exp(-0.5 * d * d);
+		}
+		input[i] = signal + 1e-7 * ((double)rand() / RAND_MAX - 0.5);
+	}
+
+	printf("%zu points, AVX2 %s\n\n", count,
+		mscript_savgol_has_simd() ? "available" : "not available");
+
+	bool success = true;
+	success &= run("smooth, window 11, order 2", 5, 2, 0, spacing, input, count, output,
+		reference);
+	success &= run("smooth, window 31, order 4", 15, 4, 0, spacing, input, count, output,
+		reference);
+	success &= run("derivative, window 21", 10, 2, 1, spacing, input, count, output,
+		reference);
+
+	free(input);
+	free(output);
+	free(reference);
+	if (!success) {
+		printf("\nThe results differ.\n");
+		return 1;
+	}
+	return 0;
+}
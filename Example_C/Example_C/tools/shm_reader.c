@@ -0,0 +1,176 @@
+/**
+ * \file
+ * Reader of the data packages published in shared memory.
+ *
+ * The example publishes the data packages of all devices in a ring buffer in
+ * shared memory when it is started with `--publish NAME` (see
+ * `mscript_shm_ring.h`). This tool shows how another process, e.g. a plotting
+ * program or an archiver, reads the live data: it prints each package
+ * (optionally only those of one device or channel), the number of packages
+ * that were lost because the reader was too slow, and the latency from
+ * receiving a package to reading it. Any number of readers can run at the
+ * same time. When the example stops, the reader waits for the next run.
+ *
+ * Linux only.
+ *
+ * ----------------------------------------------------------------------------
+ *
+ *	\copyright (c) 2026 PalmSens BV
+ *	All rights reserved.
+ *
+ *	Redistribution and use in source and binary forms, with or without
+ *	modification, are permitted provided that the following conditions are met:
+ *
+ *		- Redistributions of source code must retain the above copyright notice,
+ *		  this list of conditions and the following disclaimer.
+ *		- Neither the name of PalmSens BV nor the names of its contributors
+ *		  may be used to endorse or promote products derived from this software
+ *		  without specific prior written permission.
+ *		- This license does not release you from any requirement to obtain separate 
+ *		  licenses from 3rd party patent holders to use this software.
+ *		- Use of the software either in source or binary form must be connected to, 
+ *		  run on or loaded to an PalmSens BV component.
+ *
+ *	DISCLAIMER: THIS SOFTWARE IS PROVIDED BY PALMSENS "AS IS" AND ANY EXPRESS OR
+ *	IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *	MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ *	EVENT SHALL THE REGENTS AND CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *	OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *	LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *	NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *	EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mscript.h"
+#include "mscript_shm_ring.h"
+
+/// Time between checks for new packages.
+#define POLL_INTERVAL_MS 1
+
+/// Time between attempts to open the ring.
+#define OPEN_INTERVAL_MS 500
+
+/** Options and counters of the reader. */
+typedef struct {
+	/** Device to show, or 0 for all devices. */
+	unsigned int device;
+	/** Channel to show, or -2 for all channels. */
+	int channel;
+	bool is_quiet;
+	uint64_t nr_of_packages;
+	uint64_t nr_lost;
+	uint64_t total_latency_us;
+	uint64_t max_latency_us;
+} Reader_t;
+
+/**
+ * Print a package.
+ */
+static void print_package(MscriptShmPackage_t const * package)
+{
+	printf("%" PRIu64 " [%u]", package->sequence, package->device);
+	if (package->channel != MSCRIPT_SHM_NO_CHANNEL) {
+		printf(" ch%02d", package->channel);
+	}
+	printf(" M%u #%u:", package->meas_loop_index, package->package_index);
+	for (uint32_t i = 0; i < package->nr_of_values; ++i) {
+		MscriptShmValue_t const * value = &package->values[i];
+		printf(" %s=%g", mscript_vartype_to_string(value->variable_type), value->value);
+	}
+	printf("\n");
+}
+
+/**
+ * Read the packages of one run, until the ring is closed.
+ */
+static void read_run(Reader_t * reader, MscriptShmReader_t * shm_reader)
+{
+	MscriptShmPackage_t package;
+	uint64_t nr_lost;
+	for (;;) {
+		// Check for closing before reading, so no package is missed.
+		bool is_closed = mscript_shm_reader_is_closed(shm_reader);
+		bool has_package = mscript_shm_reader_read(shm_reader, &package, &nr_lost);
+		if (nr_lost > 0) {
+			printf("Overrun: %" PRIu64 " packages lost.\n", nr_lost);
+			reader->nr_lost += nr_lost;
+		}
+		if (!has_package) {
+			if (is_closed) {
+				return;
+			}
+			mscript_sleep_ms(POLL_INTERVAL_MS);
+			continue;
+		}
+		if (((reader->device != 0) && (package.device != reader->device))
+			|| ((reader->channel != -2) && (package.channel != reader->channel))) {
+			continue;
+		}
+		uint64_t latency_us = mscript_get_time_us() - package.receive_time_us;
+		++reader->nr_of_packages;
+		reader->total_latency_us += latency_us;
+		if (latency_us > reader->max_latency_us) {
+			reader->max_latency_us = latency_us;
+		}
+		if (!reader->is_quiet) {
+			print_package(&package);
+		}
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	Reader_t reader = { .device = 0, .channel = -2 };
+	int arg_index = 1;
+	for (; arg_index < argc; ++arg_index) {
+		if (!strcmp(argv[arg_index], "--device") && (arg_index + 1 < argc)) {
+			reader.device = (unsigned int)atoi(argv[++arg_index]);
+		} else if (!strcmp(argv[arg_index], "--channel") && (arg_index + 1 < argc)) {
+			reader.channel = atoi(argv[++arg_index]);
+		} else if (!strcmp(argv[arg_index], "--quiet")) {
+			reader.is_quiet = true;
+		} else {
+			break;
+		}
+	}
+	if (arg_index + 1 != argc) {
+		printf("USAGE: %s [--device N] [--channel N] [--quiet] NAME\n"
+			"    NAME: the name passed to '--publish' of the example (e.g. /mscript).\n"
+			"    Use channel -1 for the packages without a channel.\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	char const * name = argv[arg_index];
+
+	for (;;) {
+		MscriptShmReader_t * shm_reader = mscript_shm_reader_open(name);
+		if (shm_reader == NULL) {
+			mscript_sleep_ms(OPEN_INTERVAL_MS);
+			continue;
+		}
+		printf("Reading %s.\n", name);
+		read_run(&reader, shm_reader);
+		mscript_shm_reader_close(shm_reader);
+		printf("Ring closed: %" PRIu64 " packages read, %" PRIu64 " lost", reader.nr_of_packages,
+			reader.nr_lost);
+		if (reader.nr_of_packages > 0) {
+			printf(", latency %.3f ms (mean), %.3f ms (max)",
+				1e-3 * (double)reader.total_latency_us / (double)reader.nr_of_packages,
+				1e-3 * (double)reader.max_latency_us);
+		}
+		printf(".\n");
+		fflush(stdout);
+		reader.nr_of_packages = 0;
+		reader.nr_lost = 0;
+		reader.total_latency_us = 0;
+		reader.max_latency_us = 0;
+	}
+}